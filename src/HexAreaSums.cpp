@@ -0,0 +1,58 @@
+#include "HexAreaSums.h"
+
+#include <algorithm>
+#include <cmath>
+
+double HexAreaSums::get_entry(int q, int r) const {
+	// Entry (q, r) sums every cell before it, so it is clamped to the box rather than cut off.
+	int column = std::clamp(q - min_q, 0, width);
+	int row = std::clamp(r - min_r, 0, height);
+	return table[size_t(row) * size_t(width + 1) + size_t(column)];
+}
+
+double HexAreaSums::get_table_sum(int q_from, int r_from, int q_to, int r_to) const {
+	if (table.empty() || q_from > q_to || r_from > r_to) {
+		return 0.0;
+	}
+	return get_entry(q_to + 1, r_to + 1) - get_entry(q_from, r_to + 1) - get_entry(q_to + 1, r_from) + get_entry(q_from, r_from);
+}
+
+bool HexAreaSums::has_table() const {
+	return is_built;
+}
+
+bool HexAreaSums::needs_rebuild() const {
+	double limit = std::max(64.0, std::sqrt(double(width) * double(height)));
+	return double(correction_count) > limit;
+}
+
+void HexAreaSums::set_cell(int q, int r, double value) {
+	std::map<int, double> &row = corrections[r];
+	auto correction = row.find(q);
+	if (correction == row.end()) {
+		correction = row.emplace(q, 0.0).first;
+		correction_count++;
+	}
+	correction->second = value - get_table_sum(q, r, q, r);
+}
+
+double HexAreaSums::get_row_sum(int r, int q_from, int q_to) const {
+	double sum = get_table_sum(q_from, r, q_to, r);
+	auto row = corrections.find(r);
+	if (row != corrections.end()) {
+		for (auto correction = row->second.lower_bound(q_from); correction != row->second.end() && correction->first <= q_to; ++correction) {
+			sum += correction->second;
+		}
+	}
+	return sum;
+}
+
+double HexAreaSums::get_box_sum(int q_from, int r_from, int q_to, int r_to) const {
+	double sum = get_table_sum(q_from, r_from, q_to, r_to);
+	for (auto row = corrections.lower_bound(r_from); row != corrections.end() && row->first <= r_to; ++row) {
+		for (auto correction = row->second.lower_bound(q_from); correction != row->second.end() && correction->first <= q_to; ++correction) {
+			sum += correction->second;
+		}
+	}
+	return sum;
+}
@@ -0,0 +1,128 @@
+/**
+ * @file HexAreaSums.h
+ * @brief A summed-area table over one layer of the HexGrid, for the sum of a layer over a hexagon or parallelogram without visiting its cells.
+ * @details The table is built over the axial box around the map's tiles, with the layer's value at every cell that holds a tile and zero elsewhere. Any box of q and r, which is a parallelogram on the map, is summed from four entries. A hexagon is summed one row at a time.
+ * Cells that change after the table is built are kept as corrections on top of it, row by row, so writes cost nothing until the next sum. The table is only rebuilt once the corrections grow past the square root of its size.
+ * @version 1.0
+ *
+ *
+ *
+ */
+#ifndef GODOT_HEX_GRID_EXTENSION_HEX_AREA_SUMS_H
+#define GODOT_HEX_GRID_EXTENSION_HEX_AREA_SUMS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <vector>
+
+/// @brief The sums of one layer. Not a Godot object, the HexGrid owns its tables.
+class HexAreaSums
+{
+    int min_q{};
+    int min_r{};
+    int width{};
+    int height{};
+    /**
+     * @brief The sum of every cell of the box before an entry, (width + 1) by (height + 1), row by row.
+     *
+     */
+    std::vector<double> table{};
+    /**
+     * @brief A map that maps a row to a map of the cells changed in it since the build, and how much they changed by.
+     *
+     */
+    std::map<int, std::map<int, double>> corrections{};
+    size_t correction_count{};
+    bool is_built{};
+
+    double get_entry(int q, int r) const;
+    /**
+     * @brief Sums the table over a box, without the corrections. Parts outside the table count as zero.
+     *
+     */
+    double get_table_sum(int q_from, int r_from, int q_to, int r_to) const;
+
+public:
+    /**
+     * @brief The revision the layer was added at when the table was built, to notice a layer that was replaced.
+     *
+     */
+    uint64_t created{};
+    /**
+     * @brief The grid's revision the corrections are up to date with.
+     *
+     */
+    uint64_t synced_revision{};
+
+    /**
+     * @brief Builds the table over a box, dropping the corrections.
+     *
+     * @param new_min_q The box's lowest q-coordinate.
+     * @param new_min_r The box's lowest r-coordinate.
+     * @param new_width The amount of q-coordinates in the box.
+     * @param new_height The amount of r-coordinates in the box.
+     * @param for_each_value Called as for_each_value(add), and should call add(q, r, value) for every cell with a value inside the box.
+     */
+    template <typename Function>
+    void build(int new_min_q, int new_min_r, int new_width, int new_height, Function &&for_each_value) {
+        min_q = new_min_q;
+        min_r = new_min_r;
+        width = new_width;
+        height = new_height;
+        table.assign(size_t(width + 1) * size_t(height + 1), 0.0);
+        int stride = width + 1;
+        for_each_value([this, stride](int q, int r, double value) {
+            table[size_t(r - min_r + 1) * stride + size_t(q - min_q + 1)] += value;
+        });
+        for (int row = 1; row <= height; row++) {
+            double row_sum = 0.0;
+            for (int column = 1; column <= width; column++) {
+                row_sum += table[size_t(row) * stride + column];
+                table[size_t(row) * stride + column] = row_sum + table[size_t(row - 1) * stride + column];
+            }
+        }
+        corrections.clear();
+        correction_count = 0;
+        is_built = true;
+    }
+    /**
+     * @brief Checks if the table has been built.
+     *
+     */
+    bool has_table() const;
+    /**
+     * @brief Checks if the corrections grew large enough that rebuilding is cheaper than carrying them.
+     *
+     */
+    bool needs_rebuild() const;
+    /**
+     * @brief Records a cell's current value, as a correction on top of the table.
+     *
+     * @param q The q-coordinate.
+     * @param r The r-coordinate.
+     * @param value The cell's value now, zero if it has no tile.
+     */
+    void set_cell(int q, int r, double value);
+    /**
+     * @brief Sums a run of cells in one row.
+     *
+     * @param r The row's r-coordinate.
+     * @param q_from The first q-coordinate.
+     * @param q_to The last q-coordinate, included.
+     * @return double The sum.
+     */
+    double get_row_sum(int r, int q_from, int q_to) const;
+    /**
+     * @brief Sums a box of cells.
+     *
+     * @param q_from The first q-coordinate.
+     * @param r_from The first r-coordinate.
+     * @param q_to The last q-coordinate, included.
+     * @param r_to The last r-coordinate, included.
+     * @return double The sum.
+     */
+    double get_box_sum(int q_from, int r_from, int q_to, int r_to) const;
+};
+
+#endif //GODOT_HEX_GRID_EXTENSION_HEX_AREA_SUMS_H
@@ -0,0 +1,356 @@
+#include "HexCellularAutomaton.h"
+#include "HexGrid.h"
+#include "godot_cpp/core/class_db.hpp"
+#include "godot_cpp/classes/worker_thread_pool.hpp"
+#include "godot_cpp/variant/callable_method_pointer.hpp"
+
+#include <algorithm>
+#include <array>
+#include <limits>
+
+namespace {
+	// Below this many tasks, handing them to the WorkerThreadPool costs more than it saves.
+	constexpr int MIN_PARALLEL_TASKS = 4;
+
+	// A chunk padded by one cell on every side, so every cell's neighbors are at fixed offsets.
+	constexpr int HALO_SIZE = HEX_CHUNK_SIZE + 2;
+	constexpr int HALO_CELLS = HALO_SIZE * HALO_SIZE;
+	constexpr std::array<int, 6> HALO_NEIGHBORS = { 1, -1, HALO_SIZE, -HALO_SIZE, 1 - HALO_SIZE, HALO_SIZE - 1 };
+
+	using Halo = std::array<float, HALO_CELLS>;
+
+	// Gets the index of a chunk cell in the padded array.
+	inline int halo_index(int cell) {
+		return ((cell >> HEX_CHUNK_SHIFT) + 1) * HALO_SIZE + (cell & HEX_CHUNK_MASK) + 1;
+	}
+
+	// Sums the padded array over every cell's neighbors.
+	void sum_neighbors(const Halo &halo, HexLayer::Chunk &sums) {
+		for (int row = 0; row < HEX_CHUNK_SIZE; row++) {
+			const float* center = halo.data() + (row + 1) * HALO_SIZE + 1;
+			float* out = sums.data() + (row << HEX_CHUNK_SHIFT);
+			for (int col = 0; col < HEX_CHUNK_SIZE; col++) {
+				out[col] = center[col + HALO_NEIGHBORS[0]] + center[col + HALO_NEIGHBORS[1]] + center[col + HALO_NEIGHBORS[2]] + center[col + HALO_NEIGHBORS[3]] + center[col + HALO_NEIGHBORS[4]] + center[col + HALO_NEIGHBORS[5]];
+			}
+		}
+	}
+}
+
+HexCellularAutomaton::HexCellularAutomaton() {
+
+}
+
+int HexCellularAutomaton::find_target(const godot::StringName &layer) {
+	for (size_t i = 0; i < target_layers.size(); i++) {
+		if (target_layers[i] == layer) {
+			return int(i);
+		}
+	}
+	target_layers.push_back(layer);
+	back_chunks.emplace_back();
+	return int(target_layers.size()) - 1;
+}
+
+int HexCellularAutomaton::add_count_rule(const godot::StringName &target_layer, float from_state, float to_state, const godot::StringName &source_layer, float neighbor_state, int min_count, int max_count) {
+	ERR_FAIL_COND_V_MSG(min_count > max_count, -1, "Minimum count cannot be more than the maximum count.");
+
+	Rule rule{};
+	rule.type = RULE_NEIGHBOR_COUNT;
+	rule.target = find_target(target_layer);
+	rule.source_layer = source_layer;
+	rule.from_state = from_state;
+	rule.to_state = to_state;
+	rule.neighbor_state = neighbor_state;
+	rule.min_count = min_count;
+	rule.max_count = max_count;
+	rules.push_back(rule);
+	wake_everything = true;
+	return int(rules.size()) - 1;
+}
+
+int HexCellularAutomaton::add_sum_rule(const godot::StringName &target_layer, const godot::StringName &source_layer, float self_weight, float neighbor_weight, float bias, float min_value, float max_value) {
+	ERR_FAIL_COND_V_MSG(min_value > max_value, -1, "Minimum value cannot be more than the maximum value.");
+
+	Rule rule{};
+	rule.type = RULE_NEIGHBOR_SUM;
+	rule.target = find_target(target_layer);
+	rule.source_layer = source_layer;
+	rule.self_weight = self_weight;
+	rule.neighbor_weight = neighbor_weight;
+	rule.bias = bias;
+	rule.min_value = min_value;
+	rule.max_value = max_value;
+	rules.push_back(rule);
+	wake_everything = true;
+	return int(rules.size()) - 1;
+}
+
+int HexCellularAutomaton::add_table_rule(const godot::StringName &target_layer, const godot::PackedFloat32Array &table) {
+	ERR_FAIL_COND_V_MSG(table.is_empty(), -1, "Table cannot be empty.");
+
+	Rule rule{};
+	rule.type = RULE_TRANSITION_TABLE;
+	rule.target = find_target(target_layer);
+	rule.table.assign(table.ptr(), table.ptr() + table.size());
+	rules.push_back(rule);
+	wake_everything = true;
+	return int(rules.size()) - 1;
+}
+
+void HexCellularAutomaton::clear_rules() {
+	rules.clear();
+	target_layers.clear();
+	back_chunks.clear();
+	active_chunks.clear();
+	wake_everything = true;
+}
+
+int HexCellularAutomaton::get_rule_count() const {
+	return int(rules.size());
+}
+
+void HexCellularAutomaton::wake_all() {
+	wake_everything = true;
+}
+
+void HexCellularAutomaton::wake_hex(int q, int r) {
+	woken_hexes.push_back(std::pair<int, int>(q, r));
+}
+
+int HexCellularAutomaton::get_active_chunk_count() const {
+	return int(active_chunks.size());
+}
+
+void HexCellularAutomaton::step_chunk_task(uint32_t index) {
+	ChunkTask &task = chunk_tasks[index];
+	const HexTileStorage &storage = grid->get_tile_storage();
+	std::pair<int, int> chunk = hex_chunk_unkey(task.key);
+	int chunk_q = chunk.first << HEX_CHUNK_SHIFT;
+	int chunk_r = chunk.second << HEX_CHUNK_SHIFT;
+
+	// Neighbors come from the padding, and on wrapping maps also from the part of the chunk past the seam. Both are read through their canonical coordinates, but only the chunk's own cells are written.
+	std::array<std::pair<int, int>, HALO_CELLS> hexes{};
+	Halo exists{};
+	std::array<char, HALO_CELLS> owned{};
+	for (int row = 0; row < HALO_SIZE; row++) {
+		for (int col = 0; col < HALO_SIZE; col++) {
+			int halo = row * HALO_SIZE + col;
+			bool padding = row == 0 || col == 0 || row == HALO_SIZE - 1 || col == HALO_SIZE - 1;
+			std::pair<int, int> hex(chunk_q + col - 1, chunk_r + row - 1);
+			std::pair<int, int> canonical = storage.canonicalize(hex);
+			hexes[halo] = canonical;
+			owned[halo] = !padding && canonical == hex;
+			exists[halo] = storage.contains(canonical.first, canonical.second) && storage.get(canonical.first, canonical.second) ? 1.0f : 0.0f;
+			if (!owned[halo] && exists[halo] != 0.0f) {
+				int64_t key = hex_chunk_key_of(canonical.first, canonical.second);
+				if (key != task.key && std::find(task.neighbor_chunks.begin(), task.neighbor_chunks.end(), key) == task.neighbor_chunks.end()) {
+					task.neighbor_chunks.push_back(key);
+				}
+			}
+		}
+	}
+
+	auto gather = [&](const HexLayer* layer, Halo &values) {
+		const HexLayer::Chunk* center = layer->find_chunk(task.key);
+		for (int halo = 0; halo < HALO_CELLS; halo++) {
+			values[halo] = 0.0f;
+		}
+		for (int row = 0; row < HALO_SIZE; row++) {
+			for (int col = 0; col < HALO_SIZE; col++) {
+				int halo = row * HALO_SIZE + col;
+				if (exists[halo] == 0.0f) {
+					continue;
+				}
+				if (!owned[halo] || !center) {
+					values[halo] = layer->get_value(hexes[halo].first, hexes[halo].second);
+				} else {
+					values[halo] = (*center)[((row - 1) << HEX_CHUNK_SHIFT) | (col - 1)];
+				}
+			}
+		}
+	};
+
+	// Every rule reads the values from the start of the step, and writes over the back buffer.
+	std::vector<HexLayer::Chunk> fronts(targets.size());
+	for (size_t target = 0; target < targets.size(); target++) {
+		const HexLayer::Chunk* front = targets[target]->find_chunk(task.key);
+		if (front) {
+			fronts[target] = *front;
+		} else {
+			fronts[target].fill(targets[target]->get_default_value());
+		}
+		*task.back[target] = fronts[target];
+	}
+
+	HexLayer::Chunk mask{};
+	for (int cell = 0; cell < HEX_CHUNK_CELLS; cell++) {
+		int halo = halo_index(cell);
+		mask[cell] = owned[halo] ? exists[halo] : 0.0f;
+	}
+
+	Halo neighbors{};
+	HexLayer::Chunk sums{};
+	for (const Rule &rule : rules) {
+		const HexLayer::Chunk &self = fronts[rule.target];
+		HexLayer::Chunk &out = *task.back[rule.target];
+
+		switch (rule.type) {
+			case RULE_NEIGHBOR_COUNT: {
+				gather(rule.source, neighbors);
+				for (int halo = 0; halo < HALO_CELLS; halo++) {
+					neighbors[halo] = (exists[halo] != 0.0f && neighbors[halo] == rule.neighbor_state) ? 1.0f : 0.0f;
+				}
+				sum_neighbors(neighbors, sums);
+				float min_count = float(rule.min_count);
+				float max_count = float(rule.max_count);
+				for (int cell = 0; cell < HEX_CHUNK_CELLS; cell++) {
+					bool matches = mask[cell] != 0.0f && self[cell] == rule.from_state && sums[cell] >= min_count && sums[cell] <= max_count;
+					out[cell] = matches ? rule.to_state : out[cell];
+				}
+				break;
+			}
+			case RULE_NEIGHBOR_SUM: {
+				gather(rule.source, neighbors);
+				sum_neighbors(neighbors, sums);
+				for (int cell = 0; cell < HEX_CHUNK_CELLS; cell++) {
+					float value = std::min(std::max(rule.self_weight * self[cell] + rule.neighbor_weight * sums[cell] + rule.bias, rule.min_value), rule.max_value);
+					out[cell] = mask[cell] != 0.0f ? value : out[cell];
+				}
+				break;
+			}
+			default: {
+				int size = int(rule.table.size());
+				for (int cell = 0; cell < HEX_CHUNK_CELLS; cell++) {
+					int state = int(self[cell]);
+					if (mask[cell] != 0.0f && float(state) == self[cell] && state >= 0 && state < size) {
+						out[cell] = rule.table[state];
+					}
+				}
+				break;
+			}
+		}
+	}
+
+	for (size_t target = 0; target < targets.size(); target++) {
+		task.changed[target] = fronts[target] != *task.back[target];
+	}
+}
+
+void HexCellularAutomaton::run_tasks(int count, void (HexCellularAutomaton::*task)(uint32_t)) {
+	godot::WorkerThreadPool* pool = godot::WorkerThreadPool::get_singleton();
+	if (count < MIN_PARALLEL_TASKS || pool == nullptr) {
+		for (int i = 0; i < count; i++) {
+			(this->*task)(i);
+		}
+		return;
+	}
+
+	int64_t group = pool->add_group_task(godot::callable_mp(this, task), count, -1, false, "HexCellularAutomaton");
+	pool->wait_for_group_task_completion(group);
+}
+
+int HexCellularAutomaton::step(HexGrid* target_grid) {
+	ERR_FAIL_NULL_V_MSG(target_grid, 0, "Grid cannot be null.");
+
+	// Layers are looked up once, so the tasks never touch the grid's layer map.
+	targets.clear();
+	for (const godot::StringName &name : target_layers) {
+		HexLayer* layer = target_grid->find_layer(name);
+		ERR_FAIL_NULL_V_MSG(layer, 0, "Cannot step a non-existing layer.");
+		targets.push_back(layer);
+	}
+	for (Rule &rule : rules) {
+		if (rule.type != RULE_TRANSITION_TABLE) {
+			rule.source = target_grid->find_layer(rule.source_layer);
+			ERR_FAIL_NULL_V_MSG(rule.source, 0, "Cannot read neighbors from a non-existing layer.");
+		}
+	}
+
+	const HexTileStorage &storage = target_grid->get_tile_storage();
+	if (wake_everything) {
+		active_chunks.clear();
+		storage.for_each([this](int q, int r, HexTile*) {
+			active_chunks.insert(hex_chunk_key_of(q, r));
+		});
+		wake_everything = false;
+	}
+	for (std::pair<int, int> hex : woken_hexes) {
+		hex = storage.canonicalize(hex);
+		active_chunks.insert(hex_chunk_key_of(hex.first, hex.second));
+		storage.for_each_neighbor(hex.first, hex.second, [this](int q, int r, HexTile*) {
+			active_chunks.insert(hex_chunk_key_of(q, r));
+		});
+	}
+	woken_hexes.clear();
+	if (rules.empty()) {
+		return 0;
+	}
+
+	// Back buffers are created up front, since creating them is not thread safe.
+	grid = target_grid;
+	chunk_tasks.clear();
+	chunk_tasks.reserve(active_chunks.size());
+	for (int64_t key : active_chunks) {
+		ChunkTask task{};
+		task.key = key;
+		task.changed.assign(targets.size(), 0);
+		for (size_t target = 0; target < targets.size(); target++) {
+			std::unique_ptr<HexLayer::Chunk> &buffer = back_chunks[target][key];
+			if (!buffer) {
+				buffer = std::make_unique<HexLayer::Chunk>();
+			}
+			task.back.push_back(buffer.get());
+		}
+		chunk_tasks.push_back(std::move(task));
+	}
+
+	run_tasks(chunk_tasks.size(), &HexCellularAutomaton::step_chunk_task);
+
+	// Only chunks that changed, and the chunks next to them, can change during the next step.
+	active_chunks.clear();
+	std::vector<godot::Ref<HexRegion>> changed_cells(targets.size());
+	for (ChunkTask &task : chunk_tasks) {
+		bool changed = false;
+		for (size_t target = 0; target < targets.size(); target++) {
+			if (task.changed[target]) {
+				if (changed_cells[target].is_null()) {
+					changed_cells[target].instantiate();
+				}
+				targets[target]->swap_chunk(task.key, back_chunks[target][task.key]);
+				target_grid->mark_layer_chunk(target_layers[target], task.key, back_chunks[target][task.key].get(), changed_cells[target].ptr());
+				changed = true;
+			}
+		}
+		if (changed) {
+			active_chunks.insert(task.key);
+			active_chunks.insert(task.neighbor_chunks.begin(), task.neighbor_chunks.end());
+		}
+	}
+	// Chunks are swapped in without set_layer_value, so listeners such as HexPathPlanner are told once per layer instead.
+	for (size_t target = 0; target < targets.size(); target++) {
+		if (changed_cells[target].is_valid() && !changed_cells[target]->is_empty()) {
+			target_grid->emit_signal("layer_region_changed", target_layers[target], changed_cells[target]);
+		}
+	}
+
+	int stepped = chunk_tasks.size();
+	grid = nullptr;
+	chunk_tasks.clear();
+	return stepped;
+}
+
+void HexCellularAutomaton::_bind_methods() {
+	godot::ClassDB::bind_method(godot::D_METHOD("add_count_rule", "target_layer", "from_state", "to_state", "source_layer", "neighbor_state", "min_count", "max_count"), &HexCellularAutomaton::add_count_rule, DEFVAL(6));
+	godot::ClassDB::bind_method(godot::D_METHOD("add_sum_rule", "target_layer", "source_layer", "self_weight", "neighbor_weight", "bias", "min_value", "max_value"), &HexCellularAutomaton::add_sum_rule, DEFVAL(0.0f), DEFVAL(-std::numeric_limits<float>::infinity()), DEFVAL(std::numeric_limits<float>::infinity()));
+	godot::ClassDB::bind_method(godot::D_METHOD("add_table_rule", "target_layer", "table"), &HexCellularAutomaton::add_table_rule);
+	godot::ClassDB::bind_method(godot::D_METHOD("clear_rules"), &HexCellularAutomaton::clear_rules);
+	godot::ClassDB::bind_method(godot::D_METHOD("get_rule_count"), &HexCellularAutomaton::get_rule_count);
+	godot::ClassDB::bind_method(godot::D_METHOD("wake_all"), &HexCellularAutomaton::wake_all);
+	godot::ClassDB::bind_method(godot::D_METHOD("wake_hex", "q", "r"), &HexCellularAutomaton::wake_hex);
+	godot::ClassDB::bind_method(godot::D_METHOD("get_active_chunk_count"), &HexCellularAutomaton::get_active_chunk_count);
+	godot::ClassDB::bind_method(godot::D_METHOD("step", "grid"), &HexCellularAutomaton::step);
+
+	godot::ClassDB::bind_integer_constant(get_class_static(), "RuleType", "RULE_NEIGHBOR_COUNT", RULE_NEIGHBOR_COUNT);
+	godot::ClassDB::bind_integer_constant(get_class_static(), "RuleType", "RULE_NEIGHBOR_SUM", RULE_NEIGHBOR_SUM);
+	godot::ClassDB::bind_integer_constant(get_class_static(), "RuleType", "RULE_TRANSITION_TABLE", RULE_TRANSITION_TABLE);
+}
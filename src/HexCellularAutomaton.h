@@ -0,0 +1,212 @@
+/**
+ * @file HexCellularAutomaton.h
+ * @brief Steps cellular automaton rules over HexGrid data layers, such as fire spread, water flow and plant growth.
+ * @details Every step reads the layers as they were at the start of the step and writes into back buffers, which are swapped in once every chunk is done, so the order cells are visited in never matters. Chunks run in parallel on the WorkerThreadPool. Each one first gathers its cells and their neighbors into a padded array per layer, so the rules themselves run over flat arrays with fixed offsets. A chunk is only stepped if it or a neighboring chunk changed during the last step, since the rules are deterministic and an unchanged neighborhood gives an unchanged result.
+ * @version 1.0
+ *
+ *
+ *
+ */
+#ifndef GODOT_HEX_GRID_EXTENSION_HEX_CELLULAR_AUTOMATON_H
+#define GODOT_HEX_GRID_EXTENSION_HEX_CELLULAR_AUTOMATON_H
+
+#include "godot_cpp/classes/ref_counted.hpp"
+#include "godot_cpp/core/object.hpp"
+#include "HexLayer.h"
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+class HexGrid;
+
+/// @brief A set of rules that update float layers tick by tick. Only cells holding a tile are updated or counted as neighbors.
+class HexCellularAutomaton : public godot::RefCounted
+{
+    GDCLASS(HexCellularAutomaton, godot::RefCounted)
+
+public:
+    /**
+     * @brief Enumerations for the kinds of rules.
+     *
+     */
+    enum RuleType {
+        /// @brief Changes a cell from one state to another if the amount of neighbors in a given state lies within a range.
+        RULE_NEIGHBOR_COUNT,
+        /// @brief Sets a cell to a weighted sum of itself and its neighbors, clamped to a range.
+        RULE_NEIGHBOR_SUM,
+        /// @brief Maps every whole state to the next one through a table.
+        RULE_TRANSITION_TABLE
+    };
+
+private:
+    /**
+     * @brief A single rule. Only the fields of its type are used.
+     *
+     */
+    struct Rule {
+        int type{};
+        /// @brief The index into target_layers of the layer the rule writes.
+        int target{};
+        /// @brief The layer the neighbors are read from.
+        godot::StringName source_layer{};
+        float from_state{};
+        float to_state{};
+        float neighbor_state{};
+        int min_count{};
+        int max_count{};
+        float self_weight{};
+        float neighbor_weight{};
+        float bias{};
+        float min_value{};
+        float max_value{};
+        std::vector<float> table{};
+        /// @brief The source layer, resolved at the start of every step.
+        const HexLayer* source{};
+    };
+    /**
+     * @brief The work for one chunk.
+     *
+     */
+    struct ChunkTask {
+        int64_t key{};
+        /// @brief The back buffer of each target layer.
+        std::vector<HexLayer::Chunk*> back{};
+        /// @brief Whether each target layer changed in this chunk.
+        std::vector<char> changed{};
+        /// @brief The other chunks holding neighbors of this chunk's cells, woken if this chunk changes.
+        std::vector<int64_t> neighbor_chunks{};
+    };
+
+    /**
+     * @brief The rules, applied in order. When several rules match a cell, the last one wins.
+     *
+     */
+    std::vector<Rule> rules{};
+    /**
+     * @brief The names of the layers written by the rules, each once.
+     *
+     */
+    std::vector<godot::StringName> target_layers{};
+    /**
+     * @brief The back buffers of every target layer, per chunk. They hold the previous values after a swap, and are reused by the next step.
+     *
+     */
+    std::vector<std::unordered_map<int64_t, std::unique_ptr<HexLayer::Chunk>>> back_chunks{};
+    /**
+     * @brief The chunks to step next.
+     *
+     */
+    std::unordered_set<int64_t> active_chunks{};
+    /**
+     * @brief The hexes changed from outside since the last step, whose chunks and neighboring chunks are woken.
+     *
+     */
+    std::vector<std::pair<int, int>> woken_hexes{};
+    /**
+     * @brief Whether the next step has to run every chunk holding a tile.
+     *
+     */
+    bool wake_everything{ true };
+    /**
+     * @brief The grid, target layers and chunks of the current step. Only valid inside step.
+     *
+     */
+    HexGrid* grid{};
+    std::vector<HexLayer*> targets{};
+    std::vector<ChunkTask> chunk_tasks{};
+
+    /**
+     * @brief Binds methods for usage in Godot.
+     *
+     */
+    static void _bind_methods();
+    /**
+     * @brief Gets the index of a target layer, adding it if needed.
+     *
+     */
+    int find_target(const godot::StringName &layer);
+    /**
+     * @brief Steps one chunk into its back buffers. Run on the WorkerThreadPool.
+     *
+     * @param index The index into chunk_tasks.
+     */
+    void step_chunk_task(uint32_t index);
+    /**
+     * @brief Runs a task once per index, on the WorkerThreadPool if there is enough work to be worth it.
+     *
+     * @param count The amount of indices.
+     * @param task The task to run.
+     */
+    void run_tasks(int count, void (HexCellularAutomaton::*task)(uint32_t));
+
+public:
+    HexCellularAutomaton();
+    /**
+     * @brief Adds a rule that changes a cell's state based on how many neighbors are in a given state, like fire catching from burning neighbors.
+     *
+     * @param target_layer The layer holding the cell's state, and the one written.
+     * @param from_state The state the cell has to be in.
+     * @param to_state The state the cell changes to.
+     * @param source_layer The layer the neighbors' states are read from.
+     * @param neighbor_state The state counted among the neighbors.
+     * @param min_count The least amount of counted neighbors.
+     * @param max_count The most amount of counted neighbors.
+     * @return int The index of the rule.
+     */
+    int add_count_rule(const godot::StringName &target_layer, float from_state, float to_state, const godot::StringName &source_layer, float neighbor_state, int min_count, int max_count);
+    /**
+     * @brief Adds a rule that sets a cell to self_weight * itself + neighbor_weight * the sum of its neighbors + bias, like water spreading out.
+     *
+     * @param target_layer The layer holding the cell's value, and the one written.
+     * @param source_layer The layer the neighbors' values are read from.
+     * @param self_weight The weight of the cell's own value.
+     * @param neighbor_weight The weight of each neighbor's value.
+     * @param bias A constant added to every cell.
+     * @param min_value The lowest result.
+     * @param max_value The highest result.
+     * @return int The index of the rule.
+     */
+    int add_sum_rule(const godot::StringName &target_layer, const godot::StringName &source_layer, float self_weight, float neighbor_weight, float bias, float min_value, float max_value);
+    /**
+     * @brief Adds a rule that moves every cell holding a whole state to table[state], like plants growing through stages. Other values are left alone.
+     *
+     * @param target_layer The layer holding the cell's state, and the one written.
+     * @param table The next state for each state from 0.
+     * @return int The index of the rule.
+     */
+    int add_table_rule(const godot::StringName &target_layer, const godot::PackedFloat32Array &table);
+    /**
+     * @brief Removes every rule and drops the back buffers.
+     *
+     */
+    void clear_rules();
+    int get_rule_count() const;
+    /**
+     * @brief Makes the next step run every chunk holding a tile. Call after editing the layers in bulk.
+     *
+     */
+    void wake_all();
+    /**
+     * @brief Makes the next step run the chunks around a hex. Call after editing a cell from outside.
+     *
+     * @param q The q-coordinate.
+     * @param r The r-coordinate.
+     */
+    void wake_hex(int q, int r);
+    /**
+     * @brief Gets the amount of chunks the next step will run, not counting woken ones.
+     *
+     */
+    int get_active_chunk_count() const;
+    /**
+     * @brief Applies every rule once. Layers are written without emitting the grid's layer_value_changed signal. Instead, layer_region_changed is emitted once per layer that changed, which HexPathPlanner repairs from. The changed cells are still recorded for the grid's deltas.
+     *
+     * @param target_grid The grid whose layers are stepped. Every layer the rules use has to exist.
+     * @return int The amount of chunks that were stepped.
+     */
+    int step(HexGrid* target_grid);
+};
+
+#endif //GODOT_HEX_GRID_EXTENSION_HEX_CELLULAR_AUTOMATON_H
@@ -0,0 +1,112 @@
+/**
+ * @file HexChunk.h
+ * @brief The chunk layout shared by the HexGrid's per-cell storage.
+ * @details Axial coordinates are split into 16 by 16 chunks. A chunk is addressed by the coordinates shifted right by four, and a cell inside it by the low four bits of each coordinate, q first. Arithmetic shifts keep negative coordinates in the right chunk.
+ * @version 1.0
+ *
+ *
+ *
+ */
+#ifndef GODOT_HEX_GRID_EXTENSION_HEX_CHUNK_H
+#define GODOT_HEX_GRID_EXTENSION_HEX_CHUNK_H
+
+#include <cstdint>
+#include <utility>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+/// @brief The amount of bits each coordinate is shifted by to get its chunk.
+inline constexpr int HEX_CHUNK_SHIFT = 4;
+/// @brief The width and height of a chunk, in cells.
+inline constexpr int HEX_CHUNK_SIZE = 1 << HEX_CHUNK_SHIFT;
+/// @brief The mask that gets a coordinate's position inside its chunk.
+inline constexpr int HEX_CHUNK_MASK = HEX_CHUNK_SIZE - 1;
+/// @brief The amount of cells in a chunk.
+inline constexpr int HEX_CHUNK_CELLS = HEX_CHUNK_SIZE * HEX_CHUNK_SIZE;
+/// @brief The amount of 64 bit words needed for one bit per cell.
+inline constexpr int HEX_CHUNK_WORDS = HEX_CHUNK_CELLS / 64;
+
+/**
+ * @brief Packs chunk coordinates into a single key. Keys sort by the chunk's q-coordinate first.
+ *
+ * @param chunk_q The chunk's q-coordinate.
+ * @param chunk_r The chunk's r-coordinate.
+ * @return int64_t The key.
+ */
+inline int64_t hex_chunk_key(int chunk_q, int chunk_r) {
+    return int64_t((uint64_t(uint32_t(chunk_q)) << 32) | uint64_t(uint32_t(chunk_r)));
+}
+
+/**
+ * @brief Gets the key of the chunk a cell is in.
+ *
+ * @param q The q-coordinate.
+ * @param r The r-coordinate.
+ * @return int64_t The chunk's key.
+ */
+inline int64_t hex_chunk_key_of(int q, int r) {
+    return hex_chunk_key(q >> HEX_CHUNK_SHIFT, r >> HEX_CHUNK_SHIFT);
+}
+
+/**
+ * @brief Unpacks a chunk key back into chunk coordinates.
+ *
+ * @param key The key.
+ * @return std::pair<int, int> The chunk's q-coordinate as its first, and r-coordinate as its second.
+ */
+inline std::pair<int, int> hex_chunk_unkey(int64_t key) {
+    return std::pair<int, int>(int(int32_t(uint32_t(uint64_t(key) >> 32))), int(int32_t(uint32_t(uint64_t(key)))));
+}
+
+/**
+ * @brief Gets a cell's index inside its chunk.
+ *
+ * @param q The q-coordinate.
+ * @param r The r-coordinate.
+ * @return int The index, from 0 to HEX_CHUNK_CELLS - 1.
+ */
+inline int hex_chunk_cell(int q, int r) {
+    return (q & HEX_CHUNK_MASK) | ((r & HEX_CHUNK_MASK) << HEX_CHUNK_SHIFT);
+}
+
+/**
+ * @brief Gets the coordinates of a cell from its chunk key and index.
+ *
+ * @param key The chunk's key.
+ * @param cell The cell's index inside the chunk.
+ * @return std::pair<int, int> The cell's axial coordinates.
+ */
+inline std::pair<int, int> hex_chunk_cell_co_ords(int64_t key, int cell) {
+    std::pair<int, int> chunk = hex_chunk_unkey(key);
+    return std::pair<int, int>((chunk.first << HEX_CHUNK_SHIFT) | (cell & HEX_CHUNK_MASK), (chunk.second << HEX_CHUNK_SHIFT) | (cell >> HEX_CHUNK_SHIFT));
+}
+
+/**
+ * @brief Counts the set bits in a word.
+ *
+ */
+inline int hex_popcount(uint64_t word) {
+#if defined(_MSC_VER)
+    return int(__popcnt64(word));
+#else
+    return __builtin_popcountll(word);
+#endif
+}
+
+/**
+ * @brief Gets the index of the lowest set bit in a word. The word must not be zero.
+ *
+ */
+inline int hex_lowest_bit(uint64_t word) {
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward64(&index, word);
+    return int(index);
+#else
+    return __builtin_ctzll(word);
+#endif
+}
+
+#endif //GODOT_HEX_GRID_EXTENSION_HEX_CHUNK_H
@@ -0,0 +1,35 @@
+#include "HexCommandBuffer.h"
+
+#include <algorithm>
+
+HexCommandBuffer::~HexCommandBuffer() {
+	Node* node = head.exchange(nullptr);
+	while (node) {
+		Node* next = node->next;
+		delete node;
+		node = next;
+	}
+}
+
+void HexCommandBuffer::push(const Command &command) {
+	Node* node = new Node{ command, head.load(std::memory_order_relaxed) };
+	while (!head.compare_exchange_weak(node->next, node, std::memory_order_release, std::memory_order_relaxed)) {
+	}
+}
+
+void HexCommandBuffer::take(std::vector<Command> &commands) {
+	commands.clear();
+	Node* node = head.exchange(nullptr, std::memory_order_acquire);
+	while (node) {
+		Node* next = node->next;
+		commands.push_back(std::move(node->command));
+		delete node;
+		node = next;
+	}
+	// The stack hands them out newest first.
+	std::reverse(commands.begin(), commands.end());
+}
+
+bool HexCommandBuffer::is_empty() const {
+	return head.load(std::memory_order_relaxed) == nullptr;
+}
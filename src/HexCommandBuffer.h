@@ -0,0 +1,80 @@
+/**
+ * @file HexCommandBuffer.h
+ * @brief A queue of grid mutations that any thread can push to, applied later by the HexGrid on the main thread.
+ * @details The queue is a lock-free stack: pushing links a node in with a single compare and swap, and the main thread takes every node at once by swapping the head out. Nodes are never popped one at a time, so the stack cannot suffer from ABA.
+ * @version 1.0
+ *
+ *
+ *
+ */
+#ifndef GODOT_HEX_GRID_EXTENSION_HEX_COMMAND_BUFFER_H
+#define GODOT_HEX_GRID_EXTENSION_HEX_COMMAND_BUFFER_H
+
+#include "godot_cpp/classes/packed_scene.hpp"
+#include "godot_cpp/classes/ref.hpp"
+#include "godot_cpp/variant/string_name.hpp"
+#include <atomic>
+#include <vector>
+
+/// @brief Mutations waiting to be applied. Not a Godot object, the HexGrid owns its buffer.
+class HexCommandBuffer
+{
+public:
+    /**
+     * @brief What a command does.
+     *
+     */
+    enum Kind {
+        COMMAND_SPAWN,
+        COMMAND_REPLACE,
+        COMMAND_DELETE,
+        COMMAND_LAYER_VALUE,
+        /// @brief Spawns the hex, or replaces it if it exists.
+        COMMAND_PLACE
+    };
+    /**
+     * @brief One mutation, with the arguments it was queued with.
+     *
+     */
+    struct Command {
+        Kind kind{};
+        int q{};
+        int r{};
+        /// @brief The layer written by COMMAND_LAYER_VALUE.
+        godot::StringName layer{};
+        float value{};
+        /// @brief The tile spawned by the command. If null, the one given to the flush is used.
+        godot::Ref<godot::PackedScene> tile{};
+    };
+
+private:
+    struct Node {
+        Command command{};
+        Node* next{};
+    };
+    std::atomic<Node*> head{ nullptr };
+
+public:
+    HexCommandBuffer() = default;
+    HexCommandBuffer(const HexCommandBuffer &) = delete;
+    HexCommandBuffer &operator=(const HexCommandBuffer &) = delete;
+    ~HexCommandBuffer();
+    /**
+     * @brief Queues a command. Safe to call from any thread.
+     *
+     */
+    void push(const Command &command);
+    /**
+     * @brief Takes every queued command, leaving the buffer empty. Commands pushed while it runs are left for the next call.
+     *
+     * @param commands Filled with the commands, in the order they were pushed. Commands pushed by different threads at the same time are ordered arbitrarily.
+     */
+    void take(std::vector<Command> &commands);
+    /**
+     * @brief Checks if no command is queued.
+     *
+     */
+    bool is_empty() const;
+};
+
+#endif //GODOT_HEX_GRID_EXTENSION_HEX_COMMAND_BUFFER_H
@@ -0,0 +1,302 @@
+#include "HexCooperativePlanner.h"
+#include "HexGrid.h"
+
+#include <algorithm>
+#include <limits>
+#include <map>
+
+namespace {
+	constexpr int UNREACHABLE = std::numeric_limits<int>::max();
+
+	/**
+	 * @brief A backward search from an agent's goal that is resumed on demand, so true distances are only found for hexes the agent looks at.
+	 *
+	 */
+	class ResumableDistance {
+		struct OpenEntry {
+			int estimate{};
+			int distance{};
+			std::pair<int, int> hex{};
+		};
+
+		static bool is_worse(const OpenEntry &a, const OpenEntry &b) {
+			return a.estimate > b.estimate || (a.estimate == b.estimate && a.distance < b.distance);
+		}
+
+		const HexTileStorage &storage;
+		std::pair<int, int> start{};
+		/// @brief A map that maps a hex's key to its best known distance, and whether that distance is final.
+		std::unordered_map<int64_t, std::pair<int, bool>> distances{};
+		std::vector<OpenEntry> open{};
+
+	public:
+		template <typename Passable>
+		ResumableDistance(const HexTileStorage &storage, std::pair<int, int> start, std::pair<int, int> goal, Passable &is_passable) : storage(storage), start(start) {
+			if (is_passable(goal)) {
+				distances[HexTileStorage::key(goal.first, goal.second)] = std::pair<int, bool>(0, false);
+				open.push_back(OpenEntry{ storage.distance(goal, start), 0, goal });
+			}
+		}
+
+		// Aimed at the agent's start, the search closes the hexes the agent is most likely to ask about first.
+		template <typename Passable>
+		int get(std::pair<int, int> hex, Passable &is_passable) {
+			int64_t hex_key = HexTileStorage::key(hex.first, hex.second);
+			while (true) {
+				auto known = distances.find(hex_key);
+				if (known != distances.end() && known->second.second) {
+					return known->second.first;
+				}
+				if (open.empty()) {
+					return UNREACHABLE;
+				}
+
+				std::pop_heap(open.begin(), open.end(), is_worse);
+				OpenEntry entry = open.back();
+				open.pop_back();
+				std::pair<int, bool> &current = distances[HexTileStorage::key(entry.hex.first, entry.hex.second)];
+				if (current.second || entry.distance > current.first) {
+					continue;
+				}
+				current.second = true;
+
+				storage.for_each_neighbor(entry.hex.first, entry.hex.second, [&](int q, int r, HexTile*) {
+					std::pair<int, int> neighbor(q, r);
+					if (!is_passable(neighbor)) {
+						return;
+					}
+					auto inserted = distances.try_emplace(HexTileStorage::key(q, r), std::pair<int, bool>(entry.distance + 1, false));
+					if (!inserted.second) {
+						if (inserted.first->second.second || inserted.first->second.first <= entry.distance + 1) {
+							return;
+						}
+						inserted.first->second.first = entry.distance + 1;
+					}
+					open.push_back(OpenEntry{ entry.distance + 1 + storage.distance(neighbor, start), entry.distance + 1, neighbor });
+					std::push_heap(open.begin(), open.end(), is_worse);
+				});
+			}
+		}
+	};
+}
+
+void HexReservationTable::reset(int window) {
+	ticks.assign(size_t(std::max(window, 0)) + 1, std::unordered_map<int64_t, int32_t>());
+}
+
+int HexReservationTable::get_window() const {
+	return int(ticks.size()) - 1;
+}
+
+bool HexReservationTable::reserve(std::pair<int, int> hex, int tick, int32_t agent) {
+	if (tick < 0 || tick >= int(ticks.size())) {
+		return true;
+	}
+	std::pair<std::unordered_map<int64_t, int32_t>::iterator, bool> inserted = ticks[tick].emplace(HexTileStorage::key(hex.first, hex.second), agent);
+	return inserted.second || inserted.first->second == agent;
+}
+
+int32_t HexReservationTable::get_agent(std::pair<int, int> hex, int tick) const {
+	if (tick < 0 || tick >= int(ticks.size())) {
+		return -1;
+	}
+	auto agent = ticks[tick].find(HexTileStorage::key(hex.first, hex.second));
+	return agent == ticks[tick].end() ? -1 : agent->second;
+}
+
+bool HexReservationTable::is_step_free(std::pair<int, int> from, std::pair<int, int> to, int tick, int32_t agent) const {
+	int32_t holder = get_agent(to, tick + 1);
+	if (holder >= 0 && holder != agent) {
+		return false;
+	}
+	if (from == to) {
+		return true;
+	}
+	// Two agents swapping places would pass through each other.
+	int32_t oncoming = get_agent(to, tick);
+	return oncoming < 0 || oncoming == agent || get_agent(from, tick + 1) != oncoming;
+}
+
+HexCooperativePlanner::HexCooperativePlanner(const HexGrid &grid, const HexLayer* cost_layer, const HexRegion* blockers, int window) : grid(grid), cost_layer(cost_layer), blockers(blockers) {
+	reservations.reset(window);
+}
+
+bool HexCooperativePlanner::is_passable(std::pair<int, int> hex) const {
+	return grid.is_hex_passable(hex.first, hex.second, cost_layer, blockers);
+}
+
+void HexCooperativePlanner::add_agent(std::pair<int, int> start, std::pair<int, int> goal, int priority) {
+	const HexTileStorage &storage = grid.get_tile_storage();
+	Agent agent{};
+	agent.start = storage.canonicalize(start);
+	agent.goal = storage.canonicalize(goal);
+	agent.priority = priority;
+	agents.push_back(agent);
+}
+
+void HexCooperativePlanner::reserve_stranded() {
+	const HexTileStorage &storage = grid.get_tile_storage();
+	auto is_hex_passable = [this](std::pair<int, int> hex) {
+		return is_passable(hex);
+	};
+	for (uint32_t i = 0; i < agents.size(); i++) {
+		Agent &agent = agents[i];
+		ResumableDistance distance(storage, agent.start, agent.goal, is_hex_passable);
+		if (!is_passable(agent.start) || distance.get(agent.start, is_hex_passable) == UNREACHABLE) {
+			agent.path.clear();
+			reserve(i);
+		}
+	}
+}
+
+void HexCooperativePlanner::plan_agent(uint32_t index) {
+	Agent &agent = agents[index];
+	agent.path.clear();
+	const HexTileStorage &storage = grid.get_tile_storage();
+	int window = reservations.get_window();
+	int32_t id = int32_t(index);
+
+	auto is_hex_passable = [this](std::pair<int, int> hex) {
+		return is_passable(hex);
+	};
+	ResumableDistance distance(storage, agent.start, agent.goal, is_hex_passable);
+	if (!is_passable(agent.start) || distance.get(agent.start, is_hex_passable) == UNREACHABLE) {
+		return;
+	}
+
+	// A space-time A*. Every move, waiting included, takes one tick, so a state's cost is its tick and the first way to reach it is as good as any.
+	struct OpenEntry {
+		int estimate{};
+		int tick{};
+		std::pair<int, int> hex{};
+	};
+	auto is_worse = [](const OpenEntry &a, const OpenEntry &b) {
+		return a.estimate > b.estimate || (a.estimate == b.estimate && a.tick < b.tick);
+	};
+	std::vector<std::unordered_map<int64_t, std::pair<int, int>>> parents(size_t(window) + 1);
+	std::vector<OpenEntry> open{};
+	parents[0][HexTileStorage::key(agent.start.first, agent.start.second)] = agent.start;
+	open.push_back(OpenEntry{ distance.get(agent.start, is_hex_passable), 0, agent.start });
+
+	auto keeps_goal = [this, &agent, window, id](int tick) {
+		for (int later = tick + 1; later <= window; later++) {
+			int32_t holder = reservations.get_agent(agent.goal, later);
+			if (holder >= 0 && holder != id) {
+				return false;
+			}
+		}
+		return true;
+	};
+
+	bool found = false;
+	OpenEntry current{};
+	while (!open.empty()) {
+		std::pop_heap(open.begin(), open.end(), is_worse);
+		current = open.back();
+		open.pop_back();
+		if ((current.hex == agent.goal && keeps_goal(current.tick)) || current.tick == window) {
+			found = true;
+			break;
+		}
+
+		auto try_step = [&](std::pair<int, int> next) {
+			if (!reservations.is_step_free(current.hex, next, current.tick, id)) {
+				return;
+			}
+			auto inserted = parents[current.tick + 1].try_emplace(HexTileStorage::key(next.first, next.second), current.hex);
+			if (!inserted.second) {
+				return;
+			}
+			int remaining = distance.get(next, is_hex_passable);
+			if (remaining != UNREACHABLE) {
+				open.push_back(OpenEntry{ current.tick + 1 + remaining, current.tick + 1, next });
+				std::push_heap(open.begin(), open.end(), is_worse);
+			}
+		};
+		try_step(current.hex);
+		storage.for_each_neighbor(current.hex.first, current.hex.second, [&](int q, int r, HexTile*) {
+			std::pair<int, int> next(q, r);
+			if (is_passable(next)) {
+				try_step(next);
+			}
+		});
+	}
+
+	if (!found) {
+		// Boxed in by the agents before it, so it holds its ground and tries again next plan.
+		agent.path.push_back(agent.start);
+		return;
+	}
+
+	agent.path.resize(size_t(current.tick) + 1);
+	std::pair<int, int> hex = current.hex;
+	for (int tick = current.tick; tick >= 0; tick--) {
+		agent.path[tick] = hex;
+		if (tick > 0) {
+			hex = parents[tick].at(HexTileStorage::key(hex.first, hex.second));
+		}
+	}
+
+	// Past the window, the agent walks down the distances on its own.
+	hex = agent.path.back();
+	int remaining = distance.get(hex, is_hex_passable);
+	while (remaining > 0) {
+		std::pair<int, int> next = hex;
+		storage.for_each_neighbor(hex.first, hex.second, [&](int q, int r, HexTile*) {
+			std::pair<int, int> neighbor(q, r);
+			if (next == hex && is_passable(neighbor) && distance.get(neighbor, is_hex_passable) == remaining - 1) {
+				next = neighbor;
+			}
+		});
+		if (next == hex) {
+			break;
+		}
+		hex = next;
+		remaining--;
+		agent.path.push_back(hex);
+	}
+}
+
+void HexCooperativePlanner::reserve(uint32_t index) {
+	const Agent &agent = agents[index];
+	// Agents are reserved in the order they plan, so the first to hold a hex keeps it. A stranded agent or one parked on its goal cannot take it from an agent of higher priority.
+	for (int tick = 0; tick <= reservations.get_window(); tick++) {
+		if (agent.path.empty()) {
+			reservations.reserve(agent.start, tick, int32_t(index));
+		} else {
+			reservations.reserve(agent.path[std::min(size_t(tick), agent.path.size() - 1)], tick, int32_t(index));
+		}
+	}
+}
+
+std::vector<std::vector<uint32_t>> HexCooperativePlanner::get_tiers() const {
+	std::map<int, std::vector<uint32_t>, std::greater<int>> by_priority{};
+	for (uint32_t i = 0; i < agents.size(); i++) {
+		by_priority[agents[i].priority].push_back(i);
+	}
+
+	std::vector<std::vector<uint32_t>> tiers{};
+	tiers.reserve(by_priority.size());
+	for (std::pair<const int, std::vector<uint32_t>> &pair : by_priority) {
+		tiers.push_back(std::move(pair.second));
+	}
+	return tiers;
+}
+
+void HexCooperativePlanner::set_tier(const std::vector<uint32_t> &indices) {
+	tier = indices;
+}
+
+void HexCooperativePlanner::plan_tier_agent(uint32_t index) {
+	plan_agent(tier[index]);
+}
+
+void HexCooperativePlanner::reserve_tier() {
+	for (uint32_t index : tier) {
+		reserve(index);
+	}
+}
+
+const std::vector<HexCooperativePlanner::Agent> &HexCooperativePlanner::get_agents() const {
+	return agents;
+}
@@ -0,0 +1,168 @@
+/**
+ * @file HexCooperativePlanner.h
+ * @brief Plans a group of agents at once with Windowed Hierarchical Cooperative A*.
+ * @details See Silver, "Cooperative Pathfinding" (2005). Agents plan one after another in priority order. Each one searches in space and time, where waiting in place is a move of its own, and avoids every hex and tick reserved by the agents before it. Its own path is then reserved for the window. The estimate is the true distance to the goal ignoring other agents, found by a backward search that is resumed whenever a new hex needs its distance. Past the window, agents follow that distance without reservations, since the group is expected to plan again before then.
+ * @version 1.0
+ *
+ *
+ *
+ */
+#ifndef GODOT_HEX_GRID_EXTENSION_HEX_COOPERATIVE_PLANNER_H
+#define GODOT_HEX_GRID_EXTENSION_HEX_COOPERATIVE_PLANNER_H
+
+#include "HexLayer.h"
+#include "HexRegion.h"
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+class HexGrid;
+
+/// @brief The longest window a group can be planned for. Every tick of it keeps its own reservations, and every agent searches them all.
+inline constexpr int HEX_MAX_GROUP_WINDOW = 256;
+
+/// @brief The hexes taken by each agent at each tick of the window.
+class HexReservationTable
+{
+    /**
+     * @brief A map per tick that maps a hex's key to the agent holding it.
+     *
+     */
+    std::vector<std::unordered_map<int64_t, int32_t>> ticks{};
+
+public:
+    /**
+     * @brief Drops every reservation and resizes the window.
+     *
+     * @param window The last tick that can be reserved.
+     */
+    void reset(int window);
+    /**
+     * @brief Gets the last tick that can be reserved.
+     *
+     */
+    int get_window() const;
+    /**
+     * @brief Reserves a hex at a tick, unless another agent holds it already. Ticks past the window are ignored.
+     *
+     * @return bool False if another agent holds the hex at that tick.
+     */
+    bool reserve(std::pair<int, int> hex, int tick, int32_t agent);
+    /**
+     * @brief Gets the agent holding a hex at a tick.
+     *
+     * @return int32_t The agent, or -1 if the hex is free or the tick is past the window.
+     */
+    int32_t get_agent(std::pair<int, int> hex, int tick) const;
+    /**
+     * @brief Checks if an agent can step from one hex to another between a tick and the next. Stepping is blocked if the target is taken, or if another agent is stepping the other way across the same edge.
+     *
+     * @param from The hex at the tick.
+     * @param to The hex at the next tick. The same as from for waiting.
+     * @param tick The tick the step starts at.
+     * @param agent The agent stepping.
+     * @return bool True if the step is free.
+     */
+    bool is_step_free(std::pair<int, int> from, std::pair<int, int> to, int tick, int32_t agent) const;
+};
+
+/// @brief A single group plan. Not a Godot object, the HexGrid creates one per call.
+class HexCooperativePlanner
+{
+public:
+    /**
+     * @brief An agent of the group and its planned path.
+     *
+     */
+    struct Agent {
+        std::pair<int, int> start{};
+        std::pair<int, int> goal{};
+        int priority{};
+        /// @brief The hex at every tick, starting with the start. After the window, the remaining steps to the goal.
+        std::vector<std::pair<int, int>> path{};
+    };
+
+private:
+    /**
+     * @brief The grid the group paths on, and what it cannot enter.
+     *
+     */
+    const HexGrid &grid;
+    const HexLayer* cost_layer{};
+    const HexRegion* blockers{};
+    /**
+     * @brief The agents, in the order they were given.
+     *
+     */
+    std::vector<Agent> agents{};
+    /**
+     * @brief The reservations of every agent planned so far.
+     *
+     */
+    HexReservationTable reservations{};
+    /**
+     * @brief The agents of the tier being planned, as indices into agents.
+     *
+     */
+    std::vector<uint32_t> tier{};
+
+    /**
+     * @brief Checks if a hex can be entered at all, ignoring other agents.
+     *
+     */
+    bool is_passable(std::pair<int, int> hex) const;
+    /**
+     * @brief Reserves an agent's path for the whole window. An agent that arrives early keeps its goal for the rest of it. Hexes already held by an agent reserved before, which plans first, are left to that agent.
+     *
+     */
+    void reserve(uint32_t index);
+
+public:
+    HexCooperativePlanner(const HexGrid &grid, const HexLayer* cost_layer, const HexRegion* blockers, int window);
+    /**
+     * @brief Adds an agent to the group.
+     *
+     */
+    void add_agent(std::pair<int, int> start, std::pair<int, int> goal, int priority);
+    /**
+     * @brief Reserves the start of every agent that cannot reach its goal for the whole window, before anyone plans. Such agents never move, so everyone has to path around them.
+     *
+     */
+    void reserve_stranded();
+    /**
+     * @brief Plans a single agent against the reservations so far. Safe to call for several agents at once, as long as nothing is reserved meanwhile. An agent boxed in by earlier reservations waits at its start, and may still be run into.
+     *
+     * @param index The index into agents.
+     */
+    void plan_agent(uint32_t index);
+    /**
+     * @brief Splits the agents into tiers of equal priority, highest first.
+     *
+     * @return std::vector<std::vector<uint32_t>> The tiers, in the order they should be planned.
+     */
+    std::vector<std::vector<uint32_t>> get_tiers() const;
+    /**
+     * @brief Sets the agents of the tier about to be planned.
+     *
+     */
+    void set_tier(const std::vector<uint32_t> &indices);
+    /**
+     * @brief Plans one agent of the current tier. Run on the WorkerThreadPool.
+     *
+     * @param index The index into the current tier.
+     */
+    void plan_tier_agent(uint32_t index);
+    /**
+     * @brief Reserves the paths of every agent in the current tier.
+     *
+     */
+    void reserve_tier();
+    /**
+     * @brief Gets the agents and their paths.
+     *
+     */
+    const std::vector<Agent> &get_agents() const;
+};
+
+#endif //GODOT_HEX_GRID_EXTENSION_HEX_COOPERATIVE_PLANNER_H
@@ -0,0 +1,365 @@
+#include "HexGraph.h"
+#include "HexGrid.h"
+#include "godot_cpp/core/class_db.hpp"
+
+#include <algorithm>
+#include <limits>
+
+namespace {
+	constexpr float UNREACHABLE = std::numeric_limits<float>::infinity();
+
+	struct OpenEntry {
+		float cost{};
+		int32_t node{};
+	};
+
+	// Orders the open list so the cheapest node is on top.
+	bool is_worse(const OpenEntry &a, const OpenEntry &b) {
+		return a.cost > b.cost;
+	}
+}
+
+HexGraph::HexGraph() {
+
+}
+
+HexGrid* HexGraph::get_grid() const {
+	return grid_id == 0 ? nullptr : godot::Object::cast_to<HexGrid>(godot::ObjectDB::get_instance(grid_id));
+}
+
+void HexGraph::setup(HexGrid* target_grid, const godot::StringName &layer_name, const godot::Ref<HexRegion> &blocker_region) {
+	ERR_FAIL_NULL_MSG(target_grid, "Cannot build a graph of a non-existing grid.");
+	grid_id = target_grid->get_instance_id();
+	cost_layer = layer_name;
+	blockers = blocker_region;
+	rebuild();
+}
+
+void HexGraph::rebuild() {
+	coords.clear();
+	indices.clear();
+	offsets.clear();
+	targets.clear();
+	costs.clear();
+	node_costs.clear();
+	components.clear();
+	component_count = 0;
+
+	HexGrid* grid = get_grid();
+	ERR_FAIL_NULL_MSG(grid, "The graph's grid no longer exists.");
+	const HexLayer* layer = nullptr;
+	if (cost_layer != godot::StringName()) {
+		layer = grid->find_layer(cost_layer);
+		ERR_FAIL_NULL_MSG(layer, "Cannot build a graph over a non-existing cost layer.");
+	}
+
+	const HexTileStorage &storage = grid->get_tile_storage();
+	const HexRegion* blocker_region = blockers.ptr();
+	storage.for_each([&](int q, int r, HexTile*) {
+		if (grid->is_hex_passable(q, r, layer, blocker_region)) {
+			indices.emplace(HexTileStorage::key(q, r), int32_t(coords.size()));
+			coords.push_back(std::pair<int, int>(q, r));
+			node_costs.push_back(layer ? std::max(layer->get_value(q, r), 1.0f) : 1.0f);
+		}
+	});
+
+	offsets.reserve(coords.size() + 1);
+	targets.reserve(coords.size() * 6);
+	costs.reserve(coords.size() * 6);
+	for (const std::pair<int, int> &hex : coords) {
+		offsets.push_back(int32_t(targets.size()));
+		storage.for_each_neighbor(hex.first, hex.second, [this](int q, int r, HexTile*) {
+			int32_t neighbor = find_node(q, r);
+			if (neighbor >= 0) {
+				targets.push_back(neighbor);
+				costs.push_back(node_costs[neighbor]);
+			}
+		});
+	}
+	offsets.push_back(int32_t(targets.size()));
+}
+
+bool HexGraph::update_hex(int q, int r) {
+	HexGrid* grid = get_grid();
+	ERR_FAIL_NULL_V_MSG(grid, false, "The graph's grid no longer exists.");
+	const HexLayer* layer = nullptr;
+	if (cost_layer != godot::StringName()) {
+		layer = grid->find_layer(cost_layer);
+		if (!layer) {
+			rebuild();
+			return false;
+		}
+	}
+
+	std::pair<int, int> hex = grid->get_tile_storage().canonicalize(std::pair<int, int>(q, r));
+	int32_t node = find_node(hex.first, hex.second);
+	bool passable = grid->is_hex_passable(hex.first, hex.second, layer, blockers.ptr());
+	if ((node >= 0) != passable) {
+		rebuild();
+		return false;
+	}
+	if (node < 0) {
+		return true;
+	}
+
+	// Edges run both ways, so the edges into the node are found among its neighbors' edges.
+	float cost = layer ? std::max(layer->get_value(hex.first, hex.second), 1.0f) : 1.0f;
+	node_costs[node] = cost;
+	for (int32_t edge = offsets[node]; edge < offsets[node + 1]; edge++) {
+		int32_t neighbor = targets[edge];
+		for (int32_t back = offsets[neighbor]; back < offsets[neighbor + 1]; back++) {
+			if (targets[back] == node) {
+				costs[back] = cost;
+			}
+		}
+	}
+	return true;
+}
+
+int HexGraph::get_node_count() const {
+	return int(coords.size());
+}
+
+int32_t HexGraph::find_node(int q, int r) const {
+	auto node = indices.find(HexTileStorage::key(q, r));
+	return node == indices.end() ? -1 : node->second;
+}
+
+int HexGraph::get_node_index(godot::Vector2i hex) const {
+	HexGrid* grid = get_grid();
+	std::pair<int, int> pair(hex.x, hex.y);
+	if (grid) {
+		pair = grid->get_tile_storage().canonicalize(pair);
+	}
+	return find_node(pair.first, pair.second);
+}
+
+godot::Vector2i HexGraph::get_node_coords(int node) const {
+	ERR_FAIL_INDEX_V_MSG(node, int(coords.size()), godot::Vector2i(), "Node is out of range.");
+	return godot::Vector2i(coords[node].first, coords[node].second);
+}
+
+const std::vector<int32_t> &HexGraph::get_offsets_raw() const {
+	return offsets;
+}
+
+const std::vector<int32_t> &HexGraph::get_targets_raw() const {
+	return targets;
+}
+
+const std::vector<float> &HexGraph::get_costs_raw() const {
+	return costs;
+}
+
+godot::PackedInt32Array HexGraph::get_offsets() const {
+	godot::PackedInt32Array array = godot::PackedInt32Array();
+	array.resize(int64_t(offsets.size()));
+	std::copy(offsets.begin(), offsets.end(), array.ptrw());
+	return array;
+}
+
+godot::PackedInt32Array HexGraph::get_targets() const {
+	godot::PackedInt32Array array = godot::PackedInt32Array();
+	array.resize(int64_t(targets.size()));
+	std::copy(targets.begin(), targets.end(), array.ptrw());
+	return array;
+}
+
+godot::PackedFloat32Array HexGraph::get_edge_costs() const {
+	godot::PackedFloat32Array array = godot::PackedFloat32Array();
+	array.resize(int64_t(costs.size()));
+	std::copy(costs.begin(), costs.end(), array.ptrw());
+	return array;
+}
+
+godot::PackedInt32Array HexGraph::get_neighbors(int node) const {
+	godot::PackedInt32Array array = godot::PackedInt32Array();
+	ERR_FAIL_INDEX_V_MSG(node, int(coords.size()), array, "Node is out of range.");
+	array.resize(offsets[node + 1] - offsets[node]);
+	std::copy(targets.begin() + offsets[node], targets.begin() + offsets[node + 1], array.ptrw());
+	return array;
+}
+
+void HexGraph::ensure_components() {
+	if (components.size() == coords.size()) {
+		return;
+	}
+
+	components.assign(coords.size(), -1);
+	component_count = 0;
+	std::vector<int32_t> stack{};
+	for (int32_t seed = 0; seed < int32_t(coords.size()); seed++) {
+		if (components[seed] >= 0) {
+			continue;
+		}
+		components[seed] = component_count;
+		stack.push_back(seed);
+		while (!stack.empty()) {
+			int32_t node = stack.back();
+			stack.pop_back();
+			for (int32_t edge = offsets[node]; edge < offsets[node + 1]; edge++) {
+				if (components[targets[edge]] < 0) {
+					components[targets[edge]] = component_count;
+					stack.push_back(targets[edge]);
+				}
+			}
+		}
+		component_count++;
+	}
+}
+
+const std::vector<int32_t> &HexGraph::get_components_raw() {
+	ensure_components();
+	return components;
+}
+
+godot::PackedInt32Array HexGraph::get_components() {
+	ensure_components();
+	godot::PackedInt32Array array = godot::PackedInt32Array();
+	array.resize(int64_t(components.size()));
+	std::copy(components.begin(), components.end(), array.ptrw());
+	return array;
+}
+
+int HexGraph::get_component_count() {
+	ensure_components();
+	return component_count;
+}
+
+std::vector<int32_t> HexGraph::to_nodes(const godot::PackedInt32Array &nodes) const {
+	std::vector<int32_t> valid{};
+	valid.reserve(size_t(nodes.size()));
+	for (int64_t i = 0; i < nodes.size(); i++) {
+		ERR_CONTINUE_MSG(nodes[i] < 0 || nodes[i] >= int32_t(coords.size()), "Node is out of range.");
+		valid.push_back(nodes[i]);
+	}
+	return valid;
+}
+
+void HexGraph::compute_distances(const std::vector<int32_t> &goals, std::vector<float> &distances) const {
+	distances.assign(coords.size(), UNREACHABLE);
+	std::vector<OpenEntry> open{};
+	for (int32_t goal : goals) {
+		distances[goal] = 0.0f;
+		open.push_back(OpenEntry{ 0.0f, goal });
+	}
+	std::make_heap(open.begin(), open.end(), is_worse);
+
+	// Searched backward from the goals. Edges run both ways, and stepping from a neighbor onto a node costs the node's cost.
+	while (!open.empty()) {
+		std::pop_heap(open.begin(), open.end(), is_worse);
+		OpenEntry entry = open.back();
+		open.pop_back();
+		if (entry.cost > distances[entry.node]) {
+			continue;
+		}
+		float cost = entry.cost + node_costs[entry.node];
+		for (int32_t edge = offsets[entry.node]; edge < offsets[entry.node + 1]; edge++) {
+			int32_t neighbor = targets[edge];
+			if (cost < distances[neighbor]) {
+				distances[neighbor] = cost;
+				open.push_back(OpenEntry{ cost, neighbor });
+				std::push_heap(open.begin(), open.end(), is_worse);
+			}
+		}
+	}
+}
+
+godot::PackedFloat32Array HexGraph::get_distance_field(const godot::PackedInt32Array &goals) const {
+	std::vector<float> distances{};
+	compute_distances(to_nodes(goals), distances);
+	godot::PackedFloat32Array array = godot::PackedFloat32Array();
+	array.resize(int64_t(distances.size()));
+	std::copy(distances.begin(), distances.end(), array.ptrw());
+	return array;
+}
+
+godot::PackedInt32Array HexGraph::get_flow_field(const godot::PackedInt32Array &goals) const {
+	std::vector<float> distances{};
+	compute_distances(to_nodes(goals), distances);
+
+	godot::PackedInt32Array array = godot::PackedInt32Array();
+	array.resize(int64_t(coords.size()));
+	int32_t* flow = array.ptrw();
+	for (int32_t node = 0; node < int32_t(coords.size()); node++) {
+		flow[node] = -1;
+		if (distances[node] == 0.0f || distances[node] == UNREACHABLE) {
+			continue;
+		}
+		float best = distances[node];
+		for (int32_t edge = offsets[node]; edge < offsets[node + 1]; edge++) {
+			float through = costs[edge] + distances[targets[edge]];
+			if (through <= best) {
+				best = through;
+				flow[node] = targets[edge];
+			}
+		}
+	}
+	return array;
+}
+
+std::vector<int32_t> HexGraph::find_path_nodes(int32_t from, int32_t to) const {
+	std::vector<int32_t> path{};
+	std::vector<float> distances(coords.size(), UNREACHABLE);
+	std::vector<int32_t> parents(coords.size(), -1);
+	std::vector<OpenEntry> open{ OpenEntry{ 0.0f, from } };
+	distances[from] = 0.0f;
+
+	while (!open.empty()) {
+		std::pop_heap(open.begin(), open.end(), is_worse);
+		OpenEntry entry = open.back();
+		open.pop_back();
+		if (entry.cost > distances[entry.node]) {
+			continue;
+		}
+		if (entry.node == to) {
+			break;
+		}
+		for (int32_t edge = offsets[entry.node]; edge < offsets[entry.node + 1]; edge++) {
+			float cost = entry.cost + costs[edge];
+			if (cost < distances[targets[edge]]) {
+				distances[targets[edge]] = cost;
+				parents[targets[edge]] = entry.node;
+				open.push_back(OpenEntry{ cost, targets[edge] });
+				std::push_heap(open.begin(), open.end(), is_worse);
+			}
+		}
+	}
+
+	if (distances[to] == UNREACHABLE) {
+		return path;
+	}
+	for (int32_t node = to; node >= 0; node = parents[node]) {
+		path.push_back(node);
+	}
+	std::reverse(path.begin(), path.end());
+	return path;
+}
+
+godot::PackedInt32Array HexGraph::find_path(int from, int to) const {
+	godot::PackedInt32Array array = godot::PackedInt32Array();
+	ERR_FAIL_INDEX_V_MSG(from, int(coords.size()), array, "Start node is out of range.");
+	ERR_FAIL_INDEX_V_MSG(to, int(coords.size()), array, "Goal node is out of range.");
+
+	std::vector<int32_t> path = find_path_nodes(from, to);
+	array.resize(int64_t(path.size()));
+	std::copy(path.begin(), path.end(), array.ptrw());
+	return array;
+}
+
+void HexGraph::_bind_methods() {
+	godot::ClassDB::bind_method(godot::D_METHOD("rebuild"), &HexGraph::rebuild);
+	godot::ClassDB::bind_method(godot::D_METHOD("update_hex", "q", "r"), &HexGraph::update_hex);
+	godot::ClassDB::bind_method(godot::D_METHOD("get_node_count"), &HexGraph::get_node_count);
+	godot::ClassDB::bind_method(godot::D_METHOD("get_node_index", "hex"), &HexGraph::get_node_index);
+	godot::ClassDB::bind_method(godot::D_METHOD("get_node_coords", "node"), &HexGraph::get_node_coords);
+	godot::ClassDB::bind_method(godot::D_METHOD("get_offsets"), &HexGraph::get_offsets);
+	godot::ClassDB::bind_method(godot::D_METHOD("get_targets"), &HexGraph::get_targets);
+	godot::ClassDB::bind_method(godot::D_METHOD("get_edge_costs"), &HexGraph::get_edge_costs);
+	godot::ClassDB::bind_method(godot::D_METHOD("get_neighbors", "node"), &HexGraph::get_neighbors);
+	godot::ClassDB::bind_method(godot::D_METHOD("get_components"), &HexGraph::get_components);
+	godot::ClassDB::bind_method(godot::D_METHOD("get_component_count"), &HexGraph::get_component_count);
+	godot::ClassDB::bind_method(godot::D_METHOD("get_distance_field", "goals"), &HexGraph::get_distance_field);
+	godot::ClassDB::bind_method(godot::D_METHOD("get_flow_field", "goals"), &HexGraph::get_flow_field);
+	godot::ClassDB::bind_method(godot::D_METHOD("find_path", "from", "to"), &HexGraph::find_path);
+}
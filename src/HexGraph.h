@@ -0,0 +1,237 @@
+/**
+ * @file HexGraph.h
+ * @brief An immutable snapshot of the grid's adjacency, in compressed sparse row form.
+ * @details Every passable hex gets a dense node index. The neighbors of node i are targets[offsets[i]] to targets[offsets[i + 1] - 1], and stepping to one costs the matching entry of costs. Searches over the snapshot walk flat integer arrays instead of hashing coordinates for every neighbor. Cost changes are patched in place. A hex that becomes passable or impassable changes the node set, so the snapshot is rebuilt.
+ * @version 1.0
+ *
+ *
+ *
+ */
+#ifndef GODOT_HEX_GRID_EXTENSION_HEX_GRAPH_H
+#define GODOT_HEX_GRID_EXTENSION_HEX_GRAPH_H
+
+#include "godot_cpp/classes/ref_counted.hpp"
+#include "godot_cpp/core/object.hpp"
+#include "HexLayer.h"
+#include "HexRegion.h"
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+class HexGrid;
+
+/// @brief A graph of the grid's passable hexes, built by HexGrid.build_graph.
+class HexGraph : public godot::RefCounted
+{
+    GDCLASS(HexGraph, godot::RefCounted)
+
+    /**
+     * @brief The instance id of the grid, so a freed grid is noticed instead of used.
+     *
+     */
+    uint64_t grid_id{};
+    /**
+     * @brief The name of the layer holding the cost of entering each hex. If empty, every step costs 1.
+     *
+     */
+    godot::StringName cost_layer{};
+    /**
+     * @brief The hexes left out of the graph.
+     *
+     */
+    godot::Ref<HexRegion> blockers;
+    /**
+     * @brief The coordinates of every node.
+     *
+     */
+    std::vector<std::pair<int, int>> coords{};
+    /**
+     * @brief A map that maps a hex's key to its node.
+     *
+     */
+    std::unordered_map<int64_t, int32_t> indices{};
+    /**
+     * @brief Where each node's edges start in targets and costs, with one extra entry marking the end of the last node.
+     *
+     */
+    std::vector<int32_t> offsets{};
+    /**
+     * @brief The node each edge leads to.
+     *
+     */
+    std::vector<int32_t> targets{};
+    /**
+     * @brief The cost of each edge, which is the cost of entering its target.
+     *
+     */
+    std::vector<float> costs{};
+    /**
+     * @brief The cost of entering each node, kept to patch and to search backward.
+     *
+     */
+    std::vector<float> node_costs{};
+    /**
+     * @brief The connected component of every node. Empty until asked for, and dropped on rebuild.
+     *
+     */
+    std::vector<int32_t> components{};
+    int32_t component_count{};
+
+    /**
+     * @brief Binds methods for usage in Godot.
+     *
+     */
+    static void _bind_methods();
+    /**
+     * @brief Gets the grid if it is still alive.
+     *
+     */
+    HexGrid* get_grid() const;
+    /**
+     * @brief Labels the connected components, if they are not already.
+     *
+     */
+    void ensure_components();
+    /**
+     * @brief Copies an array of nodes, skipping those out of range.
+     *
+     */
+    std::vector<int32_t> to_nodes(const godot::PackedInt32Array &nodes) const;
+
+public:
+    HexGraph();
+    /**
+     * @brief Points the graph at a grid, and builds it.
+     *
+     * @param target_grid The grid to snapshot.
+     * @param layer_name The name of the layer holding the cost of entering each hex, clamped to at least 1. Negative values leave the hex out. If empty, every step costs 1.
+     * @param blocker_region The hexes left out of the graph. Can be null.
+     */
+    void setup(HexGrid* target_grid, const godot::StringName &layer_name, const godot::Ref<HexRegion> &blocker_region);
+    /**
+     * @brief Builds the snapshot from scratch. Intended for usage directly from Godot.
+     *
+     */
+    void rebuild();
+    /**
+     * @brief Patches the snapshot after a hex changed. A changed cost is written into the edges leading to the hex, anything else rebuilds the snapshot. Intended for usage directly from Godot.
+     *
+     * @param q The q-coordinate.
+     * @param r The r-coordinate.
+     * @return bool True if the snapshot was patched in place, false if it was rebuilt.
+     */
+    bool update_hex(int q, int r);
+    /**
+     * @brief Gets the amount of nodes. Intended for usage directly from Godot.
+     *
+     */
+    int get_node_count() const;
+    /**
+     * @brief Gets the node of a hex.
+     *
+     * @param q The q-coordinate.
+     * @param r The r-coordinate.
+     * @return int32_t The node, or -1 if the hex is not in the graph.
+     */
+    int32_t find_node(int q, int r) const;
+    /**
+     * @brief Gets the node of a hex. Intended for usage directly from Godot.
+     *
+     * @param hex The coordinates, q as x and r as y.
+     * @return int The node, or -1 if the hex is not in the graph.
+     */
+    int get_node_index(godot::Vector2i hex) const;
+    /**
+     * @brief Gets the coordinates of a node. Intended for usage directly from Godot.
+     *
+     * @param node The node.
+     * @return godot::Vector2i The coordinates, q as x and r as y.
+     */
+    godot::Vector2i get_node_coords(int node) const;
+    /**
+     * @brief Gets the raw adjacency, for native graph algorithms.
+     *
+     */
+    const std::vector<int32_t> &get_offsets_raw() const;
+    const std::vector<int32_t> &get_targets_raw() const;
+    const std::vector<float> &get_costs_raw() const;
+    /**
+     * @brief Gets where each node's edges start, with one extra entry at the end. Intended for usage directly from Godot.
+     *
+     */
+    godot::PackedInt32Array get_offsets() const;
+    /**
+     * @brief Gets the node each edge leads to. Intended for usage directly from Godot.
+     *
+     */
+    godot::PackedInt32Array get_targets() const;
+    /**
+     * @brief Gets the cost of each edge. Intended for usage directly from Godot.
+     *
+     */
+    godot::PackedFloat32Array get_edge_costs() const;
+    /**
+     * @brief Gets the nodes next to a node. Intended for usage directly from Godot.
+     *
+     * @param node The node.
+     * @return godot::PackedInt32Array The neighboring nodes.
+     */
+    godot::PackedInt32Array get_neighbors(int node) const;
+    /**
+     * @brief Labels the nodes by which connected component they are in. Labels are kept until the next rebuild, since cost changes cannot split or join components.
+     *
+     * @return const std::vector<int32_t>& The component of every node, numbered from 0.
+     */
+    const std::vector<int32_t> &get_components_raw();
+    /**
+     * @brief Labels the nodes by which connected component they are in. Intended for usage directly from Godot.
+     *
+     * @return godot::PackedInt32Array The component of every node, numbered from 0.
+     */
+    godot::PackedInt32Array get_components();
+    /**
+     * @brief Gets the amount of connected components. Intended for usage directly from Godot.
+     *
+     */
+    int get_component_count();
+    /**
+     * @brief Finds the cheapest cost from every node to the closest goal, using Dijkstra.
+     *
+     * @param goals The goal nodes.
+     * @param distances Filled with the cost of every node, infinity if no goal can be reached.
+     */
+    void compute_distances(const std::vector<int32_t> &goals, std::vector<float> &distances) const;
+    /**
+     * @brief Finds the cheapest cost from every node to the closest goal. Intended for usage directly from Godot.
+     *
+     * @param goals The goal nodes.
+     * @return godot::PackedFloat32Array The cost of every node, INF if no goal can be reached.
+     */
+    godot::PackedFloat32Array get_distance_field(const godot::PackedInt32Array &goals) const;
+    /**
+     * @brief Finds the next step from every node toward the closest goal, so any amount of units can share one search. Intended for usage directly from Godot.
+     *
+     * @param goals The goal nodes.
+     * @return godot::PackedInt32Array The node to step to from every node. -1 for goals and for nodes that cannot reach one.
+     */
+    godot::PackedInt32Array get_flow_field(const godot::PackedInt32Array &goals) const;
+    /**
+     * @brief Finds the cheapest path between two nodes, using Dijkstra stopped at the goal.
+     *
+     * @param from The node to start from.
+     * @param to The node to reach.
+     * @return std::vector<int32_t> The nodes of the path, both ends included. Empty if there is none.
+     */
+    std::vector<int32_t> find_path_nodes(int32_t from, int32_t to) const;
+    /**
+     * @brief Finds the cheapest path between two nodes. Intended for usage directly from Godot.
+     *
+     * @param from The node to start from.
+     * @param to The node to reach.
+     * @return godot::PackedInt32Array The nodes of the path, both ends included. Empty if there is none.
+     */
+    godot::PackedInt32Array find_path(int from, int to) const;
+};
+
+#endif //GODOT_HEX_GRID_EXTENSION_HEX_GRAPH_H
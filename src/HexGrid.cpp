@@ -1,5 +1,42 @@
 #include "HexGrid.h"
 #include "godot_cpp/core/class_db.hpp"
+#include "godot_cpp/classes/performance.hpp"
+#include "godot_cpp/classes/worker_thread_pool.hpp"
+#include "godot_cpp/classes/concave_polygon_shape3d.hpp"
+#include "godot_cpp/classes/physics_server3d.hpp"
+#include "godot_cpp/classes/world3d.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <string>
+
+namespace {
+	// Below this, planning a tier on the WorkerThreadPool costs more than it saves.
+	constexpr size_t MIN_PARALLEL_AGENTS = 4;
+
+	// Stored in place of a tile for hexes spawned while headless. Only its address is used, it is never dereferenced.
+	char headless_marker{};
+	HexTile* const HEADLESS_TILE = reinterpret_cast<HexTile*>(&headless_marker);
+
+	// Bumped whenever the delta layout changes, so old deltas are refused instead of misread.
+	constexpr uint64_t DELTA_FORMAT = 1;
+	// The kinds of tile runs.
+	constexpr int DELTA_UNCHANGED = 0;
+	constexpr int DELTA_SPAWNED = 1;
+	constexpr int DELTA_DELETED = 2;
+	// The kinds of layer runs. A repeated run is followed by one value, a literal run by one per cell.
+	constexpr int DELTA_REPEATED = 1;
+	constexpr int DELTA_LITERAL = 2;
+
+	// The largest texture most GPUs accept along each side, well below Image.MAX_WIDTH.
+	constexpr int64_t MAX_LAYER_TEXTURE_SIZE = 16384;
+	// The most texels a layer texture can hold, 64 MiB of floats. Each one is kept three times: the texels, the image and the texture.
+	constexpr int64_t MAX_LAYER_TEXTURE_CELLS = 4096 * 4096;
+
+	bool is_same_value(float a, float b) {
+		return std::memcmp(&a, &b, sizeof(float)) == 0;
+	}
+}
 
 HexGrid::HexGrid() {
 
@@ -11,13 +48,13 @@ std::string HexGrid::convert_cube_to_string(std::tuple<int,int,int> cube_hex) {
 	return std::to_string(q)+","+std::to_string(r)+","+std::to_string(s);
 }
 
-long HexGrid::hash(int q, int r) {
-	return (long(q) + long(r) * max_size);
+int64_t HexGrid::hash(int q, int r) {
+	return HexTileStorage::key(q, r);
 }
 
-std::pair<int, int> HexGrid::unhash(long key)
+std::pair<int, int> HexGrid::unhash(int64_t key)
 {
-	return std::make_pair(int(key % max_size), int(key / max_size));
+	return HexTileStorage::unkey(key);
 }
 
 int HexGrid::get_max_size() {
@@ -30,6 +67,7 @@ void HexGrid::set_max_size(int new_size) {
 
 void HexGrid::set_tile_size(float new_size) {
 	tile_size = new_size;
+	is_collision_stale = true;
 }
 
 float HexGrid::get_tile_size() {
@@ -44,6 +82,122 @@ godot::Ref<godot::PackedScene> HexGrid::get_tile() {
 	return tile_scene;
 }
 
+void HexGrid::configure_map(int new_shape, int new_width, int new_height, int new_wrap) {
+	ERR_FAIL_COND_MSG((new_shape < MAP_SHAPE_UNBOUNDED) || (new_shape > MAP_SHAPE_PARALLELOGRAM), "Invalid map shape.");
+	ERR_FAIL_COND_MSG((new_wrap < WRAP_NONE) || (new_wrap > WRAP_TOROIDAL), "Invalid wrap mode.");
+	ERR_FAIL_COND_MSG(new_width < 0 || new_height < 0, "Map size cannot be less than zero.");
+	ERR_FAIL_COND_MSG(tile_storage.size() > 0, "Cannot change the map while it has tiles. Delete them first.");
+
+	map_width = new_width;
+	map_height = new_height;
+	wrap_mode = new_wrap;
+	// The inspector sets the wrap mode and the shape one at a time, so an unsupported combination is kept around until the shape catches up.
+	if (!HexTileStorage::can_wrap(new_shape, new_height, new_wrap)) {
+		WARN_PRINT("Only odd-r rectangles and parallelograms can wrap, and odd-r rectangles need an even height to wrap north to south. The map will not wrap.");
+	}
+	tile_storage.configure(new_shape, new_width, new_height, new_wrap);
+	snapshot_layout.reset();
+	area_sums.clear();
+	layer_hierarchies.clear();
+	is_collision_stale = true;
+}
+
+void HexGrid::set_map_shape(int new_shape) {
+	configure_map(new_shape, map_width, map_height, wrap_mode);
+}
+
+int HexGrid::get_map_shape() {
+	return tile_storage.get_shape();
+}
+
+void HexGrid::set_map_width(int new_width) {
+	configure_map(tile_storage.get_shape(), new_width, map_height, wrap_mode);
+}
+
+int HexGrid::get_map_width() {
+	return map_width;
+}
+
+void HexGrid::set_map_height(int new_height) {
+	configure_map(tile_storage.get_shape(), map_width, new_height, wrap_mode);
+}
+
+int HexGrid::get_map_height() {
+	return map_height;
+}
+
+void HexGrid::set_wrap_mode(int new_wrap) {
+	configure_map(tile_storage.get_shape(), map_width, map_height, new_wrap);
+}
+
+int HexGrid::get_wrap_mode() {
+	return wrap_mode;
+}
+
+godot::Vector2i HexGrid::wrap_hex(int q, int r) {
+	std::pair<int, int> hex = tile_storage.canonicalize(std::pair<int, int>(q, r));
+	return godot::Vector2i(hex.first, hex.second);
+}
+
+godot::Vector3 HexGrid::get_hex_position(int q, int r) {
+	float x = (float(q) + (float(r) * .5f)) * tile_size;
+	float z = float(r) * tile_size * sqrtf(3) / 2.0f;
+	return godot::Vector3(x, 0, z);
+}
+
+godot::Vector2i HexGrid::world_to_hex(godot::Vector3 position) {
+	ERR_FAIL_COND_V_MSG(tile_size <= 0.0f, godot::Vector2i(), "Tile size must be greater than zero.");
+
+	// The inverse of get_hex_position, in the grid's local space.
+	double r = double(position.z) / (double(tile_size) * sqrt(3.0) / 2.0);
+	double q = double(position.x) / double(tile_size) - r * 0.5;
+	std::pair<int, int> hex = tile_storage.canonicalize(axial_round(std::pair<double, double>(q, r)));
+	return godot::Vector2i(hex.first, hex.second);
+}
+
+HexTile* HexGrid::get_hex_at_position(godot::Vector3 position) {
+	godot::Vector2i hex = world_to_hex(position);
+	return get_hex(hex.x, hex.y);
+}
+
+bool HexGrid::is_in_map(int q, int r) {
+	return tile_storage.contains(q, r);
+}
+
+int HexGrid::spawn_map(bool connect_mouse_signals, const godot::Ref<godot::PackedScene> &tile_to_spawn) {
+	ERR_FAIL_COND_V_MSG(!tile_storage.is_bounded(), 0, "Only bounded maps can be filled, set a map shape first.");
+
+	ERR_FAIL_COND_V_MSG(!headless && (tile_scene == NULL) && (tile_to_spawn == NULL), 0, "No default hex assigned, check that the grid has one.");
+
+	int spawned = 0;
+	tile_storage.for_each_cell([&](int q, int r) {
+		if (!tile_storage.get(q, r) && (spawn_hex(q, r, connect_mouse_signals, tile_to_spawn) || tile_storage.get(q, r))) {
+			spawned++;
+		}
+	});
+	return spawned;
+}
+
+godot::Vector2i HexGrid::offset_to_axial(godot::Vector2i offset_co_ords, int offset_type) {
+	ERR_FAIL_COND_V_MSG((offset_type < OFFSET_ODD_R) || (offset_type > OFFSET_EVEN_Q), godot::Vector2i(), "Invalid offset type.");
+	std::pair<int, int> axial = hex_offset_to_axial(offset_co_ords.x, offset_co_ords.y, offset_type);
+	return godot::Vector2i(axial.first, axial.second);
+}
+
+godot::Vector2i HexGrid::axial_to_offset(godot::Vector2i axial_co_ords, int offset_type) {
+	ERR_FAIL_COND_V_MSG((offset_type < OFFSET_ODD_R) || (offset_type > OFFSET_EVEN_Q), godot::Vector2i(), "Invalid offset type.");
+	std::pair<int, int> offset = hex_axial_to_offset(axial_co_ords.x, axial_co_ords.y, offset_type);
+	return godot::Vector2i(offset.first, offset.second);
+}
+
+HexTile* HexGrid::get_hex_offset(int col, int row) {
+	int shape = tile_storage.get_shape();
+	ERR_FAIL_COND_V_MSG((shape != MAP_SHAPE_RECTANGLE_ODD_R) && (shape != MAP_SHAPE_RECTANGLE_EVEN_Q), nullptr, "Only rectangular maps have an offset layout, use offset_to_axial instead.");
+
+	std::pair<int, int> axial = hex_offset_to_axial(col, row, shape == MAP_SHAPE_RECTANGLE_ODD_R ? OFFSET_ODD_R : OFFSET_EVEN_Q);
+	return get_hex(axial.first, axial.second);
+}
+
 void HexGrid::on_mouse_enter_tile(int q, int r) {
 
 }
@@ -54,39 +208,290 @@ void HexGrid::on_mouse_exit_tile(int q, int r) {
 
 
 HexTile* HexGrid::spawn_hex(int q, int r, bool connect_mouse_signals, const godot::Ref<godot::PackedScene> &tile_to_spawn) {
-	ERR_FAIL_COND_V_MSG(tile_map.size() >= max_size,nullptr, "Grid is full. Increase the grid's max size to add more hexes.");
-	ERR_FAIL_COND_V_MSG((tile_scene == NULL),nullptr, "No default hex assigned, check that the grid has one.");
-	ERR_FAIL_COND_V_MSG(tile_map[hash(q, r)] != NULL,nullptr, "Hex was already spawned.");
-	godot::Node* tile_node;
-	if (tile_to_spawn != NULL) {
-		tile_node = tile_to_spawn->instantiate();
-	} else {
-		tile_node = tile_scene->instantiate();
+	HEX_GRID_PROFILE_SCOPE(profile_counters[PROFILE_SPAWN]);
+	// On a wrapping map, a tile spawned past the seam is spawned at its canonical coordinates instead of duplicating one.
+	std::tie(q, r) = tile_storage.canonicalize(std::pair<int, int>(q, r));
+	ERR_FAIL_COND_V_MSG(!tile_storage.is_bounded() && tile_storage.size() >= max_size,nullptr, "Grid is full. Increase the grid's max size to add more hexes.");
+	ERR_FAIL_COND_V_MSG(!tile_storage.contains(q, r),nullptr, "Hex is outside of the map.");
+	ERR_FAIL_COND_V_MSG(tile_storage.get(q, r) != NULL,nullptr, "Hex was already spawned.");
+
+	if (headless) {
+		// Only the coordinates are kept, there is no tile to return.
+		tile_storage.store(q, r, HEADLESS_TILE);
+		tile_revisions.mark(q, r, ++revision);
+		if (!is_flushing_commands) {
+			emit_signal("hex_spawned", q, r);
+		}
+		return nullptr;
 	}
+	ERR_FAIL_COND_V_MSG((tile_scene == NULL),nullptr, "No default hex assigned, check that the grid has one.");
 
-	this->add_child(tile_node);
-	HexTile* tile_hex = godot::Object::cast_to<HexTile>(tile_node);
+	HexTile* tile_hex = place_tile(q, r, connect_mouse_signals, tile_to_spawn != NULL ? tile_to_spawn : tile_scene);
 	ERR_FAIL_COND_V_MSG(tile_hex == nullptr,nullptr,"Spawned Tile was not a HexTile.");
 
+	tile_storage.store(q, r, tile_hex);
+	tile_revisions.mark(q, r, ++revision);
+	if (!is_flushing_commands) {
+		emit_signal("hex_spawned", q, r);
+	}
+
+	return tile_hex;
+}
+
+HexTile* HexGrid::place_tile(int q, int r, bool connect_mouse_signals, const godot::Ref<godot::PackedScene> &scene) {
+	HexTile* tile_hex = acquire_tile(scene);
+	if (tile_hex == nullptr) {
+		return nullptr;
+	}
+
+	this->add_child(tile_hex);
 
 	tile_hex->set_co_ords(q, r);
 	if (connect_mouse_signals) {
 		tile_hex->connect("mouse_entered", godot::Callable(this, "on_mouse_enter_tile").bind(q,r));
 		tile_hex->connect("mouse_exited", godot::Callable(this, "on_mouse_exit_tile").bind(q,r));
 	}
+	tile_hex->mouse_signals_connected = connect_mouse_signals;
 
-	float x = (float(q) + (float(r) * .5f)) * tile_size;
-	float z = float(r) * tile_size * sqrtf(3) / 2.0f;
+	tile_hex->set_position(get_hex_position(q, r));
+	if (collision_mode == COLLISION_CHUNKS) {
+		update_tile_collision(tile_hex);
+	}
+	return tile_hex;
+}
+
+HexTile* HexGrid::acquire_tile(const godot::Ref<godot::PackedScene> &scene) {
+	uint64_t scene_id = scene->get_instance_id();
+
+	// Without pooling no pool is created, so the grid does not hold onto scenes it will never reuse.
+	if (pool_max_size > 0) {
+		// The pool holds onto the scene, so its instance id stays valid for as long as its tiles are around.
+		TilePool &pool = tile_pools[scene_id];
+		if (!pool.tiles.empty()) {
+			HexTile* tile_hex = pool.tiles.back();
+			pool.tiles.pop_back();
+			pool_hits++;
+			return tile_hex;
+		}
+		pool.scene = scene;
+	}
 
-	tile_hex->set_position(godot::Vector3(x, 0, z));
+	pool_misses++;
+	godot::Node* tile_node = scene->instantiate();
+	ERR_FAIL_NULL_V_MSG(tile_node, nullptr, "Tile scene could not be instantiated.");
 
-	//NOTE: Insert function w/ a pair causes issues that end up creating a null ptr in the pair, use this way instead.
-	tile_map[hash(q, r)] = tile_hex;
+	HexTile* tile_hex = godot::Object::cast_to<HexTile>(tile_node);
+	if (tile_hex == nullptr) {
+		memdelete(tile_node);
+		return nullptr;
+	}
 
+	tile_hex->scene_id = scene_id;
 	return tile_hex;
 }
 
+void HexGrid::release_tile(HexTile* tile) {
+	// Reset the signal bindings first, a recycled tile may be spawned somewhere else without them.
+	if (tile->mouse_signals_connected) {
+		tile->disconnect("mouse_entered", godot::Callable(this, "on_mouse_enter_tile").bind(tile->co_ords.first, tile->co_ords.second));
+		tile->disconnect("mouse_exited", godot::Callable(this, "on_mouse_exit_tile").bind(tile->co_ords.first, tile->co_ords.second));
+		tile->mouse_signals_connected = false;
+	}
+
+	auto pool = tile_pools.find(tile->scene_id);
+	if (pool_max_size <= 0 || pool == tile_pools.end() || pool->second.tiles.size() >= size_t(pool_max_size)) {
+		tile->queue_free();
+		return;
+	}
+
+	this->remove_child(tile);
+	pool->second.tiles.push_back(tile);
+}
+
+void HexGrid::free_pooled_tiles() {
+	for (std::pair<const uint64_t, TilePool> &pair : tile_pools) {
+		for (HexTile* tile : pair.second.tiles) {
+			memdelete(tile);
+		}
+	}
+	tile_pools.clear();
+}
+
+void HexGrid::set_pool_max_size(int new_size) {
+	pool_max_size = new_size < 0 ? 0 : new_size;
+
+	for (std::pair<const uint64_t, TilePool> &pair : tile_pools) {
+		while (pair.second.tiles.size() > size_t(pool_max_size)) {
+			memdelete(pair.second.tiles.back());
+			pair.second.tiles.pop_back();
+		}
+	}
+}
+
+int HexGrid::get_pool_max_size() {
+	return pool_max_size;
+}
+
+int HexGrid::prewarm_pool(int count, const godot::Ref<godot::PackedScene> &scene) {
+	godot::Ref<godot::PackedScene> pool_scene = scene != NULL ? scene : tile_scene;
+	ERR_FAIL_COND_V_MSG((pool_scene == NULL), 0, "No scene to prewarm, check that the grid has a default hex.");
+	ERR_FAIL_COND_V_MSG((pool_max_size <= 0), 0, "Pooling is disabled. Increase the grid's pool max size to prewarm.");
+
+	TilePool &pool = tile_pools[pool_scene->get_instance_id()];
+	pool.scene = pool_scene;
+
+	int target = count < pool_max_size ? count : pool_max_size;
+	while (pool.tiles.size() < size_t(target)) {
+		godot::Node* tile_node = pool_scene->instantiate();
+		ERR_FAIL_NULL_V_MSG(tile_node, pool.tiles.size(), "Tile scene could not be instantiated.");
+
+		HexTile* tile_hex = godot::Object::cast_to<HexTile>(tile_node);
+		if (tile_hex == nullptr) {
+			memdelete(tile_node);
+			ERR_FAIL_V_MSG(pool.tiles.size(), "Pooled Tile was not a HexTile.");
+		}
+
+		tile_hex->scene_id = pool_scene->get_instance_id();
+		pool.tiles.push_back(tile_hex);
+	}
+
+	return pool.tiles.size();
+}
+
+int HexGrid::get_pooled_tile_count(const godot::Ref<godot::PackedScene> &scene) {
+	godot::Ref<godot::PackedScene> pool_scene = scene != NULL ? scene : tile_scene;
+	ERR_FAIL_COND_V_MSG((pool_scene == NULL), 0, "No scene to check, check that the grid has a default hex.");
+
+	auto pool = tile_pools.find(pool_scene->get_instance_id());
+	return pool == tile_pools.end() ? 0 : pool->second.tiles.size();
+}
+
+void HexGrid::clear_pools() {
+	free_pooled_tiles();
+	pool_hits = 0;
+	pool_misses = 0;
+}
+
+float HexGrid::get_pool_hit_rate() {
+	uint64_t total = pool_hits + pool_misses;
+	return total == 0 ? 0.0f : float(double(pool_hits) / double(total));
+}
+
+void HexGrid::_notification(int what) {
+	switch (what) {
+		case NOTIFICATION_ENTER_TREE:
+			register_profile_monitors();
+			is_tile_collision_stale = true;
+			break;
+		case NOTIFICATION_EXIT_TREE:
+			unregister_profile_monitors();
+			break;
+		case NOTIFICATION_PREDELETE:
+			free_pooled_tiles();
+			break;
+		case NOTIFICATION_INTERNAL_PHYSICS_PROCESS:
+			if (is_tile_collision_stale) {
+				update_tile_collisions();
+			}
+			if (is_collision_stale || collision_revision != revision) {
+				update_collision();
+			}
+			break;
+	}
+}
+
+void HexGrid::register_profile_monitors() {
+#ifdef HEX_GRID_PROFILING
+	static const char* monitor_names[MONITOR_MAX] = {
+		"lookup_calls", "lookup_time_usec", "lookup_max_usec",
+		"spawn_calls", "spawn_time_usec", "spawn_max_usec",
+		"search_calls", "search_time_usec", "search_max_usec", "search_tiles_visited",
+		"line_calls", "line_time_usec", "line_max_usec",
+		"storage_tiles", "storage_null_entries", "storage_bytes", "storage_load_factor"
+	};
+
+	godot::Performance* performance = godot::Performance::get_singleton();
+	// The instance id keeps grids with the same name apart, and a slash in the name would start a new category.
+	godot::String category = godot::String("HexGrid_") + godot::String(get_name()).replace("/", "_") + "_" + godot::String::num_uint64(get_instance_id());
+
+	for (int i = 0; i < MONITOR_MAX; i++) {
+		godot::StringName id = category + "/" + monitor_names[i];
+		if (performance->has_custom_monitor(id)) {
+			continue;
+		}
+		godot::Array args = godot::Array();
+		args.append(i);
+		performance->add_custom_monitor(id, godot::Callable(this, "get_profile_monitor"), args);
+		registered_monitors.push_back(id);
+	}
+#endif
+}
+
+void HexGrid::unregister_profile_monitors() {
+#ifdef HEX_GRID_PROFILING
+	godot::Performance* performance = godot::Performance::get_singleton();
+	for (const godot::StringName &id : registered_monitors) {
+		performance->remove_custom_monitor(id);
+	}
+	registered_monitors.clear();
+#endif
+}
+
+double HexGrid::get_profile_monitor(int monitor) {
+	ERR_FAIL_COND_V_MSG((monitor < 0) || (monitor >= MONITOR_MAX), 0.0, "Invalid monitor.");
+
+	switch (monitor) {
+		case MONITOR_STORAGE_TILES:
+			return double(tile_storage.size());
+		case MONITOR_STORAGE_NULL_ENTRIES:
+			return tile_storage.is_bounded() ? double(tile_storage.get_cell_count() - int64_t(tile_storage.size())) : 0.0;
+		case MONITOR_STORAGE_BYTES:
+			return double(tile_storage.get_memory_usage());
+		case MONITOR_STORAGE_LOAD_FACTOR:
+			return double(tile_storage.get_load_factor());
+	}
+
+#ifdef HEX_GRID_PROFILING
+	const HexGridProfileCounter &counter = profile_counters[monitor < MONITOR_SPAWN_CALLS ? PROFILE_LOOKUP : monitor < MONITOR_SEARCH_CALLS ? PROFILE_SPAWN : monitor < MONITOR_LINE_CALLS ? PROFILE_SEARCH : PROFILE_LINE];
+	switch (monitor) {
+		case MONITOR_LOOKUP_CALLS:
+		case MONITOR_SPAWN_CALLS:
+		case MONITOR_SEARCH_CALLS:
+		case MONITOR_LINE_CALLS:
+			return double(counter.calls.load());
+		case MONITOR_LOOKUP_TIME_USEC:
+		case MONITOR_SPAWN_TIME_USEC:
+		case MONITOR_SEARCH_TIME_USEC:
+		case MONITOR_LINE_TIME_USEC:
+			return double(counter.total_nsec.load()) / 1000.0;
+		case MONITOR_LOOKUP_MAX_USEC:
+		case MONITOR_SPAWN_MAX_USEC:
+		case MONITOR_SEARCH_MAX_USEC:
+		case MONITOR_LINE_MAX_USEC:
+			return double(counter.max_nsec.load()) / 1000.0;
+		case MONITOR_SEARCH_TILES_VISITED: {
+			uint64_t calls = counter.calls.load();
+			return calls == 0 ? 0.0 : double(counter.tiles_visited.load()) / double(calls);
+		}
+	}
+#endif
+
+	return 0.0;
+}
+
+void HexGrid::reset_profile_counters() {
+#ifdef HEX_GRID_PROFILING
+	for (HexGridProfileCounter &counter : profile_counters) {
+		counter.reset();
+	}
+#endif
+}
+
 float HexGrid::calculate_distance_axial(std::pair<int,int> hex_one, std::pair<int,int> hex_two) {
+	if (tile_storage.wraps()) {
+		return float(tile_storage.distance(hex_one, hex_two));
+	}
+
 	int q1,r1;
 	std::tie(q1,r1) = hex_one;
 	int q2, r2;
@@ -226,13 +631,16 @@ std::tuple<int,int,int> HexGrid::cube_round(std::tuple<double,double,double> cub
 }
 
 std::vector<std::pair<int, int>> HexGrid::get_axial_line(std::pair<int, int> hex_one, std::pair<int, int> hex_two) {
+	HEX_GRID_PROFILE_SCOPE(profile_counters[PROFILE_LINE]);
 	std::vector<std::pair<int, int>> results{};
 
+	hex_one = tile_storage.canonicalize(hex_one);
+	hex_two = tile_storage.nearest_copy(hex_one, hex_two);
 	int number_of_points = calculate_distance_axial(hex_one, hex_two);
 
 	for (int i = 0; i <= number_of_points; i++) {
 		std::pair<double, double> point = axial_lerp(hex_one, hex_two, 1.0 / number_of_points * i);
-		results.push_back(axial_round(point));
+		results.push_back(tile_storage.canonicalize(axial_round(point)));
 	}
 
 
@@ -240,140 +648,33 @@ std::vector<std::pair<int, int>> HexGrid::get_axial_line(std::pair<int, int> hex
 }
 
 std::vector<std::tuple<int,int,int>> HexGrid::get_cube_line(std::tuple<int,int,int> hex_one, std::tuple<int,int,int> hex_two) {
-	//Gets the difference between two values as an absolute value, and also gets the sign.
-	auto Difference = [](int start, int end) {
-		return end >= start ? std::make_pair(end - start, 1) : std::make_pair(start - end, -1);
-	};
-
-	std::vector<std::tuple<int,int,int>> results{};
-
-	auto Plot = [](int x, int y, std::vector<std::tuple<int,int,int>> &result_list) {
-		result_list.push_back(std::make_tuple(x,y,-x-y));
-	};
-
-	// Assigns variables based on variables from the tuples.
-	int x1, y1, z1;
-	std::tie(x1,y1,z1) = hex_one;
-	int x2, y2, z2;
-	std::tie(x2,y2,z2) = hex_two;
-
-	// Assigns variables based on the tuple generated from the Difference function.
-	int diff_x, diff_y, diff_z;
-	int sign_x, sign_y, sign_z;
-	std::tie(diff_x,sign_x) = Difference(x1,x2);
-	std::tie(diff_y,sign_y) = Difference(y1,y2);
-	std::tie(diff_z,sign_z) = Difference(z1,z2);
-
-	int x = x1;
-	int y = y1;
-	int z = z1;
-
-	Plot(x, y, results);
-
-	// A variation of the Bresenham's line algorithm called the TranThong algorithm.
+	HEX_GRID_PROFILE_SCOPE(profile_counters[PROFILE_LINE]);
+	// A variation of the Bresenham's line algorithm called the TranThong algorithm, see HexLineRange.
 	// I slapped together this crude implementation from denismr's Symmetric Precomputed Visibility Trie project
 	// Check out that at https://github.com/denismr/SymmetricPCVT/
+	std::pair<int, int> start = tile_storage.canonicalize(cube_to_axial(hex_one));
+	std::pair<int, int> end = tile_storage.nearest_copy(start, cube_to_axial(hex_two));
 
-	int test1 = ((sign_y == -1) ? -1 : 0);// + (sign_x == -1) ? -1 : 0;
-	int test2 = ((sign_z == -1) ? -1 : 0);// + (sign_x == -1) ? -1 : 0;
-
-	if (diff_x >= diff_y && diff_x >= diff_z) {
-
-		test1 = (diff_x + test1) >> 1;
-		test2 = (diff_x + test2) >> 1;
-
-		for (int i = 0; i < diff_x; i++) {
-			test1 -= diff_y;
-			test2 -= diff_z;
-			x += sign_x;
-			if (test1 < 0) {
-				y += sign_y;
-				test1 += diff_x;
-			}
-			if (test2 < 0) {
-				z += sign_z;
-				test2 += diff_x;
-			}
-			Plot(x, y, results);
-		}
-
-	} else if (diff_y >= diff_x && diff_y >= diff_z) {
-
-		test1 = (diff_y + test1) >> 1;
-		test2 = (diff_y + test2) >> 1;
-
-		for (int i = 0; i < diff_y; i++) {
-			test1 -= diff_x;
-			test2 -= diff_z;
-			y += sign_y;
-			if (test1 < 0) {
-				x += sign_x;
-				test1 += diff_y;
-			}
-			if (test2 < 0) {
-				z += sign_z;
-				test2 += diff_y;
-			}
-			Plot(x, y, results);
-		}
-
-	} else {
-
-		test1 = (diff_z + test1) >> 1;
-		test2 = (diff_z + test2) >> 1;
-
-
-		for (int i = 0; i < diff_z; i++) {
-			test1 -= diff_x;
-			test2 -= diff_y;
-			z += sign_z;
-			if (test1 < 0) {
-				x += sign_x;
-				test1 += diff_z;
-			}
-			if (test2 < 0) {
-				y += sign_y;
-				test2 += diff_z;
-			}
-			Plot(x, y, results);
-		}
-	}
+	std::vector<std::tuple<int,int,int>> results{};
+	results.reserve(HexLineRange(start, end, false).size());
+	for_each_line_hex(start, end, false, [this, &results](std::pair<int, int> hex) {
+		results.push_back(axial_to_cube(tile_storage.canonicalize(hex)));
+	});
 
 	return results;
 }
 
 std::vector<std::tuple<int,int,int>> HexGrid::get_cube_symmetric_line(std::tuple<int,int,int> hex_one, std::tuple<int,int,int> hex_two) {
-		auto Sign = [](int val) {
-    	return (int(0) < val) - (val < int(0));
-	};
-	
-	std::vector<std::tuple<int,int,int>> return_list{};
-	
-	auto vector = cube_subtract(hex_two,hex_one);
+	HEX_GRID_PROFILE_SCOPE(profile_counters[PROFILE_LINE]);
+	// The range mirrors over q whenever q is less than s along the vector, that is when the algorithm has trouble.
+	std::pair<int, int> start = tile_storage.canonicalize(cube_to_axial(hex_one));
+	std::pair<int, int> end = tile_storage.nearest_copy(start, cube_to_axial(hex_two));
 
-	// We need to mirror if q is less than s. That is when the algorithm has trouble.
-	if ((std::get<0>(vector)) < (std::get<2>(vector))) {
-		//Mirror
-		std::tuple<int,int,int> mirrored_hex_two = cube_mirror(hex_two,hex_one,1);
-
-		//
-		auto line = get_cube_line(hex_one,mirrored_hex_two);
-
-		//Unmirror
-		for (int i = 0; i < line.size(); i++) {
-			auto unmirrored_hex = line[i];
-			auto mirrored_hex = cube_mirror(unmirrored_hex,hex_one,1);
-			return_list.push_back(mirrored_hex);
-
-		}
-
-	} else {
-	// Otherwise, just draw as normal.
-		 auto line = get_cube_line(hex_one, hex_two);
-		 for (std::tuple<int,int,int> hex : line) {
-			return_list.push_back(hex);
-		}
-	}
+	std::vector<std::tuple<int,int,int>> return_list{};
+	return_list.reserve(HexLineRange(start, end, true).size());
+	for_each_line_hex(start, end, true, [this, &return_list](std::pair<int, int> hex) {
+		return_list.push_back(axial_to_cube(tile_storage.canonicalize(hex)));
+	});
 
 	return return_list;
 }
@@ -385,19 +686,14 @@ godot::Array HexGrid::get_line(HexTile* hex_one, HexTile* hex_two, bool make_sym
 	ERR_FAIL_NULL_V_MSG(hex_one, return_array, "First hex on line was null.");
 	ERR_FAIL_NULL_V_MSG(hex_two, return_array, "Second hex on line was null.");
 
-	std::vector<std::tuple<int,int,int>> unfiltered_hexes;
-	if (!make_symmetric) {
-		unfiltered_hexes = get_cube_line(axial_to_cube(hex_one->co_ords), axial_to_cube(hex_two->co_ords));
-	} else {
-		unfiltered_hexes = get_cube_symmetric_line(axial_to_cube(hex_one->co_ords), axial_to_cube(hex_two->co_ords));
-	}
-
-	for (std::tuple<int, int,int> tuple : unfiltered_hexes) {
-		HexTile* hex = get_hex(std::get<0>(tuple),std::get<1>(tuple));
+	HEX_GRID_PROFILE_SCOPE(profile_counters[PROFILE_LINE]);
+	// Tiles sit at canonical coordinates, and get_hex wraps the points past the seam back onto the map.
+	for_each_line_hex(hex_one->co_ords, tile_storage.nearest_copy(hex_one->co_ords, hex_two->co_ords), make_symmetric, [this, &return_array](std::pair<int, int> pair) {
+		HexTile* hex = get_hex(pair.first, pair.second);
 		if (hex) {
 			return_array.append(hex);
 		}
-	}
+	});
 
 	return return_array;
 }
@@ -416,14 +712,11 @@ std::pair<double, double> HexGrid::axial_lerp(std::pair<int, int> hex_one, std::
 
 
 
-std::vector<std::pair<int,int>> HexGrid::get_neighbors(std::pair<int,int> center_hex) {
-	std::vector<std::pair<int, int>> return_array{};
-
-	for (std::pair<int, int> direction : hex_neighbors) {
-		std::pair<int, int> neighbor = std::pair<int, int>(center_hex.first + direction.first, center_hex.second + direction.second);
-
-		return_array.push_back(neighbor);
+std::array<std::pair<int,int>, 6> HexGrid::get_neighbors(std::pair<int,int> center_hex) {
+	std::array<std::pair<int, int>, 6> return_array{};
 
+	for (int i = 0; i < 6; i++) {
+		return_array[i] = tile_storage.canonicalize(std::pair<int, int>(center_hex.first + HEX_DIRECTIONS[i].first, center_hex.second + HEX_DIRECTIONS[i].second));
 	}
 	return return_array;
 }
@@ -433,18 +726,30 @@ godot::Array HexGrid::get_neighbors_hex(HexTile* hex) {
 	godot::Array return_array = godot::Array();
 	ERR_FAIL_NULL_V_MSG(hex, return_array, "Cannot get neighbors on non-existing hex.");
 
-	for (std::pair<int, int> pair : get_neighbors(hex->co_ords)) {
-		HexTile* neighbor = get_hex(pair.first, pair.second);
-		if (neighbor) {
+	tile_storage.for_each_neighbor(hex->co_ords.first, hex->co_ords.second, [&return_array](int q, int r, HexTile* neighbor) {
+		if (neighbor && neighbor != HEADLESS_TILE) {
 			return_array.append(neighbor);
 		}
+	});
+	return return_array;
+}
 
-	}
+godot::Array HexGrid::get_neighbors_at(godot::Vector2i hex) {
+	godot::Array return_array = godot::Array();
+	std::pair<int, int> co_ords{};
+	ERR_FAIL_COND_V_MSG(!find_existing_hex(hex, co_ords), return_array, "Cannot get neighbors on non-existing hex.");
+
+	tile_storage.for_each_neighbor(co_ords.first, co_ords.second, [&return_array](int q, int r, HexTile* neighbor) {
+		if (neighbor) {
+			return_array.append(godot::Vector2i(q, r));
+		}
+	});
 	return return_array;
 }
 
 
-std::unordered_map<long, HexTile*> HexGrid::breadth_first_search(std::pair<int, int> origin, std::unordered_map<long, HexTile*> visited = std::unordered_map<long, HexTile*>()) {
+std::unordered_map<int64_t, HexTile*> HexGrid::breadth_first_search(std::pair<int, int> origin, std::unordered_map<int64_t, HexTile*> visited = std::unordered_map<int64_t, HexTile*>()) {
+	HEX_GRID_PROFILE_SCOPE(profile_counters[PROFILE_SEARCH]);
 
 	std::vector<std::pair<int, int>> queue{};
 	queue.push_back(origin);
@@ -456,19 +761,21 @@ std::unordered_map<long, HexTile*> HexGrid::breadth_first_search(std::pair<int,
 		std::pair<int, int> tile = queue.back();
 		queue.pop_back();
 
-		long hash_value = hash(tile.first, tile.second);
+		int64_t hash_value = hash(tile.first, tile.second);
 		//Check if it's already in our visited map
-		if (!visited[hash_value]) {
+		HexTile* &visited_tile = visited[hash_value];
+		if (!visited_tile) {
 			//If it's not, add it.
-			visited[hash_value] = tile_map[hash_value];
+			visited_tile = tile_storage.get(tile.first, tile.second);
+			HEX_GRID_PROFILE_VISITS(profile_counters[PROFILE_SEARCH], 1);
 
 			//Since it wasn't in our visited dict, add its neighbors to our queue.
-			for (std::pair<int, int> neighbor : get_neighbors(tile)) {
-				// Only add neighbors that are actually in the tile_map. Otherwise, we could iterate infinitely.
-				if (tile_map[hash(neighbor.first, neighbor.second)]) {
-					queue.push_back(neighbor);
+			tile_storage.for_each_neighbor(tile.first, tile.second, [&queue](int q, int r, HexTile* neighbor) {
+				// Only add neighbors that are actually in the tile storage. Otherwise, we could iterate infinitely.
+				if (neighbor) {
+					queue.push_back(std::pair<int, int>(q, r));
 				}
-			}
+			});
 		}
 	}
 
@@ -481,7 +788,7 @@ godot::Array HexGrid::breadth_first_search_hex(HexTile* origin, godot::Array pre
 
 	godot::Array results = godot::Array();
 
-	std::unordered_map<long, HexTile*> input_hex_map{};
+	std::unordered_map<int64_t, HexTile*> input_hex_map{};
 
 	for (int i = 0; i < pre_visited.size(); i++) {
 		HexTile* hex = godot::Object::cast_to<HexTile>(pre_visited[i]);
@@ -490,86 +797,1478 @@ godot::Array HexGrid::breadth_first_search_hex(HexTile* origin, godot::Array pre
 		input_hex_map[hash(hex->co_ords.first, hex->co_ords.second)] = hex;
 	}
 
-	std::unordered_map<long, HexTile*> search_map = breadth_first_search(origin->co_ords, input_hex_map);
+	std::unordered_map<int64_t, HexTile*> search_map = breadth_first_search(origin->co_ords, input_hex_map);
 
-	for (std::pair<long, HexTile*> pair : search_map) {
-		results.append(pair.second);
+	for (std::pair<int64_t, HexTile*> pair : search_map) {
+		if (pair.second != HEADLESS_TILE) {
+			results.append(pair.second);
+		}
 	}
 
 	return results;
 }
 
 
-std::vector<std::pair<int, int>> HexGrid::get_diagonals(std::pair<int, int> center_hex) {
-	std::vector<std::pair<int, int>> return_array{};
-
-	for (std::pair<int, int> direction : hex_diagonals) {
-		std::pair<int, int> diagonal = std::pair<int, int>(center_hex.first + direction.first, center_hex.second + direction.second);
+void HexGrid::add_layer(const godot::StringName &name, float default_value) {
+	ERR_FAIL_COND_MSG(layers.count(name), "Layer already exists.");
+	layers.emplace(name, HexLayer(default_value));
 
-		return_array.push_back(diagonal);
-
-	}
-	return return_array;
+	LayerRevisions &revisions = layer_revisions[name];
+	revisions.cells.clear();
+	revisions.created = ++revision;
+	removed_layers.erase(name);
 }
 
-godot::Array HexGrid::get_diagonals_hex(HexTile* hex) {
-	godot::Array return_array = godot::Array();
-	ERR_FAIL_NULL_V_MSG(hex, return_array, "Cannot get diagonals on non-existing hex.");
+void HexGrid::remove_layer(const godot::StringName &name) {
+	ERR_FAIL_COND_MSG(!layers.count(name), "Cannot remove non-existing layer.");
+	layers.erase(name);
+	layer_revisions.erase(name);
+	area_sums.erase(name);
+	layer_hierarchies.erase(name);
+	layer_textures.erase(name);
+	removed_layers[name] = ++revision;
+	emit_signal("layer_cleared", name);
+}
 
-	for (std::pair<int, int> pair : get_diagonals(hex->co_ords)) {
-		HexTile* diagonal = get_hex(pair.first, pair.second);
-		if (diagonal) {
-			return_array.append(diagonal);
-		}
+bool HexGrid::has_layer(const godot::StringName &name) {
+	return layers.count(name) > 0;
+}
 
+godot::Array HexGrid::get_layer_names() {
+	godot::Array names = godot::Array();
+	for (const std::pair<const godot::StringName, HexLayer> &pair : layers) {
+		names.append(pair.first);
 	}
-	return return_array;
+	return names;
 }
 
-
-std::pair<int, int> HexGrid::axial_add(std::pair<int, int> hex_one, std::pair<int, int> hex_two) {
-	return std::pair<int, int>{hex_one.first + hex_two.first, hex_one.second + hex_two.second};
+void HexGrid::set_layer_value(const godot::StringName &name, int q, int r, float value) {
+	HexLayer* layer = find_layer(name);
+	ERR_FAIL_NULL_MSG(layer, "Cannot set a value on a non-existing layer.");
+	layer->set_value(q, r, value);
+	layer_revisions[name].cells.mark(q, r, ++revision);
+	if (!is_flushing_commands) {
+		emit_signal("layer_value_changed", name, q, r);
+	}
 }
 
-std::pair<int,int> HexGrid::axial_subtract(std::pair<int,int> hex_one, std::pair<int,int> hex_two) {
-	return std::pair<int, int>{hex_one.first - hex_two.first, hex_one.second - hex_two.second}; 
+float HexGrid::get_layer_value(const godot::StringName &name, int q, int r) {
+	HexLayer* layer = find_layer(name);
+	ERR_FAIL_NULL_V_MSG(layer, 0.0f, "Cannot get a value from a non-existing layer.");
+	return layer->get_value(q, r);
 }
 
-std::pair<int, int> HexGrid::axial_scale(std::pair<int, int> hex, int factor) {
-	return std::pair<int, int>{hex.first * factor, hex.second * factor};
+void HexGrid::clear_layer(const godot::StringName &name) {
+	HexLayer* layer = find_layer(name);
+	ERR_FAIL_NULL_MSG(layer, "Cannot clear a non-existing layer.");
+	revision++;
+	for (int64_t key : layer->get_chunk_keys()) {
+		layer_revisions[name].cells.mark_chunk(key, revision);
+	}
+	layer->clear();
+	emit_signal("layer_cleared", name);
 }
 
+HexLayer* HexGrid::find_layer(const godot::StringName &name) {
+	auto layer = layers.find(name);
+	return layer == layers.end() ? nullptr : &layer->second;
+}
 
-std::tuple<int, int, int> HexGrid::cube_add(std::tuple<int, int, int> hex_one, std::tuple<int, int, int> hex_two) {
-	int q1 = std::get<0>(hex_one);
-	int r1 = std::get<1>(hex_one);
-	int s1 = std::get<2>(hex_one);
+HexAreaSums* HexGrid::sync_area_sums(const godot::StringName &name) {
+	const HexLayer* layer = find_layer(name);
+	ERR_FAIL_NULL_V_MSG(layer, nullptr, "Cannot sum a non-existing layer.");
+	const LayerRevisions &revisions = layer_revisions[name];
+	HexAreaSums &sums = area_sums[name];
 
-	int q2 = std::get<0>(hex_two);
-	int r2 = std::get<1>(hex_two);
-	int s2 = std::get<2>(hex_two);
+	// Layer cells can be written at any coordinates, but only the canonical copy of a hex is summed.
+	auto get_summed_value = [this, layer](int q, int r) {
+		std::pair<int, int> hex(q, r);
+		return (tile_storage.canonicalize(hex) == hex && tile_storage.get(q, r)) ? double(layer->get_value(q, r)) : 0.0;
+	};
+	if (sums.has_table() && sums.created == revisions.created && sums.synced_revision != revision) {
+		uint64_t from = sums.synced_revision;
+		auto record_changes = [&sums, &get_summed_value, from](int64_t key, const HexRevisionLog::Chunk &chunk) {
+			for (int cell = 0; cell < HEX_CHUNK_CELLS; cell++) {
+				if (chunk.cells[cell] > from) {
+					std::pair<int, int> hex = hex_chunk_cell_co_ords(key, cell);
+					sums.set_cell(hex.first, hex.second, get_summed_value(hex.first, hex.second));
+				}
+			}
+		};
+		tile_revisions.for_each_chunk_since(from, record_changes);
+		revisions.cells.for_each_chunk_since(from, record_changes);
+		sums.synced_revision = revision;
+	}
 
-	return std::tuple<int, int, int>(q1 + q2, r1 + r2, s1 + s2);
+	if (!sums.has_table() || sums.created != revisions.created || sums.needs_rebuild()) {
+		int min_q = INT_MAX;
+		int min_r = INT_MAX;
+		int max_q = INT_MIN;
+		int max_r = INT_MIN;
+		tile_storage.for_each([&min_q, &min_r, &max_q, &max_r](int q, int r, HexTile*) {
+			min_q = std::min(min_q, q);
+			min_r = std::min(min_r, r);
+			max_q = std::max(max_q, q);
+			max_r = std::max(max_r, r);
+		});
+		if (tile_storage.size() == 0) {
+			min_q = min_r = 0;
+			max_q = max_r = -1;
+		}
+		sums.build(min_q, min_r, max_q - min_q + 1, max_r - min_r + 1, [this, layer](auto &&add) {
+			tile_storage.for_each([layer, &add](int q, int r, HexTile*) {
+				add(q, r, double(layer->get_value(q, r)));
+			});
+		});
+		sums.created = revisions.created;
+		sums.synced_revision = revision;
+	}
+	return &sums;
 }
 
-std::tuple<int, int, int> HexGrid::cube_subtract(std::tuple<int, int, int> hex_one, std::tuple<int, int, int> hex_two) {
-	int q1 = std::get<0>(hex_one);
-	int r1 = std::get<1>(hex_one);
-	int s1 = std::get<2>(hex_one);
+double HexGrid::sum_layer_row(const HexAreaSums &sums, const HexLayer &layer, int r, int q_from, int q_to) {
+	std::pair<int, int> first(q_from, r);
+	std::pair<int, int> last(q_to, r);
+	// Canonical cells form one run per row, so a row whose ends are canonical has nothing past a seam.
+	if (tile_storage.canonicalize(first) == first && tile_storage.canonicalize(last) == last) {
+		return sums.get_row_sum(r, q_from, q_to);
+	}
+	double sum = 0.0;
+	for (int q = q_from; q <= q_to; q++) {
+		std::pair<int, int> hex = tile_storage.canonicalize(std::pair<int, int>(q, r));
+		if (tile_storage.get(hex.first, hex.second)) {
+			sum += layer.get_value(hex.first, hex.second);
+		}
+	}
+	return sum;
+}
 
-	int q2 = std::get<0>(hex_two);
-	int r2 = std::get<1>(hex_two);
-	int s2 = std::get<2>(hex_two);
+double HexGrid::get_layer_sum_hexagon(const godot::StringName &name, godot::Vector2i center, int radius) {
+	ERR_FAIL_COND_V_MSG(radius < 0, 0.0, "Radius cannot be less than zero.");
+	HexAreaSums* sums = sync_area_sums(name);
+	if (!sums) {
+		return 0.0;
+	}
+	const HexLayer &layer = *find_layer(name);
 
-	return std::tuple<int, int, int>(q1-q2,r1-r2,s1-s2);
+	double sum = 0.0;
+	for (int dr = -radius; dr <= radius; dr++) {
+		int q_from = center.x + std::max(-radius, -dr - radius);
+		int q_to = center.x + std::min(radius, -dr + radius);
+		sum += sum_layer_row(*sums, layer, center.y + dr, q_from, q_to);
+	}
+	return sum;
 }
 
-std::tuple<int, int, int> HexGrid::axial_to_cube(std::pair<int, int> axial_hex) {
-	return std::tuple<int, int, int>(axial_hex.first, axial_hex.second, -axial_hex.first - axial_hex.second);
-}
+double HexGrid::get_layer_sum_parallelogram(const godot::StringName &name, godot::Vector2i corner, godot::Vector2i size) {
+	ERR_FAIL_COND_V_MSG(size.x < 0 || size.y < 0, 0.0, "Size cannot be less than zero.");
+	HexAreaSums* sums = sync_area_sums(name);
+	if (!sums || size.x == 0 || size.y == 0) {
+		return 0.0;
+	}
+	if (tile_storage.get_wrap() == WRAP_NONE) {
+		return sums->get_box_sum(corner.x, corner.y, corner.x + size.x - 1, corner.y + size.y - 1);
+	}
+	const HexLayer &layer = *find_layer(name);
 
-std::pair<int, int> HexGrid::cube_to_axial(std::tuple<int, int, int> cube_hex) {
-	return std::pair<int, int>(std::get<0>(cube_hex), std::get<1>(cube_hex));
+	double sum = 0.0;
+	for (int r = corner.y; r < corner.y + size.y; r++) {
+		sum += sum_layer_row(*sums, layer, r, corner.x, corner.x + size.x - 1);
+	}
+	return sum;
+}
+
+HexGrid::LayerTexture* HexGrid::sync_layer_texture(const godot::StringName &name) {
+	const HexLayer* layer = find_layer(name);
+	ERR_FAIL_NULL_V_MSG(layer, nullptr, "Cannot pack a non-existing layer.");
+	const LayerRevisions &revisions = layer_revisions[name];
+	LayerTexture &layer_texture = layer_textures[name];
+	HexLayerTexture &texels = layer_texture.texels;
+
+	// Layer cells can be written at any coordinates, but only the canonical copy of a hex is packed.
+	auto is_packed = [this](int q, int r) {
+		std::pair<int, int> hex(q, r);
+		return tile_storage.canonicalize(hex) == hex && tile_storage.get(q, r);
+	};
+	if (texels.has_texels() && texels.created == revisions.created && texels.synced_revision != revision) {
+		uint64_t from = texels.synced_revision;
+		bool &is_outside = layer_texture.needs_repack;
+		auto record_changes = [&texels, &is_packed, &is_outside, layer, from](int64_t key, const HexRevisionLog::Chunk &chunk) {
+			for (int cell = 0; cell < HEX_CHUNK_CELLS; cell++) {
+				if (chunk.cells[cell] > from) {
+					std::pair<int, int> hex = hex_chunk_cell_co_ords(key, cell);
+					bool has_texel = is_packed(hex.first, hex.second);
+					if (!texels.contains(hex.first, hex.second)) {
+						is_outside = is_outside || has_texel;
+						continue;
+					}
+					texels.set_cell(hex.first, hex.second, has_texel ? layer->get_value(hex.first, hex.second) : 0.0f);
+				}
+			}
+		};
+		tile_revisions.for_each_chunk_since(from, record_changes);
+		revisions.cells.for_each_chunk_since(from, record_changes);
+		texels.synced_revision = revision;
+	}
+
+	// Kept until a repack succeeds, since the incremental pass above will not see the cells outside the box again.
+	if (!texels.has_texels() || texels.created != revisions.created || layer_texture.needs_repack) {
+		int min_q = INT_MAX;
+		int min_r = INT_MAX;
+		int max_q = INT_MIN;
+		int max_r = INT_MIN;
+		tile_storage.for_each([&min_q, &min_r, &max_q, &max_r](int q, int r, HexTile*) {
+			min_q = std::min(min_q, q);
+			min_r = std::min(min_r, r);
+			max_q = std::max(max_q, q);
+			max_r = std::max(max_r, r);
+		});
+		if (tile_storage.size() == 0) {
+			min_q = min_r = max_q = max_r = 0;
+		}
+		// Grown out to whole chunks, so a map that grows a little at a time is not repacked, nor the texture resized, every time.
+		min_q = (min_q >> HEX_CHUNK_SHIFT) << HEX_CHUNK_SHIFT;
+		min_r = (min_r >> HEX_CHUNK_SHIFT) << HEX_CHUNK_SHIFT;
+		max_q = (max_q | HEX_CHUNK_MASK);
+		max_r = (max_r | HEX_CHUNK_MASK);
+		// Checked before allocating, since two far apart tiles on an unbounded map would otherwise ask for gigabytes.
+		int64_t width = int64_t(max_q) - min_q + 1;
+		int64_t height = int64_t(max_r) - min_r + 1;
+		ERR_FAIL_COND_V_MSG(width > MAX_LAYER_TEXTURE_SIZE || height > MAX_LAYER_TEXTURE_SIZE, nullptr, "The tiles are spread too far apart to pack into a texture, which is limited to 16384 hexes along q and r.");
+		ERR_FAIL_COND_V_MSG(width * height > MAX_LAYER_TEXTURE_CELLS, nullptr, "The tiles cover too large a box to pack into a texture, which is limited to 4096 * 4096 hexes.");
+		int old_width = texels.get_width();
+		int old_height = texels.get_height();
+		texels.pack(min_q, min_r, max_q - min_q + 1, max_r - min_r + 1, [this, layer](auto &&set) {
+			tile_storage.for_each([layer, &set](int q, int r, HexTile*) {
+				set(q, r, layer->get_value(q, r));
+			});
+		});
+		texels.created = revisions.created;
+		texels.synced_revision = revision;
+		layer_texture.needs_repack = false;
+		layer_texture.is_image_resized = layer_texture.is_image_resized || texels.get_width() != old_width || texels.get_height() != old_height;
+	}
+
+	if (texels.has_changed() || layer_texture.image.is_null()) {
+		const std::vector<float> &values = texels.get_texels();
+		godot::PackedByteArray data = godot::PackedByteArray();
+		data.resize(int64_t(values.size() * sizeof(float)));
+		std::memcpy(data.ptrw(), values.data(), values.size() * sizeof(float));
+		if (layer_texture.image.is_null()) {
+			layer_texture.image = godot::Image::create_from_data(texels.get_width(), texels.get_height(), false, godot::Image::FORMAT_RF, data);
+		} else {
+			layer_texture.image->set_data(texels.get_width(), texels.get_height(), false, godot::Image::FORMAT_RF, data);
+		}
+		texels.mark_uploaded();
+		layer_texture.is_image_changed = true;
+	}
+	return &layer_texture;
+}
+
+godot::Ref<godot::Image> HexGrid::get_layer_image(const godot::StringName &name) {
+	LayerTexture* layer_texture = sync_layer_texture(name);
+	ERR_FAIL_NULL_V(layer_texture, godot::Ref<godot::Image>());
+	return layer_texture->image;
+}
+
+godot::Ref<godot::ImageTexture> HexGrid::get_layer_texture(const godot::StringName &name) {
+	LayerTexture* layer_texture = sync_layer_texture(name);
+	ERR_FAIL_NULL_V(layer_texture, godot::Ref<godot::ImageTexture>());
+
+	if (layer_texture->texture.is_null()) {
+		layer_texture->texture = godot::ImageTexture::create_from_image(layer_texture->image);
+	} else if (layer_texture->is_image_resized) {
+		layer_texture->texture->set_image(layer_texture->image);
+	} else if (layer_texture->is_image_changed) {
+		layer_texture->texture->update(layer_texture->image);
+	}
+	layer_texture->is_image_changed = false;
+	layer_texture->is_image_resized = false;
+	return layer_texture->texture;
+}
+
+godot::Vector4 HexGrid::get_layer_texture_rect(const godot::StringName &name) {
+	LayerTexture* layer_texture = sync_layer_texture(name);
+	ERR_FAIL_NULL_V(layer_texture, godot::Vector4());
+	const HexLayerTexture &texels = layer_texture->texels;
+	return godot::Vector4(float(texels.get_min_q()), float(texels.get_min_r()), float(texels.get_width()), float(texels.get_height()));
+}
+
+const HexLayerHierarchy* HexGrid::sync_layer_hierarchy(const godot::StringName &name, int level) {
+	const HexLayer* layer = find_layer(name);
+	ERR_FAIL_NULL_V_MSG(layer, nullptr, "Cannot summarize a non-existing layer.");
+	ERR_FAIL_COND_V_MSG(level < 1 || level > HEX_HIERARCHY_MAX_LEVEL, nullptr, "Level has to be from 1 to 12.");
+	const LayerRevisions &revisions = layer_revisions[name];
+	HexLayerHierarchy &hierarchy = layer_hierarchies[name];
+
+	std::unordered_set<int64_t> changed{};
+	if (hierarchy.created != revisions.created || hierarchy.get_depth() < level) {
+		hierarchy.reset(std::max(level, hierarchy.get_depth()));
+		tile_storage.for_each([&changed](int q, int r, HexTile*) {
+			changed.insert(HexTileStorage::key(q, r));
+		});
+	} else if (hierarchy.synced_revision != revision) {
+		uint64_t from = hierarchy.synced_revision;
+		auto record_changes = [&changed, from](int64_t key, const HexRevisionLog::Chunk &chunk) {
+			for (int cell = 0; cell < HEX_CHUNK_CELLS; cell++) {
+				if (chunk.cells[cell] > from) {
+					std::pair<int, int> hex = hex_chunk_cell_co_ords(key, cell);
+					changed.insert(HexTileStorage::key(hex.first, hex.second));
+				}
+			}
+		};
+		tile_revisions.for_each_chunk_since(from, record_changes);
+		revisions.cells.for_each_chunk_since(from, record_changes);
+	}
+
+	// Like the area sums, only the canonical copy of a hex is summarized.
+	hierarchy.update(changed, [this, layer](int q, int r, float &value) {
+		std::pair<int, int> hex(q, r);
+		if (tile_storage.canonicalize(hex) != hex || !tile_storage.get(q, r)) {
+			return false;
+		}
+		value = layer->get_value(q, r);
+		return true;
+	});
+	hierarchy.created = revisions.created;
+	hierarchy.synced_revision = revision;
+	return &hierarchy;
+}
+
+godot::Vector2i HexGrid::get_parent_hex(godot::Vector2i hex, int levels) {
+	ERR_FAIL_COND_V_MSG(levels < 0, hex, "Levels cannot be less than zero.");
+	std::pair<int, int> parent(hex.x, hex.y);
+	for (int level = 0; level < levels; level++) {
+		parent = hex_aperture_parent(parent.first, parent.second);
+	}
+	return godot::Vector2i(parent.first, parent.second);
+}
+
+godot::Array HexGrid::get_child_hexes(godot::Vector2i parent) {
+	godot::Array return_array = godot::Array();
+	std::pair<int, int> center = hex_aperture_center(parent.x, parent.y);
+	return_array.append(godot::Vector2i(center.first, center.second));
+	for (const std::pair<int, int> &direction : HEX_DIRECTIONS) {
+		return_array.append(godot::Vector2i(center.first + direction.first, center.second + direction.second));
+	}
+	return return_array;
+}
+
+godot::Vector2i HexGrid::get_parent_center(godot::Vector2i parent, int level) {
+	ERR_FAIL_COND_V_MSG(level < 0, parent, "Level cannot be less than zero.");
+	std::pair<int, int> center(parent.x, parent.y);
+	for (int step = 0; step < level; step++) {
+		center = hex_aperture_center(center.first, center.second);
+	}
+	return godot::Vector2i(center.first, center.second);
+}
+
+godot::Dictionary HexGrid::get_layer_aggregate(const godot::StringName &name, int level, godot::Vector2i parent) {
+	godot::Dictionary summary = godot::Dictionary();
+	const HexLayerHierarchy* hierarchy = sync_layer_hierarchy(name, level);
+	if (!hierarchy) {
+		return summary;
+	}
+	const HexLayerHierarchy::Aggregate* aggregate = hierarchy->find(level, parent.x, parent.y);
+	if (!aggregate) {
+		return summary;
+	}
+	summary["sum"] = aggregate->sum;
+	summary["count"] = aggregate->count;
+	summary["average"] = aggregate->sum / double(aggregate->count);
+	summary["min"] = aggregate->min;
+	summary["max"] = aggregate->max;
+	return summary;
+}
+
+godot::Dictionary HexGrid::get_layer_aggregates(const godot::StringName &name, int level, int statistic) {
+	godot::Dictionary summaries = godot::Dictionary();
+	ERR_FAIL_COND_V_MSG((statistic < STATISTIC_SUM) || (statistic > STATISTIC_MAX), summaries, "Invalid statistic.");
+	const HexLayerHierarchy* hierarchy = sync_layer_hierarchy(name, level);
+	if (!hierarchy) {
+		return summaries;
+	}
+	for (const std::pair<const int64_t, HexLayerHierarchy::Aggregate> &pair : hierarchy->get_level(level)) {
+		const HexLayerHierarchy::Aggregate &aggregate = pair.second;
+		double value{};
+		switch (statistic) {
+			case STATISTIC_SUM:
+				value = aggregate.sum;
+				break;
+			case STATISTIC_COUNT:
+				value = double(aggregate.count);
+				break;
+			case STATISTIC_AVERAGE:
+				value = aggregate.sum / double(aggregate.count);
+				break;
+			case STATISTIC_MIN:
+				value = aggregate.min;
+				break;
+			default:
+				value = aggregate.max;
+				break;
+		}
+		std::pair<int, int> co_ords = HexTileStorage::unkey(pair.first);
+		summaries[godot::Vector2i(co_ords.first, co_ords.second)] = value;
+	}
+	return summaries;
+}
+
+const HexTileStorage &HexGrid::get_tile_storage() const {
+	return tile_storage;
+}
+
+godot::Ref<HexRegion> HexGrid::output_region(const godot::Ref<HexRegion> &into) {
+	if (into.is_valid()) {
+		return into;
+	}
+	godot::Ref<HexRegion> region;
+	region.instantiate();
+	return region;
+}
+
+void HexGrid::add_existing_hex(const godot::Ref<HexRegion> &region, std::pair<int, int> hex) {
+	hex = tile_storage.canonicalize(hex);
+	if (tile_storage.get(hex.first, hex.second)) {
+		region->add_hex(hex.first, hex.second);
+	}
+}
+
+godot::Ref<HexRegion> HexGrid::breadth_first_search_region(HexTile* origin, const godot::Ref<HexRegion> &pre_visited, const godot::Ref<HexRegion> &into) {
+	ERR_FAIL_NULL_V_MSG(origin, godot::Ref<HexRegion>(), "Origin hex cannot be null.");
+	return breadth_first_search_region_at(godot::Vector2i(origin->co_ords.first, origin->co_ords.second), pre_visited, into);
+}
+
+godot::Ref<HexRegion> HexGrid::breadth_first_search_region_at(godot::Vector2i origin, const godot::Ref<HexRegion> &pre_visited, const godot::Ref<HexRegion> &into) {
+	HEX_GRID_PROFILE_SCOPE(profile_counters[PROFILE_SEARCH]);
+	std::pair<int, int> start{};
+	ERR_FAIL_COND_V_MSG(!find_existing_hex(origin, start), godot::Ref<HexRegion>(), "Origin hex does not exist.");
+	ERR_FAIL_COND_V_MSG(pre_visited.is_valid() && pre_visited->has_hex(start.first, start.second), godot::Ref<HexRegion>(), "Origin cannot be in pre-visited region, search will simply return nothing.");
+
+	godot::Ref<HexRegion> region = output_region(into);
+	godot::Ref<HexRegion> visited = pre_visited.is_valid() ? pre_visited->copy() : output_region(nullptr);
+
+	std::vector<std::pair<int, int>> queue{};
+	queue.push_back(start);
+	visited->add_hex(start.first, start.second);
+
+	while (!queue.empty()) {
+		std::pair<int, int> tile = queue.back();
+		queue.pop_back();
+		region->add_hex(tile.first, tile.second);
+		HEX_GRID_PROFILE_VISITS(profile_counters[PROFILE_SEARCH], 1);
+
+		tile_storage.for_each_neighbor(tile.first, tile.second, [&queue, &visited](int q, int r, HexTile* neighbor) {
+			// Marking hexes as visited when they are queued keeps them from being queued twice.
+			if (neighbor && !visited->has_hex(q, r)) {
+				visited->add_hex(q, r);
+				queue.push_back(std::pair<int, int>(q, r));
+			}
+		});
+	}
+
+	return region;
+}
+
+godot::Ref<HexRegion> HexGrid::get_ring_region(HexTile* center, int radius, const godot::Ref<HexRegion> &into) {
+	ERR_FAIL_NULL_V_MSG(center, godot::Ref<HexRegion>(), "Cannot center on non-existing hex.");
+	return get_ring_region_at(godot::Vector2i(center->co_ords.first, center->co_ords.second), radius, into);
+}
+
+godot::Ref<HexRegion> HexGrid::get_ring_region_at(godot::Vector2i center, int radius, const godot::Ref<HexRegion> &into) {
+	ERR_FAIL_COND_V_MSG((radius <= 0), godot::Ref<HexRegion>(), "Radius cannot be less than or equal to zero.");
+	std::pair<int, int> co_ords{};
+	ERR_FAIL_COND_V_MSG(!find_existing_hex(center, co_ords), godot::Ref<HexRegion>(), "Cannot center on non-existing hex.");
+
+	godot::Ref<HexRegion> region = output_region(into);
+	for_each_ring_hex(co_ords.first, co_ords.second, radius, [this, &region](std::pair<int, int> pair) {
+		add_existing_hex(region, pair);
+	});
+	return region;
+}
+
+godot::Ref<HexRegion> HexGrid::get_spiral_ring_region(HexTile* center, int radius, const godot::Ref<HexRegion> &into) {
+	ERR_FAIL_NULL_V_MSG(center, godot::Ref<HexRegion>(), "Cannot center on non-existing hex.");
+	return get_spiral_ring_region_at(godot::Vector2i(center->co_ords.first, center->co_ords.second), radius, into);
+}
+
+godot::Ref<HexRegion> HexGrid::get_spiral_ring_region_at(godot::Vector2i center, int radius, const godot::Ref<HexRegion> &into) {
+	ERR_FAIL_COND_V_MSG((radius <= 0), godot::Ref<HexRegion>(), "Radius cannot be less than or equal to zero.");
+	std::pair<int, int> co_ords{};
+	ERR_FAIL_COND_V_MSG(!find_existing_hex(center, co_ords), godot::Ref<HexRegion>(), "Cannot center on non-existing hex.");
+
+	godot::Ref<HexRegion> region = output_region(into);
+	for_each_spiral_hex(co_ords.first, co_ords.second, radius - 1, [this, &region](std::pair<int, int> pair) {
+		add_existing_hex(region, pair);
+	});
+	return region;
+}
+
+godot::Ref<HexRegion> HexGrid::get_cone_region(HexTile* center, int direction, int radius, const godot::Ref<HexRegion> &into) {
+	ERR_FAIL_NULL_V_MSG(center, godot::Ref<HexRegion>(), "Cannot center on non-existing hex.");
+	return get_cone_region_at(godot::Vector2i(center->co_ords.first, center->co_ords.second), direction, radius, into);
+}
+
+godot::Ref<HexRegion> HexGrid::get_cone_region_at(godot::Vector2i center, int direction, int radius, const godot::Ref<HexRegion> &into) {
+	ERR_FAIL_COND_V_MSG((radius <= 0), godot::Ref<HexRegion>(), "Radius cannot be less than or equal to zero.");
+	ERR_FAIL_COND_V_MSG((direction < 0) || (direction > 5), godot::Ref<HexRegion>(), "Direction must be between 0 and 5.");
+	std::pair<int, int> co_ords{};
+	ERR_FAIL_COND_V_MSG(!find_existing_hex(center, co_ords), godot::Ref<HexRegion>(), "Cannot center on non-existing hex.");
+
+	godot::Ref<HexRegion> region = output_region(into);
+	for (std::pair<int, int> pair : HexConeRange(co_ords.first, co_ords.second, direction, radius)) {
+		add_existing_hex(region, pair);
+	}
+	return region;
+}
+
+godot::Ref<HexRegion> HexGrid::get_line_region(HexTile* hex_one, HexTile* hex_two, bool make_symmetric, const godot::Ref<HexRegion> &into) {
+	ERR_FAIL_NULL_V_MSG(hex_one, godot::Ref<HexRegion>(), "First hex on line was null.");
+	ERR_FAIL_NULL_V_MSG(hex_two, godot::Ref<HexRegion>(), "Second hex on line was null.");
+	return get_line_region_at(godot::Vector2i(hex_one->co_ords.first, hex_one->co_ords.second), godot::Vector2i(hex_two->co_ords.first, hex_two->co_ords.second), make_symmetric, into);
+}
+
+godot::Ref<HexRegion> HexGrid::get_line_region_at(godot::Vector2i hex_one, godot::Vector2i hex_two, bool make_symmetric, const godot::Ref<HexRegion> &into) {
+	std::pair<int, int> start{};
+	std::pair<int, int> end{};
+	ERR_FAIL_COND_V_MSG(!find_existing_hex(hex_one, start), godot::Ref<HexRegion>(), "First hex on line does not exist.");
+	ERR_FAIL_COND_V_MSG(!find_existing_hex(hex_two, end), godot::Ref<HexRegion>(), "Second hex on line does not exist.");
+	HEX_GRID_PROFILE_SCOPE(profile_counters[PROFILE_LINE]);
+
+	godot::Ref<HexRegion> region = output_region(into);
+	for_each_line_hex(start, tile_storage.nearest_copy(start, end), make_symmetric, [this, &region](std::pair<int, int> pair) {
+		add_existing_hex(region, pair);
+	});
+	return region;
+}
+
+int64_t HexGrid::get_shape_cache_memory_usage() const {
+	return int64_t(HexShapeCache::get_shared().get_memory_usage());
+}
+
+void HexGrid::prepare_visibility(int max_radius) {
+	ERR_FAIL_COND_MSG(max_radius < 0, "Radius cannot be less than zero.");
+	ERR_FAIL_COND_MSG(max_radius > INT16_MAX, "Radius is too large.");
+	if (max_radius > visibility_trie->get_radius()) {
+		// Grown into a new trie, since snapshots may still be walking the old one.
+		std::shared_ptr<HexVisibilityTrie> trie = std::make_shared<HexVisibilityTrie>();
+		trie->build(max_radius);
+		visibility_trie = trie;
+	}
+}
+
+void HexGrid::add_field_of_view(std::pair<int, int> origin, int radius, const HexRegion* blockers, const godot::Ref<HexRegion> &region) {
+	auto is_blocked = [this, origin, blockers](int dq, int dr) {
+		if (!blockers) {
+			return false;
+		}
+		std::pair<int, int> hex = tile_storage.canonicalize(std::pair<int, int>(origin.first + dq, origin.second + dr));
+		return blockers->has_hex(hex.first, hex.second);
+	};
+	visibility_trie->walk(radius, is_blocked, [this, origin, &region](int dq, int dr) {
+		add_existing_hex(region, std::pair<int, int>(origin.first + dq, origin.second + dr));
+	});
+}
+
+godot::Ref<HexRegion> HexGrid::get_field_of_view(HexTile* origin, int radius, const godot::Ref<HexRegion> &blockers, const godot::Ref<HexRegion> &into) {
+	ERR_FAIL_NULL_V_MSG(origin, godot::Ref<HexRegion>(), "Cannot look from a non-existing hex.");
+	return get_field_of_view_at(godot::Vector2i(origin->co_ords.first, origin->co_ords.second), radius, blockers, into);
+}
+
+godot::Ref<HexRegion> HexGrid::get_field_of_view_at(godot::Vector2i origin, int radius, const godot::Ref<HexRegion> &blockers, const godot::Ref<HexRegion> &into) {
+	std::pair<int, int> co_ords{};
+	ERR_FAIL_COND_V_MSG(!find_existing_hex(origin, co_ords), godot::Ref<HexRegion>(), "Cannot look from a non-existing hex.");
+	ERR_FAIL_COND_V_MSG(radius < 0, godot::Ref<HexRegion>(), "Radius cannot be less than zero.");
+	HEX_GRID_PROFILE_SCOPE(profile_counters[PROFILE_SEARCH]);
+
+	prepare_visibility(radius);
+	godot::Ref<HexRegion> region = output_region(into);
+	add_field_of_view(co_ords, radius, blockers.ptr(), region);
+	return region;
+}
+
+godot::Ref<HexRegion> HexGrid::get_field_of_view_many(godot::Array origins, int radius, const godot::Ref<HexRegion> &blockers, const godot::Ref<HexRegion> &into) {
+	ERR_FAIL_COND_V_MSG(radius < 0, godot::Ref<HexRegion>(), "Radius cannot be less than zero.");
+	HEX_GRID_PROFILE_SCOPE(profile_counters[PROFILE_SEARCH]);
+
+	prepare_visibility(radius);
+	godot::Ref<HexRegion> region = output_region(into);
+	for (int i = 0; i < origins.size(); i++) {
+		std::pair<int, int> co_ords{};
+		if (origins[i].get_type() == godot::Variant::VECTOR2I) {
+			ERR_FAIL_COND_V_MSG(!find_existing_hex(origins[i], co_ords), region, "Cannot look from a non-existing hex.");
+		} else {
+			HexTile* origin = godot::Object::cast_to<HexTile>(origins[i]);
+			ERR_FAIL_NULL_V_MSG(origin, region, "Can only look from arrays of hexes or coordinates.");
+			co_ords = origin->co_ords;
+		}
+		add_field_of_view(co_ords, radius, blockers.ptr(), region);
+	}
+	return region;
+}
+
+bool HexGrid::has_line_of_sight(HexTile* from, HexTile* to, const godot::Ref<HexRegion> &blockers) {
+	ERR_FAIL_NULL_V_MSG(from, false, "Cannot look from a non-existing hex.");
+	ERR_FAIL_NULL_V_MSG(to, false, "Cannot look at a non-existing hex.");
+	return has_line_of_sight_at(godot::Vector2i(from->co_ords.first, from->co_ords.second), godot::Vector2i(to->co_ords.first, to->co_ords.second), blockers);
+}
+
+bool HexGrid::has_line_of_sight_at(godot::Vector2i from, godot::Vector2i to, const godot::Ref<HexRegion> &blockers) {
+	std::pair<int, int> origin{};
+	std::pair<int, int> target{};
+	ERR_FAIL_COND_V_MSG(!find_existing_hex(from, origin), false, "Cannot look from a non-existing hex.");
+	ERR_FAIL_COND_V_MSG(!find_existing_hex(to, target), false, "Cannot look at a non-existing hex.");
+	HEX_GRID_PROFILE_SCOPE(profile_counters[PROFILE_LINE]);
+
+	target = tile_storage.nearest_copy(origin, target);
+	int dq = target.first - origin.first;
+	int dr = target.second - origin.second;
+
+	const HexRegion* blocker_region = blockers.ptr();
+	if (!blocker_region) {
+		return true;
+	}
+	auto is_blocked = [this, origin, blocker_region](int offset_q, int offset_r) {
+		std::pair<int, int> hex = tile_storage.canonicalize(std::pair<int, int>(origin.first + offset_q, origin.second + offset_r));
+		return blocker_region->has_hex(hex.first, hex.second);
+	};
+
+	if ((std::abs(dq) + std::abs(dr) + std::abs(dq + dr)) / 2 <= visibility_trie->get_radius()) {
+		return visibility_trie->is_line_clear(dq, dr, is_blocked);
+	}
+
+	// Past the trie's radius, a single line is no cheaper to look up than to draw.
+	HexLineRange line(std::pair<int, int>(0, 0), std::pair<int, int>(dq, dr), true);
+	size_t length = size_t(line.size());
+	size_t index = 0;
+	for (std::pair<int, int> hex : line) {
+		if (index > 0 && index + 1 < length && is_blocked(hex.first, hex.second)) {
+			return false;
+		}
+		index++;
+	}
+	return true;
+}
+
+bool HexGrid::is_hex_passable(int q, int r, const HexLayer* cost_layer, const HexRegion* blockers) const {
+	if (!tile_storage.get(q, r)) {
+		return false;
+	}
+	if (blockers && blockers->has_hex(q, r)) {
+		return false;
+	}
+	return !cost_layer || cost_layer->get_value(q, r) >= 0.0f;
+}
+
+std::vector<std::pair<int, int>> HexGrid::find_path_axial(std::pair<int, int> start, std::pair<int, int> goal, const HexLayer* cost_layer, const HexRegion* blockers, int mode) {
+	HEX_GRID_PROFILE_SCOPE(profile_counters[PROFILE_SEARCH]);
+	std::vector<std::pair<int, int>> path{};
+	ERR_FAIL_COND_V_MSG((mode < PATH_A_STAR) || (mode > PATH_JUMP_POINT), path, "Invalid path mode.");
+
+	auto is_passable = [this, cost_layer, blockers](int q, int r) {
+		return is_hex_passable(q, r, cost_layer, blockers);
+	};
+
+	HexPathfinder pathfinder(tile_storage);
+	if (mode == PATH_JUMP_POINT) {
+		pathfinder.find_jump_path(start, goal, is_passable, path);
+	} else if (cost_layer) {
+		pathfinder.find_path(start, goal, is_passable, [cost_layer](int q, int r) {
+			return std::max(cost_layer->get_value(q, r), 1.0f);
+		}, path);
+	} else {
+		pathfinder.find_path(start, goal, is_passable, [](int, int) {
+			return 1.0f;
+		}, path);
+	}
+	HEX_GRID_PROFILE_VISITS(profile_counters[PROFILE_SEARCH], pathfinder.get_expansions());
+	return path;
+}
+
+godot::Array HexGrid::find_path(HexTile* from, HexTile* to, const godot::StringName &cost_layer, const godot::Ref<HexRegion> &blockers, int mode) {
+	godot::Array return_array = godot::Array();
+	ERR_FAIL_NULL_V_MSG(from, return_array, "Cannot path from a non-existing hex.");
+	ERR_FAIL_NULL_V_MSG(to, return_array, "Cannot path to a non-existing hex.");
+
+	godot::Array path = find_path_at(godot::Vector2i(from->co_ords.first, from->co_ords.second), godot::Vector2i(to->co_ords.first, to->co_ords.second), cost_layer, blockers, mode);
+	for (int64_t i = 0; i < path.size(); i++) {
+		godot::Vector2i hex = path[i];
+		// Hexes spawned while headless have no tile until attach_tiles runs, so they are skipped rather than returned as null.
+		HexTile* tile = get_hex(hex.x, hex.y);
+		if (tile) {
+			return_array.append(tile);
+		}
+	}
+	return return_array;
+}
+
+godot::Array HexGrid::find_path_at(godot::Vector2i from, godot::Vector2i to, const godot::StringName &cost_layer, const godot::Ref<HexRegion> &blockers, int mode) {
+	godot::Array return_array = godot::Array();
+	std::pair<int, int> start{};
+	std::pair<int, int> goal{};
+	ERR_FAIL_COND_V_MSG(!find_existing_hex(from, start), return_array, "Cannot path from a non-existing hex.");
+	ERR_FAIL_COND_V_MSG(!find_existing_hex(to, goal), return_array, "Cannot path to a non-existing hex.");
+
+	const HexLayer* layer = nullptr;
+	if (cost_layer != godot::StringName()) {
+		layer = find_layer(cost_layer);
+		ERR_FAIL_NULL_V_MSG(layer, return_array, "Cannot path over a non-existing cost layer.");
+	}
+
+	for (std::pair<int, int> pair : find_path_axial(start, goal, layer, blockers.ptr(), mode)) {
+		return_array.append(godot::Vector2i(pair.first, pair.second));
+	}
+	return return_array;
+}
+
+std::vector<std::pair<int, int>> HexGrid::smooth_path_axial(const std::vector<std::pair<int, int>> &path, const HexLayer* cost_layer, const HexRegion* blockers) {
+	HEX_GRID_PROFILE_SCOPE(profile_counters[PROFILE_LINE]);
+	std::vector<std::pair<int, int>> waypoints{};
+	if (path.empty()) {
+		return waypoints;
+	}
+
+	// Unwraps the path first, so a step across the seam stays a single step.
+	std::vector<std::pair<int, int>> hexes{};
+	hexes.reserve(path.size());
+	hexes.push_back(path.front());
+	for (size_t i = 1; i < path.size(); i++) {
+		std::pair<int, int> previous = tile_storage.canonicalize(path[i - 1]);
+		std::pair<int, int> next = tile_storage.nearest_copy(previous, path[i]);
+		hexes.push_back(std::pair<int, int>(hexes.back().first + next.first - previous.first, hexes.back().second + next.second - previous.second));
+	}
+
+	auto is_line_passable = [this, cost_layer, blockers](std::pair<int, int> start, std::pair<int, int> end) {
+		bool passable = true;
+		for_each_line_hex(start, end, true, [this, cost_layer, blockers, &passable](std::pair<int, int> hex) {
+			hex = tile_storage.canonicalize(hex);
+			passable = passable && is_hex_passable(hex.first, hex.second, cost_layer, blockers);
+		});
+		return passable;
+	};
+
+	// Greedy string pulling. The anchor is kept until the line from it to the next hex is cut, then the last hex it could see becomes a corner.
+	waypoints.push_back(hexes.front());
+	size_t anchor = 0;
+	for (size_t i = 2; i < hexes.size(); i++) {
+		if (!is_line_passable(hexes[anchor], hexes[i])) {
+			anchor = i - 1;
+			waypoints.push_back(hexes[anchor]);
+		}
+	}
+	if (hexes.size() > 1) {
+		waypoints.push_back(hexes.back());
+	}
+	return waypoints;
+}
+
+godot::PackedVector3Array HexGrid::find_smooth_path(HexTile* from, HexTile* to, const godot::StringName &cost_layer, const godot::Ref<HexRegion> &blockers, int mode) {
+	ERR_FAIL_NULL_V_MSG(from, godot::PackedVector3Array(), "Cannot path from a non-existing hex.");
+	ERR_FAIL_NULL_V_MSG(to, godot::PackedVector3Array(), "Cannot path to a non-existing hex.");
+	return find_smooth_path_at(godot::Vector2i(from->co_ords.first, from->co_ords.second), godot::Vector2i(to->co_ords.first, to->co_ords.second), cost_layer, blockers, mode);
+}
+
+godot::PackedVector3Array HexGrid::find_smooth_path_at(godot::Vector2i from, godot::Vector2i to, const godot::StringName &cost_layer, const godot::Ref<HexRegion> &blockers, int mode) {
+	godot::PackedVector3Array positions = godot::PackedVector3Array();
+	std::pair<int, int> start{};
+	std::pair<int, int> goal{};
+	ERR_FAIL_COND_V_MSG(!find_existing_hex(from, start), positions, "Cannot path from a non-existing hex.");
+	ERR_FAIL_COND_V_MSG(!find_existing_hex(to, goal), positions, "Cannot path to a non-existing hex.");
+
+	const HexLayer* layer = nullptr;
+	if (cost_layer != godot::StringName()) {
+		layer = find_layer(cost_layer);
+		ERR_FAIL_NULL_V_MSG(layer, positions, "Cannot path over a non-existing cost layer.");
+	}
+
+	std::vector<std::pair<int, int>> path = find_path_axial(start, goal, layer, blockers.ptr(), mode);
+	for (std::pair<int, int> waypoint : smooth_path_axial(path, layer, blockers.ptr())) {
+		positions.push_back(get_hex_position(waypoint.first, waypoint.second));
+	}
+	return positions;
+}
+
+godot::Array HexGrid::plan_group_paths(const godot::Array &starts, const godot::Array &goals, int window, const godot::PackedInt32Array &priorities, const godot::StringName &cost_layer, const godot::Ref<HexRegion> &blockers, bool parallel) {
+	godot::Array return_array = godot::Array();
+	ERR_FAIL_COND_V_MSG(starts.size() != goals.size(), return_array, "Every agent needs both a start and a goal.");
+	ERR_FAIL_COND_V_MSG(!priorities.is_empty() && priorities.size() != starts.size(), return_array, "Priorities must be empty or given for every agent.");
+	ERR_FAIL_COND_V_MSG(window < 1, return_array, "Window must be at least 1.");
+	ERR_FAIL_COND_V_MSG(window > HEX_MAX_GROUP_WINDOW, return_array, "Window cannot be more than 256 ticks.");
+
+	const HexLayer* layer = nullptr;
+	if (cost_layer != godot::StringName()) {
+		layer = find_layer(cost_layer);
+		ERR_FAIL_NULL_V_MSG(layer, return_array, "Cannot path over a non-existing cost layer.");
+	}
+
+	HexCooperativePlanner planner(*this, layer, blockers.ptr(), window);
+	for (int64_t i = 0; i < starts.size(); i++) {
+		godot::Vector2i start = starts[i];
+		godot::Vector2i goal = goals[i];
+		planner.add_agent(std::pair<int, int>(start.x, start.y), std::pair<int, int>(goal.x, goal.y), priorities.is_empty() ? 0 : priorities[i]);
+	}
+
+	planner.reserve_stranded();
+	godot::WorkerThreadPool* pool = godot::WorkerThreadPool::get_singleton();
+	for (const std::vector<uint32_t> &tier : planner.get_tiers()) {
+		if (parallel && pool != nullptr && tier.size() >= MIN_PARALLEL_AGENTS) {
+			planner.set_tier(tier);
+			group_planner = &planner;
+			int64_t group = pool->add_group_task(godot::callable_mp(this, &HexGrid::plan_group_task), tier.size(), -1, false, "HexGrid");
+			pool->wait_for_group_task_completion(group);
+			group_planner = nullptr;
+			planner.reserve_tier();
+			continue;
+		}
+		// Planned one at a time, every agent is reserved before the next one plans.
+		for (uint32_t index : tier) {
+			planner.set_tier(std::vector<uint32_t>{ index });
+			planner.plan_tier_agent(0);
+			planner.reserve_tier();
+		}
+	}
+
+	for (const HexCooperativePlanner::Agent &agent : planner.get_agents()) {
+		godot::Array path = godot::Array();
+		for (std::pair<int, int> hex : agent.path) {
+			path.append(godot::Vector2i(hex.first, hex.second));
+		}
+		return_array.append(path);
+	}
+	return return_array;
+}
+
+godot::Array HexGrid::find_nearest(HexTile* origin, const godot::StringName &layer_name, int match, const godot::Variant &value, int count, int max_radius, bool use_path_distance, const godot::Ref<HexRegion> &blockers) {
+	ERR_FAIL_NULL_V_MSG(origin, godot::Array(), "Origin hex cannot be null.");
+	return find_nearest_at(godot::Vector2i(origin->co_ords.first, origin->co_ords.second), layer_name, match, value, count, max_radius, use_path_distance, blockers);
+}
+
+godot::Array HexGrid::find_nearest_at(godot::Vector2i origin, const godot::StringName &layer_name, int match, const godot::Variant &value, int count, int max_radius, bool use_path_distance, const godot::Ref<HexRegion> &blockers) {
+	HEX_GRID_PROFILE_SCOPE(profile_counters[PROFILE_SEARCH]);
+	godot::Array return_array = godot::Array();
+	std::pair<int, int> start{};
+	ERR_FAIL_COND_V_MSG(!find_existing_hex(origin, start), return_array, "Origin hex does not exist.");
+	ERR_FAIL_COND_V_MSG((match < MATCH_EQUALS) || (match > MATCH_MASK_BIT), return_array, "Invalid layer match.");
+	ERR_FAIL_COND_V_MSG(count <= 0, return_array, "Count must be at least 1.");
+	const HexLayer* layer = find_layer(layer_name);
+	ERR_FAIL_NULL_V_MSG(layer, return_array, "Cannot match a non-existing layer.");
+
+	float target = 0.0f;
+	std::vector<float> targets{};
+	int64_t mask = 0;
+	if (match == MATCH_EQUALS) {
+		target = value;
+	} else if (match == MATCH_IN_SET) {
+		godot::PackedFloat32Array set = value;
+		targets.assign(set.ptr(), set.ptr() + set.size());
+	} else {
+		mask = value;
+	}
+
+	std::vector<std::pair<std::pair<int, int>, int>> found = find_nearest_axial(start, count, max_radius, use_path_distance, blockers.ptr(), [&](int q, int r) {
+		HEX_GRID_PROFILE_VISITS(profile_counters[PROFILE_SEARCH], 1);
+		float cell = layer->get_value(q, r);
+		switch (match) {
+			case MATCH_EQUALS:
+				return cell == target;
+			case MATCH_IN_SET:
+				return std::find(targets.begin(), targets.end(), cell) != targets.end();
+			default:
+				// NaN, infinite and out of range values have no integer bits to test, and converting them is undefined.
+				return std::isfinite(cell) && std::fabs(cell) < 9.2e18f && (int64_t(cell) & mask) != 0;
+		}
+	});
+
+	for (const std::pair<std::pair<int, int>, int> &pair : found) {
+		godot::Dictionary entry = godot::Dictionary();
+		entry["coords"] = godot::Vector2i(pair.first.first, pair.first.second);
+		entry["distance"] = pair.second;
+		return_array.append(entry);
+	}
+	return return_array;
+}
+
+godot::Ref<HexGraph> HexGrid::build_graph(const godot::StringName &cost_layer, const godot::Ref<HexRegion> &blockers) {
+	HEX_GRID_PROFILE_SCOPE(profile_counters[PROFILE_SEARCH]);
+	ERR_FAIL_COND_V_MSG(cost_layer != godot::StringName() && !find_layer(cost_layer), godot::Ref<HexGraph>(), "Cannot build a graph over a non-existing cost layer.");
+
+	godot::Ref<HexGraph> graph{};
+	graph.instantiate();
+	graph->setup(this, cost_layer, blockers);
+	return graph;
+}
+
+void HexGrid::plan_group_task(uint32_t index) {
+	group_planner->plan_tier_agent(index);
+}
+
+void HexGrid::mark_layer_chunk(const godot::StringName &name, int64_t key, const HexLayer::Chunk* previous, HexRegion* changed_cells) {
+	const HexLayer* layer = find_layer(name);
+	ERR_FAIL_NULL_MSG(layer, "Cannot mark a non-existing layer.");
+	if (!previous) {
+		layer_revisions[name].cells.mark_chunk(key, ++revision);
+		for (int cell = 0; changed_cells && cell < HEX_CHUNK_CELLS; cell++) {
+			std::pair<int, int> hex = hex_chunk_cell_co_ords(key, cell);
+			changed_cells->add_hex(hex.first, hex.second);
+		}
+		return;
+	}
+
+	const HexLayer::Chunk* values = layer->find_chunk(key);
+	std::array<bool, HEX_CHUNK_CELLS> changed{};
+	for (int cell = 0; cell < HEX_CHUNK_CELLS; cell++) {
+		changed[cell] = !is_same_value(values ? (*values)[cell] : layer->get_default_value(), (*previous)[cell]);
+		if (changed[cell] && changed_cells) {
+			std::pair<int, int> hex = hex_chunk_cell_co_ords(key, cell);
+			changed_cells->add_hex(hex.first, hex.second);
+		}
+	}
+	layer_revisions[name].cells.mark_chunk(key, ++revision, &changed);
+}
+
+int64_t HexGrid::get_revision() {
+	return int64_t(revision);
+}
+
+godot::PackedByteArray HexGrid::encode_delta(int64_t from_revision) {
+	godot::PackedByteArray delta = godot::PackedByteArray();
+	ERR_FAIL_COND_V_MSG(from_revision < 0, delta, "Revision cannot be less than zero.");
+	ERR_FAIL_COND_V_MSG(uint64_t(from_revision) > revision, delta, "Cannot encode from a revision the grid has not reached.");
+	uint64_t from = uint64_t(from_revision);
+
+	HexDeltaWriter writer{};
+	writer.write_varint(DELTA_FORMAT);
+	writer.write_varint(revision);
+
+	// Each cell is written as it is now, so a tile spawned and deleted again since the start is simply deleted.
+	std::vector<std::pair<int64_t, const HexRevisionLog::Chunk*>> chunks{};
+	tile_revisions.for_each_chunk_since(from, [&chunks](int64_t key, const HexRevisionLog::Chunk &chunk) {
+		chunks.push_back(std::pair<int64_t, const HexRevisionLog::Chunk*>(key, &chunk));
+	});
+	writer.write_varint(chunks.size());
+	for (const std::pair<int64_t, const HexRevisionLog::Chunk*> &pair : chunks) {
+		std::pair<int, int> chunk_co_ords = hex_chunk_unkey(pair.first);
+		writer.write_signed(chunk_co_ords.first);
+		writer.write_signed(chunk_co_ords.second);
+
+		int run_start = 0;
+		int run_kind = DELTA_UNCHANGED;
+		for (int cell = 0; cell <= HEX_CHUNK_CELLS; cell++) {
+			int kind = -1;
+			if (cell < HEX_CHUNK_CELLS) {
+				std::pair<int, int> hex = hex_chunk_cell_co_ords(pair.first, cell);
+				kind = pair.second->cells[cell] <= from ? DELTA_UNCHANGED : tile_storage.get(hex.first, hex.second) ? DELTA_SPAWNED : DELTA_DELETED;
+			}
+			if (cell > 0 && kind != run_kind) {
+				writer.write_run(cell - run_start, run_kind);
+				run_start = cell;
+			}
+			run_kind = kind;
+		}
+	}
+
+	writer.write_varint(layers.size());
+	for (const std::pair<const godot::StringName, HexLayer> &layer : layers) {
+		const LayerRevisions &revisions = layer_revisions[layer.first];
+		writer.write_string(godot::String(layer.first).utf8().get_data());
+		writer.write_float(layer.second.get_default_value());
+		writer.write_varint(revisions.created > from ? 1 : 0);
+
+		chunks.clear();
+		revisions.cells.for_each_chunk_since(from, [&chunks](int64_t key, const HexRevisionLog::Chunk &chunk) {
+			chunks.push_back(std::pair<int64_t, const HexRevisionLog::Chunk*>(key, &chunk));
+		});
+		writer.write_varint(chunks.size());
+		for (const std::pair<int64_t, const HexRevisionLog::Chunk*> &pair : chunks) {
+			std::pair<int, int> chunk_co_ords = hex_chunk_unkey(pair.first);
+			writer.write_signed(chunk_co_ords.first);
+			writer.write_signed(chunk_co_ords.second);
+
+			const HexLayer::Chunk* values = layer.second.find_chunk(pair.first);
+			auto value_of = [&layer, values](int cell) {
+				return values ? (*values)[cell] : layer.second.get_default_value();
+			};
+			auto is_changed = [&pair, from](int cell) {
+				return pair.second->cells[cell] > from;
+			};
+
+			int cell = 0;
+			while (cell < HEX_CHUNK_CELLS) {
+				int end = cell;
+				if (!is_changed(cell)) {
+					while (end < HEX_CHUNK_CELLS && !is_changed(end)) {
+						end++;
+					}
+					writer.write_run(end - cell, DELTA_UNCHANGED);
+					cell = end;
+					continue;
+				}
+
+				// Changed cells holding the same value become one repeated run, anything else is written as is.
+				while (end + 1 < HEX_CHUNK_CELLS && is_changed(end + 1) && is_same_value(value_of(end + 1), value_of(cell))) {
+					end++;
+				}
+				if (end > cell) {
+					writer.write_run(end + 1 - cell, DELTA_REPEATED);
+					writer.write_float(value_of(cell));
+					cell = end + 1;
+					continue;
+				}
+				while (end + 1 < HEX_CHUNK_CELLS && is_changed(end + 1) && !(end + 2 < HEX_CHUNK_CELLS && is_changed(end + 2) && is_same_value(value_of(end + 1), value_of(end + 2)))) {
+					end++;
+				}
+				writer.write_run(end + 1 - cell, DELTA_LITERAL);
+				for (; cell <= end; cell++) {
+					writer.write_float(value_of(cell));
+				}
+			}
+		}
+	}
+
+	std::vector<godot::StringName> removed{};
+	for (const std::pair<const godot::StringName, uint64_t> &pair : removed_layers) {
+		if (pair.second > from) {
+			removed.push_back(pair.first);
+		}
+	}
+	writer.write_varint(removed.size());
+	for (const godot::StringName &name : removed) {
+		writer.write_string(godot::String(name).utf8().get_data());
+	}
+
+	const std::vector<uint8_t> &bytes = writer.get_bytes();
+	delta.resize(bytes.size());
+	std::memcpy(delta.ptrw(), bytes.data(), bytes.size());
+	return delta;
+}
+
+int64_t HexGrid::apply_delta(const godot::PackedByteArray &delta, bool connect_mouse_signals, const godot::Ref<godot::PackedScene> &tile_to_spawn) {
+	HexDeltaReader reader(delta.ptr(), delta.size());
+	ERR_FAIL_COND_V_MSG(reader.read_varint() != DELTA_FORMAT, -1, "Unknown delta format.");
+	uint64_t to_revision = reader.read_varint();
+
+	// The whole delta is read before anything is applied, so a malformed one leaves the grid untouched.
+	bool malformed = false;
+	auto read_chunk_key = [&reader]() {
+		int64_t chunk_q = reader.read_signed();
+		int64_t chunk_r = reader.read_signed();
+		return hex_chunk_key(int(chunk_q), int(chunk_r));
+	};
+
+	std::vector<std::pair<std::pair<int, int>, bool>> tile_changes{};
+	uint64_t chunk_count = reader.read_varint();
+	for (uint64_t i = 0; i < chunk_count && !reader.has_failed() && !malformed; i++) {
+		int64_t key = read_chunk_key();
+		int cell = 0;
+		while (cell < HEX_CHUNK_CELLS && !reader.has_failed() && !malformed) {
+			int length = 0;
+			int kind = 0;
+			reader.read_run(length, kind);
+			malformed = length == 0 || cell + length > HEX_CHUNK_CELLS || kind > DELTA_DELETED;
+			for (int end = cell + length; cell < end && !malformed; cell++) {
+				if (kind != DELTA_UNCHANGED) {
+					tile_changes.push_back(std::pair<std::pair<int, int>, bool>(hex_chunk_cell_co_ords(key, cell), kind == DELTA_SPAWNED));
+				}
+			}
+		}
+	}
+
+	struct LayerDelta {
+		godot::StringName name{};
+		float default_value{};
+		bool created{};
+		std::vector<std::pair<std::pair<int, int>, float>> values{};
+	};
+	std::vector<LayerDelta> layer_deltas{};
+	uint64_t layer_count = reader.read_varint();
+	for (uint64_t i = 0; i < layer_count && !reader.has_failed() && !malformed; i++) {
+		LayerDelta layer{};
+		std::string name = reader.read_string();
+		layer.name = godot::StringName(godot::String::utf8(name.data(), name.size()));
+		layer.default_value = reader.read_float();
+		layer.created = reader.read_varint() != 0;
+
+		chunk_count = reader.read_varint();
+		for (uint64_t j = 0; j < chunk_count && !reader.has_failed() && !malformed; j++) {
+			int64_t key = read_chunk_key();
+			int cell = 0;
+			while (cell < HEX_CHUNK_CELLS && !reader.has_failed() && !malformed) {
+				int length = 0;
+				int kind = 0;
+				reader.read_run(length, kind);
+				malformed = length == 0 || cell + length > HEX_CHUNK_CELLS || kind > DELTA_LITERAL;
+				float value = kind == DELTA_REPEATED ? reader.read_float() : 0.0f;
+				for (int end = cell + length; cell < end && !malformed; cell++) {
+					if (kind != DELTA_UNCHANGED) {
+						layer.values.push_back(std::pair<std::pair<int, int>, float>(hex_chunk_cell_co_ords(key, cell), kind == DELTA_LITERAL ? reader.read_float() : value));
+					}
+				}
+			}
+		}
+		layer_deltas.push_back(std::move(layer));
+	}
+
+	std::vector<godot::StringName> removed{};
+	uint64_t removed_count = reader.read_varint();
+	for (uint64_t i = 0; i < removed_count && !reader.has_failed(); i++) {
+		std::string name = reader.read_string();
+		removed.push_back(godot::StringName(godot::String::utf8(name.data(), name.size())));
+	}
+	ERR_FAIL_COND_V_MSG(malformed || reader.has_failed() || !reader.is_at_end(), -1, "Malformed delta.");
+
+	for (const godot::StringName &name : removed) {
+		if (has_layer(name)) {
+			remove_layer(name);
+		}
+	}
+	for (const LayerDelta &layer : layer_deltas) {
+		if (layer.created && has_layer(layer.name)) {
+			remove_layer(layer.name);
+		}
+		if (!has_layer(layer.name)) {
+			add_layer(layer.name, layer.default_value);
+		}
+	}
+
+	for (const std::pair<std::pair<int, int>, bool> &change : tile_changes) {
+		int q = change.first.first;
+		int r = change.first.second;
+		if (!change.second) {
+			if (has_hex(q, r)) {
+				delete_hex(q, r);
+			}
+		} else if (has_hex(q, r)) {
+			replace_hex(q, r, connect_mouse_signals, tile_to_spawn);
+		} else {
+			spawn_hex(q, r, connect_mouse_signals, tile_to_spawn);
+		}
+	}
+
+	for (const LayerDelta &layer : layer_deltas) {
+		for (const std::pair<std::pair<int, int>, float> &value : layer.values) {
+			set_layer_value(layer.name, value.first.first, value.first.second, value.second);
+		}
+	}
+	return int64_t(to_revision);
+}
+
+godot::Ref<HexGridSnapshot> HexGrid::publish_snapshot() {
+	if (!snapshot_layout) {
+		std::shared_ptr<HexTileStorage> layout = std::make_shared<HexTileStorage>();
+		layout->configure(tile_storage.get_shape(), map_width, map_height, wrap_mode);
+		snapshot_layout = layout;
+	}
+	const HexGridSnapshot* previous = published_snapshot.ptr();
+	if (previous && previous->revision == revision && previous->layout == snapshot_layout && previous->visibility == visibility_trie) {
+		return published_snapshot;
+	}
+
+	godot::Ref<HexGridSnapshot> snapshot;
+	snapshot.instantiate();
+	snapshot->revision = revision;
+	snapshot->layout = snapshot_layout;
+	snapshot->visibility = visibility_trie;
+	// The previous snapshot may be read by jobs right now, so its maps are copied and only the chunks that changed since are replaced.
+	uint64_t from = 0;
+	if (previous && previous->layout == snapshot_layout) {
+		from = previous->revision;
+		snapshot->tiles = previous->tiles;
+		snapshot->layers = previous->layers;
+	}
+
+	tile_revisions.for_each_chunk_since(from, [this, &snapshot](int64_t key, const HexRevisionLog::Chunk &) {
+		std::shared_ptr<HexGridSnapshot::TileChunk> cells = std::make_shared<HexGridSnapshot::TileChunk>();
+		bool is_empty = true;
+		for (int cell = 0; cell < HEX_CHUNK_CELLS; cell++) {
+			std::pair<int, int> hex = hex_chunk_cell_co_ords(key, cell);
+			if (tile_storage.get(hex.first, hex.second)) {
+				(*cells)[cell >> 6] |= uint64_t(1) << (cell & 63);
+				is_empty = false;
+			}
+		}
+		if (is_empty) {
+			snapshot->tiles.erase(key);
+		} else {
+			snapshot->tiles[key] = cells;
+		}
+	});
+
+	for (auto it = snapshot->layers.begin(); it != snapshot->layers.end();) {
+		it = layers.count(it->first) ? std::next(it) : snapshot->layers.erase(it);
+	}
+	for (const std::pair<const godot::StringName, HexLayer> &layer : layers) {
+		const LayerRevisions &revisions = layer_revisions[layer.first];
+		HexGridSnapshot::LayerView &view = snapshot->layers[layer.first];
+		uint64_t layer_from = from;
+		if (view.created != revisions.created) {
+			// A layer added since, or removed and added again, has nothing in common with the old view.
+			view = HexGridSnapshot::LayerView{};
+			view.default_value = layer.second.get_default_value();
+			view.created = revisions.created;
+			layer_from = 0;
+		}
+		revisions.cells.for_each_chunk_since(layer_from, [&layer, &view](int64_t key, const HexRevisionLog::Chunk &) {
+			const HexLayer::Chunk* values = layer.second.find_chunk(key);
+			if (values) {
+				view.chunks[key] = std::make_shared<const HexLayer::Chunk>(*values);
+			} else {
+				view.chunks.erase(key);
+			}
+		});
+	}
+
+	published_snapshot = snapshot;
+	return snapshot;
+}
+
+void HexGrid::queue_spawn_hex(int q, int r) {
+	command_buffer.push(HexCommandBuffer::Command{ HexCommandBuffer::COMMAND_SPAWN, q, r });
+}
+
+void HexGrid::queue_replace_hex(int q, int r) {
+	command_buffer.push(HexCommandBuffer::Command{ HexCommandBuffer::COMMAND_REPLACE, q, r });
+}
+
+void HexGrid::queue_delete_hex(int q, int r) {
+	command_buffer.push(HexCommandBuffer::Command{ HexCommandBuffer::COMMAND_DELETE, q, r });
+}
+
+void HexGrid::queue_layer_value(const godot::StringName &name, int q, int r, float value) {
+	command_buffer.push(HexCommandBuffer::Command{ HexCommandBuffer::COMMAND_LAYER_VALUE, q, r, name, value });
+}
+
+bool HexGrid::has_queued_commands() const {
+	return !command_buffer.is_empty();
+}
+
+int HexGrid::flush_commands(bool connect_mouse_signals, const godot::Ref<godot::PackedScene> &tile_to_spawn) {
+	ERR_FAIL_COND_V_MSG(is_flushing_commands, 0, "Cannot flush commands while they are being flushed.");
+	std::vector<HexCommandBuffer::Command> commands{};
+	command_buffer.take(commands);
+	if (commands.empty()) {
+		return 0;
+	}
+	return apply_commands(commands, connect_mouse_signals, tile_to_spawn);
+}
+
+int HexGrid::apply_commands(std::vector<HexCommandBuffer::Command> &commands, bool connect_mouse_signals, const godot::Ref<godot::PackedScene> &tile_to_spawn) {
+	// Split into the tile commands and each layer's writes, each sorted by chunk and then cell. The sorts are stable, so each cell's commands stay in the order they were given.
+	std::vector<HexCommandBuffer::Command> tile_commands{};
+	std::unordered_map<godot::StringName, std::vector<HexCommandBuffer::Command>, StringNameHasher> layer_commands{};
+	for (HexCommandBuffer::Command &command : commands) {
+		std::tie(command.q, command.r) = tile_storage.canonicalize(std::pair<int, int>(command.q, command.r));
+		if (command.kind == HexCommandBuffer::COMMAND_LAYER_VALUE) {
+			layer_commands[command.layer].push_back(std::move(command));
+		} else {
+			tile_commands.push_back(std::move(command));
+		}
+	}
+	auto by_cell = [](const HexCommandBuffer::Command &a, const HexCommandBuffer::Command &b) {
+		int64_t key_a = hex_chunk_key_of(a.q, a.r);
+		int64_t key_b = hex_chunk_key_of(b.q, b.r);
+		return key_a != key_b ? key_a < key_b : hex_chunk_cell(a.q, a.r) < hex_chunk_cell(b.q, b.r);
+	};
+	auto is_last_for_cell = [](const std::vector<HexCommandBuffer::Command> &sorted, size_t index) {
+		return index + 1 == sorted.size() || sorted[index + 1].q != sorted[index].q || sorted[index + 1].r != sorted[index].r;
+	};
+
+	godot::Ref<HexRegion> changed;
+	changed.instantiate();
+	int applied = 0;
+	is_flushing_commands = true;
+	std::stable_sort(tile_commands.begin(), tile_commands.end(), by_cell);
+	// Each hex's commands are played against whether it exists and folded into one net spawn, replace or delete. A delete then spawn on an existing hex replaces it, and a spawn then delete on an empty hex does nothing.
+	bool existed = false;
+	bool exists = false;
+	bool is_fresh = false;
+	const HexCommandBuffer::Command* last_placed = nullptr;
+	for (size_t index = 0; index < tile_commands.size(); index++) {
+		const HexCommandBuffer::Command &command = tile_commands[index];
+		if (index == 0 || is_last_for_cell(tile_commands, index - 1)) {
+			existed = tile_storage.get(command.q, command.r) != nullptr;
+			exists = existed;
+			is_fresh = false;
+			last_placed = nullptr;
+		}
+		bool places = (command.kind == HexCommandBuffer::COMMAND_SPAWN && !exists) || (command.kind == HexCommandBuffer::COMMAND_REPLACE && exists) || command.kind == HexCommandBuffer::COMMAND_PLACE;
+		if (places) {
+			exists = true;
+			is_fresh = true;
+			last_placed = &command;
+		} else if (command.kind == HexCommandBuffer::COMMAND_DELETE && exists) {
+			exists = false;
+			is_fresh = false;
+		}
+		if (!is_last_for_cell(tile_commands, index)) {
+			continue;
+		}
+		if (!existed && exists) {
+			spawn_hex(command.q, command.r, connect_mouse_signals, last_placed->tile.is_valid() ? last_placed->tile : tile_to_spawn);
+		} else if (existed && exists && is_fresh) {
+			replace_hex(command.q, command.r, connect_mouse_signals, last_placed->tile.is_valid() ? last_placed->tile : tile_to_spawn);
+		} else if (existed && !exists) {
+			delete_hex(command.q, command.r);
+		} else {
+			continue;
+		}
+		changed->add_hex(command.q, command.r);
+		applied++;
+	}
+	for (std::pair<const godot::StringName, std::vector<HexCommandBuffer::Command>> &pair : layer_commands) {
+		if (!find_layer(pair.first)) {
+			ERR_PRINT("Queued values for a non-existing layer were dropped.");
+			continue;
+		}
+		std::vector<HexCommandBuffer::Command> &writes = pair.second;
+		std::stable_sort(writes.begin(), writes.end(), by_cell);
+		for (size_t index = 0; index < writes.size(); index++) {
+			if (is_last_for_cell(writes, index)) {
+				set_layer_value(pair.first, writes[index].q, writes[index].r, writes[index].value);
+				changed->add_hex(writes[index].q, writes[index].r);
+				applied++;
+			}
+		}
+	}
+	is_flushing_commands = false;
+
+	emit_signal("commands_flushed", changed);
+	return applied;
+}
+
+godot::Ref<HexRegion> HexGrid::stamp_pattern(const godot::Ref<HexPattern> &pattern, godot::Vector2i anchor, int num_and_direction, int mirror_type, bool dry_run, bool connect_mouse_signals, const godot::Ref<godot::PackedScene> &tile_to_spawn) {
+	ERR_FAIL_COND_V_MSG(pattern.is_null(), godot::Ref<HexRegion>(), "Cannot stamp a null pattern.");
+	ERR_FAIL_COND_V_MSG((mirror_type < -1) || (mirror_type > LOCAL_NEGATE_MIRROR_S), godot::Ref<HexRegion>(), "Invalid mirror type.");
+	ERR_FAIL_COND_V_MSG(is_flushing_commands, godot::Ref<HexRegion>(), "Cannot stamp a pattern while commands are being flushed.");
+
+	bool clockwise = num_and_direction >= 0;
+	int rotation_count = std::abs(num_and_direction) % 6;
+	std::pair<int, int> origin(0, 0);
+	std::vector<std::pair<int, int>> targets{};
+	targets.reserve(pattern->cells.size());
+	for (const HexPattern::Cell &cell : pattern->cells) {
+		std::pair<int, int> offset = mirror_type >= 0 ? axial_mirror(cell.offset, origin, mirror_type) : cell.offset;
+		for (int rotation = 0; rotation < rotation_count; rotation++) {
+			offset = axial_rotate(offset, origin, clockwise);
+		}
+		targets.push_back(tile_storage.canonicalize(std::pair<int, int>(anchor.x + offset.first, anchor.y + offset.second)));
+	}
+
+	godot::Ref<HexRegion> overlap;
+	overlap.instantiate();
+	for (size_t index = 0; index < targets.size(); index++) {
+		if (pattern->cells[index].action == HexPattern::TILE_PLACE && tile_storage.get(targets[index].first, targets[index].second)) {
+			overlap->add_hex(targets[index].first, targets[index].second);
+		}
+	}
+	if (dry_run) {
+		return overlap;
+	}
+
+	std::vector<HexCommandBuffer::Command> commands{};
+	for (size_t index = 0; index < targets.size(); index++) {
+		const HexPattern::Cell &cell = pattern->cells[index];
+		if (cell.action == HexPattern::TILE_KEEP) {
+			continue;
+		}
+		HexCommandBuffer::Command command{ cell.action == HexPattern::TILE_PLACE ? HexCommandBuffer::COMMAND_PLACE : HexCommandBuffer::COMMAND_DELETE, targets[index].first, targets[index].second };
+		if (cell.tile >= 0 && size_t(cell.tile) < pattern->tiles.size()) {
+			command.tile = pattern->tiles[cell.tile];
+		}
+		commands.push_back(std::move(command));
+	}
+	for (const std::pair<const godot::StringName, std::vector<float>> &layer : pattern->layers) {
+		ERR_CONTINUE_MSG(layer.second.size() != targets.size(), "Pattern layer values do not line up with its cells.");
+		for (size_t index = 0; index < targets.size(); index++) {
+			if (!std::isnan(layer.second[index])) {
+				commands.push_back(HexCommandBuffer::Command{ HexCommandBuffer::COMMAND_LAYER_VALUE, targets[index].first, targets[index].second, layer.first, layer.second[index] });
+			}
+		}
+	}
+	apply_commands(commands, connect_mouse_signals, tile_to_spawn);
+	return overlap;
+}
+
+godot::Array HexGrid::get_region_hexes(const godot::Ref<HexRegion> &region) {
+	godot::Array return_array = godot::Array();
+	ERR_FAIL_COND_V_MSG(region.is_null(), return_array, "Region cannot be null.");
+
+	region->for_each([this, &return_array](int q, int r) {
+		HexTile* hex = get_hex(q, r);
+		if (hex) {
+			return_array.append(hex);
+		}
+	});
+	return return_array;
+}
+
+
+std::array<std::pair<int, int>, 6> HexGrid::get_diagonals(std::pair<int, int> center_hex) {
+	std::array<std::pair<int, int>, 6> return_array{};
+
+	for (int i = 0; i < 6; i++) {
+		return_array[i] = tile_storage.canonicalize(std::pair<int, int>(center_hex.first + HEX_DIAGONALS[i].first, center_hex.second + HEX_DIAGONALS[i].second));
+	}
+	return return_array;
+}
+
+godot::Array HexGrid::get_diagonals_hex(HexTile* hex) {
+	godot::Array return_array = godot::Array();
+	ERR_FAIL_NULL_V_MSG(hex, return_array, "Cannot get diagonals on non-existing hex.");
+
+	for (std::pair<int, int> pair : get_diagonals(hex->co_ords)) {
+		HexTile* diagonal = get_hex(pair.first, pair.second);
+		if (diagonal) {
+			return_array.append(diagonal);
+		}
+
+	}
+	return return_array;
+}
+
+
+std::pair<int, int> HexGrid::axial_add(std::pair<int, int> hex_one, std::pair<int, int> hex_two) {
+	return std::pair<int, int>{hex_one.first + hex_two.first, hex_one.second + hex_two.second};
+}
+
+std::pair<int,int> HexGrid::axial_subtract(std::pair<int,int> hex_one, std::pair<int,int> hex_two) {
+	return std::pair<int, int>{hex_one.first - hex_two.first, hex_one.second - hex_two.second}; 
+}
+
+std::pair<int, int> HexGrid::axial_scale(std::pair<int, int> hex, int factor) {
+	return std::pair<int, int>{hex.first * factor, hex.second * factor};
+}
+
+
+std::tuple<int, int, int> HexGrid::cube_add(std::tuple<int, int, int> hex_one, std::tuple<int, int, int> hex_two) {
+	int q1 = std::get<0>(hex_one);
+	int r1 = std::get<1>(hex_one);
+	int s1 = std::get<2>(hex_one);
+
+	int q2 = std::get<0>(hex_two);
+	int r2 = std::get<1>(hex_two);
+	int s2 = std::get<2>(hex_two);
+
+	return std::tuple<int, int, int>(q1 + q2, r1 + r2, s1 + s2);
+}
+
+std::tuple<int, int, int> HexGrid::cube_subtract(std::tuple<int, int, int> hex_one, std::tuple<int, int, int> hex_two) {
+	int q1 = std::get<0>(hex_one);
+	int r1 = std::get<1>(hex_one);
+	int s1 = std::get<2>(hex_one);
+
+	int q2 = std::get<0>(hex_two);
+	int r2 = std::get<1>(hex_two);
+	int s2 = std::get<2>(hex_two);
+
+	return std::tuple<int, int, int>(q1-q2,r1-r2,s1-s2);
+}
+
+std::tuple<int, int, int> HexGrid::axial_to_cube(std::pair<int, int> axial_hex) {
+	return std::tuple<int, int, int>(axial_hex.first, axial_hex.second, -axial_hex.first - axial_hex.second);
+}
+
+std::pair<int, int> HexGrid::cube_to_axial(std::tuple<int, int, int> cube_hex) {
+	return std::pair<int, int>(std::get<0>(cube_hex), std::get<1>(cube_hex));
 }
 
 
@@ -625,15 +2324,15 @@ godot::Array HexGrid::rotate_hex_array(godot::Array hex_array, HexTile* center,
 
 std::vector<std::pair<int, int>> HexGrid::get_ring(int q, int r, int radius) {
 	std::vector<std::pair<int, int>> results{};
-	std::pair<int, int> hex = axial_add(std::pair<int, int>(q, r), axial_scale(hex_neighbors[4], radius));
-
-	for (int i = 0; i < 6; i++) {
-		for (int j = 0; j < radius; j++) {
-			results.push_back(hex);
-			
-			hex = axial_add(hex, hex_neighbors[i]);
+	std::unordered_set<int64_t> seen{};
+	results.reserve(HexRingRange(q, r, radius).size());
+	for_each_ring_hex(q, r, radius, [this, &results, &seen](std::pair<int, int> hex) {
+		hex = tile_storage.canonicalize(hex);
+		if (!is_first_visit(seen, hex)) {
+			return;
 		}
-	}
+		results.push_back(hex);
+	});
 
 	return results;
 }
@@ -643,31 +2342,30 @@ godot::Array HexGrid::get_ring_hex(HexTile* center, int radius) {
 	ERR_FAIL_COND_V_MSG((radius <= 0), return_array, "Radius cannot be less than or equal to zero.");
 	ERR_FAIL_NULL_V_MSG(center, return_array, "Cannot center on non-existing hex.");
 
-	std::vector<std::pair<int, int>> hex_array = get_ring(center->co_ords.first, center->co_ords.second, radius);
-
-
-	for (std::pair<int, int> pair : hex_array) {
+	std::unordered_set<int64_t> seen{};
+	for_each_ring_hex(center->co_ords.first, center->co_ords.second, radius, [this, &return_array, &seen](std::pair<int, int> pair) {
 		HexTile* hex = get_hex(pair.first, pair.second);
-		if (hex) {
+		if (hex && is_first_visit(seen, hex->co_ords)) {
 			return_array.append(hex);
 		}
-	}
+	});
 
 	return return_array;
 }
 
 std::vector<std::pair<int, int>> HexGrid::get_spiral_ring(int q, int r, int radius) {
+	//The spiral always starts with the center, even for a radius of zero or less, and stops at the ring before the radius.
+	int last_ring = std::max(radius - 1, 0);
 	std::vector<std::pair<int, int>> results{};
-
-	//Add the center so we don't have a spiral with everything but the origin.
-	results.push_back(std::pair<int, int>{q, r});
-
-	for (int i = 1; i < radius; i++) {
-		std::vector<std::pair<int, int>> ring_pairs = get_ring(q, r, i);
-		for (std::pair<int, int> pair : ring_pairs) {
-			results.push_back(pair);
+	std::unordered_set<int64_t> seen{};
+	results.reserve(HexSpiralRange(q, r, last_ring).size());
+	for_each_spiral_hex(q, r, last_ring, [this, &results, &seen](std::pair<int, int> hex) {
+		hex = tile_storage.canonicalize(hex);
+		if (!is_first_visit(seen, hex)) {
+			return;
 		}
-	}
+		results.push_back(hex);
+	});
 
 	return results;
 }
@@ -677,10 +2375,24 @@ godot::Array HexGrid::get_spiral_ring_hex(HexTile* center, int radius) {
 	ERR_FAIL_COND_V_MSG((radius <= 0), return_array, "Radius cannot be less than or equal to zero.");
 	ERR_FAIL_NULL_V_MSG(center, return_array, "Cannot center on non-existing hex.");
 
-	std::vector<std::pair<int, int>> hex_array = get_spiral_ring(center->co_ords.first, center->co_ords.second, radius);
+	std::unordered_set<int64_t> seen{};
+	for_each_spiral_hex(center->co_ords.first, center->co_ords.second, radius - 1, [this, &return_array, &seen](std::pair<int, int> pair) {
+		HexTile* hex = get_hex(pair.first, pair.second);
+		if (hex && is_first_visit(seen, hex->co_ords)) {
+			return_array.append(hex);
+		}
+	});
 
+	return return_array;
+}
 
-	for (std::pair<int, int> pair : hex_array) {
+godot::Array HexGrid::get_cone_hex(HexTile* center, int direction, int radius) {
+	godot::Array return_array = godot::Array();
+	ERR_FAIL_COND_V_MSG((radius <= 0), return_array, "Radius cannot be less than or equal to zero.");
+	ERR_FAIL_COND_V_MSG((direction < 0) || (direction > 5), return_array, "Direction must be between 0 and 5.");
+	ERR_FAIL_NULL_V_MSG(center, return_array, "Cannot center on non-existing hex.");
+
+	for (std::pair<int, int> pair : HexConeRange(center->co_ords.first, center->co_ords.second, direction, radius)) {
 		HexTile* hex = get_hex(pair.first, pair.second);
 		if (hex) {
 			return_array.append(hex);
@@ -692,22 +2404,275 @@ godot::Array HexGrid::get_spiral_ring_hex(HexTile* center, int radius) {
 
 
 HexTile* HexGrid::get_hex(int q, int r) {
-	return tile_map[hash(q, r)];
+	HEX_GRID_PROFILE_SCOPE(profile_counters[PROFILE_LOOKUP]);
+	HexTile* tile = tile_storage.get(q, r);
+	return tile == HEADLESS_TILE ? nullptr : tile;
+}
+
+bool HexGrid::has_hex(int q, int r) {
+	return tile_storage.get(q, r) != nullptr;
+}
+
+bool HexGrid::find_existing_hex(godot::Vector2i hex, std::pair<int, int> &co_ords) {
+	co_ords = tile_storage.canonicalize(std::pair<int, int>(hex.x, hex.y));
+	return tile_storage.get(co_ords.first, co_ords.second) != nullptr;
+}
+
+void HexGrid::set_headless(bool new_headless) {
+	headless = new_headless;
+	if (!headless) {
+		return;
+	}
+
+	// The tiles are swapped for markers in place, so the hexes, their layers and everything built on them stay untouched.
+	std::vector<std::pair<std::pair<int, int>, HexTile*>> attached{};
+	tile_storage.for_each([&attached](int q, int r, HexTile* tile) {
+		if (tile != HEADLESS_TILE) {
+			attached.push_back(std::pair<std::pair<int, int>, HexTile*>(std::pair<int, int>(q, r), tile));
+		}
+	});
+	for (const std::pair<std::pair<int, int>, HexTile*> &pair : attached) {
+		tile_storage.store(pair.first.first, pair.first.second, HEADLESS_TILE);
+		release_tile(pair.second);
+	}
+	// Nothing is spawned from the pools while headless, so the released tiles would only sit in them.
+	free_pooled_tiles();
+}
+
+bool HexGrid::is_headless() {
+	return headless;
+}
+
+void HexGrid::set_collision_mode(int new_mode) {
+	ERR_FAIL_COND_MSG((new_mode < COLLISION_TILES) || (new_mode > COLLISION_CHUNKS), "Invalid collision mode.");
+	collision_mode = new_mode;
+	is_collision_stale = true;
+	set_physics_process_internal(collision_mode == COLLISION_CHUNKS);
+	if (collision_mode == COLLISION_TILES) {
+		free_collision_bodies();
+	}
+	update_tile_collisions();
+}
+
+int HexGrid::get_collision_mode() {
+	return collision_mode;
+}
+
+void HexGrid::set_collision_height_layer(const godot::StringName &name) {
+	collision_height_layer = name;
+	is_collision_stale = true;
+}
+
+godot::StringName HexGrid::get_collision_height_layer() {
+	return collision_height_layer;
+}
+
+void HexGrid::set_collision_layer(uint32_t new_layer) {
+	collision_layer = new_layer;
+	for (std::pair<const int64_t, CollisionChunk> &pair : collision_bodies) {
+		pair.second.body->set_collision_layer(collision_layer);
+	}
+}
+
+uint32_t HexGrid::get_collision_layer() {
+	return collision_layer;
+}
+
+float HexGrid::get_collision_height(const HexLayer* heights, int q, int r) {
+	return heights ? heights->get_value(q, r) : 0.0f;
+}
+
+int HexGrid::update_collision() {
+	ERR_FAIL_COND_V_MSG(collision_mode != COLLISION_CHUNKS, 0, "Chunk bodies are only built in chunk collision mode.");
+
+	const HexLayer* heights = nullptr;
+	uint64_t height_created = 0;
+	if (collision_height_layer != godot::StringName()) {
+		heights = find_layer(collision_height_layer);
+		height_created = heights ? layer_revisions[collision_height_layer].created : 0;
+	}
+	if (height_created != collision_height_created) {
+		is_collision_stale = true;
+	}
+
+	std::unordered_set<int64_t> dirty{};
+	if (is_collision_stale) {
+		for (const std::pair<const int64_t, CollisionChunk> &pair : collision_bodies) {
+			dirty.insert(pair.first);
+		}
+		tile_storage.for_each([&dirty](int q, int r, HexTile*) {
+			dirty.insert(hex_chunk_key_of(q, r));
+		});
+	} else {
+		// Walls are built down to the neighbors' heights, so a hex changing also changes the chunks bordering it.
+		auto mark_dirty = [this, &dirty](int64_t key, const HexRevisionLog::Chunk &chunk) {
+			for (int cell = 0; cell < HEX_CHUNK_CELLS; cell++) {
+				if (chunk.cells[cell] <= collision_revision) {
+					continue;
+				}
+				std::pair<int, int> hex = tile_storage.canonicalize(hex_chunk_cell_co_ords(key, cell));
+				dirty.insert(hex_chunk_key_of(hex.first, hex.second));
+				tile_storage.for_each_neighbor(hex.first, hex.second, [&dirty](int q, int r, HexTile*) {
+					dirty.insert(hex_chunk_key_of(q, r));
+				});
+			}
+		};
+		tile_revisions.for_each_chunk_since(collision_revision, mark_dirty);
+		if (heights) {
+			layer_revisions[collision_height_layer].cells.for_each_chunk_since(collision_revision, mark_dirty);
+		}
+	}
+
+	for (int64_t key : dirty) {
+		build_collision_chunk(key, heights);
+	}
+	collision_revision = revision;
+	collision_height_created = height_created;
+	is_collision_stale = false;
+	return int(dirty.size());
+}
+
+void HexGrid::build_collision_chunk(int64_t key, const HexLayer* heights) {
+	// The corners of a hex, seen from its center. The edge between corner i and corner i + 5 faces HEX_DIRECTIONS[i].
+	const float half = tile_size * .5f;
+	const float sixth = tile_size / (2.0f * sqrtf(3));
+	const std::array<std::pair<float, float>, 6> corners{ {
+		{half, -sixth}, {0.0f, -2.0f * sixth}, {-half, -sixth}, {-half, sixth}, {0.0f, 2.0f * sixth}, {half, sixth}
+	} };
+
+	std::vector<godot::Vector3> faces{};
+	for (int cell = 0; cell < HEX_CHUNK_CELLS; cell++) {
+		std::pair<int, int> hex = hex_chunk_cell_co_ords(key, cell);
+		if (tile_storage.canonicalize(hex) != hex || !tile_storage.get(hex.first, hex.second)) {
+			continue;
+		}
+		godot::Vector3 center = get_hex_position(hex.first, hex.second);
+		float top = get_collision_height(heights, hex.first, hex.second);
+		auto corner = [&center, &corners](int i, float height) {
+			return godot::Vector3(center.x + corners[i].first, height, center.z + corners[i].second);
+		};
+
+		for (int i = 1; i < 5; i++) {
+			faces.push_back(corner(0, top));
+			faces.push_back(corner(i, top));
+			faces.push_back(corner(i + 1, top));
+		}
+		// Each wall is built by the higher of the two hexes, down to the lower one's top. Edges of the map go down to zero.
+		for (int i = 0; i < 6; i++) {
+			std::pair<int, int> neighbor = tile_storage.canonicalize(std::pair<int, int>(hex.first + HEX_DIRECTIONS[i].first, hex.second + HEX_DIRECTIONS[i].second));
+			float bottom = tile_storage.get(neighbor.first, neighbor.second) ? get_collision_height(heights, neighbor.first, neighbor.second) : std::min(top, 0.0f);
+			if (bottom >= top) {
+				continue;
+			}
+			int next = (i + 5) % 6;
+			faces.push_back(corner(i, top));
+			faces.push_back(corner(next, top));
+			faces.push_back(corner(next, bottom));
+			faces.push_back(corner(i, top));
+			faces.push_back(corner(next, bottom));
+			faces.push_back(corner(i, bottom));
+		}
+	}
+
+	auto existing = collision_bodies.find(key);
+	if (faces.empty()) {
+		if (existing != collision_bodies.end()) {
+			existing->second.body->queue_free();
+			collision_bodies.erase(existing);
+		}
+		return;
+	}
+
+	if (existing == collision_bodies.end()) {
+		CollisionChunk chunk{};
+		chunk.body = memnew(godot::StaticBody3D);
+		chunk.body->set_collision_layer(collision_layer);
+		chunk.owner = chunk.body->create_shape_owner(chunk.body);
+		this->add_child(chunk.body, false, INTERNAL_MODE_BACK);
+		existing = collision_bodies.emplace(key, chunk).first;
+	}
+
+	godot::PackedVector3Array array = godot::PackedVector3Array();
+	array.resize(faces.size());
+	std::copy(faces.begin(), faces.end(), array.ptrw());
+	godot::Ref<godot::ConcavePolygonShape3D> shape;
+	shape.instantiate();
+	shape->set_backface_collision_enabled(true);
+	shape->set_faces(array);
+	existing->second.body->shape_owner_clear_shapes(existing->second.owner);
+	existing->second.body->shape_owner_add_shape(existing->second.owner, shape);
+}
+
+void HexGrid::free_collision_bodies() {
+	for (std::pair<const int64_t, CollisionChunk> &pair : collision_bodies) {
+		pair.second.body->queue_free();
+	}
+	collision_bodies.clear();
+}
+
+void HexGrid::update_tile_collision(HexTile* tile) {
+	if (!tile->is_inside_tree()) {
+		return;
+	}
+	godot::RID space = collision_mode == COLLISION_CHUNKS ? godot::RID() : get_world_3d()->get_space();
+	godot::PhysicsServer3D::get_singleton()->area_set_space(tile->get_rid(), space);
+}
+
+void HexGrid::update_tile_collisions() {
+	tile_storage.for_each([this](int q, int r, HexTile* tile) {
+		if (tile && tile != HEADLESS_TILE) {
+			update_tile_collision(tile);
+		}
+	});
+	is_tile_collision_stale = false;
+}
+
+godot::Vector2i HexGrid::collision_to_hex(godot::Vector3 position, godot::Vector3 normal) {
+	return world_to_hex(to_local(position - normal * (tile_size * 0.01f)));
+}
+
+int HexGrid::attach_tiles(bool connect_mouse_signals, const godot::Ref<godot::PackedScene> &tile_to_spawn) {
+	godot::Ref<godot::PackedScene> scene = tile_to_spawn != NULL ? tile_to_spawn : tile_scene;
+	ERR_FAIL_COND_V_MSG((scene == NULL), 0, "No default hex assigned, check that the grid has one.");
+	headless = false;
+
+	std::vector<std::pair<int, int>> detached{};
+	tile_storage.for_each([&detached](int q, int r, HexTile* tile) {
+		if (tile == HEADLESS_TILE) {
+			detached.push_back(std::pair<int, int>(q, r));
+		}
+	});
+
+	int attached = 0;
+	for (std::pair<int, int> hex : detached) {
+		HexTile* tile_hex = place_tile(hex.first, hex.second, connect_mouse_signals, scene);
+		ERR_FAIL_COND_V_MSG(tile_hex == nullptr, attached, "Attached Tile was not a HexTile.");
+		tile_storage.store(hex.first, hex.second, tile_hex);
+		attached++;
+	}
+	return attached;
 }
 
 void HexGrid::delete_hex(int q, int r) {
-	ERR_FAIL_COND_MSG(!(tile_map[hash(q, r)]), "Cannot delete non-existing tile.");
+	std::pair<int, int> co_ords = tile_storage.canonicalize(std::pair<int, int>(q, r));
+	HexTile* hex = tile_storage.erase(co_ords.first, co_ords.second);
+	ERR_FAIL_NULL_MSG(hex, "Cannot delete non-existing tile.");
 
-	auto hex = tile_map.extract(hash(q, r));
-	hex.mapped()->queue_free();
+	if (hex != HEADLESS_TILE) {
+		release_tile(hex);
+	}
+	tile_revisions.mark(co_ords.first, co_ords.second, ++revision);
+	if (!is_flushing_commands) {
+		emit_signal("hex_deleted", co_ords.first, co_ords.second);
+	}
 }
 
 HexTile* HexGrid::replace_hex(int q, int r, bool connect_mouse_signals, const godot::Ref<godot::PackedScene> &tile_to_replace_with) {
-	ERR_FAIL_COND_V_MSG(!(tile_map[hash(q, r)]),nullptr, "Cannot replace non-existing tile.");
-	ERR_FAIL_COND_V_MSG((tile_scene == NULL),nullptr, "No default hex assigned, check that the grid has one.");
+	ERR_FAIL_COND_V_MSG(!(tile_storage.get(q, r)),nullptr, "Cannot replace non-existing tile.");
+	ERR_FAIL_COND_V_MSG(!headless && (tile_scene == NULL),nullptr, "No default hex assigned, check that the grid has one.");
 	
 	delete_hex(q,r);
-	spawn_hex(q,r,connect_mouse_signals,tile_to_replace_with);
+	return spawn_hex(q,r,connect_mouse_signals,tile_to_replace_with);
 
 }
 
@@ -716,12 +2681,82 @@ void HexGrid::_bind_methods() {
 	godot::ClassDB::bind_method(godot::D_METHOD("replace_hex", "q", "r", "connect_mouse_signals", "custom_tile"), &HexGrid::replace_hex, DEFVAL(true), DEFVAL(nullptr));
 	godot::ClassDB::bind_method(godot::D_METHOD("delete_hex", "q", "r"), &HexGrid::delete_hex);
 	godot::ClassDB::bind_method(godot::D_METHOD("get_hex", "q", "r"), &HexGrid::get_hex);
+	godot::ClassDB::bind_method(godot::D_METHOD("has_hex", "q", "r"), &HexGrid::has_hex);
+	godot::ClassDB::bind_method(godot::D_METHOD("set_headless", "headless"), &HexGrid::set_headless);
+	godot::ClassDB::bind_method(godot::D_METHOD("is_headless"), &HexGrid::is_headless);
+	godot::ClassDB::bind_method(godot::D_METHOD("set_collision_mode", "mode"), &HexGrid::set_collision_mode);
+	godot::ClassDB::bind_method(godot::D_METHOD("get_collision_mode"), &HexGrid::get_collision_mode);
+	godot::ClassDB::bind_method(godot::D_METHOD("set_collision_height_layer", "name"), &HexGrid::set_collision_height_layer);
+	godot::ClassDB::bind_method(godot::D_METHOD("get_collision_height_layer"), &HexGrid::get_collision_height_layer);
+	godot::ClassDB::bind_method(godot::D_METHOD("set_collision_layer", "layer"), &HexGrid::set_collision_layer);
+	godot::ClassDB::bind_method(godot::D_METHOD("get_collision_layer"), &HexGrid::get_collision_layer);
+	godot::ClassDB::bind_method(godot::D_METHOD("update_collision"), &HexGrid::update_collision);
+	godot::ClassDB::bind_method(godot::D_METHOD("collision_to_hex", "position", "normal"), &HexGrid::collision_to_hex);
+	godot::ClassDB::bind_method(godot::D_METHOD("attach_tiles", "connect_mouse_signals", "custom_tile"), &HexGrid::attach_tiles, DEFVAL(true), DEFVAL(nullptr));
 	godot::ClassDB::bind_method(godot::D_METHOD("get_neighbors","hex"), &HexGrid::get_neighbors_hex);
 	godot::ClassDB::bind_method(godot::D_METHOD("get_diagonals", "hex"), &HexGrid::get_diagonals_hex);
 	godot::ClassDB::bind_method(godot::D_METHOD("get_ring", "center", "radius"), &HexGrid::get_ring_hex);
 	godot::ClassDB::bind_method(godot::D_METHOD("get_spiral_ring", "center", "radius"), &HexGrid::get_spiral_ring_hex);
+	godot::ClassDB::bind_method(godot::D_METHOD("get_cone", "center", "direction", "radius"), &HexGrid::get_cone_hex);
 	godot::ClassDB::bind_method(godot::D_METHOD("calculate_distance", "hex_one", "hex_two"), &HexGrid::calculate_distance_hex);
 	godot::ClassDB::bind_method(godot::D_METHOD("breadth_first_search", "origin_hex", "pre_visited_array"), &HexGrid::breadth_first_search_hex);
+	godot::ClassDB::bind_method(godot::D_METHOD("breadth_first_search_region", "origin_hex", "pre_visited_region", "into"), &HexGrid::breadth_first_search_region, DEFVAL(nullptr), DEFVAL(nullptr));
+	godot::ClassDB::bind_method(godot::D_METHOD("get_ring_region", "center", "radius", "into"), &HexGrid::get_ring_region, DEFVAL(nullptr));
+	godot::ClassDB::bind_method(godot::D_METHOD("get_spiral_ring_region", "center", "radius", "into"), &HexGrid::get_spiral_ring_region, DEFVAL(nullptr));
+	godot::ClassDB::bind_method(godot::D_METHOD("get_cone_region", "center", "direction", "radius", "into"), &HexGrid::get_cone_region, DEFVAL(nullptr));
+	godot::ClassDB::bind_method(godot::D_METHOD("get_line_region", "hex_one", "hex_two", "make_symmetric", "into"), &HexGrid::get_line_region, DEFVAL(false), DEFVAL(nullptr));
+	godot::ClassDB::bind_method(godot::D_METHOD("get_region_hexes", "region"), &HexGrid::get_region_hexes);
+	godot::ClassDB::bind_method(godot::D_METHOD("prepare_visibility", "max_radius"), &HexGrid::prepare_visibility);
+	godot::ClassDB::bind_method(godot::D_METHOD("get_shape_cache_memory_usage"), &HexGrid::get_shape_cache_memory_usage);
+	godot::ClassDB::bind_method(godot::D_METHOD("get_field_of_view", "origin_hex", "radius", "blockers", "into"), &HexGrid::get_field_of_view, DEFVAL(nullptr), DEFVAL(nullptr));
+	godot::ClassDB::bind_method(godot::D_METHOD("get_field_of_view_many", "origin_hexes", "radius", "blockers", "into"), &HexGrid::get_field_of_view_many, DEFVAL(nullptr), DEFVAL(nullptr));
+	godot::ClassDB::bind_method(godot::D_METHOD("has_line_of_sight", "from_hex", "to_hex", "blockers"), &HexGrid::has_line_of_sight, DEFVAL(nullptr));
+	godot::ClassDB::bind_method(godot::D_METHOD("find_path", "from_hex", "to_hex", "cost_layer", "blockers", "mode"), &HexGrid::find_path, DEFVAL(godot::StringName()), DEFVAL(nullptr), DEFVAL(PATH_A_STAR));
+	godot::ClassDB::bind_method(godot::D_METHOD("find_smooth_path", "from_hex", "to_hex", "cost_layer", "blockers", "mode"), &HexGrid::find_smooth_path, DEFVAL(godot::StringName()), DEFVAL(nullptr), DEFVAL(PATH_A_STAR));
+	godot::ClassDB::bind_method(godot::D_METHOD("plan_group_paths", "starts", "goals", "window", "priorities", "cost_layer", "blockers", "parallel"), &HexGrid::plan_group_paths, DEFVAL(16), DEFVAL(godot::PackedInt32Array()), DEFVAL(godot::StringName()), DEFVAL(nullptr), DEFVAL(false));
+	godot::ClassDB::bind_method(godot::D_METHOD("find_nearest", "origin_hex", "layer", "match", "value", "count", "max_radius", "use_path_distance", "blockers"), &HexGrid::find_nearest, DEFVAL(1), DEFVAL(-1), DEFVAL(false), DEFVAL(nullptr));
+	godot::ClassDB::bind_method(godot::D_METHOD("build_graph", "cost_layer", "blockers"), &HexGrid::build_graph, DEFVAL(godot::StringName()), DEFVAL(nullptr));
+	godot::ClassDB::bind_method(godot::D_METHOD("get_revision"), &HexGrid::get_revision);
+	godot::ClassDB::bind_method(godot::D_METHOD("encode_delta", "from_revision"), &HexGrid::encode_delta, DEFVAL(0));
+	godot::ClassDB::bind_method(godot::D_METHOD("apply_delta", "delta", "connect_mouse_signals", "custom_tile"), &HexGrid::apply_delta, DEFVAL(true), DEFVAL(nullptr));
+	godot::ClassDB::bind_method(godot::D_METHOD("publish_snapshot"), &HexGrid::publish_snapshot);
+	godot::ClassDB::bind_method(godot::D_METHOD("queue_spawn_hex", "q", "r"), &HexGrid::queue_spawn_hex);
+	godot::ClassDB::bind_method(godot::D_METHOD("queue_replace_hex", "q", "r"), &HexGrid::queue_replace_hex);
+	godot::ClassDB::bind_method(godot::D_METHOD("queue_delete_hex", "q", "r"), &HexGrid::queue_delete_hex);
+	godot::ClassDB::bind_method(godot::D_METHOD("queue_layer_value", "name", "q", "r", "value"), &HexGrid::queue_layer_value);
+	godot::ClassDB::bind_method(godot::D_METHOD("has_queued_commands"), &HexGrid::has_queued_commands);
+	godot::ClassDB::bind_method(godot::D_METHOD("flush_commands", "connect_mouse_signals", "custom_tile"), &HexGrid::flush_commands, DEFVAL(true), DEFVAL(nullptr));
+	godot::ClassDB::bind_method(godot::D_METHOD("stamp_pattern", "pattern", "anchor", "rotation_count_and_direction", "mirror_type", "dry_run", "connect_mouse_signals", "custom_tile"), &HexGrid::stamp_pattern, DEFVAL(0), DEFVAL(-1), DEFVAL(false), DEFVAL(true), DEFVAL(nullptr));
+
+	godot::ClassDB::bind_method(godot::D_METHOD("get_neighbors_at", "hex"), &HexGrid::get_neighbors_at);
+	godot::ClassDB::bind_method(godot::D_METHOD("breadth_first_search_region_at", "origin", "pre_visited_region", "into"), &HexGrid::breadth_first_search_region_at, DEFVAL(nullptr), DEFVAL(nullptr));
+	godot::ClassDB::bind_method(godot::D_METHOD("get_ring_region_at", "center", "radius", "into"), &HexGrid::get_ring_region_at, DEFVAL(nullptr));
+	godot::ClassDB::bind_method(godot::D_METHOD("get_spiral_ring_region_at", "center", "radius", "into"), &HexGrid::get_spiral_ring_region_at, DEFVAL(nullptr));
+	godot::ClassDB::bind_method(godot::D_METHOD("get_cone_region_at", "center", "direction", "radius", "into"), &HexGrid::get_cone_region_at, DEFVAL(nullptr));
+	godot::ClassDB::bind_method(godot::D_METHOD("get_line_region_at", "hex_one", "hex_two", "make_symmetric", "into"), &HexGrid::get_line_region_at, DEFVAL(false), DEFVAL(nullptr));
+	godot::ClassDB::bind_method(godot::D_METHOD("get_field_of_view_at", "origin", "radius", "blockers", "into"), &HexGrid::get_field_of_view_at, DEFVAL(nullptr), DEFVAL(nullptr));
+	godot::ClassDB::bind_method(godot::D_METHOD("has_line_of_sight_at", "from", "to", "blockers"), &HexGrid::has_line_of_sight_at, DEFVAL(nullptr));
+	godot::ClassDB::bind_method(godot::D_METHOD("find_path_at", "from", "to", "cost_layer", "blockers", "mode"), &HexGrid::find_path_at, DEFVAL(godot::StringName()), DEFVAL(nullptr), DEFVAL(PATH_A_STAR));
+	godot::ClassDB::bind_method(godot::D_METHOD("find_smooth_path_at", "from", "to", "cost_layer", "blockers", "mode"), &HexGrid::find_smooth_path_at, DEFVAL(godot::StringName()), DEFVAL(nullptr), DEFVAL(PATH_A_STAR));
+	godot::ClassDB::bind_method(godot::D_METHOD("find_nearest_at", "origin", "layer", "match", "value", "count", "max_radius", "use_path_distance", "blockers"), &HexGrid::find_nearest_at, DEFVAL(1), DEFVAL(-1), DEFVAL(false), DEFVAL(nullptr));
+
+	godot::ClassDB::bind_method(godot::D_METHOD("add_layer", "name", "default_value"), &HexGrid::add_layer, DEFVAL(0.0f));
+	godot::ClassDB::bind_method(godot::D_METHOD("remove_layer", "name"), &HexGrid::remove_layer);
+	godot::ClassDB::bind_method(godot::D_METHOD("has_layer", "name"), &HexGrid::has_layer);
+	godot::ClassDB::bind_method(godot::D_METHOD("get_layer_names"), &HexGrid::get_layer_names);
+	godot::ClassDB::bind_method(godot::D_METHOD("set_layer_value", "name", "q", "r", "value"), &HexGrid::set_layer_value);
+	godot::ClassDB::bind_method(godot::D_METHOD("get_layer_value", "name", "q", "r"), &HexGrid::get_layer_value);
+	godot::ClassDB::bind_method(godot::D_METHOD("clear_layer", "name"), &HexGrid::clear_layer);
+	godot::ClassDB::bind_method(godot::D_METHOD("get_layer_sum_hexagon", "name", "center", "radius"), &HexGrid::get_layer_sum_hexagon);
+	godot::ClassDB::bind_method(godot::D_METHOD("get_layer_sum_parallelogram", "name", "corner", "size"), &HexGrid::get_layer_sum_parallelogram);
+	godot::ClassDB::bind_method(godot::D_METHOD("get_parent_hex", "hex", "levels"), &HexGrid::get_parent_hex, DEFVAL(1));
+	godot::ClassDB::bind_method(godot::D_METHOD("get_child_hexes", "parent"), &HexGrid::get_child_hexes);
+	godot::ClassDB::bind_method(godot::D_METHOD("get_parent_center", "parent", "level"), &HexGrid::get_parent_center);
+	godot::ClassDB::bind_method(godot::D_METHOD("get_layer_aggregate", "name", "level", "parent"), &HexGrid::get_layer_aggregate);
+	godot::ClassDB::bind_method(godot::D_METHOD("get_layer_aggregates", "name", "level", "statistic"), &HexGrid::get_layer_aggregates, DEFVAL(STATISTIC_AVERAGE));
+	godot::ClassDB::bind_method(godot::D_METHOD("get_layer_image", "name"), &HexGrid::get_layer_image);
+	godot::ClassDB::bind_method(godot::D_METHOD("get_layer_texture", "name"), &HexGrid::get_layer_texture);
+	godot::ClassDB::bind_method(godot::D_METHOD("get_layer_texture_rect", "name"), &HexGrid::get_layer_texture_rect);
 
 	godot::ClassDB::bind_method(godot::D_METHOD("get_line", "hex_one", "hex_two", "make_symmetric"), &HexGrid::get_line, DEFVAL(false));
 	godot::ClassDB::bind_method(godot::D_METHOD("rotate_hex", "hex", "center", "rotation_count_and_direction"), &HexGrid::rotate_hex);
@@ -735,16 +2770,84 @@ void HexGrid::_bind_methods() {
 	BIND_VIRTUAL_METHOD(HexGrid, on_mouse_enter_tile);
 	BIND_VIRTUAL_METHOD(HexGrid, on_mouse_exit_tile);
 
+	ADD_SIGNAL(godot::MethodInfo("hex_spawned", godot::PropertyInfo(godot::Variant::INT, "q"), godot::PropertyInfo(godot::Variant::INT, "r")));
+	ADD_SIGNAL(godot::MethodInfo("hex_deleted", godot::PropertyInfo(godot::Variant::INT, "q"), godot::PropertyInfo(godot::Variant::INT, "r")));
+	ADD_SIGNAL(godot::MethodInfo("layer_value_changed", godot::PropertyInfo(godot::Variant::STRING_NAME, "layer"), godot::PropertyInfo(godot::Variant::INT, "q"), godot::PropertyInfo(godot::Variant::INT, "r")));
+	ADD_SIGNAL(godot::MethodInfo("layer_cleared", godot::PropertyInfo(godot::Variant::STRING_NAME, "layer")));
+	ADD_SIGNAL(godot::MethodInfo("layer_region_changed", godot::PropertyInfo(godot::Variant::STRING_NAME, "layer"), godot::PropertyInfo(godot::Variant::OBJECT, "changed", godot::PROPERTY_HINT_RESOURCE_TYPE, "HexRegion")));
+	ADD_SIGNAL(godot::MethodInfo("commands_flushed", godot::PropertyInfo(godot::Variant::OBJECT, "changed", godot::PROPERTY_HINT_RESOURCE_TYPE, "HexRegion")));
+
 	godot::ClassDB::bind_method(godot::D_METHOD("set_max_size","size"), &HexGrid::set_max_size);
 	godot::ClassDB::bind_method(godot::D_METHOD("get_max_size"), &HexGrid::get_max_size);
 	godot::ClassDB::bind_method(godot::D_METHOD("set_tile_size","size"), &HexGrid::set_tile_size);
 	godot::ClassDB::bind_method(godot::D_METHOD("get_tile_size"), &HexGrid::get_tile_size);
 	godot::ClassDB::bind_method(godot::D_METHOD("get_tile"), &HexGrid::get_tile);
+	godot::ClassDB::bind_method(godot::D_METHOD("set_map_shape","shape"), &HexGrid::set_map_shape);
+	godot::ClassDB::bind_method(godot::D_METHOD("get_map_shape"), &HexGrid::get_map_shape);
+	godot::ClassDB::bind_method(godot::D_METHOD("set_map_width","width"), &HexGrid::set_map_width);
+	godot::ClassDB::bind_method(godot::D_METHOD("get_map_width"), &HexGrid::get_map_width);
+	godot::ClassDB::bind_method(godot::D_METHOD("set_map_height","height"), &HexGrid::set_map_height);
+	godot::ClassDB::bind_method(godot::D_METHOD("get_map_height"), &HexGrid::get_map_height);
+	godot::ClassDB::bind_method(godot::D_METHOD("set_wrap_mode","wrap_mode"), &HexGrid::set_wrap_mode);
+	godot::ClassDB::bind_method(godot::D_METHOD("get_wrap_mode"), &HexGrid::get_wrap_mode);
+	godot::ClassDB::bind_method(godot::D_METHOD("wrap_hex", "q", "r"), &HexGrid::wrap_hex);
+	godot::ClassDB::bind_method(godot::D_METHOD("get_hex_position", "q", "r"), &HexGrid::get_hex_position);
+	godot::ClassDB::bind_method(godot::D_METHOD("world_to_hex", "position"), &HexGrid::world_to_hex);
+	godot::ClassDB::bind_method(godot::D_METHOD("get_hex_at_position", "position"), &HexGrid::get_hex_at_position);
+	godot::ClassDB::bind_method(godot::D_METHOD("is_in_map", "q", "r"), &HexGrid::is_in_map);
+	godot::ClassDB::bind_method(godot::D_METHOD("spawn_map", "connect_mouse_signals", "custom_tile"), &HexGrid::spawn_map, DEFVAL(true), DEFVAL(nullptr));
+	godot::ClassDB::bind_method(godot::D_METHOD("offset_to_axial", "offset_co_ords", "offset_type"), &HexGrid::offset_to_axial);
+	godot::ClassDB::bind_method(godot::D_METHOD("axial_to_offset", "axial_co_ords", "offset_type"), &HexGrid::axial_to_offset);
+	godot::ClassDB::bind_method(godot::D_METHOD("get_hex_offset", "col", "row"), &HexGrid::get_hex_offset);
+	godot::ClassDB::bind_method(godot::D_METHOD("set_pool_max_size","size"), &HexGrid::set_pool_max_size);
+	godot::ClassDB::bind_method(godot::D_METHOD("get_pool_max_size"), &HexGrid::get_pool_max_size);
+	godot::ClassDB::bind_method(godot::D_METHOD("prewarm_pool", "count", "custom_tile"), &HexGrid::prewarm_pool, DEFVAL(nullptr));
+	godot::ClassDB::bind_method(godot::D_METHOD("get_pooled_tile_count", "custom_tile"), &HexGrid::get_pooled_tile_count, DEFVAL(nullptr));
+	godot::ClassDB::bind_method(godot::D_METHOD("clear_pools"), &HexGrid::clear_pools);
+	godot::ClassDB::bind_method(godot::D_METHOD("get_pool_hit_rate"), &HexGrid::get_pool_hit_rate);
+	godot::ClassDB::bind_method(godot::D_METHOD("get_profile_monitor", "monitor"), &HexGrid::get_profile_monitor);
+	godot::ClassDB::bind_method(godot::D_METHOD("reset_profile_counters"), &HexGrid::reset_profile_counters);
 	godot::ClassDB::bind_method(godot::D_METHOD("set_tile","tile"), &HexGrid::set_tile);
 	ADD_PROPERTY(godot::PropertyInfo(godot::Variant::INT, "max_size"), "set_max_size", "get_max_size");
 	ADD_PROPERTY(godot::PropertyInfo(godot::Variant::FLOAT, "tile_size"), "set_tile_size", "get_tile_size");
 	ADD_PROPERTY(godot::PropertyInfo(godot::Variant::OBJECT, "tile_scene", godot::PROPERTY_HINT_RESOURCE_TYPE, "PackedScene"), "set_tile", "get_tile");
-
+	ADD_PROPERTY(godot::PropertyInfo(godot::Variant::INT, "pool_max_size"), "set_pool_max_size", "get_pool_max_size");
+	ADD_PROPERTY(godot::PropertyInfo(godot::Variant::BOOL, "headless"), "set_headless", "is_headless");
+	ADD_PROPERTY(godot::PropertyInfo(godot::Variant::INT, "collision_mode", godot::PROPERTY_HINT_ENUM, "Tiles,Chunks"), "set_collision_mode", "get_collision_mode");
+	ADD_PROPERTY(godot::PropertyInfo(godot::Variant::STRING_NAME, "collision_height_layer"), "set_collision_height_layer", "get_collision_height_layer");
+	ADD_PROPERTY(godot::PropertyInfo(godot::Variant::INT, "collision_layer", godot::PROPERTY_HINT_LAYERS_3D_PHYSICS), "set_collision_layer", "get_collision_layer");
+	ADD_PROPERTY(godot::PropertyInfo(godot::Variant::INT, "map_shape", godot::PROPERTY_HINT_ENUM, "Unbounded,Rectangle Odd-R,Rectangle Even-Q,Hexagon,Parallelogram"), "set_map_shape", "get_map_shape");
+	ADD_PROPERTY(godot::PropertyInfo(godot::Variant::INT, "map_width"), "set_map_width", "get_map_width");
+	ADD_PROPERTY(godot::PropertyInfo(godot::Variant::INT, "map_height"), "set_map_height", "get_map_height");
+	ADD_PROPERTY(godot::PropertyInfo(godot::Variant::INT, "wrap_mode", godot::PROPERTY_HINT_ENUM, "None,Cylindrical,Toroidal"), "set_wrap_mode", "get_wrap_mode");
+
+
+	godot::ClassDB::bind_integer_constant(get_class_static(), "MapShape", "MAP_SHAPE_UNBOUNDED", MAP_SHAPE_UNBOUNDED);
+	godot::ClassDB::bind_integer_constant(get_class_static(), "MapShape", "MAP_SHAPE_RECTANGLE_ODD_R", MAP_SHAPE_RECTANGLE_ODD_R);
+	godot::ClassDB::bind_integer_constant(get_class_static(), "MapShape", "MAP_SHAPE_RECTANGLE_EVEN_Q", MAP_SHAPE_RECTANGLE_EVEN_Q);
+	godot::ClassDB::bind_integer_constant(get_class_static(), "MapShape", "MAP_SHAPE_HEXAGON", MAP_SHAPE_HEXAGON);
+	godot::ClassDB::bind_integer_constant(get_class_static(), "MapShape", "MAP_SHAPE_PARALLELOGRAM", MAP_SHAPE_PARALLELOGRAM);
+
+	godot::ClassDB::bind_integer_constant(get_class_static(), "WrapMode", "WRAP_NONE", WRAP_NONE);
+	godot::ClassDB::bind_integer_constant(get_class_static(), "WrapMode", "WRAP_CYLINDRICAL", WRAP_CYLINDRICAL);
+	godot::ClassDB::bind_integer_constant(get_class_static(), "WrapMode", "WRAP_TOROIDAL", WRAP_TOROIDAL);
+
+	godot::ClassDB::bind_integer_constant(get_class_static(), "OffsetType", "OFFSET_ODD_R", OFFSET_ODD_R);
+	godot::ClassDB::bind_integer_constant(get_class_static(), "OffsetType", "OFFSET_EVEN_R", OFFSET_EVEN_R);
+	godot::ClassDB::bind_integer_constant(get_class_static(), "OffsetType", "OFFSET_ODD_Q", OFFSET_ODD_Q);
+	godot::ClassDB::bind_integer_constant(get_class_static(), "OffsetType", "OFFSET_EVEN_Q", OFFSET_EVEN_Q);
+
+	godot::ClassDB::bind_integer_constant(get_class_static(), "PathMode", "PATH_A_STAR", PATH_A_STAR);
+	godot::ClassDB::bind_integer_constant(get_class_static(), "PathMode", "PATH_JUMP_POINT", PATH_JUMP_POINT);
+
+	godot::ClassDB::bind_integer_constant(get_class_static(), "LayerMatch", "MATCH_EQUALS", MATCH_EQUALS);
+	godot::ClassDB::bind_integer_constant(get_class_static(), "LayerMatch", "MATCH_IN_SET", MATCH_IN_SET);
+	godot::ClassDB::bind_integer_constant(get_class_static(), "LayerMatch", "MATCH_MASK_BIT", MATCH_MASK_BIT);
+	godot::ClassDB::bind_integer_constant(get_class_static(), "LayerStatistic", "STATISTIC_SUM", STATISTIC_SUM);
+	godot::ClassDB::bind_integer_constant(get_class_static(), "LayerStatistic", "STATISTIC_COUNT", STATISTIC_COUNT);
+	godot::ClassDB::bind_integer_constant(get_class_static(), "LayerStatistic", "STATISTIC_AVERAGE", STATISTIC_AVERAGE);
+	godot::ClassDB::bind_integer_constant(get_class_static(), "LayerStatistic", "STATISTIC_MIN", STATISTIC_MIN);
+	godot::ClassDB::bind_integer_constant(get_class_static(), "LayerStatistic", "STATISTIC_MAX", STATISTIC_MAX);
 
 	godot::ClassDB::bind_integer_constant(get_class_static(), "MirrorType", "LOCAL_NEGATE", LOCAL_NEGATE);
 	godot::ClassDB::bind_integer_constant(get_class_static(), "MirrorType", "MIRROR_Q", MIRROR_Q);
@@ -753,5 +2856,24 @@ void HexGrid::_bind_methods() {
 	godot::ClassDB::bind_integer_constant(get_class_static(), "MirrorType", "LOCAL_NEGATE_MIRROR_Q", LOCAL_NEGATE_MIRROR_Q);
 	godot::ClassDB::bind_integer_constant(get_class_static(), "MirrorType", "LOCAL_NEGATE_MIRROR_R", LOCAL_NEGATE_MIRROR_R);
 	godot::ClassDB::bind_integer_constant(get_class_static(), "MirrorType", "LOCAL_NEGATE_MIRROR_S", LOCAL_NEGATE_MIRROR_S);
-}
-
+	godot::ClassDB::bind_integer_constant(get_class_static(), "CollisionMode", "COLLISION_TILES", COLLISION_TILES);
+	godot::ClassDB::bind_integer_constant(get_class_static(), "CollisionMode", "COLLISION_CHUNKS", COLLISION_CHUNKS);
+
+	godot::ClassDB::bind_integer_constant(get_class_static(), "ProfileMonitor", "MONITOR_LOOKUP_CALLS", MONITOR_LOOKUP_CALLS);
+	godot::ClassDB::bind_integer_constant(get_class_static(), "ProfileMonitor", "MONITOR_LOOKUP_TIME_USEC", MONITOR_LOOKUP_TIME_USEC);
+	godot::ClassDB::bind_integer_constant(get_class_static(), "ProfileMonitor", "MONITOR_LOOKUP_MAX_USEC", MONITOR_LOOKUP_MAX_USEC);
+	godot::ClassDB::bind_integer_constant(get_class_static(), "ProfileMonitor", "MONITOR_SPAWN_CALLS", MONITOR_SPAWN_CALLS);
+	godot::ClassDB::bind_integer_constant(get_class_static(), "ProfileMonitor", "MONITOR_SPAWN_TIME_USEC", MONITOR_SPAWN_TIME_USEC);
+	godot::ClassDB::bind_integer_constant(get_class_static(), "ProfileMonitor", "MONITOR_SPAWN_MAX_USEC", MONITOR_SPAWN_MAX_USEC);
+	godot::ClassDB::bind_integer_constant(get_class_static(), "ProfileMonitor", "MONITOR_SEARCH_CALLS", MONITOR_SEARCH_CALLS);
+	godot::ClassDB::bind_integer_constant(get_class_static(), "ProfileMonitor", "MONITOR_SEARCH_TIME_USEC", MONITOR_SEARCH_TIME_USEC);
+	godot::ClassDB::bind_integer_constant(get_class_static(), "ProfileMonitor", "MONITOR_SEARCH_MAX_USEC", MONITOR_SEARCH_MAX_USEC);
+	godot::ClassDB::bind_integer_constant(get_class_static(), "ProfileMonitor", "MONITOR_SEARCH_TILES_VISITED", MONITOR_SEARCH_TILES_VISITED);
+	godot::ClassDB::bind_integer_constant(get_class_static(), "ProfileMonitor", "MONITOR_LINE_CALLS", MONITOR_LINE_CALLS);
+	godot::ClassDB::bind_integer_constant(get_class_static(), "ProfileMonitor", "MONITOR_LINE_TIME_USEC", MONITOR_LINE_TIME_USEC);
+	godot::ClassDB::bind_integer_constant(get_class_static(), "ProfileMonitor", "MONITOR_LINE_MAX_USEC", MONITOR_LINE_MAX_USEC);
+	godot::ClassDB::bind_integer_constant(get_class_static(), "ProfileMonitor", "MONITOR_STORAGE_TILES", MONITOR_STORAGE_TILES);
+	godot::ClassDB::bind_integer_constant(get_class_static(), "ProfileMonitor", "MONITOR_STORAGE_NULL_ENTRIES", MONITOR_STORAGE_NULL_ENTRIES);
+	godot::ClassDB::bind_integer_constant(get_class_static(), "ProfileMonitor", "MONITOR_STORAGE_BYTES", MONITOR_STORAGE_BYTES);
+	godot::ClassDB::bind_integer_constant(get_class_static(), "ProfileMonitor", "MONITOR_STORAGE_LOAD_FACTOR", MONITOR_STORAGE_LOAD_FACTOR);
+}
\ No newline at end of file
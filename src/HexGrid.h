@@ -19,15 +19,38 @@
 #include "godot_cpp/variant/utility_functions.hpp"
 #include "godot_cpp/core/object.hpp"
 #include "godot_cpp/classes/packed_scene.hpp"
+#include "godot_cpp/classes/static_body3d.hpp"
+#include "godot_cpp/classes/image.hpp"
+#include "godot_cpp/classes/image_texture.hpp"
 #include "godot_cpp/variant/callable.hpp"
 #include "HexTile.h"
+#include "HexGridProfiler.h"
+#include "HexShapes.h"
+#include "HexRegion.h"
+#include "HexLayer.h"
+#include "HexTileStorage.h"
+#include "HexVisibilityTrie.h"
+#include "HexShapeCache.h"
+#include "HexPathfinder.h"
+#include "HexCooperativePlanner.h"
+#include "HexGraph.h"
+#include "HexRevisionLog.h"
+#include "HexGridSnapshot.h"
+#include "HexCommandBuffer.h"
+#include "HexAreaSums.h"
+#include "HexHierarchy.h"
+#include "HexPattern.h"
+#include "HexLayerTexture.h"
+#include <climits>
+#include <memory>
 #include <unordered_map>
+#include <unordered_set>
 /// @brief Manages and Manipulates Hexagonal Grids.
 class HexGrid : public godot::Node3D
 {
     GDCLASS(HexGrid, godot::Node3D)
     /**
-     * @brief The max grid size.
+     * @brief The max grid size. Bounded maps are limited by their shape instead.
      * 
      */
     int max_size{};
@@ -37,15 +60,237 @@ class HexGrid : public godot::Node3D
      */
     float tile_size{};
     /**
-     * @brief A map that maps a hash value to a hex tile.
+     * @brief The spawned tiles. A hash map for unbounded maps, a flat array for bounded ones.
      * 
      */
-    std::unordered_map<long, HexTile*> tile_map{};
+    HexTileStorage tile_storage{};
+    /**
+     * @brief The map's width, or its radius for hexagons. Unused by unbounded maps.
+     * 
+     */
+    int map_width{};
+    /**
+     * @brief The map's height. Unused by unbounded maps and hexagons.
+     * 
+     */
+    int map_height{};
+    /**
+     * @brief The requested wrap mode. Only applied to shapes that can wrap.
+     * 
+     */
+    int wrap_mode{};
     /**
      * @brief The default tile scene.
      * 
      */
     godot::Ref<godot::PackedScene> tile_scene;
+    /**
+     * @brief Whether hexes are kept as data only, without a tile node.
+     * 
+     */
+    bool headless{};
+    /**
+     * @brief Detached tiles that were all instantiated from the same scene, waiting to be reused by spawn_hex.
+     * 
+     */
+    struct TilePool {
+        /// @brief The scene the pooled tiles came from. Keeps the scene alive for prewarming.
+        godot::Ref<godot::PackedScene> scene;
+        /// @brief The detached tiles, used as a stack.
+        std::vector<HexTile*> tiles{};
+    };
+    /**
+     * @brief A map that maps a scene's instance id to its pool of detached tiles.
+     * 
+     */
+    std::unordered_map<uint64_t, TilePool> tile_pools{};
+    /**
+     * @brief The max amount of detached tiles kept per scene. Zero disables pooling.
+     * 
+     */
+    int pool_max_size{};
+    /**
+     * @brief The amount of spawns that reused a pooled tile.
+     * 
+     */
+    uint64_t pool_hits{};
+    /**
+     * @brief The amount of spawns that had to instantiate a new tile.
+     * 
+     */
+    uint64_t pool_misses{};
+    /**
+     * @brief Hashes StringNames so they can be used as map keys.
+     * 
+     */
+    struct StringNameHasher {
+        size_t operator()(const godot::StringName &name) const { return name.hash(); }
+    };
+    /**
+     * @brief A map that maps a layer name to its per-cell values.
+     * 
+     */
+    std::unordered_map<godot::StringName, HexLayer, StringNameHasher> layers{};
+    /**
+     * @brief The revision of the latest change to the tiles or layers. Every change gets its own.
+     * 
+     */
+    uint64_t revision{};
+    /**
+     * @brief The revisions of the tiles.
+     * 
+     */
+    HexRevisionLog tile_revisions{};
+    /**
+     * @brief The revisions of a layer.
+     * 
+     */
+    struct LayerRevisions {
+        /// @brief The revision the layer was added at. Deltas starting before it replace the whole layer.
+        uint64_t created{};
+        HexRevisionLog cells{};
+    };
+    /**
+     * @brief A map that maps a layer name to its revisions.
+     * 
+     */
+    std::unordered_map<godot::StringName, LayerRevisions, StringNameHasher> layer_revisions{};
+    /**
+     * @brief A map that maps the name of a removed layer to the revision it was removed at.
+     * 
+     */
+    std::unordered_map<godot::StringName, uint64_t, StringNameHasher> removed_layers{};
+    /**
+     * @brief A map that maps a layer name to its summed-area table. Built by the first sum over the layer.
+     * 
+     */
+    std::unordered_map<godot::StringName, HexAreaSums, StringNameHasher> area_sums{};
+    /**
+     * @brief A map that maps a layer name to its per-level summaries. Built by the first query on the layer.
+     * 
+     */
+    std::unordered_map<godot::StringName, HexLayerHierarchy, StringNameHasher> layer_hierarchies{};
+    /**
+     * @brief A layer packed for shaders, and the image and texture it is handed to.
+     * 
+     */
+    struct LayerTexture {
+        HexLayerTexture texels{};
+        godot::Ref<godot::Image> image{};
+        godot::Ref<godot::ImageTexture> texture{};
+        /// @brief Whether the image changed since it was last uploaded to the texture.
+        bool is_image_changed{};
+        /// @brief Whether the image changed size since it was last uploaded, which the texture cannot update in place.
+        bool is_image_resized{};
+        /// @brief Whether a tile appeared outside the packed box, so the texels have to be packed again. Kept until that succeeds.
+        bool needs_repack{};
+    };
+    /**
+     * @brief A map that maps a layer name to its texture. Packed by the first request for it.
+     * 
+     */
+    std::unordered_map<godot::StringName, LayerTexture, StringNameHasher> layer_textures{};
+    /**
+     * @brief The lines of sight used by the visibility queries. Grown to the largest radius asked for. Shared with the snapshots published while it was current.
+     * 
+     */
+    std::shared_ptr<const HexVisibilityTrie> visibility_trie{ std::make_shared<HexVisibilityTrie>() };
+    /**
+     * @brief An empty storage with the map's shape, handed to snapshots. Created on the first publish after the map changes.
+     * 
+     */
+    std::shared_ptr<const HexTileStorage> snapshot_layout{};
+    /**
+     * @brief The latest snapshot from publish_snapshot, which the next one shares its unchanged chunks with.
+     * 
+     */
+    godot::Ref<HexGridSnapshot> published_snapshot{};
+    /**
+     * @brief The mutations queued from other threads, waiting for flush_commands.
+     * 
+     */
+    HexCommandBuffer command_buffer{};
+    /**
+     * @brief Whether flush_commands is applying commands. The per-hex signals are held back meanwhile, and commands_flushed is emitted once instead, which HexPathPlanner listens to as well.
+     * 
+     */
+    bool is_flushing_commands{};
+    /**
+     * @brief Whether tiles keep their own colliders, or the grid builds merged bodies per chunk.
+     * 
+     */
+    int collision_mode{};
+    /**
+     * @brief The layer giving the height of each hex's collision prism. Without one, every prism is flat at zero.
+     * 
+     */
+    godot::StringName collision_height_layer{};
+    /**
+     * @brief The physics layers the chunk bodies are on.
+     * 
+     */
+    uint32_t collision_layer{ 1 };
+    /**
+     * @brief The merged body of one chunk.
+     * 
+     */
+    struct CollisionChunk {
+        godot::StaticBody3D* body{};
+        uint32_t owner{};
+    };
+    /**
+     * @brief A map that maps a chunk key to its merged body. Chunks without hexes have none.
+     * 
+     */
+    std::unordered_map<int64_t, CollisionChunk> collision_bodies{};
+    /**
+     * @brief The revision the chunk bodies were last brought up to.
+     * 
+     */
+    uint64_t collision_revision{};
+    /**
+     * @brief When the height layer the chunk bodies were built from was added, zero if it did not exist. A layer added again is rebuilt in full.
+     * 
+     */
+    uint64_t collision_height_created{};
+    /**
+     * @brief Whether every chunk body has to be rebuilt, such as after the tile size changed.
+     * 
+     */
+    bool is_collision_stale{};
+    /**
+     * @brief Whether the tiles' own colliders have to be taken out of the physics space again, since entering the tree puts them back.
+     * 
+     */
+    bool is_tile_collision_stale{};
+    /**
+     * @brief The group being planned by plan_group_paths. Only valid during the call.
+     * 
+     */
+    HexCooperativePlanner* group_planner{};
+#ifdef HEX_GRID_PROFILING
+    /**
+     * @brief The instrumented code paths, used to index profile_counters.
+     * 
+     */
+    enum ProfileCounter {
+        PROFILE_LOOKUP,
+        PROFILE_SPAWN,
+        PROFILE_SEARCH,
+        PROFILE_LINE,
+        PROFILE_COUNTER_MAX
+    };
+    /**
+     * @brief The stats for every instrumented code path.
+     * 
+     */
+    HexGridProfileCounter profile_counters[PROFILE_COUNTER_MAX]{};
+    /**
+     * @brief The ids the grid's monitors were registered under, so they can be removed again.
+     * 
+     */
+    std::vector<godot::StringName> registered_monitors{};
+#endif
 
 public:
 /**
@@ -70,33 +315,288 @@ private:
      */
     static void _bind_methods();
     /**
-     * @brief Converts q and r into a hash value.
+     * @brief Converts q and r into a hash value. Every pair of coordinates gets its own value.
      * 
      * @param q The q-coordinate.
      * @param r  The r-coordinate.
-     * @return long The resulting hash value from the two coordinates.
+     * @return int64_t The resulting hash value from the two coordinates.
      */
-    long hash(int q, int r);
+    int64_t hash(int q, int r);
     /**
      * @brief Unhashes a key to return a pair containing q and r coordinates.
      * 
      * @param key The key to be unhashed.
      * @return std::pair<int, int> A pair containing q as its first, and r as its second.
      */
-    std::pair<int, int> unhash(long key);
+    std::pair<int, int> unhash(int64_t key);
+    /**
+     * @brief Applies the map shape properties to the tile storage.
+     * 
+     * @param new_shape The shape. Typically a MapShape enum.
+     * @param new_width The width, or the radius for hexagons.
+     * @param new_height The height.
+     * @param new_wrap How the edges connect. Typically a WrapMode enum.
+     */
+    void configure_map(int new_shape, int new_width, int new_height, int new_wrap);
+    /**
+     * @brief Adds a hex to a region if it has a tile, at the tile's canonical coordinates.
+     * 
+     * @param region The region to add to.
+     * @param hex The coordinates. May lie past the seam of a wrapping map.
+     */
+    void add_existing_hex(const godot::Ref<HexRegion> &region, std::pair<int, int> hex);
+    /**
+     * @brief Adds every existing hex visible from an origin to a region.
+     * 
+     * @param origin The coordinates to look from.
+     * @param radius How far to look. The visibility trie must already be built at least this far.
+     * @param blockers The hexes that block sight. Can be null.
+     * @param region The region to add to.
+     */
+    void add_field_of_view(std::pair<int, int> origin, int radius, const HexRegion* blockers, const godot::Ref<HexRegion> &region);
+    /**
+     * @brief Visits every hex on a line, in the order of HexLineRange. Short lines come from the shape cache.
+     * 
+     * @param start The start of the line.
+     * @param end The end of the line.
+     * @param make_symmetric Whether to draw the symmetric variant of the line.
+     * @param visit Called as visit(pair) for every hex on the line.
+     */
+    template <typename Visit>
+    void for_each_line_hex(std::pair<int, int> start, std::pair<int, int> end, bool make_symmetric, Visit &&visit) {
+        HexShapeCache::Span offsets{};
+        if (!HexShapeCache::get_shared().find_line(end.first - start.first, end.second - start.second, make_symmetric, offsets)) {
+            for (std::pair<int, int> hex : HexLineRange(start, end, make_symmetric)) {
+                visit(hex);
+            }
+            return;
+        }
+        for (const std::pair<int, int> &offset : offsets) {
+            visit(std::pair<int, int>(start.first + offset.first, start.second + offset.second));
+        }
+    }
+    /**
+     * @brief Visits every hex on a ring, in the order of HexRingRange. Small rings come from the shape cache.
+     * 
+     * @param q The q-coordinate of the center.
+     * @param r The r-coordinate of the center.
+     * @param radius The radius of the ring.
+     * @param visit Called as visit(pair) for every hex on the ring.
+     */
+    template <typename Visit>
+    void for_each_ring_hex(int q, int r, int radius, Visit &&visit) {
+        HexShapeCache::Span offsets{};
+        if (!HexShapeCache::get_shared().find_ring(radius, offsets)) {
+            for (std::pair<int, int> hex : HexRingRange(q, r, radius)) {
+                visit(hex);
+            }
+            return;
+        }
+        for (const std::pair<int, int> &offset : offsets) {
+            visit(std::pair<int, int>(q + offset.first, r + offset.second));
+        }
+    }
+    /**
+     * @brief Visits every hex of a spiral, in the order of HexSpiralRange. Small spirals come from the shape cache.
+     * 
+     * @param q The q-coordinate of the center.
+     * @param r The r-coordinate of the center.
+     * @param radius The radius of the outermost ring.
+     * @param visit Called as visit(pair) for every hex of the spiral.
+     */
+    template <typename Visit>
+    void for_each_spiral_hex(int q, int r, int radius, Visit &&visit) {
+        HexShapeCache::Span offsets{};
+        if (!HexShapeCache::get_shared().find_spiral(radius, offsets)) {
+            for (std::pair<int, int> hex : HexSpiralRange(q, r, radius)) {
+                visit(hex);
+            }
+            return;
+        }
+        for (const std::pair<int, int> &offset : offsets) {
+            visit(std::pair<int, int>(q + offset.first, r + offset.second));
+        }
+    }
+    /**
+     * @brief Checks if a hex is reached for the first time while walking a shape. On a wrapping map, a shape wider than the map reaches some hexes again from the other side of the seam.
+     * 
+     * @param seen The hexes reached so far. Left untouched on maps that do not wrap.
+     * @param hex The hex, at its canonical coordinates.
+     * @return bool True if the hex was not reached before. Always true on maps that do not wrap.
+     */
+    bool is_first_visit(std::unordered_set<int64_t> &seen, std::pair<int, int> hex) const {
+        return !tile_storage.wraps() || seen.insert(HexTileStorage::key(hex.first, hex.second)).second;
+    }
+    /**
+     * @brief Takes a tile out of the scene's pool, or instantiates a new one if the pool is empty.
+     * 
+     * @param scene The scene the tile should come from.
+     * @return HexTile* A detached tile, or null if the scene is not a HexTile.
+     */
+    HexTile* acquire_tile(const godot::Ref<godot::PackedScene> &scene);
+    /**
+     * @brief Gets a tile from the scene's pool and places it in the grid at the given coordinates. Does not store it.
+     * 
+     * @param q The q-coordinate.
+     * @param r The r-coordinate.
+     * @param connect_mouse_signals Whether or not to connect mouse signals.
+     * @param scene The scene the tile should come from.
+     * @return HexTile* The placed tile, or null if the scene is not a HexTile.
+     */
+    HexTile* place_tile(int q, int r, bool connect_mouse_signals, const godot::Ref<godot::PackedScene> &scene);
+    /**
+     * @brief Detaches a tile and parks it in its scene's pool. Tiles are freed instead if the pool is full or pooling is disabled.
+     * 
+     * @param tile The tile to release. It must already be removed from the tile map.
+     */
+    void release_tile(HexTile* tile);
+    /**
+     * @brief Frees every pooled tile.
+     * 
+     */
+    void free_pooled_tiles();
+    /**
+     * @brief Gets the region a query should add its hexes to.
+     * 
+     * @param into The region passed to the query. Can be null.
+     * @return godot::Ref<HexRegion> The given region, or a new one if it was null.
+     */
+    godot::Ref<HexRegion> output_region(const godot::Ref<HexRegion> &into);
     /**
-     * @brief A vector containing pairs of hex neighbors based on coordinates.
+     * @brief Registers the grid's monitors with the Performance singleton. Does nothing unless built with hex_grid_profiling=yes.
      * 
      */
-    std::vector<std::pair<int, int>>hex_neighbors{ {1,0}, {1, -1}, {0, -1}, {-1, 0}, {-1, 1}, {0, 1} };
+    void register_profile_monitors();
     /**
-     * @brief A vector containing pairs of hex diagonals based on coordinates.
+     * @brief Removes the grid's monitors from the Performance singleton.
      * 
      */
-    std::vector<std::pair<int, int>>hex_diagonals{ {2,-1}, {1, -2}, {-1, -1}, {-2, 1}, {-1, 2}, {1, 1} };
+    void unregister_profile_monitors();
        
 
 public: HexGrid();
+    /**
+     * @brief Enumerations for usage with get_profile_monitor. These are also registered as custom monitors when the extension is built with hex_grid_profiling=yes.
+     * 
+     */
+    enum ProfileMonitor {
+        /// @brief The amount of get_hex calls.
+        MONITOR_LOOKUP_CALLS,
+        /// @brief The total time spent in get_hex, in microseconds.
+        MONITOR_LOOKUP_TIME_USEC,
+        /// @brief The longest get_hex call, in microseconds.
+        MONITOR_LOOKUP_MAX_USEC,
+        /// @brief The amount of spawn_hex calls.
+        MONITOR_SPAWN_CALLS,
+        /// @brief The total time spent in spawn_hex, in microseconds.
+        MONITOR_SPAWN_TIME_USEC,
+        /// @brief The longest spawn_hex call, in microseconds.
+        MONITOR_SPAWN_MAX_USEC,
+        /// @brief The amount of searches.
+        MONITOR_SEARCH_CALLS,
+        /// @brief The total time spent searching, in microseconds.
+        MONITOR_SEARCH_TIME_USEC,
+        /// @brief The longest search, in microseconds.
+        MONITOR_SEARCH_MAX_USEC,
+        /// @brief The average amount of tiles visited per search.
+        MONITOR_SEARCH_TILES_VISITED,
+        /// @brief The amount of lines drawn.
+        MONITOR_LINE_CALLS,
+        /// @brief The total time spent drawing lines, in microseconds.
+        MONITOR_LINE_TIME_USEC,
+        /// @brief The longest line, in microseconds.
+        MONITOR_LINE_MAX_USEC,
+        /// @brief The amount of spawned tiles.
+        MONITOR_STORAGE_TILES,
+        /// @brief The amount of empty cells in a bounded map. Always zero for unbounded maps, since lookups of empty coordinates no longer leave entries behind.
+        MONITOR_STORAGE_NULL_ENTRIES,
+        /// @brief An estimate of the memory used by the tile storage, in bytes.
+        MONITOR_STORAGE_BYTES,
+        /// @brief The load factor of the tile map, or the share of a bounded map's cells that hold a tile.
+        MONITOR_STORAGE_LOAD_FACTOR,
+        /// @brief The amount of monitors.
+        MONITOR_MAX
+    };
+    /**
+     * @brief Enumerations for usage with the map_shape property. Bounded shapes store their tiles in one flat array.
+     * 
+     */
+    enum MapShape {
+        /// @brief No bounds, tiles can be spawned anywhere as long as the grid is below its max size.
+        MAP_SHAPE_UNBOUNDED = HEX_MAP_UNBOUNDED,
+        /// @brief A rectangle of map_width columns and map_height rows in odd-r offset coordinates.
+        MAP_SHAPE_RECTANGLE_ODD_R = HEX_MAP_RECTANGLE_ODD_R,
+        /// @brief A rectangle of map_width columns and map_height rows in even-q offset coordinates.
+        MAP_SHAPE_RECTANGLE_EVEN_Q = HEX_MAP_RECTANGLE_EVEN_Q,
+        /// @brief A hexagon centered on 0,0 with map_width as its radius.
+        MAP_SHAPE_HEXAGON = HEX_MAP_HEXAGON,
+        /// @brief A parallelogram with q from 0 to map_width - 1 and r from 0 to map_height - 1.
+        MAP_SHAPE_PARALLELOGRAM = HEX_MAP_PARALLELOGRAM
+    };
+    /**
+     * @brief Enumerations for usage with the wrap_mode property. Wrapping maps store every cell once, and every query crosses the seams on its own.
+     * 
+     */
+    enum WrapMode {
+        /// @brief The edges of the map are walls.
+        WRAP_NONE = HEX_WRAP_NONE,
+        /// @brief The east and west edges are joined. Needs an odd-r rectangle or a parallelogram.
+        WRAP_CYLINDRICAL = HEX_WRAP_CYLINDRICAL,
+        /// @brief Both pairs of edges are joined. Needs a parallelogram, or an odd-r rectangle with an even height.
+        WRAP_TOROIDAL = HEX_WRAP_TOROIDAL
+    };
+    /**
+     * @brief Enumerations for usage with the offset coordinate conversions.
+     * 
+     */
+    enum OffsetType {
+        /// @brief Pointy tops, odd rows shoved right.
+        OFFSET_ODD_R = HEX_OFFSET_ODD_R,
+        /// @brief Pointy tops, even rows shoved right.
+        OFFSET_EVEN_R = HEX_OFFSET_EVEN_R,
+        /// @brief Flat tops, odd columns shoved down.
+        OFFSET_ODD_Q = HEX_OFFSET_ODD_Q,
+        /// @brief Flat tops, even columns shoved down.
+        OFFSET_EVEN_Q = HEX_OFFSET_EVEN_Q
+    };
+    /**
+     * @brief Enumerations for usage with the pathfinding methods.
+     * 
+     */
+    enum PathMode {
+        /// @brief A* over the cost layer. Finds the cheapest path for any costs.
+        PATH_A_STAR,
+        /// @brief Jump Point Search. Every step costs the same, so the cost layer only decides which hexes are impassable. Expands far fewer hexes than A* in open terrain.
+        PATH_JUMP_POINT
+    };
+    /**
+     * @brief Enumerations for usage with the nearest match methods.
+     * 
+     */
+    enum LayerMatch {
+        /// @brief Matches cells whose layer value equals the given float.
+        MATCH_EQUALS,
+        /// @brief Matches cells whose layer value is one of the given floats.
+        MATCH_IN_SET,
+        /// @brief Matches cells whose layer value, as an integer, shares a bit with the given mask.
+        MATCH_MASK_BIT
+    };
+    /**
+     * @brief Enumerations for usage with the layer summary methods.
+     * 
+     */
+    enum LayerStatistic {
+        /// @brief The sum of the values.
+        STATISTIC_SUM,
+        /// @brief The amount of hexes.
+        STATISTIC_COUNT,
+        /// @brief The mean of the values.
+        STATISTIC_AVERAGE,
+        /// @brief The lowest value.
+        STATISTIC_MIN,
+        /// @brief The highest value.
+        STATISTIC_MAX
+    };
     /**
      * @brief Enumerations for usage with the mirror hex methods.
      * 
@@ -117,6 +617,45 @@ public: HexGrid();
         /// @brief Creates a vector starting at the center, negates it, mirrors it over the s axis, and then recreates the original point using the vector.
         LOCAL_NEGATE_MIRROR_S
     };
+    /**
+     * @brief Enumerations for usage with the collision mode.
+     * 
+     */
+    enum CollisionMode {
+        /// @brief Every tile collides through its own shapes, as its scene sets them up.
+        COLLISION_TILES,
+        /// @brief The grid builds one static body per chunk, out of a prism per hex. The tiles' own areas are taken out of the physics space meanwhile.
+        COLLISION_CHUNKS
+    };
+
+    /**
+     * @brief Gets the height of a hex's collision prism.
+     * 
+     */
+    float get_collision_height(const HexLayer* heights, int q, int r);
+    /**
+     * @brief Rebuilds the body of one chunk, freeing it if the chunk has no hexes left.
+     * 
+     * @param key The chunk's key.
+     * @param heights The height layer. Can be null.
+     */
+    void build_collision_chunk(int64_t key, const HexLayer* heights);
+    /**
+     * @brief Frees every chunk body.
+     * 
+     */
+    void free_collision_bodies();
+    /**
+     * @brief Puts a tile's own area in the physics space in tile mode, or takes it out in chunk mode. Tiles outside the tree are left alone, they join the space when they enter it.
+     * 
+     * @param tile The tile.
+     */
+    void update_tile_collision(HexTile* tile);
+    /**
+     * @brief Calls update_tile_collision for every tile.
+     * 
+     */
+    void update_tile_collisions();
 
     /**
      * @brief Converts a given tuple into a string.
@@ -134,54 +673,306 @@ public:
      */
       void set_tile_size(float new_size);
       /**
-       * @brief Gets the tile size.
+       * @brief Gets the tile size.
+       * 
+       * @return float The tile size.
+       */
+      float get_tile_size();
+      /**
+       * @brief Sets the max size of the grid.
+       * 
+       * @param new_size Self-explanatory.
+       */
+      void set_max_size(int new_size);
+      /**
+       * @brief Gets the max size of the grid.
+       * 
+       * @return int The size of the grid.
+       */
+      int get_max_size();
+      /**
+       * @brief Sets the default tile
+       * 
+       * @param new_scene The scene to use as the tile, must be a HexTile object.
+       */
+      void set_tile(const godot::Ref<godot::PackedScene> &new_scene);
+      /**
+       * @brief Gets the current default tile.
+       * 
+       * @return godot::Ref<godot::PackedScene> The default tile.
+       */
+      godot::Ref<godot::PackedScene> get_tile();
+      /**
+       * @brief Sets the map's shape. Only possible while the grid has no tiles, typically from the inspector.
+       * 
+       * @param new_shape The shape. Typically a MapShape enum.
+       */
+      void set_map_shape(int new_shape);
+      /**
+       * @brief Gets the map's shape.
+       * 
+       * @return int The shape, a MapShape enum.
+       */
+      int get_map_shape();
+      /**
+       * @brief Sets the map's width, or its radius for hexagons. Only possible while the grid has no tiles.
+       * 
+       * @param new_width Self-explanatory.
+       */
+      void set_map_width(int new_width);
+      /**
+       * @brief Gets the map's width, or its radius for hexagons.
+       * 
+       * @return int The width.
+       */
+      int get_map_width();
+      /**
+       * @brief Sets the map's height. Only possible while the grid has no tiles.
+       * 
+       * @param new_height Self-explanatory.
+       */
+      void set_map_height(int new_height);
+      /**
+       * @brief Gets the map's height.
+       * 
+       * @return int The height.
+       */
+      int get_map_height();
+      /**
+       * @brief Sets how the map's edges connect. Only possible while the grid has no tiles.
+       * 
+       * @param new_wrap The wrap mode. Typically a WrapMode enum.
+       */
+      void set_wrap_mode(int new_wrap);
+      /**
+       * @brief Gets how the map's edges connect.
+       * 
+       * @return int The wrap mode, a WrapMode enum.
+       */
+      int get_wrap_mode();
+      /**
+       * @brief Maps coordinates past the seam of a wrapping map back onto the map. Intended for usage directly from Godot.
+       * 
+       * @param q The q-coordinate.
+       * @param r The r-coordinate.
+       * @return godot::Vector2i The canonical coordinates, q as x and r as y. Unchanged if the map does not wrap.
+       */
+      godot::Vector2i wrap_hex(int q, int r);
+      /**
+       * @brief Gets the position of a hex, in the grid's local space.
+       * 
+       * @param q The q-coordinate.
+       * @param r The r-coordinate.
+       * @return godot::Vector3 The position tiles at these coordinates are placed at.
+       */
+      godot::Vector3 get_hex_position(int q, int r);
+      /**
+       * @brief Gets the hex under a position in the grid's local space, such as a mouse pick. On wrapping maps, positions past the seam give the canonical hex, so a view scrolled across the seam picks the right tile. Intended for usage directly from Godot.
+       * 
+       * @param position The position, in the grid's local space.
+       * @return godot::Vector2i The hex's coordinates, q as x and r as y.
+       */
+      godot::Vector2i world_to_hex(godot::Vector3 position);
+      /**
+       * @brief Gets the tile under a position in the grid's local space. Intended for usage directly from Godot.
+       * 
+       * @param position The position, in the grid's local space.
+       * @return HexTile* The tile if it exists, otherwise null.
+       */
+      HexTile* get_hex_at_position(godot::Vector3 position);
+      /**
+       * @brief Checks if coordinates are inside the map. Always true for unbounded maps.
+       * 
+       * @param q The q-coordinate.
+       * @param r The r-coordinate.
+       * @return bool True if a tile can be spawned there.
+       */
+      bool is_in_map(int q, int r);
+      /**
+       * @brief Spawns a tile in every empty cell of a bounded map. Intended for usage directly from Godot.
+       * 
+       * @param connect_mouse_signals Whether or not to connect mouse signals.
+       * @param tile_to_spawn An optional custom tile. Can be null.
+       * @return int The amount of spawned tiles.
+       */
+      int spawn_map(bool connect_mouse_signals, const godot::Ref<godot::PackedScene> &tile_to_spawn);
+      /**
+       * @brief Converts offset coordinates to axial coordinates. Intended for usage directly from Godot.
+       * 
+       * @param offset_co_ords The column as x, and the row as y.
+       * @param offset_type The offset layout. Typically an OffsetType enum.
+       * @return godot::Vector2i The q-coordinate as x, and the r-coordinate as y.
+       */
+      godot::Vector2i offset_to_axial(godot::Vector2i offset_co_ords, int offset_type);
+      /**
+       * @brief Converts axial coordinates to offset coordinates. Intended for usage directly from Godot.
+       * 
+       * @param axial_co_ords The q-coordinate as x, and the r-coordinate as y.
+       * @param offset_type The offset layout. Typically an OffsetType enum.
+       * @return godot::Vector2i The column as x, and the row as y.
+       */
+      godot::Vector2i axial_to_offset(godot::Vector2i axial_co_ords, int offset_type);
+      /**
+       * @brief Gets the hex at a column and row of a rectangular map, in the map's own offset layout.
+       * 
+       * @param col The column.
+       * @param row The row.
+       * @return HexTile* The requested hex if it exists, otherwise null.
+       */
+      HexTile* get_hex_offset(int col, int row);
+      /**
+       * @brief Sets the max amount of detached tiles kept per scene. Pools bigger than the new size are trimmed.
+       * 
+       * @param new_size Self-explanatory. Zero disables pooling, so deleted tiles are freed.
+       */
+      void set_pool_max_size(int new_size);
+      /**
+       * @brief Gets the max amount of detached tiles kept per scene.
+       * 
+       * @return int The max pool size.
+       */
+      int get_pool_max_size();
+      /**
+       * @brief Instantiates tiles ahead of time so later spawns can reuse them. Intended for usage directly from Godot.
+       * 
+       * @param count The amount of tiles the pool should hold. Capped by the max pool size.
+       * @param scene The scene to prewarm. If null, the default tile is used.
+       * @return int The amount of tiles in the pool afterwards.
+       */
+      int prewarm_pool(int count, const godot::Ref<godot::PackedScene> &scene);
+      /**
+       * @brief Gets the amount of detached tiles waiting in a scene's pool.
+       * 
+       * @param scene The scene to check. If null, the default tile is used.
+       * @return int The amount of pooled tiles.
+       */
+      int get_pooled_tile_count(const godot::Ref<godot::PackedScene> &scene);
+      /**
+       * @brief Frees every pooled tile and resets the pool stats.
+       * 
+       */
+      void clear_pools();
+      /**
+       * @brief Gets the share of spawns that reused a pooled tile instead of instantiating a new one.
+       * 
+       * @return float The hit rate, between 0 and 1. Zero if nothing has been spawned yet.
+       */
+      float get_pool_hit_rate();
+      /**
+       * @brief Frees the pooled tiles when the grid is deleted, since they are no longer in the tree, and keeps the chunk bodies up to date in chunk collision mode.
+       * 
+       * @param what The notification.
+       */
+      void _notification(int what);
+      /**
+       * @brief Gets the current value of a monitor. The timing monitors are always zero unless the extension was built with hex_grid_profiling=yes. Intended for usage directly from Godot.
+       * 
+       * @param monitor The monitor to read. Typically a ProfileMonitor enum.
+       * @return double The value of the monitor.
+       */
+      double get_profile_monitor(int monitor);
+      /**
+       * @brief Resets the call counts and timings of every monitor.
+       * 
+       */
+      void reset_profile_counters();
+
+        /**
+         * @brief Spawns a tile at the designated coordinates, provided there is space in the grid, the coordinates are inside the map and they are not occupied. NOTE: If you do enable connect mouse signals, you must implement on_mouse_enter_tile and on_mouse_exit_tile in your script.
+         * 
+         * @param q The q-coordinate to spawn the tile at.
+         * @param r The r-coordinate to spawn the tile at.
+         * @param connect_mouse_signals Whether or not to connect mouse signals. By default, this is true.
+         * @param tile_to_spawn An optional custom tile. GDExtension doesn't support default parameters, but it can be null.
+         * @return HexTile* The spawned tile.
+         */
+      HexTile* spawn_hex(int q, int r, bool connect_mouse_signals, const godot::Ref<godot::PackedScene> &tile_to_spawn);
+      /**
+       * @brief Gets the hex at the given coordinates, if it exists.
+       * 
+       * @param q The q-coordinate.
+       * @param r The r-coordinate.
+       * @return HexTile* The requested hex if it exists, otherwise null.
+       */
+      HexTile* get_hex(int q, int r);
+      /**
+       * @brief Checks whether a hex has been spawned at the given coordinates, with or without a tile node. Intended for usage directly from Godot.
+       * 
+       * @param q The q-coordinate.
+       * @param r The r-coordinate.
+       * @return bool True if the hex exists.
+       */
+      bool has_hex(int q, int r);
+      /**
+       * @brief Sets whether hexes are kept as data only. While headless, spawn_hex stores the coordinates without instantiating a tile, and functions that return tiles return nothing. Turning it on frees the tiles of hexes that already exist, along with every pooled tile, but keeps the hexes and their layers.
+       * 
+       * @param new_headless Self-explanatory.
+       */
+      void set_headless(bool new_headless);
+      /**
+       * @brief Gets whether hexes are kept as data only.
+       * 
+       * @return bool True if the grid is headless.
+       */
+      bool is_headless();
+      /**
+       * @brief Leaves headless mode and gives a tile to every hex that does not have one. Intended for usage directly from Godot.
+       * 
+       * @param connect_mouse_signals Whether or not to connect mouse signals.
+       * @param tile_to_spawn An optional custom tile. Can be null.
+       * @return int The amount of tiles attached.
+       */
+      int attach_tiles(bool connect_mouse_signals, const godot::Ref<godot::PackedScene> &tile_to_spawn);
+      /**
+       * @brief Sets how the grid collides. In chunk mode, the chunk bodies are kept up to date on every physics frame, rebuilding only the chunks that changed. The tiles' own areas are taken out of the physics space while in chunk mode, and put back when switching to tile mode.
+       * 
+       * @param new_mode Typically a CollisionMode enum.
+       */
+      void set_collision_mode(int new_mode);
+      /**
+       * @brief Gets how the grid collides.
        * 
-       * @return float The tile size.
+       * @return int A CollisionMode enum.
        */
-      float get_tile_size();
+      int get_collision_mode();
       /**
-       * @brief Sets the max size of the grid.
+       * @brief Sets the layer giving the height of each hex's collision prism. Can be empty.
        * 
-       * @param new_size Self-explanatory.
+       * @param name Self-explanatory.
        */
-      void set_max_size(int new_size);
+      void set_collision_height_layer(const godot::StringName &name);
       /**
-       * @brief Gets the max size of the grid.
+       * @brief Gets the layer giving the height of each hex's collision prism.
        * 
-       * @return int The size of the grid.
+       * @return godot::StringName The layer's name, empty if there is none.
        */
-      int get_max_size();
+      godot::StringName get_collision_height_layer();
       /**
-       * @brief Sets the default tile
+       * @brief Sets the physics layers the chunk bodies are on.
        * 
-       * @param new_scene The scene to use as the tile, must be a HexTile object.
+       * @param new_layer Self-explanatory.
        */
-      void set_tile(const godot::Ref<godot::PackedScene> &new_scene);
+      void set_collision_layer(uint32_t new_layer);
       /**
-       * @brief Gets the current default tile.
+       * @brief Gets the physics layers the chunk bodies are on.
        * 
-       * @return godot::Ref<godot::PackedScene> The default tile.
+       * @return uint32_t The layers, as a bitmask.
        */
-      godot::Ref<godot::PackedScene> get_tile();
-
-        /**
-         * @brief Spawns a tile at the designated coordinates, provided there is space in the grid and the coordinates are not occupied. NOTE: If you do enable connect mouse signals, you must implement on_mouse_enter_tile and on_mouse_exit_tile in your script.
-         * 
-         * @param q The q-coordinate to spawn the tile at.
-         * @param r The r-coordinate to spawn the tile at.
-         * @param connect_mouse_signals Whether or not to connect mouse signals. By default, this is true.
-         * @param tile_to_spawn An optional custom tile. GDExtension doesn't support default parameters, but it can be null.
-         * @return HexTile* The spawned tile.
-         */
-      HexTile* spawn_hex(int q, int r, bool connect_mouse_signals, const godot::Ref<godot::PackedScene> &tile_to_spawn);
+      uint32_t get_collision_layer();
       /**
-       * @brief Gets the hex at the given coordinates, if it exists.
+       * @brief Rebuilds the chunk bodies that changed since the last update. A chunk changes when a hex in it, or a hex bordering it, is spawned, deleted or changes height. Called on every physics frame in chunk mode, but can be called right after a change so raycasts see it before then. Intended for usage directly from Godot.
        * 
-       * @param q The q-coordinate.
-       * @param r The r-coordinate.
-       * @return HexTile* The requested hex if it exists, otherwise null.
+       * @return int The amount of chunks rebuilt, counting the ones whose bodies were freed.
        */
-      HexTile* get_hex(int q, int r);
+      int update_collision();
+      /**
+       * @brief Gets the hex a ray hit on a chunk body. The point is nudged into the surface, so hits on walls resolve to the hex the wall belongs to. Intended for usage directly from Godot.
+       * 
+       * @param position The hit's position, in global space.
+       * @param normal The hit's normal.
+       * @return godot::Vector2i The hex's coordinates, q as x and r as y.
+       */
+      godot::Vector2i collision_to_hex(godot::Vector3 position, godot::Vector3 normal);
       
       /**
        * @brief Adds two axial coordinates together, represented by pairs of integers.
@@ -386,7 +1177,7 @@ public:
       std::pair<double, double> axial_lerp(std::pair<int, int> hex_one, std::pair<int, int> hex_two, double t);
 
         /**
-         * @brief Calculates the distance between two axial coordinates.
+         * @brief Calculates the distance between two axial coordinates. On wrapping maps, this is the shortest way around.
          * 
          * @param hex_one The first hex.
          * @param hex_two The second hex.
@@ -402,7 +1193,7 @@ public:
         */
       float calculate_distance_hex(HexTile* tile1, HexTile* tile2);
         /**
-         * @brief Calculates a ring of axial hexes.
+         * @brief Calculates a ring of axial hexes. On a wrapping map, each hex is returned once.
          * 
          * @param q The origin q-coordinate.
          * @param r The origin r-coordinate.
@@ -411,7 +1202,7 @@ public:
          */
       std::vector<std::pair<int, int>> get_ring(int q, int r, int radius);
       /**
-       * @brief Calculates a ring of hexes. Intended for usage directly from Godot.
+       * @brief Calculates a ring of hexes. On a wrapping map, each hex is returned once. Intended for usage directly from Godot.
        * 
        * @param center The center of the ring.
        * @param radius The radius of the ring, must be greater than zero.
@@ -419,7 +1210,7 @@ public:
        */
       godot::Array get_ring_hex(HexTile* center, int radius);
       /**
-       * @brief Calculates several rings of hexes, in a sort of inward spiral. This can be an efficient way to get a count of hexes within a radius. Intended for usage directly from Godot.
+       * @brief Calculates several rings of hexes, in a sort of inward spiral. This can be an efficient way to get a count of hexes within a radius. On a wrapping map, each hex is returned once. Intended for usage directly from Godot.
        * 
          * @param q The origin q-coordinate.
          * @param r The origin r-coordinate.
@@ -428,22 +1219,31 @@ public:
        */
       std::vector<std::pair<int, int>> get_spiral_ring(int q, int r, int radius);
         /**
-       * @brief Calculates a spiral ring of hexes by calculating multiple rings up to the radius.
+       * @brief Calculates a spiral ring of hexes by calculating multiple rings up to the radius. On a wrapping map, each hex is returned once.
        * 
        * @param center The center of the ring.
        * @param radius The radius of the ring, must be greater than zero.
        * @return godot::Array An array containing a ring of hexes. Null hexes will be excluded.
        */
       godot::Array get_spiral_ring_hex(HexTile* center, int radius);
+      /**
+       * @brief Calculates a 60' wedge of hexes spreading out from a center. Intended for usage directly from Godot.
+       * 
+       * @param center The center of the wedge. It is not included.
+       * @param direction The direction of the wedge's first edge, from 0 to 5. The second edge is the next direction counter-clockwise.
+       * @param radius The distance of the wedge's last row, must be greater than zero.
+       * @return godot::Array An array containing the wedge of hexes. Null hexes will be excluded.
+       */
+      godot::Array get_cone_hex(HexTile* center, int direction, int radius);
 
     /**
      * @brief Searches outward in a breadth first search for every hex possible. Only stopped by those it has already visited.
      * 
      * @param origin The origin hex to start at.
      * @param visited The pre visited map. Hexes in this map will not be searched from, allowing a boundary to be defined.
-     * @return std::unordered_map<long, HexTile*> A map containing the hexes from the search plus the pre visited hexes. Will only include hexes defined in the tile map.
+     * @return std::unordered_map<int64_t, HexTile*> A map containing the hexes from the search plus the pre visited hexes. Will only include hexes defined in the tile map.
      */
-      std::unordered_map<long, HexTile*> breadth_first_search(std::pair<int, int> origin, std::unordered_map<long, HexTile*> visited);
+      std::unordered_map<int64_t, HexTile*> breadth_first_search(std::pair<int, int> origin, std::unordered_map<int64_t, HexTile*> visited);
     /**
      * @brief Searches outward in a breadth first search for every hex possible. Only stopped by those it has already visited. Intended for usage directly from Godot.
      * 
@@ -453,7 +1253,342 @@ public:
      */
       godot::Array breadth_first_search_hex(HexTile* origin, godot::Array pre_visited);
     /**
-     * @brief Deletes a hex at the given coordinates, if it exists. This calls queue free on the hex. Intended for usage directly from Godot.
+     * @brief Searches outward in a breadth first search, tracking visited hexes in a region. Intended for usage directly from Godot.
+     * 
+     * @param origin The origin hex to start at.
+     * @param pre_visited Hexes in this region will not be searched from, allowing a boundary to be defined. Can be null.
+     * @param into The region to add the reached hexes to. If null, a new region is created.
+     * @return godot::Ref<HexRegion> The region containing every hex reached by the search. Pre visited hexes are not added.
+     */
+      godot::Ref<HexRegion> breadth_first_search_region(HexTile* origin, const godot::Ref<HexRegion> &pre_visited, const godot::Ref<HexRegion> &into);
+    /**
+     * @brief Adds a ring of existing hexes to a region. Intended for usage directly from Godot.
+     * 
+     * @param center The center of the ring.
+     * @param radius The radius of the ring, must be greater than zero.
+     * @param into The region to add the hexes to. If null, a new region is created.
+     * @return godot::Ref<HexRegion> The region containing the ring.
+     */
+      godot::Ref<HexRegion> get_ring_region(HexTile* center, int radius, const godot::Ref<HexRegion> &into);
+    /**
+     * @brief Adds a spiral ring of existing hexes to a region, with the same extent as get_spiral_ring_hex. Intended for usage directly from Godot.
+     * 
+     * @param center The center of the spiral.
+     * @param radius The radius of the spiral, must be greater than zero.
+     * @param into The region to add the hexes to. If null, a new region is created.
+     * @return godot::Ref<HexRegion> The region containing the spiral.
+     */
+      godot::Ref<HexRegion> get_spiral_ring_region(HexTile* center, int radius, const godot::Ref<HexRegion> &into);
+    /**
+     * @brief Adds a wedge of existing hexes to a region. Intended for usage directly from Godot.
+     * 
+     * @param center The center of the wedge. It is not included.
+     * @param direction The direction of the wedge's first edge, from 0 to 5.
+     * @param radius The distance of the wedge's last row, must be greater than zero.
+     * @param into The region to add the hexes to. If null, a new region is created.
+     * @return godot::Ref<HexRegion> The region containing the wedge.
+     */
+      godot::Ref<HexRegion> get_cone_region(HexTile* center, int direction, int radius, const godot::Ref<HexRegion> &into);
+    /**
+     * @brief Adds a line of existing hexes to a region. Intended for usage directly from Godot.
+     * 
+     * @param hex_one The first hex.
+     * @param hex_two The second hex.
+     * @param make_symmetric Whether to draw the symmetric variant of the line.
+     * @param into The region to add the hexes to. If null, a new region is created.
+     * @return godot::Ref<HexRegion> The region containing the line.
+     */
+      godot::Ref<HexRegion> get_line_region(HexTile* hex_one, HexTile* hex_two, bool make_symmetric, const godot::Ref<HexRegion> &into);
+    /**
+     * @brief Gets the hexes in a region. Intended for usage directly from Godot.
+     * 
+     * @param region The region.
+     * @return godot::Array An array containing the hexes of the region. Null hexes will be excluded.
+     */
+      godot::Array get_region_hexes(const godot::Ref<HexRegion> &region);
+    /**
+     * @brief Precomputes the visibility trie out to a radius, so the first visibility query does not have to. Queries with a bigger radius grow it on their own.
+     * 
+     * @param max_radius The largest radius visibility will be queried with.
+     */
+      void prepare_visibility(int max_radius);
+    /**
+     * @brief Gets the memory held by the cached line, ring and spiral offsets, which every grid shares. The cache only grows, and is bounded by HexShapeCache::MAX_CACHED_DISTANCE. Intended for usage directly from Godot.
+     * 
+     * @return int64_t The memory, in bytes.
+     */
+      int64_t get_shape_cache_memory_usage() const;
+    /**
+     * @brief Gets every hex visible from an origin, using the precomputed symmetric lines. A hex is visible if nothing blocks the line to it, blockers themselves included. Intended for usage directly from Godot.
+     * 
+     * @param origin The hex to look from. It is always visible, even if it is a blocker.
+     * @param radius How far to look.
+     * @param blockers The hexes that block sight. Can be null.
+     * @param into The region to add the visible hexes to. If null, a new region is created.
+     * @return godot::Ref<HexRegion> The region containing every visible hex that exists.
+     */
+      godot::Ref<HexRegion> get_field_of_view(HexTile* origin, int radius, const godot::Ref<HexRegion> &blockers, const godot::Ref<HexRegion> &into);
+    /**
+     * @brief Gets every hex visible from any of several viewers, walking the trie once per viewer. Intended for usage directly from Godot.
+     * 
+     * @param origins An array of hexes, or of Vector2i coordinates, to look from.
+     * @param radius How far to look.
+     * @param blockers The hexes that block sight. Can be null.
+     * @param into The region to add the visible hexes to. If null, a new region is created.
+     * @return godot::Ref<HexRegion> The region containing every hex visible to at least one viewer.
+     */
+      godot::Ref<HexRegion> get_field_of_view_many(godot::Array origins, int radius, const godot::Ref<HexRegion> &blockers, const godot::Ref<HexRegion> &into);
+    /**
+     * @brief Checks if one hex can see another, using the same symmetric lines as the field of view. Only the hexes between the two can block. Intended for usage directly from Godot.
+     * 
+     * @param from The hex to look from.
+     * @param to The hex to look at.
+     * @param blockers The hexes that block sight. Can be null.
+     * @return bool True if the line between them is clear.
+     */
+      bool has_line_of_sight(HexTile* from, HexTile* to, const godot::Ref<HexRegion> &blockers);
+    /**
+     * @brief Finds a path between two hexes. Only existing hexes are walked on.
+     * 
+     * @param start The coordinates to start from.
+     * @param goal The coordinates to reach.
+     * @param cost_layer The cost of entering each hex, clamped to at least 1. Negative values are impassable. Can be null, in which case every step costs 1.
+     * @param blockers The hexes that cannot be entered. Can be null.
+     * @param mode How to search. Typically a PathMode enum.
+     * @return std::vector<std::pair<int, int>> The path from the start to the goal, both included. Empty if there is none.
+     */
+      std::vector<std::pair<int, int>> find_path_axial(std::pair<int, int> start, std::pair<int, int> goal, const HexLayer* cost_layer, const HexRegion* blockers, int mode);
+    /**
+     * @brief Finds a path between two hexes. Intended for usage directly from Godot.
+     * 
+     * @param from The hex to start from.
+     * @param to The hex to reach.
+     * @param cost_layer The name of the layer holding the cost of entering each hex, clamped to at least 1. Negative values are impassable. If empty, every step costs 1.
+     * @param blockers The hexes that cannot be entered. Can be null.
+     * @param mode How to search. Typically a PathMode enum.
+     * @return godot::Array An array containing the hexes of the path, from the start to the goal. Empty if there is none. Hexes without a tile are left out, so use find_path_at on grids that are partly headless.
+     */
+      godot::Array find_path(HexTile* from, HexTile* to, const godot::StringName &cost_layer, const godot::Ref<HexRegion> &blockers, int mode);
+    /**
+     * @brief Shortens a path by pulling it tight. Hexes are skipped for as long as the symmetric line to them stays passable, so only the corners around obstacles are kept.
+     * 
+     * @param path A path of neighboring hexes, like the ones returned by find_path_axial.
+     * @param cost_layer Negative values are impassable. Other costs are not weighed, a shortcut is taken whenever it is passable. Can be null.
+     * @param blockers The hexes that cannot be entered. Can be null.
+     * @return std::vector<std::pair<int, int>> The waypoints, including the path's start and end. On wrapping maps they continue past the seam, so every line between them is straight.
+     */
+      std::vector<std::pair<int, int>> smooth_path_axial(const std::vector<std::pair<int, int>> &path, const HexLayer* cost_layer, const HexRegion* blockers);
+    /**
+     * @brief Finds a path between two hexes and pulls it tight into any angle waypoints, so units can walk straight between them. Intended for usage directly from Godot.
+     * 
+     * @param from The hex to start from.
+     * @param to The hex to reach.
+     * @param cost_layer The name of the layer holding the cost of entering each hex. Negative values are impassable. If empty, every step costs 1.
+     * @param blockers The hexes that cannot be entered. Can be null.
+     * @param mode How to search. Typically a PathMode enum.
+     * @return godot::PackedVector3Array The positions of the waypoints in the grid's space, from the start to the goal. Empty if there is no path.
+     */
+      godot::PackedVector3Array find_smooth_path(HexTile* from, HexTile* to, const godot::StringName &cost_layer, const godot::Ref<HexRegion> &blockers, int mode);
+    /**
+     * @brief Plans paths for a group of agents that do not run into each other, by reserving every agent's hexes in space and time. Agents plan one after another, highest priority first, and avoid the hexes already reserved. Intended for usage directly from Godot.
+     * 
+     * @param starts The coordinates each agent starts from, as Vector2i.
+     * @param goals The coordinates each agent should reach, as Vector2i.
+     * @param window The amount of ticks the agents are kept apart for. Paths continue to the goal past it, but without avoiding each other, so plan again before the window runs out. From 1 to 256.
+     * @param priorities The priority of each agent, higher plans first. Agents of equal priority plan in the given order. If empty, every agent has the same priority.
+     * @param cost_layer The name of the layer whose negative values are impassable. Other costs are not weighed, every move takes one tick. If empty, every hex is passable.
+     * @param blockers The hexes that cannot be entered. Can be null.
+     * @param parallel Whether agents of equal priority plan at once on the WorkerThreadPool. They then only avoid agents of higher priority, not each other.
+     * @return godot::Array An array containing an array of coordinates per agent, holding the agent's hex at every tick, starting with its start. Waiting repeats a hex. Empty for agents whose goal cannot be reached.
+     */
+      godot::Array plan_group_paths(const godot::Array &starts, const godot::Array &goals, int window, const godot::PackedInt32Array &priorities, const godot::StringName &cost_layer, const godot::Ref<HexRegion> &blockers, bool parallel);
+    /**
+     * @brief Finds the closest hexes that match a condition, by expanding rings or a breadth first search outward from the origin. Stops as soon as the closest matches are known, so a match next to the origin costs a handful of lookups. Once the rings have covered more cells than there are hexes, the rest is found by one pass over the hexes instead, so sparse maps never walk empty space. Only existing hexes are visited.
+     * 
+     * @param origin The coordinates to search from.
+     * @param count The amount of matches wanted.
+     * @param max_radius The farthest distance searched. If negative, the search runs until every hex was visited.
+     * @param path_distance Whether to measure distance in steps around the blockers instead of in a straight line.
+     * @param blockers The hexes that are never matched, and that cannot be walked through when measuring path distance. Can be null.
+     * @param matches Called as matches(q, r) for every visited hex, returns true if it is wanted.
+     * @return std::vector<std::pair<std::pair<int, int>, int>> Up to count matches and their distances, closest first. Matches at equal distance keep the order they were visited in.
+     */
+    template <typename Match>
+    std::vector<std::pair<std::pair<int, int>, int>> find_nearest_axial(std::pair<int, int> origin, int count, int max_radius, bool path_distance, const HexRegion* blockers, Match &&matches) {
+        std::vector<std::pair<std::pair<int, int>, int>> found{};
+        origin = tile_storage.canonicalize(origin);
+        if (count <= 0 || !tile_storage.get(origin.first, origin.second)) {
+            return found;
+        }
+        int limit = max_radius < 0 ? INT_MAX : max_radius;
+        auto is_blocked = [blockers](std::pair<int, int> hex) {
+            return blockers && blockers->has_hex(hex.first, hex.second);
+        };
+
+        if (path_distance) {
+            // Searched level by level, so every hex of a level has the same distance and the search can stop between levels.
+            std::unordered_set<int64_t> visited{ HexTileStorage::key(origin.first, origin.second) };
+            std::vector<std::pair<int, int>> level{ origin };
+            std::vector<std::pair<int, int>> next_level{};
+            for (int distance = 0; !level.empty() && distance <= limit; distance++) {
+                for (std::pair<int, int> hex : level) {
+                    if (!is_blocked(hex) && matches(hex.first, hex.second)) {
+                        found.push_back(std::pair<std::pair<int, int>, int>(hex, distance));
+                    }
+                }
+                if (found.size() >= size_t(count)) {
+                    break;
+                }
+                next_level.clear();
+                for (std::pair<int, int> hex : level) {
+                    tile_storage.for_each_neighbor(hex.first, hex.second, [&](int q, int r, HexTile* tile) {
+                        std::pair<int, int> neighbor(q, r);
+                        if (tile && !is_blocked(neighbor) && visited.insert(HexTileStorage::key(q, r)).second) {
+                            next_level.push_back(neighbor);
+                        }
+                    });
+                }
+                level.swap(next_level);
+            }
+        } else {
+            // On wrapping maps a ring can reach a hex again through the seam. Its first ring is its true distance.
+            bool wraps = tile_storage.wraps();
+            std::unordered_set<int64_t> visited{};
+            size_t seen = 0;
+            size_t tile_count = tile_storage.size();
+            // Rings over mostly empty space cost more than one pass over the tiles, so the walk stops once it has covered more cells than there are tiles.
+            size_t walked = 0;
+            int radius = 0;
+            for (; radius <= limit && seen < tile_count && found.size() < size_t(count) && walked <= tile_count; radius++) {
+                auto visit = [&](std::pair<int, int> hex) {
+                    hex = tile_storage.canonicalize(hex);
+                    if ((wraps && !visited.insert(HexTileStorage::key(hex.first, hex.second)).second) || !tile_storage.get(hex.first, hex.second)) {
+                        return;
+                    }
+                    seen++;
+                    if (!is_blocked(hex) && matches(hex.first, hex.second)) {
+                        found.push_back(std::pair<std::pair<int, int>, int>(hex, radius));
+                    }
+                };
+                if (radius == 0) {
+                    visit(origin);
+                } else {
+                    for_each_ring_hex(origin.first, origin.second, radius, visit);
+                }
+                walked += radius == 0 ? 1 : size_t(6) * size_t(radius);
+            }
+            if (radius <= limit && seen < tile_count && found.size() < size_t(count)) {
+                // Every hex closer than the radius has been visited, so the rest are the tiles at the radius or further, nearest first.
+                std::vector<std::pair<std::pair<int, int>, int>> rest{};
+                tile_storage.for_each([&](int q, int r, HexTile*) {
+                    std::pair<int, int> hex(q, r);
+                    int distance = tile_storage.distance(origin, hex);
+                    if (distance >= radius && distance <= limit && !is_blocked(hex) && matches(q, r)) {
+                        rest.push_back(std::pair<std::pair<int, int>, int>(hex, distance));
+                    }
+                });
+                std::stable_sort(rest.begin(), rest.end(), [](const std::pair<std::pair<int, int>, int> &a, const std::pair<std::pair<int, int>, int> &b) {
+                    return a.second < b.second;
+                });
+                found.insert(found.end(), rest.begin(), rest.end());
+            }
+        }
+
+        if (found.size() > size_t(count)) {
+            found.resize(size_t(count));
+        }
+        return found;
+    }
+    /**
+     * @brief Finds the closest hexes whose layer value matches, such as the nearest forest or the nearest free hex. Intended for usage directly from Godot.
+     * 
+     * @param origin The hex to search from.
+     * @param layer_name The name of the layer to test.
+     * @param match How to test the layer value. Typically a LayerMatch enum.
+     * @param value A float for MATCH_EQUALS, an array of floats for MATCH_IN_SET, or an integer mask for MATCH_MASK_BIT.
+     * @param count The amount of matches wanted.
+     * @param max_radius The farthest distance searched. If negative, the search runs until every hex was visited.
+     * @param use_path_distance Whether to measure distance in steps around the blockers instead of in a straight line.
+     * @param blockers The hexes that are never matched, and that cannot be walked through when measuring path distance. Can be null.
+     * @return godot::Array An array containing a dictionary per match, closest first, with the match's coordinates as a Vector2i under "coords" and its distance under "distance".
+     */
+      godot::Array find_nearest(HexTile* origin, const godot::StringName &layer_name, int match, const godot::Variant &value, int count, int max_radius, bool use_path_distance, const godot::Ref<HexRegion> &blockers);
+    /**
+     * @brief Gets the canonical coordinates of a hex passed from Godot, and whether it exists.
+     * 
+     * @param hex The coordinates, q as x and r as y.
+     * @param co_ords Set to the canonical coordinates.
+     * @return bool True if the hex exists.
+     */
+      bool find_existing_hex(godot::Vector2i hex, std::pair<int, int> &co_ords);
+    /**
+     * @brief Gets the coordinates of the existing neighbors of a hex. Works on headless grids. Intended for usage directly from Godot.
+     * 
+     * @param hex The center hex, q as x and r as y.
+     * @return godot::Array An array containing the Vector2i coordinates of the neighbors.
+     */
+      godot::Array get_neighbors_at(godot::Vector2i hex);
+    /**
+     * @brief The same as breadth_first_search_region, from coordinates. Works on headless grids. Intended for usage directly from Godot.
+     * 
+     */
+      godot::Ref<HexRegion> breadth_first_search_region_at(godot::Vector2i origin, const godot::Ref<HexRegion> &pre_visited, const godot::Ref<HexRegion> &into);
+    /**
+     * @brief The same as get_ring_region, from coordinates. Works on headless grids. Intended for usage directly from Godot.
+     * 
+     */
+      godot::Ref<HexRegion> get_ring_region_at(godot::Vector2i center, int radius, const godot::Ref<HexRegion> &into);
+    /**
+     * @brief The same as get_spiral_ring_region, from coordinates. Works on headless grids. Intended for usage directly from Godot.
+     * 
+     */
+      godot::Ref<HexRegion> get_spiral_ring_region_at(godot::Vector2i center, int radius, const godot::Ref<HexRegion> &into);
+    /**
+     * @brief The same as get_cone_region, from coordinates. Works on headless grids. Intended for usage directly from Godot.
+     * 
+     */
+      godot::Ref<HexRegion> get_cone_region_at(godot::Vector2i center, int direction, int radius, const godot::Ref<HexRegion> &into);
+    /**
+     * @brief The same as get_line_region, from coordinates. Works on headless grids. Intended for usage directly from Godot.
+     * 
+     */
+      godot::Ref<HexRegion> get_line_region_at(godot::Vector2i hex_one, godot::Vector2i hex_two, bool make_symmetric, const godot::Ref<HexRegion> &into);
+    /**
+     * @brief The same as get_field_of_view, from coordinates. Works on headless grids. Intended for usage directly from Godot.
+     * 
+     */
+      godot::Ref<HexRegion> get_field_of_view_at(godot::Vector2i origin, int radius, const godot::Ref<HexRegion> &blockers, const godot::Ref<HexRegion> &into);
+    /**
+     * @brief The same as has_line_of_sight, from coordinates. Works on headless grids. Intended for usage directly from Godot.
+     * 
+     */
+      bool has_line_of_sight_at(godot::Vector2i from, godot::Vector2i to, const godot::Ref<HexRegion> &blockers);
+    /**
+     * @brief The same as find_path, from coordinates. Works on headless grids. Intended for usage directly from Godot.
+     * 
+     * @return godot::Array An array containing the Vector2i coordinates of the path, from the start to the goal. Empty if there is none.
+     */
+      godot::Array find_path_at(godot::Vector2i from, godot::Vector2i to, const godot::StringName &cost_layer, const godot::Ref<HexRegion> &blockers, int mode);
+    /**
+     * @brief The same as find_smooth_path, from coordinates. Works on headless grids. Intended for usage directly from Godot.
+     * 
+     */
+      godot::PackedVector3Array find_smooth_path_at(godot::Vector2i from, godot::Vector2i to, const godot::StringName &cost_layer, const godot::Ref<HexRegion> &blockers, int mode);
+    /**
+     * @brief The same as find_nearest, from coordinates. Works on headless grids. Intended for usage directly from Godot.
+     * 
+     */
+      godot::Array find_nearest_at(godot::Vector2i origin, const godot::StringName &layer_name, int match, const godot::Variant &value, int count, int max_radius, bool use_path_distance, const godot::Ref<HexRegion> &blockers);
+    /**
+     * @brief Compiles the passable hexes into an adjacency snapshot, for searches and graph algorithms that run over flat arrays. Intended for usage directly from Godot.
+     * 
+     * @param cost_layer The name of the layer holding the cost of entering each hex, clamped to at least 1. Negative values leave the hex out. If empty, every step costs 1.
+     * @param blockers The hexes left out of the graph. Can be null.
+     * @return godot::Ref<HexGraph> The graph. It does not follow the grid, report changes with its update_hex.
+     */
+      godot::Ref<HexGraph> build_graph(const godot::StringName &cost_layer, const godot::Ref<HexRegion> &blockers);
+    /**
+     * @brief Deletes a hex at the given coordinates, if it exists. The hex is parked in its scene's pool, or queue freed if pooling is disabled or the pool is full. Intended for usage directly from Godot.
      * 
      * @param q The q-coordinate to delete at.
      * @param r The r-coordinate to delete at.
@@ -469,13 +1604,302 @@ public:
      */
       HexTile* replace_hex(int q, int r, bool connect_mouse_signals, const godot::Ref<godot::PackedScene> &tile_to_replace_with);
 public:
+    /**
+     * @brief Adds a data layer that holds one float per cell. Layers are independent of tiles, any coordinate can hold a value. Intended for usage directly from Godot.
+     * 
+     * @param name The name of the layer.
+     * @param default_value The value of cells that were never written.
+     */
+    void add_layer(const godot::StringName &name, float default_value);
+    /**
+     * @brief Removes a data layer and all of its values.
+     * 
+     * @param name The name of the layer.
+     */
+    void remove_layer(const godot::StringName &name);
+    /**
+     * @brief Checks if a data layer exists.
+     * 
+     * @param name The name of the layer.
+     * @return bool True if the layer exists.
+     */
+    bool has_layer(const godot::StringName &name);
+    /**
+     * @brief Gets the names of every data layer.
+     * 
+     * @return godot::Array An array of StringNames.
+     */
+    godot::Array get_layer_names();
+    /**
+     * @brief Sets the value of a cell in a data layer.
+     * 
+     * @param name The name of the layer.
+     * @param q The q-coordinate.
+     * @param r The r-coordinate.
+     * @param value The new value.
+     */
+    void set_layer_value(const godot::StringName &name, int q, int r, float value);
+    /**
+     * @brief Gets the value of a cell in a data layer.
+     * 
+     * @param name The name of the layer.
+     * @param q The q-coordinate.
+     * @param r The r-coordinate.
+     * @return float The value, or the layer's default value if the cell was never written.
+     */
+    float get_layer_value(const godot::StringName &name, int q, int r);
+    /**
+     * @brief Resets every cell of a data layer to its default value.
+     * 
+     * @param name The name of the layer.
+     */
+    void clear_layer(const godot::StringName &name);
+    /**
+     * @brief Gets the storage of a data layer, for native code working on whole chunks.
+     * 
+     * @param name The name of the layer.
+     * @return HexLayer* The layer, or null if it does not exist.
+     */
+    HexLayer* find_layer(const godot::StringName &name);
+    /**
+     * @brief Gets a layer's summed-area table, brought up to date with the cells and tiles that changed since it was last used.
+     * 
+     * @param name The name of the layer.
+     * @return HexAreaSums* The table, or null if the layer does not exist.
+     */
+    HexAreaSums* sync_area_sums(const godot::StringName &name);
+    /**
+     * @brief Sums a layer over a run of cells in one row, at their canonical coordinates.
+     * 
+     */
+    double sum_layer_row(const HexAreaSums &sums, const HexLayer &layer, int r, int q_from, int q_to);
+    /**
+     * @brief Sums a layer over the hexes in a hexagon, without visiting them. The sums are kept in a table that is updated with what changed since the last sum, so repeated sums cost O(radius). Intended for usage directly from Godot.
+     * 
+     * @param name The name of the layer.
+     * @param center The hexagon's center, q as x and r as y.
+     * @param radius The hexagon's radius.
+     * @return double The sum of the layer over every hex in the hexagon. Cells without a hex count as zero.
+     */
+    double get_layer_sum_hexagon(const godot::StringName &name, godot::Vector2i center, int radius);
+    /**
+     * @brief Sums a layer over the hexes in a parallelogram of q and r, without visiting them. Costs O(1) on a map that does not wrap, and O(size.y) on one that does. Intended for usage directly from Godot.
+     * 
+     * @param name The name of the layer.
+     * @param corner The corner with the lowest q and r.
+     * @param size The amount of q-coordinates as x, and of r-coordinates as y.
+     * @return double The sum of the layer over every hex in the parallelogram. Cells without a hex count as zero.
+     */
+    double get_layer_sum_parallelogram(const godot::StringName &name, godot::Vector2i corner, godot::Vector2i size);
+    /**
+     * @brief Gets a layer's summaries, brought up to date with the cells and tiles that changed since they were last used. Only the parents above a change are recomputed.
+     * 
+     * @param name The name of the layer.
+     * @param level The highest level needed.
+     * @return const HexLayerHierarchy* The summaries, or null if the layer does not exist or the level is out of range.
+     */
+    const HexLayerHierarchy* sync_layer_hierarchy(const godot::StringName &name, int level);
+    /**
+     * @brief Gets the aperture-7 parent a hex belongs to. Every parent covers a hex and its six neighbors on the level below. Intended for usage directly from Godot.
+     * 
+     * @param hex The hex, q as x and r as y.
+     * @param levels How many levels to go up.
+     * @return godot::Vector2i The parent's coordinates on its level.
+     */
+    godot::Vector2i get_parent_hex(godot::Vector2i hex, int levels);
+    /**
+     * @brief Gets the seven children of an aperture-7 parent, on the level below. Intended for usage directly from Godot.
+     * 
+     * @param parent The parent's coordinates, q as x and r as y.
+     * @return godot::Array An array containing the Vector2i coordinates of the children, the center first.
+     */
+    godot::Array get_child_hexes(godot::Vector2i parent);
+    /**
+     * @brief Gets the hex at the center of an aperture-7 parent, for placing it on the map. Intended for usage directly from Godot.
+     * 
+     * @param parent The parent's coordinates, q as x and r as y.
+     * @param level The parent's level.
+     * @return godot::Vector2i The coordinates of the hex at its center.
+     */
+    godot::Vector2i get_parent_center(godot::Vector2i parent, int level);
+    /**
+     * @brief Summarizes a layer over the hexes under an aperture-7 parent. Summaries are kept per level and only the parents above a change are recomputed, so coarse views read a few parents instead of every hex. Intended for usage directly from Godot.
+     * 
+     * @param name The name of the layer.
+     * @param level The parent's level, from 1 to 12.
+     * @param parent The parent's coordinates, q as x and r as y.
+     * @return godot::Dictionary The "sum", "count", "average", "min" and "max" of the layer over the hexes under the parent. Empty if there are none.
+     */
+    godot::Dictionary get_layer_aggregate(const godot::StringName &name, int level, godot::Vector2i parent);
+    /**
+     * @brief Summarizes a layer over every aperture-7 parent of a level that has hexes under it. Intended for usage directly from Godot.
+     * 
+     * @param name The name of the layer.
+     * @param level The level, from 1 to 12.
+     * @param statistic What to summarize. Typically a LayerStatistic enum.
+     * @return godot::Dictionary A dictionary that maps the Vector2i coordinates of each parent to its statistic.
+     */
+    godot::Dictionary get_layer_aggregates(const godot::StringName &name, int level, int statistic);
+    /**
+     * @brief Gets a layer's texture, brought up to date with the cells and tiles that changed since it was last used, and repacked into a larger box if tiles appeared outside it.
+     * 
+     * @param name The name of the layer.
+     * @return LayerTexture* The texture, or null if the layer does not exist or its tiles span more than 16384 hexes along q or r, or 4096 * 4096 hexes in all.
+     */
+    LayerTexture* sync_layer_texture(const godot::StringName &name);
+    /**
+     * @brief Packs a layer into a single channel float image, one pixel per hex, without touching the GPU. The pixel of a hex is at (q, r) minus the corner from get_layer_texture_rect. Works on headless grids and servers. Intended for usage directly from Godot.
+     * 
+     * @param name The name of the layer.
+     * @return godot::Ref<godot::Image> The image, in Image.FORMAT_RF. Cells without a hex are zero.
+     */
+    godot::Ref<godot::Image> get_layer_image(const godot::StringName &name);
+    /**
+     * @brief Gets a texture of a layer, for one shader to color every tile with, instead of a material per tile. Only the cells that changed since the last call are repacked, and the texture is uploaded once per call, only if something changed. The same texture is returned every time, so a material keeps it across updates. Sample it with filter_nearest. Intended for usage directly from Godot.
+     * 
+     * @param name The name of the layer.
+     * @return godot::Ref<godot::ImageTexture> The texture, laid out as get_layer_image.
+     */
+    godot::Ref<godot::ImageTexture> get_layer_texture(const godot::StringName &name);
+    /**
+     * @brief Gets where a layer's texture lies in axial coordinates, to pass to its shader. A hex's texel is at UV ((q, r) - position + 0.5) / size, after wrapping it to its canonical coordinates. Intended for usage directly from Godot.
+     * 
+     * @param name The name of the layer.
+     * @return godot::Vector4 The lowest q and r of the texture as x and y, and its width and height in hexes as z and w.
+     */
+    godot::Vector4 get_layer_texture_rect(const godot::StringName &name);
+    /**
+     * @brief Gets the storage of the tiles, for native code that walks the map itself.
+     * 
+     * @return const HexTileStorage& The storage.
+     */
+    const HexTileStorage &get_tile_storage() const;
+    /**
+     * @brief Checks if a path can enter a hex.
+     * 
+     * @param q The canonical q-coordinate.
+     * @param r The canonical r-coordinate.
+     * @param cost_layer Negative values are impassable. Can be null.
+     * @param blockers The hexes that cannot be entered. Can be null.
+     * @return bool True if the hex exists and is neither blocked nor negative on the cost layer.
+     */
+    bool is_hex_passable(int q, int r, const HexLayer* cost_layer, const HexRegion* blockers) const;
+    /**
+     * @brief Records that a chunk of a layer was written directly, bypassing set_layer_value, so deltas pick it up.
+     * 
+     * @param name The layer's name.
+     * @param key The chunk's key.
+     * @param previous The chunk's values before the write, to only record the cells that differ. If null, every cell is recorded.
+     * @param changed_cells If not null, the recorded cells are added to it, for the layer_region_changed signal.
+     */
+    void mark_layer_chunk(const godot::StringName &name, int64_t key, const HexLayer::Chunk* previous, HexRegion* changed_cells = nullptr);
+    /**
+     * @brief Gets the revision of the latest change to the tiles or layers. Intended for usage directly from Godot.
+     * 
+     * @return int64_t The revision, zero if nothing changed yet.
+     */
+    int64_t get_revision();
+    /**
+     * @brief Encodes every change since a revision into a compact delta: tiles spawned, deleted or replaced, layer cells that changed, and layers added or removed. Only chunks that changed are visited, so the cost follows the changes rather than the map. Intended for usage directly from Godot.
+     * 
+     * @param from_revision The revision the receiver is at. Zero encodes the whole grid.
+     * @return godot::PackedByteArray The delta, up to the current revision.
+     */
+    godot::PackedByteArray encode_delta(int64_t from_revision);
+    /**
+     * @brief Applies a delta from encode_delta. Tiles that were spawned on a hex the grid already has are replaced. The tiles' scenes are not part of the delta, so they come from this grid. Intended for usage directly from Godot.
+     * 
+     * @param delta The delta.
+     * @param connect_mouse_signals Whether or not to connect the mouse signals of spawned tiles.
+     * @param tile_to_spawn An optional custom tile. Can be null.
+     * @return int64_t The revision of the grid the delta came from, to encode the next delta from. -1 if the delta is malformed, in which case nothing is applied.
+     */
+    int64_t apply_delta(const godot::PackedByteArray &delta, bool connect_mouse_signals, const godot::Ref<godot::PackedScene> &tile_to_spawn);
+    /**
+     * @brief Publishes the grid's current tiles, layers and lines of sight as a snapshot that worker threads can query while the grid keeps changing. Only chunks that changed since the previous snapshot are copied, the rest are shared with it. Call it from the thread that changes the grid, then hand the snapshot to the jobs. Intended for usage directly from Godot.
+     * 
+     * @return godot::Ref<HexGridSnapshot> The snapshot. The previous one if nothing changed since.
+     */
+    godot::Ref<HexGridSnapshot> publish_snapshot();
+    /**
+     * @brief Queues a spawn_hex, to be applied by the next flush_commands. Safe to call from any thread. Intended for usage directly from Godot.
+     * 
+     * @param q The q-coordinate.
+     * @param r The r-coordinate.
+     */
+    void queue_spawn_hex(int q, int r);
+    /**
+     * @brief Queues a replace_hex, to be applied by the next flush_commands. Safe to call from any thread. Intended for usage directly from Godot.
+     * 
+     * @param q The q-coordinate.
+     * @param r The r-coordinate.
+     */
+    void queue_replace_hex(int q, int r);
+    /**
+     * @brief Queues a delete_hex, to be applied by the next flush_commands. Safe to call from any thread. Intended for usage directly from Godot.
+     * 
+     * @param q The q-coordinate.
+     * @param r The r-coordinate.
+     */
+    void queue_delete_hex(int q, int r);
+    /**
+     * @brief Queues a set_layer_value, to be applied by the next flush_commands. Safe to call from any thread. Intended for usage directly from Godot.
+     * 
+     * @param name The layer's name.
+     * @param q The q-coordinate.
+     * @param r The r-coordinate.
+     * @param value The new value.
+     */
+    void queue_layer_value(const godot::StringName &name, int q, int r, float value);
+    /**
+     * @brief Checks if any command is waiting for flush_commands. Intended for usage directly from Godot.
+     * 
+     * @return bool True if a command is queued.
+     */
+    bool has_queued_commands() const;
+    /**
+     * @brief Applies every queued command in one batch, sorted by chunk. The commands queued for a hex are folded into one net spawn, replace or delete, so a delete then spawn of an existing hex replaces it and a spawn then delete of an empty hex does nothing. Within that, a spawn is skipped if the hex exists by then, and a replace or delete if it does not. Only the last value queued for a layer cell is applied. Instead of a signal per hex, commands_flushed is emitted once. Must be called on the main thread. Intended for usage directly from Godot.
+     * 
+     * @param connect_mouse_signals Whether or not to connect the mouse signals of spawned tiles.
+     * @param tile_to_spawn An optional custom tile for spawned and replaced hexes. Can be null.
+     * @return int The amount of net tile changes and layer values applied.
+     */
+    int flush_commands(bool connect_mouse_signals, const godot::Ref<godot::PackedScene> &tile_to_spawn);
+    /**
+     * @brief Applies a batch of commands, as flush_commands does, and emits commands_flushed once.
+     * 
+     * @param commands The commands, in the order they were given. Sorted in place.
+     * @param connect_mouse_signals Whether or not to connect the mouse signals of spawned tiles.
+     * @param tile_to_spawn The tile for commands that have none of their own. Can be null.
+     * @return int The amount of net tile changes and layer values applied.
+     */
+    int apply_commands(std::vector<HexCommandBuffer::Command> &commands, bool connect_mouse_signals, const godot::Ref<godot::PackedScene> &tile_to_spawn);
+    /**
+     * @brief Stamps a pattern onto the grid, mirrored and then rotated around its anchor. Every tile and layer value is applied in one batch like flush_commands, emitting commands_flushed once. Intended for usage directly from Godot.
+     * 
+     * @param pattern The pattern.
+     * @param anchor Where the pattern's origin lands, q as x and r as y.
+     * @param num_and_direction The amount and direction to rotate in. Positive is clockwise, negative is counter clockwise.
+     * @param mirror_type How to mirror the pattern before rotating. Typically a MirrorType enum, or -1 to not mirror.
+     * @param dry_run If true, nothing is changed, and only the overlap is returned.
+     * @param connect_mouse_signals Whether or not to connect the mouse signals of spawned tiles.
+     * @param tile_to_spawn The tile for cells without one of their own. Can be null.
+     * @return godot::Ref<HexRegion> The hexes that existed where the pattern places tiles, before it was stamped.
+     */
+    godot::Ref<HexRegion> stamp_pattern(const godot::Ref<HexPattern> &pattern, godot::Vector2i anchor, int num_and_direction, int mirror_type, bool dry_run, bool connect_mouse_signals, const godot::Ref<godot::PackedScene> &tile_to_spawn);
+    /**
+     * @brief Plans one agent of group_planner's current tier. Run on the WorkerThreadPool.
+     * 
+     * @param index The index into the tier.
+     */
+    void plan_group_task(uint32_t index);
     /**
      * @brief Gets the neighboring hexes.
      * 
      * @param center_hex the center hex to get neighbors from.
-     * @return std::vector<std::pair<int, int>> The neighboring hexes.
+     * @return std::array<std::pair<int, int>, 6> The neighboring hexes.
      */
-    std::vector<std::pair<int, int>> get_neighbors(std::pair<int, int> center_hex);
+    std::array<std::pair<int, int>, 6> get_neighbors(std::pair<int, int> center_hex);
     /**
      * @brief Gets the neighboring hexes. Intended for usage directly from Godot.
      * 
@@ -487,9 +1911,9 @@ public:
      * @brief Gets the diagonal hexes.
      * 
      * @param center_hex the center hex to get diagonals from.
-     * @return std::vector<std::pair<int, int>> The diagonal hexes.
+     * @return std::array<std::pair<int, int>, 6> The diagonal hexes.
      */
-    std::vector<std::pair<int, int>> get_diagonals(std::pair<int, int> center_hex);
+    std::array<std::pair<int, int>, 6> get_diagonals(std::pair<int, int> center_hex);
     /**
      * @brief Gets the diagonal hexes. Intended for usage directly from Godot.
      * 
@@ -0,0 +1,77 @@
+/**
+ * @file HexGridProfiler.h
+ * @brief Counters and scoped timers for the HexGrid hot paths.
+ * @details Everything in here compiles away unless HEX_GRID_PROFILING is defined. Build with "scons hex_grid_profiling=yes" to enable it.
+ * @version 1.0
+ *
+ *
+ *
+ */
+#ifndef GODOT_HEX_GRID_EXTENSION_HEX_GRID_PROFILER_H
+#define GODOT_HEX_GRID_EXTENSION_HEX_GRID_PROFILER_H
+
+#ifdef HEX_GRID_PROFILING
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+/**
+ * @brief The accumulated stats for one instrumented code path. Atomics so that queries running on worker threads can be counted too.
+ *
+ */
+struct HexGridProfileCounter {
+    /// @brief The amount of calls.
+    std::atomic<uint64_t> calls{};
+    /// @brief The total time spent, in nanoseconds. Lookups take well under a microsecond each, so they are only converted when read.
+    std::atomic<int64_t> total_nsec{};
+    /// @brief The longest single call, in nanoseconds.
+    std::atomic<int64_t> max_nsec{};
+    /// @brief The amount of tiles visited. Only used by searches.
+    std::atomic<uint64_t> tiles_visited{};
+
+    /**
+     * @brief Resets every stat to zero.
+     *
+     */
+    void reset() {
+        calls = 0;
+        total_nsec = 0;
+        max_nsec = 0;
+        tiles_visited = 0;
+    }
+};
+
+/**
+ * @brief Times the scope it lives in and adds the result to a counter when it goes out of scope.
+ *
+ */
+class HexGridProfileScope {
+    HexGridProfileCounter &counter;
+    std::chrono::steady_clock::time_point start;
+
+public:
+    explicit HexGridProfileScope(HexGridProfileCounter &counter) : counter(counter), start(std::chrono::steady_clock::now()) {}
+
+    ~HexGridProfileScope() {
+        int64_t elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+        counter.calls.fetch_add(1, std::memory_order_relaxed);
+        counter.total_nsec.fetch_add(elapsed, std::memory_order_relaxed);
+
+        int64_t previous_max = counter.max_nsec.load(std::memory_order_relaxed);
+        while (elapsed > previous_max && !counter.max_nsec.compare_exchange_weak(previous_max, elapsed, std::memory_order_relaxed)) {
+        }
+    }
+};
+
+#define HEX_GRID_PROFILE_SCOPE(counter) HexGridProfileScope hex_grid_profile_scope(counter)
+#define HEX_GRID_PROFILE_VISITS(counter, count) (counter).tiles_visited.fetch_add((count), std::memory_order_relaxed)
+
+#else
+
+#define HEX_GRID_PROFILE_SCOPE(counter) ((void)0)
+#define HEX_GRID_PROFILE_VISITS(counter, count) ((void)0)
+
+#endif //HEX_GRID_PROFILING
+
+#endif //GODOT_HEX_GRID_EXTENSION_HEX_GRID_PROFILER_H
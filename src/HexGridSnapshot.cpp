@@ -0,0 +1,232 @@
+#include "HexGridSnapshot.h"
+#include "HexGrid.h"
+#include "HexPathfinder.h"
+#include "HexShapes.h"
+#include "godot_cpp/core/class_db.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
+
+namespace {
+	godot::Ref<HexRegion> output_region(const godot::Ref<HexRegion> &into) {
+		if (into.is_valid()) {
+			return into;
+		}
+		godot::Ref<HexRegion> region;
+		region.instantiate();
+		return region;
+	}
+}
+
+HexGridSnapshot::HexGridSnapshot() {
+
+}
+
+const HexGridSnapshot::LayerView* HexGridSnapshot::find_layer(const godot::StringName &name) const {
+	auto layer = layers.find(name);
+	return layer == layers.end() ? nullptr : &layer->second;
+}
+
+float HexGridSnapshot::get_value(const LayerView &layer, int q, int r) const {
+	auto chunk = layer.chunks.find(hex_chunk_key_of(q, r));
+	return chunk == layer.chunks.end() ? layer.default_value : (*chunk->second)[hex_chunk_cell(q, r)];
+}
+
+bool HexGridSnapshot::has_tile(int q, int r) const {
+	auto chunk = tiles.find(hex_chunk_key_of(q, r));
+	if (chunk == tiles.end()) {
+		return false;
+	}
+	int cell = hex_chunk_cell(q, r);
+	return ((*chunk->second)[cell >> 6] >> (cell & 63)) & 1;
+}
+
+bool HexGridSnapshot::find_existing_hex(godot::Vector2i hex, std::pair<int, int> &co_ords) const {
+	co_ords = layout->canonicalize(std::pair<int, int>(hex.x, hex.y));
+	return has_tile(co_ords.first, co_ords.second);
+}
+
+bool HexGridSnapshot::is_passable(int q, int r, const LayerView* cost_layer, const HexRegion* blockers) const {
+	if (!has_tile(q, r)) {
+		return false;
+	}
+	if (blockers && blockers->has_hex(q, r)) {
+		return false;
+	}
+	return !cost_layer || get_value(*cost_layer, q, r) >= 0.0f;
+}
+
+int64_t HexGridSnapshot::get_revision() const {
+	return int64_t(revision);
+}
+
+bool HexGridSnapshot::has_hex(int q, int r) const {
+	ERR_FAIL_COND_V_MSG(!layout, false, "Snapshots have to be published by a grid.");
+	std::pair<int, int> hex{};
+	return find_existing_hex(godot::Vector2i(q, r), hex);
+}
+
+bool HexGridSnapshot::has_layer(const godot::StringName &name) const {
+	return find_layer(name) != nullptr;
+}
+
+float HexGridSnapshot::get_layer_value(const godot::StringName &name, int q, int r) const {
+	const LayerView* layer = find_layer(name);
+	ERR_FAIL_NULL_V_MSG(layer, 0.0f, "Cannot get a value from a non-existing layer.");
+	return get_value(*layer, q, r);
+}
+
+godot::Array HexGridSnapshot::get_neighbors(godot::Vector2i hex) const {
+	godot::Array return_array = godot::Array();
+	ERR_FAIL_COND_V_MSG(!layout, return_array, "Snapshots have to be published by a grid.");
+	std::pair<int, int> co_ords{};
+	ERR_FAIL_COND_V_MSG(!find_existing_hex(hex, co_ords), return_array, "Cannot get neighbors on non-existing hex.");
+
+	layout->for_each_neighbor(co_ords.first, co_ords.second, [this, &return_array](int q, int r, HexTile*) {
+		if (has_tile(q, r)) {
+			return_array.append(godot::Vector2i(q, r));
+		}
+	});
+	return return_array;
+}
+
+godot::Ref<HexRegion> HexGridSnapshot::breadth_first_search_region(godot::Vector2i origin, const godot::Ref<HexRegion> &pre_visited, const godot::Ref<HexRegion> &into) const {
+	ERR_FAIL_COND_V_MSG(!layout, godot::Ref<HexRegion>(), "Snapshots have to be published by a grid.");
+	std::pair<int, int> start{};
+	ERR_FAIL_COND_V_MSG(!find_existing_hex(origin, start), godot::Ref<HexRegion>(), "Origin hex does not exist.");
+	ERR_FAIL_COND_V_MSG(pre_visited.is_valid() && pre_visited->has_hex(start.first, start.second), godot::Ref<HexRegion>(), "Origin cannot be in pre-visited region, search will simply return nothing.");
+
+	godot::Ref<HexRegion> region = output_region(into);
+	godot::Ref<HexRegion> visited = pre_visited.is_valid() ? pre_visited->copy() : output_region(nullptr);
+
+	std::vector<std::pair<int, int>> queue{};
+	queue.push_back(start);
+	visited->add_hex(start.first, start.second);
+	while (!queue.empty()) {
+		std::pair<int, int> hex = queue.back();
+		queue.pop_back();
+		region->add_hex(hex.first, hex.second);
+
+		layout->for_each_neighbor(hex.first, hex.second, [this, &queue, &visited](int q, int r, HexTile*) {
+			if (has_tile(q, r) && !visited->has_hex(q, r)) {
+				visited->add_hex(q, r);
+				queue.push_back(std::pair<int, int>(q, r));
+			}
+		});
+	}
+	return region;
+}
+
+godot::Ref<HexRegion> HexGridSnapshot::get_field_of_view(godot::Vector2i origin, int radius, const godot::Ref<HexRegion> &blockers, const godot::Ref<HexRegion> &into) const {
+	ERR_FAIL_COND_V_MSG(!layout, godot::Ref<HexRegion>(), "Snapshots have to be published by a grid.");
+	std::pair<int, int> start{};
+	ERR_FAIL_COND_V_MSG(!find_existing_hex(origin, start), godot::Ref<HexRegion>(), "Cannot look from a non-existing hex.");
+	ERR_FAIL_COND_V_MSG(radius < 0, godot::Ref<HexRegion>(), "Radius cannot be less than zero.");
+	ERR_FAIL_COND_V_MSG(radius > visibility->get_radius(), godot::Ref<HexRegion>(), "Radius is larger than the grid had prepared, call prepare_visibility before publishing.");
+
+	godot::Ref<HexRegion> region = output_region(into);
+	const HexRegion* blocker_region = blockers.ptr();
+	auto is_blocked = [this, start, blocker_region](int dq, int dr) {
+		if (!blocker_region) {
+			return false;
+		}
+		std::pair<int, int> hex = layout->canonicalize(std::pair<int, int>(start.first + dq, start.second + dr));
+		return blocker_region->has_hex(hex.first, hex.second);
+	};
+	visibility->walk(radius, is_blocked, [this, start, &region](int dq, int dr) {
+		std::pair<int, int> hex = layout->canonicalize(std::pair<int, int>(start.first + dq, start.second + dr));
+		if (has_tile(hex.first, hex.second)) {
+			region->add_hex(hex.first, hex.second);
+		}
+	});
+	return region;
+}
+
+bool HexGridSnapshot::has_line_of_sight(godot::Vector2i from, godot::Vector2i to, const godot::Ref<HexRegion> &blockers) const {
+	ERR_FAIL_COND_V_MSG(!layout, false, "Snapshots have to be published by a grid.");
+	std::pair<int, int> origin{};
+	std::pair<int, int> target{};
+	ERR_FAIL_COND_V_MSG(!find_existing_hex(from, origin), false, "Cannot look from a non-existing hex.");
+	ERR_FAIL_COND_V_MSG(!find_existing_hex(to, target), false, "Cannot look at a non-existing hex.");
+
+	target = layout->nearest_copy(origin, target);
+	int dq = target.first - origin.first;
+	int dr = target.second - origin.second;
+
+	const HexRegion* blocker_region = blockers.ptr();
+	if (!blocker_region) {
+		return true;
+	}
+	auto is_blocked = [this, origin, blocker_region](int offset_q, int offset_r) {
+		std::pair<int, int> hex = layout->canonicalize(std::pair<int, int>(origin.first + offset_q, origin.second + offset_r));
+		return blocker_region->has_hex(hex.first, hex.second);
+	};
+
+	if ((std::abs(dq) + std::abs(dr) + std::abs(dq + dr)) / 2 <= visibility->get_radius()) {
+		return visibility->is_line_clear(dq, dr, is_blocked);
+	}
+
+	HexLineRange line(std::pair<int, int>(0, 0), std::pair<int, int>(dq, dr), true);
+	size_t length = size_t(line.size());
+	size_t index = 0;
+	for (std::pair<int, int> hex : line) {
+		if (index > 0 && index + 1 < length && is_blocked(hex.first, hex.second)) {
+			return false;
+		}
+		index++;
+	}
+	return true;
+}
+
+godot::Array HexGridSnapshot::find_path(godot::Vector2i from, godot::Vector2i to, const godot::StringName &cost_layer, const godot::Ref<HexRegion> &blockers, int mode) const {
+	godot::Array return_array = godot::Array();
+	ERR_FAIL_COND_V_MSG(!layout, return_array, "Snapshots have to be published by a grid.");
+	ERR_FAIL_COND_V_MSG((mode < HexGrid::PATH_A_STAR) || (mode > HexGrid::PATH_JUMP_POINT), return_array, "Invalid path mode.");
+	std::pair<int, int> start{};
+	std::pair<int, int> goal{};
+	ERR_FAIL_COND_V_MSG(!find_existing_hex(from, start), return_array, "Cannot path from a non-existing hex.");
+	ERR_FAIL_COND_V_MSG(!find_existing_hex(to, goal), return_array, "Cannot path to a non-existing hex.");
+
+	const LayerView* layer = nullptr;
+	if (cost_layer != godot::StringName()) {
+		layer = find_layer(cost_layer);
+		ERR_FAIL_NULL_V_MSG(layer, return_array, "Cannot path over a non-existing cost layer.");
+	}
+
+	const HexRegion* blocker_region = blockers.ptr();
+	auto is_hex_passable = [this, layer, blocker_region](int q, int r) {
+		return is_passable(q, r, layer, blocker_region);
+	};
+
+	std::vector<std::pair<int, int>> path{};
+	HexPathfinder pathfinder(*layout);
+	if (mode == HexGrid::PATH_JUMP_POINT) {
+		pathfinder.find_jump_path(start, goal, is_hex_passable, path);
+	} else if (layer) {
+		pathfinder.find_path(start, goal, is_hex_passable, [this, layer](int q, int r) {
+			return std::max(get_value(*layer, q, r), 1.0f);
+		}, path);
+	} else {
+		pathfinder.find_path(start, goal, is_hex_passable, [](int, int) {
+			return 1.0f;
+		}, path);
+	}
+
+	for (std::pair<int, int> hex : path) {
+		return_array.append(godot::Vector2i(hex.first, hex.second));
+	}
+	return return_array;
+}
+
+void HexGridSnapshot::_bind_methods() {
+	godot::ClassDB::bind_method(godot::D_METHOD("get_revision"), &HexGridSnapshot::get_revision);
+	godot::ClassDB::bind_method(godot::D_METHOD("has_hex", "q", "r"), &HexGridSnapshot::has_hex);
+	godot::ClassDB::bind_method(godot::D_METHOD("has_layer", "name"), &HexGridSnapshot::has_layer);
+	godot::ClassDB::bind_method(godot::D_METHOD("get_layer_value", "name", "q", "r"), &HexGridSnapshot::get_layer_value);
+	godot::ClassDB::bind_method(godot::D_METHOD("get_neighbors", "hex"), &HexGridSnapshot::get_neighbors);
+	godot::ClassDB::bind_method(godot::D_METHOD("breadth_first_search_region", "origin", "pre_visited_region", "into"), &HexGridSnapshot::breadth_first_search_region, DEFVAL(nullptr), DEFVAL(nullptr));
+	godot::ClassDB::bind_method(godot::D_METHOD("get_field_of_view", "origin", "radius", "blockers", "into"), &HexGridSnapshot::get_field_of_view, DEFVAL(nullptr), DEFVAL(nullptr));
+	godot::ClassDB::bind_method(godot::D_METHOD("has_line_of_sight", "from", "to", "blockers"), &HexGridSnapshot::has_line_of_sight, DEFVAL(nullptr));
+	godot::ClassDB::bind_method(godot::D_METHOD("find_path", "from", "to", "cost_layer", "blockers", "mode"), &HexGridSnapshot::find_path, DEFVAL(godot::StringName()), DEFVAL(nullptr), DEFVAL(HexGrid::PATH_A_STAR));
+}
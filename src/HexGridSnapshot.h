@@ -0,0 +1,155 @@
+/**
+ * @file HexGridSnapshot.h
+ * @brief An immutable view of a HexGrid's tiles and layers, safe to query from any thread while the grid keeps changing.
+ * @details Snapshots are published by HexGrid.publish_snapshot. A new snapshot shares every chunk that did not change since the previous one, and only copies the ones that did, so publishing costs what changed rather than the whole map. Chunks are held by shared pointers, so a chunk is freed once the last snapshot using it is dropped, whichever thread drops it.
+ * @version 1.0
+ *
+ *
+ *
+ */
+#ifndef GODOT_HEX_GRID_EXTENSION_HEX_GRID_SNAPSHOT_H
+#define GODOT_HEX_GRID_EXTENSION_HEX_GRID_SNAPSHOT_H
+
+#include "godot_cpp/classes/ref_counted.hpp"
+#include "godot_cpp/core/object.hpp"
+#include "HexLayer.h"
+#include "HexRegion.h"
+#include "HexTileStorage.h"
+#include "HexVisibilityTrie.h"
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+
+/// @brief The state of a HexGrid at one revision. Nothing in it changes after it is published, so it can be handed to WorkerThreadPool jobs without locks.
+class HexGridSnapshot : public godot::RefCounted
+{
+    GDCLASS(HexGridSnapshot, godot::RefCounted)
+    // Filled in by HexGrid.publish_snapshot, before anyone else can see it.
+    friend class HexGrid;
+
+    /**
+     * @brief Which cells of a chunk hold a tile, one bit per cell.
+     *
+     */
+    using TileChunk = std::array<uint64_t, HEX_CHUNK_WORDS>;
+    /**
+     * @brief The values of one layer.
+     *
+     */
+    struct LayerView {
+        float default_value{};
+        /// @brief The revision the layer was added at, so a layer removed and added again is not mistaken for the old one.
+        uint64_t created{};
+        std::unordered_map<int64_t, std::shared_ptr<const HexLayer::Chunk>> chunks{};
+    };
+    struct StringNameHasher {
+        size_t operator()(const godot::StringName &name) const { return name.hash(); }
+    };
+
+    /**
+     * @brief The grid's revision when the snapshot was published.
+     *
+     */
+    uint64_t revision{};
+    /**
+     * @brief An empty storage with the grid's map shape, used for neighbors, wrapping and distances. Shared until the map changes.
+     *
+     */
+    std::shared_ptr<const HexTileStorage> layout{};
+    /**
+     * @brief A map that maps a chunk key to the cells in it that hold a tile. Chunks without tiles are left out.
+     *
+     */
+    std::unordered_map<int64_t, std::shared_ptr<const TileChunk>> tiles{};
+    /**
+     * @brief A map that maps a layer name to its values.
+     *
+     */
+    std::unordered_map<godot::StringName, LayerView, StringNameHasher> layers{};
+    /**
+     * @brief The grid's lines of sight when the snapshot was published.
+     *
+     */
+    std::shared_ptr<const HexVisibilityTrie> visibility{};
+
+    /**
+     * @brief Binds methods for usage in Godot.
+     *
+     */
+    static void _bind_methods();
+    const LayerView* find_layer(const godot::StringName &name) const;
+    float get_value(const LayerView &layer, int q, int r) const;
+    /**
+     * @brief Checks if a tile is stored at canonical coordinates.
+     *
+     */
+    bool has_tile(int q, int r) const;
+    /**
+     * @brief Gets the canonical coordinates of a hex passed from Godot, and whether it exists.
+     *
+     */
+    bool find_existing_hex(godot::Vector2i hex, std::pair<int, int> &co_ords) const;
+    /**
+     * @brief The same as HexGrid.is_hex_passable, against the snapshot.
+     *
+     */
+    bool is_passable(int q, int r, const LayerView* cost_layer, const HexRegion* blockers) const;
+
+public:
+    HexGridSnapshot();
+    /**
+     * @brief Gets the grid's revision when the snapshot was published. Intended for usage directly from Godot.
+     *
+     */
+    int64_t get_revision() const;
+    /**
+     * @brief Checks whether a hex existed. Intended for usage directly from Godot.
+     *
+     * @param q The q-coordinate.
+     * @param r The r-coordinate.
+     * @return bool True if the hex exists.
+     */
+    bool has_hex(int q, int r) const;
+    bool has_layer(const godot::StringName &name) const;
+    /**
+     * @brief Gets the value of a layer's cell. Intended for usage directly from Godot.
+     *
+     * @param name The layer's name.
+     * @param q The q-coordinate.
+     * @param r The r-coordinate.
+     * @return float The value.
+     */
+    float get_layer_value(const godot::StringName &name, int q, int r) const;
+    /**
+     * @brief Gets the coordinates of the existing neighbors of a hex. Intended for usage directly from Godot.
+     *
+     * @param hex The center hex, q as x and r as y.
+     * @return godot::Array An array containing the Vector2i coordinates of the neighbors.
+     */
+    godot::Array get_neighbors(godot::Vector2i hex) const;
+    /**
+     * @brief The same as HexGrid.breadth_first_search_region_at, against the snapshot. Intended for usage directly from Godot.
+     *
+     */
+    godot::Ref<HexRegion> breadth_first_search_region(godot::Vector2i origin, const godot::Ref<HexRegion> &pre_visited, const godot::Ref<HexRegion> &into) const;
+    /**
+     * @brief The same as HexGrid.get_field_of_view_at, against the snapshot. The radius cannot exceed what the grid had prepared when the snapshot was published. Intended for usage directly from Godot.
+     *
+     */
+    godot::Ref<HexRegion> get_field_of_view(godot::Vector2i origin, int radius, const godot::Ref<HexRegion> &blockers, const godot::Ref<HexRegion> &into) const;
+    /**
+     * @brief The same as HexGrid.has_line_of_sight_at, against the snapshot. Intended for usage directly from Godot.
+     *
+     */
+    bool has_line_of_sight(godot::Vector2i from, godot::Vector2i to, const godot::Ref<HexRegion> &blockers) const;
+    /**
+     * @brief The same as HexGrid.find_path_at, against the snapshot. Intended for usage directly from Godot.
+     *
+     * @return godot::Array An array containing the Vector2i coordinates of the path, from the start to the goal. Empty if there is none.
+     */
+    godot::Array find_path(godot::Vector2i from, godot::Vector2i to, const godot::StringName &cost_layer, const godot::Ref<HexRegion> &blockers, int mode) const;
+};
+
+#endif //GODOT_HEX_GRID_EXTENSION_HEX_GRID_SNAPSHOT_H
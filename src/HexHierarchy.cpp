@@ -0,0 +1,36 @@
+#include "HexHierarchy.h"
+
+#include <algorithm>
+
+void HexLayerHierarchy::Aggregate::add(float value) {
+	min = count > 0 ? std::min(min, value) : value;
+	max = count > 0 ? std::max(max, value) : value;
+	sum += value;
+	count++;
+}
+
+void HexLayerHierarchy::Aggregate::add(const Aggregate &child) {
+	min = count > 0 ? std::min(min, child.min) : child.min;
+	max = count > 0 ? std::max(max, child.max) : child.max;
+	sum += child.sum;
+	count += child.count;
+}
+
+void HexLayerHierarchy::reset(int depth) {
+	levels.clear();
+	levels.resize(size_t(depth));
+}
+
+int HexLayerHierarchy::get_depth() const {
+	return int(levels.size());
+}
+
+const HexLayerHierarchy::Aggregate* HexLayerHierarchy::find(int level, int q, int r) const {
+	const std::unordered_map<int64_t, Aggregate> &summaries = levels[level - 1];
+	auto aggregate = summaries.find(HexTileStorage::key(q, r));
+	return aggregate == summaries.end() ? nullptr : &aggregate->second;
+}
+
+const std::unordered_map<int64_t, HexLayerHierarchy::Aggregate> &HexLayerHierarchy::get_level(int level) const {
+	return levels[level - 1];
+}
@@ -0,0 +1,163 @@
+/**
+ * @file HexHierarchy.h
+ * @brief Aperture-7 superhexes, and the per-level summaries of a HexGrid layer built on them.
+ * @details A hex and its six neighbors make up one parent, and the parents' centers form a hex lattice of their own, stepped by (2, 1) and (-1, 3). A parent's coordinates are its center's position on that lattice, so parents are addressed with axial coordinates like any hex, and the same rule gives their parents in turn.
+ * Which of the seven children a hex is follows from (3q + r) mod 7, which is zero on the centers and different for each of the six directions around them.
+ * @version 1.0
+ *
+ *
+ *
+ */
+#ifndef GODOT_HEX_GRID_EXTENSION_HEX_HIERARCHY_H
+#define GODOT_HEX_GRID_EXTENSION_HEX_HIERARCHY_H
+
+#include "HexShapes.h"
+#include "HexTileStorage.h"
+#include <array>
+#include <cstdint>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+/// @brief The most levels above the hexes a hierarchy is built to. A level 12 parent already covers 7^12 hexes.
+inline constexpr int HEX_HIERARCHY_MAX_LEVEL = 12;
+
+/**
+ * @brief Gets the parent a hex belongs to, one level up.
+ *
+ * @param q The q-coordinate.
+ * @param r The r-coordinate.
+ * @return std::pair<int, int> The parent's coordinates on the level above.
+ */
+inline std::pair<int, int> hex_aperture_parent(int q, int r) {
+    // The direction from the center for each value of (3q + r) mod 7, the center itself at zero.
+    static constexpr std::array<std::pair<int, int>, 7> offsets{ { {0, 0}, {0, 1}, {1, -1}, {1, 0}, {-1, 0}, {-1, 1}, {0, -1} } };
+    int index = ((3 * q + r) % 7 + 7) % 7;
+    int center_q = q - offsets[index].first;
+    int center_r = r - offsets[index].second;
+    return std::pair<int, int>((3 * center_q + center_r) / 7, (2 * center_r - center_q) / 7);
+}
+
+/**
+ * @brief Gets the center child of a parent, one level down.
+ *
+ * @param q The parent's q-coordinate.
+ * @param r The parent's r-coordinate.
+ * @return std::pair<int, int> The center child's coordinates on the level below.
+ */
+inline std::pair<int, int> hex_aperture_center(int q, int r) {
+    return std::pair<int, int>(2 * q - r, q + 3 * r);
+}
+
+/// @brief The summaries of one layer, per level. Not a Godot object, the HexGrid owns its hierarchies.
+class HexLayerHierarchy
+{
+public:
+    /**
+     * @brief The summary of the hexes under one parent.
+     *
+     */
+    struct Aggregate {
+        double sum{};
+        int64_t count{};
+        float min{};
+        float max{};
+
+        /**
+         * @brief Adds a single value, or a whole child's summary.
+         *
+         */
+        void add(float value);
+        void add(const Aggregate &child);
+    };
+
+private:
+    /**
+     * @brief The summaries of each level, starting at level one, each a map that maps a parent's key to its summary. Parents without a hex under them are left out.
+     *
+     */
+    std::vector<std::unordered_map<int64_t, Aggregate>> levels{};
+
+public:
+    /**
+     * @brief The revision the layer was added at when the hierarchy was built, to notice a layer that was replaced.
+     *
+     */
+    uint64_t created{};
+    /**
+     * @brief The grid's revision the summaries are up to date with.
+     *
+     */
+    uint64_t synced_revision{};
+
+    /**
+     * @brief Drops every summary, and sets the levels to keep.
+     *
+     * @param depth The amount of levels above the hexes.
+     */
+    void reset(int depth);
+    int get_depth() const;
+    /**
+     * @brief Gets the summary of a parent.
+     *
+     * @param level The parent's level, from one to the depth.
+     * @param q The parent's q-coordinate.
+     * @param r The parent's r-coordinate.
+     * @return const Aggregate* The summary, or null if there is no hex under the parent.
+     */
+    const Aggregate* find(int level, int q, int r) const;
+    /**
+     * @brief Gets every summary of a level.
+     *
+     * @param level The level, from one to the depth.
+     * @return const std::unordered_map<int64_t, Aggregate>& A map that maps a parent's key to its summary.
+     */
+    const std::unordered_map<int64_t, Aggregate> &get_level(int level) const;
+    /**
+     * @brief Recomputes the parents of some hexes, and every parent above them, from their children.
+     *
+     * @param hexes The hexes that changed, as HexTileStorage keys.
+     * @param get_value Called as get_value(q, r, value), and returns false if the hex does not exist, or true after setting value.
+     */
+    template <typename Function>
+    void update(const std::unordered_set<int64_t> &hexes, Function &&get_value) {
+        std::unordered_set<int64_t> dirty{};
+        for (int64_t hex : hexes) {
+            std::pair<int, int> co_ords = HexTileStorage::unkey(hex);
+            std::pair<int, int> parent = hex_aperture_parent(co_ords.first, co_ords.second);
+            dirty.insert(HexTileStorage::key(parent.first, parent.second));
+        }
+        for (int level = 1; level <= get_depth() && !dirty.empty(); level++) {
+            std::unordered_map<int64_t, Aggregate> &summaries = levels[level - 1];
+            std::unordered_set<int64_t> dirty_parents{};
+            for (int64_t key : dirty) {
+                std::pair<int, int> co_ords = HexTileStorage::unkey(key);
+                std::pair<int, int> center = hex_aperture_center(co_ords.first, co_ords.second);
+                Aggregate aggregate{};
+                for (int child = 0; child < 7; child++) {
+                    int child_q = center.first + (child > 0 ? HEX_DIRECTIONS[child - 1].first : 0);
+                    int child_r = center.second + (child > 0 ? HEX_DIRECTIONS[child - 1].second : 0);
+                    if (level == 1) {
+                        float value{};
+                        if (get_value(child_q, child_r, value)) {
+                            aggregate.add(value);
+                        }
+                    } else if (const Aggregate* below = find(level - 1, child_q, child_r)) {
+                        aggregate.add(*below);
+                    }
+                }
+                if (aggregate.count > 0) {
+                    summaries[key] = aggregate;
+                } else {
+                    summaries.erase(key);
+                }
+                std::pair<int, int> parent = hex_aperture_parent(co_ords.first, co_ords.second);
+                dirty_parents.insert(HexTileStorage::key(parent.first, parent.second));
+            }
+            dirty.swap(dirty_parents);
+        }
+    }
+};
+
+#endif //GODOT_HEX_GRID_EXTENSION_HEX_HIERARCHY_H
@@ -0,0 +1,383 @@
+#include "HexInfluenceMap.h"
+#include "HexGrid.h"
+#include "HexShapes.h"
+#include "godot_cpp/core/class_db.hpp"
+#include "godot_cpp/classes/worker_thread_pool.hpp"
+#include "godot_cpp/variant/callable_method_pointer.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <unordered_set>
+
+namespace {
+	// Below this many tasks, handing them to the WorkerThreadPool costs more than it saves.
+	constexpr int MIN_PARALLEL_TASKS = 4;
+
+	// Keeps a blocked source's distance grid, (2 * radius + 1)^2 16-bit cells, at about 8 MiB.
+	constexpr int MAX_SOURCE_RADIUS = 1024;
+
+	// Calls a function with the key of every chunk overlapping a source's bounding box.
+	template <typename Function>
+	void for_each_footprint_chunk(int q, int r, int radius, Function &&function) {
+		for (int chunk_q = (q - radius) >> HEX_CHUNK_SHIFT; chunk_q <= (q + radius) >> HEX_CHUNK_SHIFT; chunk_q++) {
+			for (int chunk_r = (r - radius) >> HEX_CHUNK_SHIFT; chunk_r <= (r + radius) >> HEX_CHUNK_SHIFT; chunk_r++) {
+				function(hex_chunk_key(chunk_q, chunk_r));
+			}
+		}
+	}
+}
+
+HexInfluenceMap::HexInfluenceMap() {
+
+}
+
+void HexInfluenceMap::set_source(int64_t id, int q, int r, float strength, int radius, int falloff) {
+	ERR_FAIL_COND_MSG(radius < 0, "Radius cannot be less than zero.");
+	ERR_FAIL_COND_MSG(radius > MAX_SOURCE_RADIUS, "Radius cannot be more than 1024.");
+	ERR_FAIL_COND_MSG((falloff < FALLOFF_CONSTANT) || (falloff > FALLOFF_CURVE), "Invalid falloff.");
+
+	Source &source = sources[id];
+	source.q = q;
+	source.r = r;
+	source.strength = strength;
+	source.radius = radius;
+	source.falloff = falloff;
+	source.dirty = true;
+}
+
+void HexInfluenceMap::move_source(int64_t id, int q, int r) {
+	auto source = sources.find(id);
+	ERR_FAIL_COND_MSG(source == sources.end(), "Cannot move non-existing source.");
+
+	if (source->second.q != q || source->second.r != r) {
+		source->second.q = q;
+		source->second.r = r;
+		source->second.dirty = true;
+	}
+}
+
+void HexInfluenceMap::remove_source(int64_t id) {
+	auto source = sources.find(id);
+	ERR_FAIL_COND_MSG(source == sources.end(), "Cannot remove non-existing source.");
+
+	if (source->second.applied) {
+		removed_footprints.push_back({ source->second.applied_q, source->second.applied_r, source->second.applied_radius });
+	}
+	sources.erase(source);
+}
+
+bool HexInfluenceMap::has_source(int64_t id) const {
+	return sources.count(id) > 0;
+}
+
+void HexInfluenceMap::clear_sources() {
+	sources.clear();
+	removed_footprints.clear();
+	needs_rebuild = true;
+}
+
+void HexInfluenceMap::set_output_layer(const godot::StringName &layer) {
+	output_layer = layer;
+	needs_rebuild = true;
+}
+
+godot::StringName HexInfluenceMap::get_output_layer() const {
+	return output_layer;
+}
+
+void HexInfluenceMap::set_obstacles(const godot::Ref<HexRegion> &region) {
+	obstacles = region;
+	needs_rebuild = true;
+}
+
+godot::Ref<HexRegion> HexInfluenceMap::get_obstacles() const {
+	return obstacles;
+}
+
+void HexInfluenceMap::set_falloff_curve(const godot::Ref<godot::Curve> &curve) {
+	falloff_curve = curve;
+	needs_rebuild = true;
+}
+
+godot::Ref<godot::Curve> HexInfluenceMap::get_falloff_curve() const {
+	return falloff_curve;
+}
+
+void HexInfluenceMap::set_decay(float new_decay) {
+	decay = new_decay;
+	needs_rebuild = true;
+}
+
+float HexInfluenceMap::get_decay() const {
+	return decay;
+}
+
+void HexInfluenceMap::rebuild() {
+	needs_rebuild = true;
+}
+
+void HexInfluenceMap::compute_weights(Source &source) const {
+	source.weights.resize(source.radius + 1);
+
+	for (int distance = 0; distance <= source.radius; distance++) {
+		float linear = 1.0f - float(distance) / float(source.radius + 1);
+		float weight = 1.0f;
+		switch (source.falloff) {
+			case FALLOFF_CONSTANT:
+				weight = 1.0f;
+				break;
+			case FALLOFF_LINEAR:
+				weight = linear;
+				break;
+			case FALLOFF_QUADRATIC:
+				weight = linear * linear;
+				break;
+			case FALLOFF_EXPONENTIAL:
+				weight = std::pow(decay, float(distance));
+				break;
+			case FALLOFF_CURVE:
+				// Sampled here on the calling thread, so the tasks never touch the curve.
+				weight = falloff_curve.is_valid() ? falloff_curve->sample(source.radius > 0 ? float(distance) / float(source.radius) : 0.0f) : linear;
+				break;
+		}
+		source.weights[distance] = source.strength * weight;
+	}
+}
+
+void HexInfluenceMap::compute_distances_task(uint32_t index) {
+	Source &source = *distance_tasks[index];
+	size_t width = size_t(2 * source.radius + 1);
+	source.distances.assign(width * width, -1);
+
+	if (obstacles->has_hex(source.q, source.r)) {
+		return;
+	}
+
+	// A breadth first search over the source's bounding box, stopping at the obstacles and the radius.
+	std::vector<std::pair<int, int>> frontier{ { 0, 0 } };
+	std::vector<std::pair<int, int>> next_frontier{};
+	source.distances[size_t(source.radius) * width + size_t(source.radius)] = 0;
+
+	for (int distance = 1; distance <= source.radius && !frontier.empty(); distance++) {
+		for (std::pair<int, int> offset : frontier) {
+			for (std::pair<int, int> direction : HEX_DIRECTIONS) {
+				int dq = offset.first + direction.first;
+				int dr = offset.second + direction.second;
+				if (std::abs(dq) > source.radius || std::abs(dr) > source.radius) {
+					continue;
+				}
+
+				int16_t &cell = source.distances[size_t(dq + source.radius) * width + size_t(dr + source.radius)];
+				if (cell >= 0 || obstacles->has_hex(source.q + dq, source.r + dr)) {
+					continue;
+				}
+				cell = int16_t(distance);
+				next_frontier.push_back(std::pair<int, int>(dq, dr));
+			}
+		}
+		frontier.swap(next_frontier);
+		next_frontier.clear();
+	}
+}
+
+void HexInfluenceMap::accumulate_chunk_task(uint32_t index) {
+	ChunkTask &task = chunk_tasks[index];
+	HexLayer::Chunk &values = *task.values;
+	values.fill(0.0f);
+
+	std::pair<int, int> chunk = hex_chunk_unkey(task.key);
+	int chunk_q = chunk.first << HEX_CHUNK_SHIFT;
+	int chunk_r = chunk.second << HEX_CHUNK_SHIFT;
+
+	for (const Source* source : task.sources) {
+		int radius = source->radius;
+		size_t width = size_t(2 * radius + 1);
+		bool blocked = !source->distances.empty();
+
+		// Only the part of the source's bounding box that lies in this chunk.
+		int q_min = std::max(chunk_q, source->q - radius);
+		int q_max = std::min(chunk_q + HEX_CHUNK_MASK, source->q + radius);
+		int r_min = std::max(chunk_r, source->r - radius);
+		int r_max = std::min(chunk_r + HEX_CHUNK_MASK, source->r + radius);
+
+		for (int r = r_min; r <= r_max; r++) {
+			int dr = r - source->r;
+			float* row = values.data() + ((r - chunk_r) << HEX_CHUNK_SHIFT);
+			for (int q = q_min; q <= q_max; q++) {
+				int dq = q - source->q;
+				int distance = (std::abs(dq) + std::abs(dr) + std::abs(dq + dr)) / 2;
+				if (distance > radius) {
+					continue;
+				}
+				if (blocked) {
+					distance = source->distances[size_t(dq + radius) * width + size_t(dr + radius)];
+					if (distance < 0) {
+						continue;
+					}
+				}
+				row[q - chunk_q] += source->weights[distance];
+			}
+		}
+	}
+}
+
+void HexInfluenceMap::run_tasks(int count, void (HexInfluenceMap::*task)(uint32_t)) {
+	godot::WorkerThreadPool* pool = godot::WorkerThreadPool::get_singleton();
+	if (count < MIN_PARALLEL_TASKS || pool == nullptr) {
+		for (int i = 0; i < count; i++) {
+			(this->*task)(i);
+		}
+		return;
+	}
+
+	int64_t group = pool->add_group_task(godot::callable_mp(this, task), count, -1, false, "HexInfluenceMap");
+	pool->wait_for_group_task_completion(group);
+}
+
+int HexInfluenceMap::update(HexGrid* grid) {
+	ERR_FAIL_NULL_V_MSG(grid, 0, "Grid cannot be null.");
+
+	if (!grid->has_layer(output_layer)) {
+		grid->add_layer(output_layer, 0.0f);
+	}
+	HexLayer* layer = grid->find_layer(output_layer);
+
+	// Gather every chunk whose sum changes: the old and new footprints of changed sources, and the footprints of removed ones.
+	std::unordered_set<int64_t> dirty_chunks{};
+	auto mark_dirty = [&dirty_chunks](int64_t key) { dirty_chunks.insert(key); };
+
+	if (needs_rebuild) {
+		for (int64_t key : layer->get_chunk_keys()) {
+			dirty_chunks.insert(key);
+		}
+		removed_footprints.clear();
+		for (std::pair<const int64_t, Source> &pair : sources) {
+			pair.second.dirty = true;
+			pair.second.applied = false;
+		}
+	}
+
+	for (const std::array<int, 3> &footprint : removed_footprints) {
+		for_each_footprint_chunk(footprint[0], footprint[1], footprint[2], mark_dirty);
+	}
+
+	distance_tasks.clear();
+	for (std::pair<const int64_t, Source> &pair : sources) {
+		Source &source = pair.second;
+		if (!source.dirty) {
+			continue;
+		}
+		if (source.applied) {
+			for_each_footprint_chunk(source.applied_q, source.applied_r, source.applied_radius, mark_dirty);
+		}
+		for_each_footprint_chunk(source.q, source.r, source.radius, mark_dirty);
+
+		compute_weights(source);
+		if (obstacles.is_valid()) {
+			distance_tasks.push_back(&source);
+		} else {
+			source.distances.clear();
+		}
+	}
+
+	if (dirty_chunks.empty()) {
+		return 0;
+	}
+
+	// The values before the update, so only the cells that actually change are recorded and signalled.
+	std::unordered_map<int64_t, HexLayer::Chunk> previous_chunks{};
+	for (int64_t key : dirty_chunks) {
+		const HexLayer::Chunk* values = layer->find_chunk(key);
+		HexLayer::Chunk &previous = previous_chunks[key];
+		if (values) {
+			previous = *values;
+		} else {
+			previous.fill(layer->get_default_value());
+		}
+	}
+
+	run_tasks(distance_tasks.size(), &HexInfluenceMap::compute_distances_task);
+
+	// Every dirty chunk is recomputed from all the sources that reach it, changed or not.
+	chunk_tasks.clear();
+	std::unordered_map<int64_t, size_t> task_indices{};
+	for (std::pair<const int64_t, Source> &pair : sources) {
+		const Source &source = pair.second;
+		for_each_footprint_chunk(source.q, source.r, source.radius, [&](int64_t key) {
+			if (!dirty_chunks.count(key)) {
+				return;
+			}
+			auto task = task_indices.find(key);
+			if (task == task_indices.end()) {
+				task = task_indices.emplace(key, chunk_tasks.size()).first;
+				chunk_tasks.push_back(ChunkTask{ key });
+			}
+			chunk_tasks[task->second].sources.push_back(&source);
+		});
+	}
+
+	// Chunks no source reaches anymore go back to the default value. The rest are created here, since creating chunks is not thread safe.
+	for (int64_t key : dirty_chunks) {
+		if (!task_indices.count(key)) {
+			layer->erase_chunk(key);
+		}
+	}
+	for (ChunkTask &task : chunk_tasks) {
+		task.values = layer->ensure_chunk(task.key);
+	}
+
+	run_tasks(chunk_tasks.size(), &HexInfluenceMap::accumulate_chunk_task);
+	godot::Ref<HexRegion> changed_cells;
+	changed_cells.instantiate();
+	for (int64_t key : dirty_chunks) {
+		grid->mark_layer_chunk(output_layer, key, &previous_chunks[key], changed_cells.ptr());
+	}
+	if (!changed_cells->is_empty()) {
+		grid->emit_signal("layer_region_changed", output_layer, changed_cells);
+	}
+
+	for (std::pair<const int64_t, Source> &pair : sources) {
+		Source &source = pair.second;
+		source.dirty = false;
+		source.applied = true;
+		source.applied_q = source.q;
+		source.applied_r = source.r;
+		source.applied_radius = source.radius;
+	}
+	removed_footprints.clear();
+	needs_rebuild = false;
+
+	int recomputed = dirty_chunks.size();
+	distance_tasks.clear();
+	chunk_tasks.clear();
+	return recomputed;
+}
+
+void HexInfluenceMap::_bind_methods() {
+	godot::ClassDB::bind_method(godot::D_METHOD("set_source", "id", "q", "r", "strength", "radius", "falloff"), &HexInfluenceMap::set_source, DEFVAL(FALLOFF_LINEAR));
+	godot::ClassDB::bind_method(godot::D_METHOD("move_source", "id", "q", "r"), &HexInfluenceMap::move_source);
+	godot::ClassDB::bind_method(godot::D_METHOD("remove_source", "id"), &HexInfluenceMap::remove_source);
+	godot::ClassDB::bind_method(godot::D_METHOD("has_source", "id"), &HexInfluenceMap::has_source);
+	godot::ClassDB::bind_method(godot::D_METHOD("clear_sources"), &HexInfluenceMap::clear_sources);
+	godot::ClassDB::bind_method(godot::D_METHOD("rebuild"), &HexInfluenceMap::rebuild);
+	godot::ClassDB::bind_method(godot::D_METHOD("update", "grid"), &HexInfluenceMap::update);
+
+	godot::ClassDB::bind_method(godot::D_METHOD("set_output_layer", "layer"), &HexInfluenceMap::set_output_layer);
+	godot::ClassDB::bind_method(godot::D_METHOD("get_output_layer"), &HexInfluenceMap::get_output_layer);
+	godot::ClassDB::bind_method(godot::D_METHOD("set_obstacles", "region"), &HexInfluenceMap::set_obstacles);
+	godot::ClassDB::bind_method(godot::D_METHOD("get_obstacles"), &HexInfluenceMap::get_obstacles);
+	godot::ClassDB::bind_method(godot::D_METHOD("set_falloff_curve", "curve"), &HexInfluenceMap::set_falloff_curve);
+	godot::ClassDB::bind_method(godot::D_METHOD("get_falloff_curve"), &HexInfluenceMap::get_falloff_curve);
+	godot::ClassDB::bind_method(godot::D_METHOD("set_decay", "decay"), &HexInfluenceMap::set_decay);
+	godot::ClassDB::bind_method(godot::D_METHOD("get_decay"), &HexInfluenceMap::get_decay);
+	ADD_PROPERTY(godot::PropertyInfo(godot::Variant::STRING_NAME, "output_layer"), "set_output_layer", "get_output_layer");
+	ADD_PROPERTY(godot::PropertyInfo(godot::Variant::OBJECT, "obstacles", godot::PROPERTY_HINT_RESOURCE_TYPE, "HexRegion"), "set_obstacles", "get_obstacles");
+	ADD_PROPERTY(godot::PropertyInfo(godot::Variant::OBJECT, "falloff_curve", godot::PROPERTY_HINT_RESOURCE_TYPE, "Curve"), "set_falloff_curve", "get_falloff_curve");
+	ADD_PROPERTY(godot::PropertyInfo(godot::Variant::FLOAT, "decay"), "set_decay", "get_decay");
+
+	godot::ClassDB::bind_integer_constant(get_class_static(), "Falloff", "FALLOFF_CONSTANT", FALLOFF_CONSTANT);
+	godot::ClassDB::bind_integer_constant(get_class_static(), "Falloff", "FALLOFF_LINEAR", FALLOFF_LINEAR);
+	godot::ClassDB::bind_integer_constant(get_class_static(), "Falloff", "FALLOFF_QUADRATIC", FALLOFF_QUADRATIC);
+	godot::ClassDB::bind_integer_constant(get_class_static(), "Falloff", "FALLOFF_EXPONENTIAL", FALLOFF_EXPONENTIAL);
+	godot::ClassDB::bind_integer_constant(get_class_static(), "Falloff", "FALLOFF_CURVE", FALLOFF_CURVE);
+}
@@ -0,0 +1,221 @@
+/**
+ * @file HexInfluenceMap.h
+ * @brief Accumulates decaying influence from many sources into a HexGrid data layer.
+ * @details Work is split per chunk of the output layer. Every chunk sums the sources that reach it on its own, so chunks run in parallel on the WorkerThreadPool without sharing writes. After the first update, only chunks touched by sources that were added, moved, changed or removed are recomputed.
+ * @version 1.0
+ *
+ *
+ *
+ */
+#ifndef GODOT_HEX_GRID_EXTENSION_HEX_INFLUENCE_MAP_H
+#define GODOT_HEX_GRID_EXTENSION_HEX_INFLUENCE_MAP_H
+
+#include "godot_cpp/classes/ref_counted.hpp"
+#include "godot_cpp/classes/curve.hpp"
+#include "godot_cpp/core/object.hpp"
+#include "HexLayer.h"
+#include "HexRegion.h"
+#include <array>
+#include <unordered_map>
+#include <vector>
+
+class HexGrid;
+
+/// @brief Builds threat and control style maps from a set of sources, writing the summed influence into a float layer.
+class HexInfluenceMap : public godot::RefCounted
+{
+    GDCLASS(HexInfluenceMap, godot::RefCounted)
+
+public:
+    /**
+     * @brief Enumerations for how a source's strength falls off with distance.
+     *
+     */
+    enum Falloff {
+        /// @brief Full strength up to the radius.
+        FALLOFF_CONSTANT,
+        /// @brief Drops linearly, reaching zero one step past the radius.
+        FALLOFF_LINEAR,
+        /// @brief Drops with the square of the linear falloff.
+        FALLOFF_QUADRATIC,
+        /// @brief Multiplied by the decay once per step.
+        FALLOFF_EXPONENTIAL,
+        /// @brief Scaled by the falloff curve, sampled from 0 at the source to 1 at the radius.
+        FALLOFF_CURVE
+    };
+
+private:
+    /**
+     * @brief A single source of influence.
+     *
+     */
+    struct Source {
+        int q{};
+        int r{};
+        float strength{};
+        int radius{};
+        int falloff{};
+        /// @brief The influence at each distance, from 0 to the radius.
+        std::vector<float> weights{};
+        /// @brief The path distance to every offset in the source's bounding box, or -1 if blocked. Only used with obstacles.
+        std::vector<int16_t> distances{};
+        /// @brief Whether the source changed since the last update.
+        bool dirty{ true };
+        /// @brief Whether the source is in the output layer, and where it was when it was written.
+        bool applied{};
+        int applied_q{};
+        int applied_r{};
+        int applied_radius{};
+    };
+    /**
+     * @brief The work for one chunk of the output layer.
+     *
+     */
+    struct ChunkTask {
+        int64_t key{};
+        HexLayer::Chunk* values{};
+        std::vector<const Source*> sources{};
+    };
+
+    /**
+     * @brief A map that maps a source id to its source.
+     *
+     */
+    std::unordered_map<int64_t, Source> sources{};
+    /**
+     * @brief The footprints of removed sources that are still in the output layer, as q, r and radius.
+     *
+     */
+    std::vector<std::array<int, 3>> removed_footprints{};
+    /**
+     * @brief The name of the layer the influence is written to.
+     *
+     */
+    godot::StringName output_layer{ "influence" };
+    /**
+     * @brief Cells in this region block influence. Influence then spreads by path distance instead of hex distance.
+     *
+     */
+    godot::Ref<HexRegion> obstacles;
+    /**
+     * @brief The curve used by FALLOFF_CURVE.
+     *
+     */
+    godot::Ref<godot::Curve> falloff_curve;
+    /**
+     * @brief The multiplier per step used by FALLOFF_EXPONENTIAL.
+     *
+     */
+    float decay{ 0.5f };
+    /**
+     * @brief Whether the next update has to recompute the whole output layer.
+     *
+     */
+    bool needs_rebuild{ true };
+    /**
+     * @brief The sources whose distances are being computed by the current update.
+     *
+     */
+    std::vector<Source*> distance_tasks{};
+    /**
+     * @brief The chunks being computed by the current update.
+     *
+     */
+    std::vector<ChunkTask> chunk_tasks{};
+
+    /**
+     * @brief Binds methods for usage in Godot.
+     *
+     */
+    static void _bind_methods();
+    /**
+     * @brief Fills in a source's influence for each distance.
+     *
+     */
+    void compute_weights(Source &source) const;
+    /**
+     * @brief Computes the path distances of one source around the obstacles. Run on the WorkerThreadPool.
+     *
+     * @param index The index into distance_tasks.
+     */
+    void compute_distances_task(uint32_t index);
+    /**
+     * @brief Sums every source reaching one chunk. Run on the WorkerThreadPool.
+     *
+     * @param index The index into chunk_tasks.
+     */
+    void accumulate_chunk_task(uint32_t index);
+    /**
+     * @brief Runs a task once per index, on the WorkerThreadPool if there is enough work to be worth it.
+     *
+     * @param count The amount of indices.
+     * @param task The task to run.
+     */
+    void run_tasks(int count, void (HexInfluenceMap::*task)(uint32_t));
+
+public:
+    HexInfluenceMap();
+    /**
+     * @brief Adds a source, or replaces the source with the same id.
+     *
+     * @param id An id of your choosing, such as a unit's instance id.
+     * @param q The q-coordinate of the source.
+     * @param r The r-coordinate of the source.
+     * @param strength The influence at the source itself.
+     * @param radius The furthest distance the source reaches. At most 1024.
+     * @param falloff How the strength falls off with distance. Typically a Falloff enum.
+     */
+    void set_source(int64_t id, int q, int r, float strength, int radius, int falloff);
+    /**
+     * @brief Moves an existing source, keeping its strength, radius and falloff.
+     *
+     * @param id The source's id.
+     * @param q The new q-coordinate.
+     * @param r The new r-coordinate.
+     */
+    void move_source(int64_t id, int q, int r);
+    /**
+     * @brief Removes a source.
+     *
+     * @param id The source's id.
+     */
+    void remove_source(int64_t id);
+    /**
+     * @brief Checks if a source exists.
+     *
+     * @param id The source's id.
+     * @return bool True if the source exists.
+     */
+    bool has_source(int64_t id) const;
+    /**
+     * @brief Removes every source.
+     *
+     */
+    void clear_sources();
+    void set_output_layer(const godot::StringName &layer);
+    godot::StringName get_output_layer() const;
+    /**
+     * @brief Sets the obstacles. Call rebuild after editing the region in place, since edits are not tracked.
+     *
+     */
+    void set_obstacles(const godot::Ref<HexRegion> &region);
+    godot::Ref<HexRegion> get_obstacles() const;
+    void set_falloff_curve(const godot::Ref<godot::Curve> &curve);
+    godot::Ref<godot::Curve> get_falloff_curve() const;
+    void set_decay(float new_decay);
+    float get_decay() const;
+    /**
+     * @brief Makes the next update recompute the whole output layer.
+     *
+     */
+    void rebuild();
+    /**
+     * @brief Writes the influence into the grid's output layer, creating the layer if needed. Only chunks affected by changes since the last update are recomputed. The layer is written without emitting the grid's layer_value_changed signal. Instead, layer_region_changed is emitted once with the cells that changed, if any.
+     *
+     * @param grid The grid to write into.
+     * @return int The amount of chunks that were recomputed.
+     */
+    int update(HexGrid* grid);
+};
+
+#endif //GODOT_HEX_GRID_EXTENSION_HEX_INFLUENCE_MAP_H
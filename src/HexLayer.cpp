@@ -0,0 +1,61 @@
+#include "HexLayer.h"
+
+HexLayer::HexLayer(float default_value) : default_value(default_value) {
+
+}
+
+float HexLayer::get_value(int q, int r) const {
+	auto chunk = chunks.find(hex_chunk_key_of(q, r));
+	if (chunk == chunks.end()) {
+		return default_value;
+	}
+	return (*chunk->second)[hex_chunk_cell(q, r)];
+}
+
+void HexLayer::set_value(int q, int r, float value) {
+	(*ensure_chunk(hex_chunk_key_of(q, r)))[hex_chunk_cell(q, r)] = value;
+}
+
+float HexLayer::get_default_value() const {
+	return default_value;
+}
+
+void HexLayer::clear() {
+	chunks.clear();
+}
+
+const HexLayer::Chunk* HexLayer::find_chunk(int64_t key) const {
+	auto chunk = chunks.find(key);
+	return chunk == chunks.end() ? nullptr : chunk->second.get();
+}
+
+HexLayer::Chunk* HexLayer::ensure_chunk(int64_t key) {
+	std::unique_ptr<Chunk> &chunk = chunks[key];
+	if (!chunk) {
+		chunk = std::make_unique<Chunk>();
+		chunk->fill(default_value);
+	}
+	return chunk.get();
+}
+
+void HexLayer::swap_chunk(int64_t key, std::unique_ptr<Chunk> &buffer) {
+	ensure_chunk(key);
+	chunks[key].swap(buffer);
+}
+
+void HexLayer::erase_chunk(int64_t key) {
+	chunks.erase(key);
+}
+
+std::vector<int64_t> HexLayer::get_chunk_keys() const {
+	std::vector<int64_t> keys{};
+	keys.reserve(chunks.size());
+	for (const std::pair<const int64_t, std::unique_ptr<Chunk>> &pair : chunks) {
+		keys.push_back(pair.first);
+	}
+	return keys;
+}
+
+size_t HexLayer::get_chunk_count() const {
+	return chunks.size();
+}
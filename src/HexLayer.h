@@ -0,0 +1,111 @@
+/**
+ * @file HexLayer.h
+ * @brief Per-cell float storage for the HexGrid's data layers.
+ * @details Values live in chunks using the layout from HexChunk.h, so a layer lines up with HexRegion chunk for chunk. Cells in chunks that were never written read as the default value.
+ * @version 1.0
+ *
+ *
+ *
+ */
+#ifndef GODOT_HEX_GRID_EXTENSION_HEX_LAYER_H
+#define GODOT_HEX_GRID_EXTENSION_HEX_LAYER_H
+
+#include "HexChunk.h"
+#include <array>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+/// @brief A chunked grid of floats, one per cell. Not a Godot object, the HexGrid owns its layers.
+class HexLayer
+{
+public:
+    /**
+     * @brief The values of one chunk, one per cell.
+     *
+     */
+    using Chunk = std::array<float, HEX_CHUNK_CELLS>;
+
+private:
+    /**
+     * @brief A map that maps a chunk key to its values.
+     *
+     */
+    std::unordered_map<int64_t, std::unique_ptr<Chunk>> chunks{};
+    /**
+     * @brief The value of cells that were never written.
+     *
+     */
+    float default_value{};
+
+public:
+    explicit HexLayer(float default_value = 0.0f);
+    /**
+     * @brief Gets the value of a cell.
+     *
+     * @param q The q-coordinate.
+     * @param r The r-coordinate.
+     * @return float The value, or the default value if it was never written.
+     */
+    float get_value(int q, int r) const;
+    /**
+     * @brief Sets the value of a cell, creating its chunk if needed.
+     *
+     * @param q The q-coordinate.
+     * @param r The r-coordinate.
+     * @param value The new value.
+     */
+    void set_value(int q, int r, float value);
+    /**
+     * @brief Gets the default value.
+     *
+     * @return float The value of cells that were never written.
+     */
+    float get_default_value() const;
+    /**
+     * @brief Resets every cell to the default value and drops every chunk.
+     *
+     */
+    void clear();
+    /**
+     * @brief Gets a chunk's values for reading.
+     *
+     * @param key The chunk's key.
+     * @return const Chunk* The chunk, or null if no cell in it was written.
+     */
+    const Chunk* find_chunk(int64_t key) const;
+    /**
+     * @brief Gets a chunk's values for writing, creating it filled with the default value if needed. Creating chunks is not thread safe, writing into existing ones from different threads is.
+     *
+     * @param key The chunk's key.
+     * @return Chunk* The chunk.
+     */
+    Chunk* ensure_chunk(int64_t key);
+    /**
+     * @brief Swaps a chunk's values with a buffer, creating the chunk filled with the default value if needed. Used to double buffer without copying.
+     *
+     * @param key The chunk's key.
+     * @param buffer The new values, must not be null. Holds the old values afterward.
+     */
+    void swap_chunk(int64_t key, std::unique_ptr<Chunk> &buffer);
+    /**
+     * @brief Drops a chunk, resetting its cells to the default value.
+     *
+     * @param key The chunk's key.
+     */
+    void erase_chunk(int64_t key);
+    /**
+     * @brief Gets the keys of every chunk that was written to.
+     *
+     * @return std::vector<int64_t> The keys, in no particular order.
+     */
+    std::vector<int64_t> get_chunk_keys() const;
+    /**
+     * @brief Gets the amount of chunks that were written to.
+     *
+     * @return size_t The amount of chunks.
+     */
+    size_t get_chunk_count() const;
+};
+
+#endif //GODOT_HEX_GRID_EXTENSION_HEX_LAYER_H
@@ -0,0 +1,55 @@
+#include "HexLayerTexture.h"
+
+#include <cstring>
+
+bool HexLayerTexture::has_texels() const {
+	return is_packed;
+}
+
+bool HexLayerTexture::contains(int q, int r) const {
+	return q >= min_q && r >= min_r && q - min_q < width && r - min_r < height;
+}
+
+void HexLayerTexture::set_cell(int q, int r, float value) {
+	if (!contains(q, r)) {
+		return;
+	}
+	float &texel = texels[size_t(r - min_r) * size_t(width) + size_t(q - min_q)];
+	// Compared bitwise, so a NaN written over a NaN is not counted as a change.
+	if (std::memcmp(&texel, &value, sizeof(float)) != 0) {
+		texel = value;
+		is_changed = true;
+	}
+}
+
+float HexLayerTexture::get_cell(int q, int r) const {
+	return contains(q, r) ? texels[size_t(r - min_r) * size_t(width) + size_t(q - min_q)] : 0.0f;
+}
+
+bool HexLayerTexture::has_changed() const {
+	return is_changed;
+}
+
+void HexLayerTexture::mark_uploaded() {
+	is_changed = false;
+}
+
+int HexLayerTexture::get_min_q() const {
+	return min_q;
+}
+
+int HexLayerTexture::get_min_r() const {
+	return min_r;
+}
+
+int HexLayerTexture::get_width() const {
+	return width;
+}
+
+int HexLayerTexture::get_height() const {
+	return height;
+}
+
+const std::vector<float> &HexLayerTexture::get_texels() const {
+	return texels;
+}
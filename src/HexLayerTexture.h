@@ -0,0 +1,114 @@
+/**
+ * @file HexLayerTexture.h
+ * @brief The texels of one layer of the HexGrid, packed by axial coordinates for a shader to sample.
+ * @details The texels cover the axial box around the map's tiles, grown out to whole chunks, one texel per cell: the column is q and the row is r, both counted from the box's corner. Cells that hold a tile get the layer's value, and the rest get zero.
+ * Cells that change after the texels are packed are written in place, so an update costs what changed. Only a tile appearing outside the box makes them be packed again.
+ * @version 1.0
+ *
+ *
+ *
+ */
+#ifndef GODOT_HEX_GRID_EXTENSION_HEX_LAYER_TEXTURE_H
+#define GODOT_HEX_GRID_EXTENSION_HEX_LAYER_TEXTURE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/// @brief The texels of one layer. Not a Godot object, the HexGrid owns its textures.
+class HexLayerTexture
+{
+    int min_q{};
+    int min_r{};
+    int width{};
+    int height{};
+    /**
+     * @brief One value per cell of the box, row by row.
+     *
+     */
+    std::vector<float> texels{};
+    bool is_packed{};
+    bool is_changed{};
+
+public:
+    /**
+     * @brief The revision the layer was added at when the texels were packed, to notice a layer that was replaced.
+     *
+     */
+    uint64_t created{};
+    /**
+     * @brief The grid's revision the texels are up to date with.
+     *
+     */
+    uint64_t synced_revision{};
+
+    /**
+     * @brief Packs the texels of a box, zeroing every cell first.
+     *
+     * @param new_min_q The box's lowest q-coordinate.
+     * @param new_min_r The box's lowest r-coordinate.
+     * @param new_width The amount of q-coordinates in the box.
+     * @param new_height The amount of r-coordinates in the box.
+     * @param for_each_value Called as for_each_value(set), and should call set(q, r, value) for every cell with a value inside the box.
+     */
+    template <typename Function>
+    void pack(int new_min_q, int new_min_r, int new_width, int new_height, Function &&for_each_value) {
+        min_q = new_min_q;
+        min_r = new_min_r;
+        width = new_width;
+        height = new_height;
+        texels.assign(size_t(width) * size_t(height), 0.0f);
+        for_each_value([this](int q, int r, float value) {
+            texels[size_t(r - min_r) * size_t(width) + size_t(q - min_q)] = value;
+        });
+        is_packed = true;
+        is_changed = true;
+    }
+    /**
+     * @brief Checks if the texels have been packed.
+     *
+     */
+    bool has_texels() const;
+    /**
+     * @brief Checks if a cell is inside the box.
+     *
+     */
+    bool contains(int q, int r) const;
+    /**
+     * @brief Writes a cell's current value. Cells outside the box are ignored.
+     *
+     * @param q The q-coordinate.
+     * @param r The r-coordinate.
+     * @param value The cell's value now, zero if it has no tile.
+     */
+    void set_cell(int q, int r, float value);
+    /**
+     * @brief Gets a cell's texel.
+     *
+     * @param q The q-coordinate.
+     * @param r The r-coordinate.
+     * @return float The texel, zero outside the box.
+     */
+    float get_cell(int q, int r) const;
+    /**
+     * @brief Checks if any texel changed since the last mark_uploaded.
+     *
+     */
+    bool has_changed() const;
+    /**
+     * @brief Forgets the changes, once the texels were handed to the texture.
+     *
+     */
+    void mark_uploaded();
+    int get_min_q() const;
+    int get_min_r() const;
+    int get_width() const;
+    int get_height() const;
+    /**
+     * @brief Gets the texels, row by row.
+     *
+     */
+    const std::vector<float> &get_texels() const;
+};
+
+#endif //GODOT_HEX_GRID_EXTENSION_HEX_LAYER_TEXTURE_H
@@ -0,0 +1,365 @@
+#include "HexPathPlanner.h"
+#include "HexGrid.h"
+#include "godot_cpp/core/class_db.hpp"
+#include "godot_cpp/variant/callable_method_pointer.hpp"
+
+#include <algorithm>
+
+namespace {
+	constexpr float UNREACHABLE = std::numeric_limits<float>::infinity();
+
+	// Orders the open list so the lowest priority is on top.
+	template <typename Entry>
+	bool is_worse(const Entry &a, const Entry &b) {
+		return b.key < a.key;
+	}
+}
+
+HexPathPlanner::HexPathPlanner() {
+
+}
+
+HexPathPlanner::~HexPathPlanner() {
+	HexGrid* target = get_grid();
+	if (target) {
+		connect_grid(target, false);
+	}
+}
+
+HexGrid* HexPathPlanner::get_grid() const {
+	return grid_id == 0 ? nullptr : godot::Object::cast_to<HexGrid>(godot::ObjectDB::get_instance(grid_id));
+}
+
+void HexPathPlanner::connect_grid(HexGrid* target, bool connect) {
+	godot::Callable hex_changed = callable_mp(this, &HexPathPlanner::on_hex_changed);
+	godot::Callable layer_value_changed = callable_mp(this, &HexPathPlanner::on_layer_value_changed);
+	godot::Callable layer_cleared = callable_mp(this, &HexPathPlanner::on_layer_cleared);
+	godot::Callable commands_flushed = callable_mp(this, &HexPathPlanner::on_commands_flushed);
+	godot::Callable layer_region_changed = callable_mp(this, &HexPathPlanner::on_layer_region_changed);
+	if (connect) {
+		target->connect("hex_spawned", hex_changed);
+		target->connect("hex_deleted", hex_changed);
+		target->connect("layer_value_changed", layer_value_changed);
+		target->connect("layer_cleared", layer_cleared);
+		target->connect("commands_flushed", commands_flushed);
+		target->connect("layer_region_changed", layer_region_changed);
+		return;
+	}
+	if (target->is_connected("hex_spawned", hex_changed)) {
+		target->disconnect("hex_spawned", hex_changed);
+		target->disconnect("hex_deleted", hex_changed);
+		target->disconnect("layer_value_changed", layer_value_changed);
+		target->disconnect("layer_cleared", layer_cleared);
+		target->disconnect("commands_flushed", commands_flushed);
+		target->disconnect("layer_region_changed", layer_region_changed);
+	}
+}
+
+void HexPathPlanner::on_hex_changed(int q, int r) {
+	changed_hexes.push_back(std::pair<int, int>(q, r));
+}
+
+void HexPathPlanner::on_layer_value_changed(const godot::StringName &layer_name, int q, int r) {
+	if (layer_name == cost_layer) {
+		changed_hexes.push_back(std::pair<int, int>(q, r));
+	}
+}
+
+void HexPathPlanner::on_layer_cleared(const godot::StringName &layer_name) {
+	if (layer_name == cost_layer) {
+		needs_reset = true;
+	}
+}
+
+void HexPathPlanner::on_commands_flushed(const godot::Ref<HexRegion> &changed) {
+	HexGrid* target = get_grid();
+	if (!target || changed.is_null()) {
+		return;
+	}
+	// A batch holds back the per-hex signals, so every hex it touched is treated as changed, whichever layer it was.
+	const HexTileStorage &storage = target->get_tile_storage();
+	changed->for_each([this, &storage](int q, int r) {
+		changed_hexes.push_back(storage.canonicalize(std::pair<int, int>(q, r)));
+	});
+}
+
+void HexPathPlanner::on_layer_region_changed(const godot::StringName &layer_name, const godot::Ref<HexRegion> &changed) {
+	HexGrid* target = get_grid();
+	if (!target || changed.is_null() || layer_name != cost_layer) {
+		return;
+	}
+	const HexTileStorage &storage = target->get_tile_storage();
+	changed->for_each([this, &storage](int q, int r) {
+		changed_hexes.push_back(storage.canonicalize(std::pair<int, int>(q, r)));
+	});
+}
+
+void HexPathPlanner::setup(HexGrid* target_grid, godot::Vector2i from, godot::Vector2i to, const godot::StringName &layer_name, const godot::Ref<HexRegion> &blocker_region) {
+	ERR_FAIL_NULL_MSG(target_grid, "Cannot plan on a non-existing grid.");
+
+	HexGrid* previous = get_grid();
+	if (previous) {
+		connect_grid(previous, false);
+	}
+	grid_id = target_grid->get_instance_id();
+	connect_grid(target_grid, true);
+
+	const HexTileStorage &storage = target_grid->get_tile_storage();
+	start = storage.canonicalize(std::pair<int, int>(from.x, from.y));
+	goal = storage.canonicalize(std::pair<int, int>(to.x, to.y));
+	cost_layer = layer_name;
+	blockers = blocker_region;
+	changed_hexes.clear();
+	path.clear();
+	needs_reset = true;
+}
+
+void HexPathPlanner::set_start(godot::Vector2i from) {
+	HexGrid* target = get_grid();
+	start = target ? target->get_tile_storage().canonicalize(std::pair<int, int>(from.x, from.y)) : std::pair<int, int>(from.x, from.y);
+}
+
+godot::Vector2i HexPathPlanner::get_start() const {
+	return godot::Vector2i(start.first, start.second);
+}
+
+void HexPathPlanner::set_goal(godot::Vector2i to) {
+	HexGrid* target = get_grid();
+	std::pair<int, int> new_goal = target ? target->get_tile_storage().canonicalize(std::pair<int, int>(to.x, to.y)) : std::pair<int, int>(to.x, to.y);
+	if (new_goal != goal) {
+		goal = new_goal;
+		needs_reset = true;
+	}
+}
+
+godot::Vector2i HexPathPlanner::get_goal() const {
+	return godot::Vector2i(goal.first, goal.second);
+}
+
+void HexPathPlanner::notify_hex_changed(int q, int r) {
+	changed_hexes.push_back(std::pair<int, int>(q, r));
+}
+
+float HexPathPlanner::step_cost(int q, int r) const {
+	if (!grid->is_hex_passable(q, r, layer, blockers.ptr())) {
+		return UNREACHABLE;
+	}
+	return layer ? std::max(layer->get_value(q, r), 1.0f) : 1.0f;
+}
+
+float HexPathPlanner::estimate(std::pair<int, int> from, std::pair<int, int> to) const {
+	// Every step costs at least 1, so the hex distance never overestimates.
+	return float(grid->get_tile_storage().distance(from, to));
+}
+
+const HexPathPlanner::Record &HexPathPlanner::get_record(std::pair<int, int> hex) const {
+	static const Record unreached{};
+	auto record = records.find(HexTileStorage::key(hex.first, hex.second));
+	return record == records.end() ? unreached : record->second;
+}
+
+HexPathPlanner::Key HexPathPlanner::calculate_key(std::pair<int, int> hex, const Record &record) const {
+	float cost = std::min(record.cost, record.lookahead);
+	return Key(cost + estimate(start, hex) + key_modifier, cost);
+}
+
+void HexPathPlanner::update_hex(std::pair<int, int> hex) {
+	Record &record = records[HexTileStorage::key(hex.first, hex.second)];
+	if (hex != goal) {
+		float lookahead = UNREACHABLE;
+		grid->get_tile_storage().for_each_neighbor(hex.first, hex.second, [this, &lookahead](int q, int r, HexTile*) {
+			float cost = get_record(std::pair<int, int>(q, r)).cost;
+			if (cost < lookahead) {
+				lookahead = std::min(lookahead, step_cost(q, r) + cost);
+			}
+		});
+		record.lookahead = lookahead;
+	}
+
+	record.open = record.cost != record.lookahead;
+	if (record.open) {
+		record.key = calculate_key(hex, record);
+		open.push_back(OpenEntry{ record.key, hex });
+		std::push_heap(open.begin(), open.end(), is_worse<OpenEntry>);
+	}
+}
+
+bool HexPathPlanner::peek(OpenEntry &entry) {
+	while (!open.empty()) {
+		entry = open.front();
+		auto record = records.find(HexTileStorage::key(entry.hex.first, entry.hex.second));
+		if (record != records.end() && record->second.open && record->second.key == entry.key) {
+			return true;
+		}
+		std::pop_heap(open.begin(), open.end(), is_worse<OpenEntry>);
+		open.pop_back();
+	}
+	return false;
+}
+
+void HexPathPlanner::compute_shortest_path() {
+	OpenEntry top{};
+	while (peek(top)) {
+		const Record &start_record = get_record(start);
+		if (!(top.key < calculate_key(start, start_record)) && start_record.cost == start_record.lookahead) {
+			break;
+		}
+		std::pop_heap(open.begin(), open.end(), is_worse<OpenEntry>);
+		open.pop_back();
+
+		// References into the map stay valid while update_hex adds to it.
+		Record &record = records[HexTileStorage::key(top.hex.first, top.hex.second)];
+		Key key = calculate_key(top.hex, record);
+		if (top.key < key) {
+			// The start moved since the hex was queued, so it is requeued with a fresh priority instead of expanded.
+			record.key = key;
+			open.push_back(OpenEntry{ key, top.hex });
+			std::push_heap(open.begin(), open.end(), is_worse<OpenEntry>);
+			continue;
+		}
+
+		last_expansion_count++;
+		record.open = false;
+		if (record.cost > record.lookahead) {
+			record.cost = record.lookahead;
+		} else {
+			record.cost = UNREACHABLE;
+			update_hex(top.hex);
+		}
+		grid->get_tile_storage().for_each_neighbor(top.hex.first, top.hex.second, [this](int q, int r, HexTile*) {
+			update_hex(std::pair<int, int>(q, r));
+		});
+	}
+}
+
+void HexPathPlanner::reset_search() {
+	records.clear();
+	open.clear();
+	key_modifier = 0.0f;
+	last_start = start;
+	needs_reset = false;
+
+	Record &record = records[HexTileStorage::key(goal.first, goal.second)];
+	record.lookahead = 0.0f;
+	record.key = calculate_key(goal, record);
+	record.open = true;
+	open.push_back(OpenEntry{ record.key, goal });
+}
+
+void HexPathPlanner::build_path() {
+	path.clear();
+	if (get_record(start).cost == UNREACHABLE) {
+		return;
+	}
+
+	const HexTileStorage &storage = grid->get_tile_storage();
+	std::pair<int, int> hex = start;
+	path.push_back(hex);
+	while (hex != goal) {
+		std::pair<int, int> next = hex;
+		float best = UNREACHABLE;
+		storage.for_each_neighbor(hex.first, hex.second, [this, &next, &best](int q, int r, HexTile*) {
+			float cost = get_record(std::pair<int, int>(q, r)).cost;
+			if (cost < best) {
+				cost += step_cost(q, r);
+				if (cost < best) {
+					best = cost;
+					next = std::pair<int, int>(q, r);
+				}
+			}
+		});
+		// A path can never be longer than the amount of hexes searched, anything longer is going in circles.
+		if (best == UNREACHABLE || path.size() > records.size()) {
+			path.clear();
+			return;
+		}
+		hex = next;
+		path.push_back(hex);
+	}
+}
+
+bool HexPathPlanner::replan() {
+	grid = get_grid();
+	ERR_FAIL_NULL_V_MSG(grid, false, "The planner's grid no longer exists, call setup first.");
+	layer = nullptr;
+	if (cost_layer != godot::StringName()) {
+		layer = grid->find_layer(cost_layer);
+		if (!layer) {
+			grid = nullptr;
+			ERR_FAIL_V_MSG(false, "Cannot plan over a non-existing cost layer.");
+		}
+	}
+
+	last_expansion_count = 0;
+	if (needs_reset) {
+		reset_search();
+	} else {
+		key_modifier += estimate(last_start, start);
+		last_start = start;
+		// A changed hex changes the cost of stepping onto it, which only its neighbors look at.
+		const HexTileStorage &storage = grid->get_tile_storage();
+		for (std::pair<int, int> hex : changed_hexes) {
+			storage.for_each_neighbor(hex.first, hex.second, [this](int q, int r, HexTile*) {
+				update_hex(std::pair<int, int>(q, r));
+			});
+		}
+	}
+	changed_hexes.clear();
+
+	compute_shortest_path();
+	build_path();
+	grid = nullptr;
+	layer = nullptr;
+	return !path.empty();
+}
+
+godot::Array HexPathPlanner::get_path() const {
+	godot::Array return_array = godot::Array();
+	HexGrid* target = get_grid();
+	ERR_FAIL_NULL_V_MSG(target, return_array, "The planner's grid no longer exists.");
+
+	for (std::pair<int, int> hex : path) {
+		// Hexes spawned while headless have no tile, so they are skipped rather than returned as null.
+		HexTile* tile = target->get_hex(hex.first, hex.second);
+		if (tile) {
+			return_array.append(tile);
+		}
+	}
+	return return_array;
+}
+
+godot::Array HexPathPlanner::get_path_coords() const {
+	godot::Array return_array = godot::Array();
+	for (std::pair<int, int> hex : path) {
+		return_array.append(godot::Vector2i(hex.first, hex.second));
+	}
+	return return_array;
+}
+
+const std::vector<std::pair<int, int>> &HexPathPlanner::get_path_axial() const {
+	return path;
+}
+
+float HexPathPlanner::get_path_cost() const {
+	return path.empty() ? UNREACHABLE : get_record(start).cost;
+}
+
+int HexPathPlanner::get_last_expansion_count() const {
+	return last_expansion_count;
+}
+
+void HexPathPlanner::_bind_methods() {
+	godot::ClassDB::bind_method(godot::D_METHOD("setup", "grid", "from", "to", "cost_layer", "blockers"), &HexPathPlanner::setup, DEFVAL(godot::StringName()), DEFVAL(nullptr));
+	godot::ClassDB::bind_method(godot::D_METHOD("set_start", "from"), &HexPathPlanner::set_start);
+	godot::ClassDB::bind_method(godot::D_METHOD("get_start"), &HexPathPlanner::get_start);
+	godot::ClassDB::bind_method(godot::D_METHOD("set_goal", "to"), &HexPathPlanner::set_goal);
+	godot::ClassDB::bind_method(godot::D_METHOD("get_goal"), &HexPathPlanner::get_goal);
+	godot::ClassDB::bind_method(godot::D_METHOD("notify_hex_changed", "q", "r"), &HexPathPlanner::notify_hex_changed);
+	godot::ClassDB::bind_method(godot::D_METHOD("replan"), &HexPathPlanner::replan);
+	godot::ClassDB::bind_method(godot::D_METHOD("get_path"), &HexPathPlanner::get_path);
+	godot::ClassDB::bind_method(godot::D_METHOD("get_path_coords"), &HexPathPlanner::get_path_coords);
+	godot::ClassDB::bind_method(godot::D_METHOD("get_path_cost"), &HexPathPlanner::get_path_cost);
+	godot::ClassDB::bind_method(godot::D_METHOD("get_last_expansion_count"), &HexPathPlanner::get_last_expansion_count);
+	ADD_PROPERTY(godot::PropertyInfo(godot::Variant::VECTOR2I, "start"), "set_start", "get_start");
+	ADD_PROPERTY(godot::PropertyInfo(godot::Variant::VECTOR2I, "goal"), "set_goal", "get_goal");
+}
@@ -0,0 +1,290 @@
+/**
+ * @file HexPathPlanner.h
+ * @brief A path that repairs itself when the grid changes, using D* Lite.
+ * @details See Koenig and Likhachev, "D* Lite" (2002). The search runs backward from the goal, so every reached hex knows its cost to the goal. When a hex changes, only its neighbors are re-evaluated, and the search continues from there until the start is consistent again. The start can move along the path without restarting, since the goal side of the search does not depend on it. Changes to tiles and to the cost layer are picked up from the grid's signals. Edits to the blocker region are not tracked, report them with notify_hex_changed.
+ * @version 1.0
+ *
+ *
+ *
+ */
+#ifndef GODOT_HEX_GRID_EXTENSION_HEX_PATH_PLANNER_H
+#define GODOT_HEX_GRID_EXTENSION_HEX_PATH_PLANNER_H
+
+#include "godot_cpp/classes/ref_counted.hpp"
+#include "godot_cpp/core/object.hpp"
+#include "HexLayer.h"
+#include "HexRegion.h"
+#include <cstdint>
+#include <limits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+class HexGrid;
+
+/// @brief A single unit's path to a goal, kept up to date as the grid changes underneath it.
+class HexPathPlanner : public godot::RefCounted
+{
+    GDCLASS(HexPathPlanner, godot::RefCounted)
+
+    /**
+     * @brief A priority in the open list, compared first by the estimate through the hex, then by the cost from it.
+     *
+     */
+    using Key = std::pair<float, float>;
+    /**
+     * @brief The search state of a hex that has been reached.
+     *
+     */
+    struct Record {
+        /// @brief The cost to the goal as of the last expansion.
+        float cost{ std::numeric_limits<float>::infinity() };
+        /// @brief The cost to the goal looking one step ahead. The hex is consistent when both are equal.
+        float lookahead{ std::numeric_limits<float>::infinity() };
+        /// @brief The hex's priority, if it is in the open list.
+        Key key{};
+        bool open{};
+    };
+    /**
+     * @brief An entry in the open list. Entries are never updated, stale ones are skipped.
+     *
+     */
+    struct OpenEntry {
+        Key key{};
+        std::pair<int, int> hex{};
+    };
+
+    /**
+     * @brief The instance id of the grid, so a freed grid is noticed instead of used.
+     *
+     */
+    uint64_t grid_id{};
+    /**
+     * @brief The hex the path starts at, the unit's position.
+     *
+     */
+    std::pair<int, int> start{};
+    /**
+     * @brief The hex the start was at when the priorities were last valid.
+     *
+     */
+    std::pair<int, int> last_start{};
+    /**
+     * @brief The hex the path leads to.
+     *
+     */
+    std::pair<int, int> goal{};
+    /**
+     * @brief The name of the layer holding the cost of entering each hex. If empty, every step costs 1.
+     *
+     */
+    godot::StringName cost_layer{};
+    /**
+     * @brief The hexes that cannot be entered.
+     *
+     */
+    godot::Ref<HexRegion> blockers;
+    /**
+     * @brief The amount the estimates shrank by as the start moved, added to new priorities instead of updating old ones.
+     *
+     */
+    float key_modifier{};
+    /**
+     * @brief A map that maps a hex's key to its search state.
+     *
+     */
+    std::unordered_map<int64_t, Record> records{};
+    /**
+     * @brief The open list, kept as a heap with the lowest priority on top.
+     *
+     */
+    std::vector<OpenEntry> open{};
+    /**
+     * @brief The hexes that changed since the last replan.
+     *
+     */
+    std::vector<std::pair<int, int>> changed_hexes{};
+    /**
+     * @brief Whether the next replan has to start over, after the cost layer was cleared or the goal moved.
+     *
+     */
+    bool needs_reset{ true };
+    /**
+     * @brief The amount of hexes expanded by the last replan.
+     *
+     */
+    int last_expansion_count{};
+    /**
+     * @brief The path found by the last replan.
+     *
+     */
+    std::vector<std::pair<int, int>> path{};
+
+    /**
+     * @brief The grid and layer used during a replan. Only valid inside replan.
+     *
+     */
+    HexGrid* grid{};
+    const HexLayer* layer{};
+
+    /**
+     * @brief Binds methods for usage in Godot.
+     *
+     */
+    static void _bind_methods();
+    /**
+     * @brief Gets the grid if it is still alive.
+     *
+     */
+    HexGrid* get_grid() const;
+    /**
+     * @brief Connects to, or disconnects from, the grid's change signals.
+     *
+     */
+    void connect_grid(HexGrid* target, bool connect);
+    /**
+     * @brief Called when a tile is spawned or deleted.
+     *
+     */
+    void on_hex_changed(int q, int r);
+    /**
+     * @brief Called when a cell of any layer changes.
+     *
+     */
+    void on_layer_value_changed(const godot::StringName &layer_name, int q, int r);
+    /**
+     * @brief Called when any layer is cleared or removed.
+     *
+     */
+    void on_layer_cleared(const godot::StringName &layer_name);
+    /**
+     * @brief Called when a batch of commands or a pattern was applied.
+     *
+     */
+    void on_commands_flushed(const godot::Ref<HexRegion> &changed);
+    /**
+     * @brief Called when many cells of a layer were written at once, such as by a HexCellularAutomaton step.
+     *
+     */
+    void on_layer_region_changed(const godot::StringName &layer_name, const godot::Ref<HexRegion> &changed);
+
+    /**
+     * @brief Gets the cost of stepping onto a hex, or infinity if it cannot be entered.
+     *
+     */
+    float step_cost(int q, int r) const;
+    /**
+     * @brief Gets the estimated cost between two hexes.
+     *
+     */
+    float estimate(std::pair<int, int> from, std::pair<int, int> to) const;
+    /**
+     * @brief Gets a hex's search state, as unreached if it has none.
+     *
+     */
+    const Record &get_record(std::pair<int, int> hex) const;
+    /**
+     * @brief Gets a hex's priority from its current costs.
+     *
+     */
+    Key calculate_key(std::pair<int, int> hex, const Record &record) const;
+    /**
+     * @brief Recomputes a hex's lookahead from its neighbors, and queues it if it is inconsistent.
+     *
+     */
+    void update_hex(std::pair<int, int> hex);
+    /**
+     * @brief Gets the valid entry with the lowest priority, dropping stale ones.
+     *
+     * @param entry The entry.
+     * @return bool False if the open list is empty.
+     */
+    bool peek(OpenEntry &entry);
+    /**
+     * @brief Expands hexes until the start is consistent and nothing cheaper is left in the open list.
+     *
+     */
+    void compute_shortest_path();
+    /**
+     * @brief Drops the search and starts a new one from the goal.
+     *
+     */
+    void reset_search();
+    /**
+     * @brief Follows the cheapest neighbors from the start to the goal.
+     *
+     */
+    void build_path();
+
+public:
+    HexPathPlanner();
+    ~HexPathPlanner();
+    /**
+     * @brief Points the planner at a grid and a goal, and subscribes to the grid's changes. The first replan searches from scratch.
+     *
+     * @param target_grid The grid to path on.
+     * @param from The coordinates to start from.
+     * @param to The coordinates to reach.
+     * @param layer_name The name of the layer holding the cost of entering each hex, clamped to at least 1. Negative values are impassable. If empty, every step costs 1.
+     * @param blocker_region The hexes that cannot be entered. Can be null.
+     */
+    void setup(HexGrid* target_grid, godot::Vector2i from, godot::Vector2i to, const godot::StringName &layer_name, const godot::Ref<HexRegion> &blocker_region);
+    /**
+     * @brief Moves the start, typically as the unit walks along the path. The search is kept.
+     *
+     * @param from The new start coordinates.
+     */
+    void set_start(godot::Vector2i from);
+    godot::Vector2i get_start() const;
+    /**
+     * @brief Moves the goal. The next replan searches from scratch, since the whole search depends on the goal.
+     *
+     * @param to The new goal coordinates.
+     */
+    void set_goal(godot::Vector2i to);
+    godot::Vector2i get_goal() const;
+    /**
+     * @brief Reports a hex whose passability changed without a signal, such as after editing the blocker region in place.
+     *
+     * @param q The q-coordinate.
+     * @param r The r-coordinate.
+     */
+    void notify_hex_changed(int q, int r);
+    /**
+     * @brief Repairs the search for every change since the last replan, and rebuilds the path.
+     *
+     * @return bool True if the goal can be reached.
+     */
+    bool replan();
+    /**
+     * @brief Gets the path found by the last replan.
+     *
+     * @return godot::Array An array containing the hexes of the path, from the start to the goal. Empty if there is none. Hexes without a tile are left out, so use get_path_coords on grids that are partly headless.
+     */
+    godot::Array get_path() const;
+    /**
+     * @brief Gets the coordinates of the path found by the last replan, which also works on headless grids. Intended for usage directly from Godot.
+     *
+     * @return godot::Array An array containing the Vector2i coordinates of the path, from the start to the goal. Empty if there is none.
+     */
+    godot::Array get_path_coords() const;
+    /**
+     * @brief Gets the coordinates of the path found by the last replan.
+     *
+     * @return const std::vector<std::pair<int, int>>& The path, from the start to the goal.
+     */
+    const std::vector<std::pair<int, int>> &get_path_axial() const;
+    /**
+     * @brief Gets the cost of the path found by the last replan.
+     *
+     * @return float The cost, or infinity if there is no path.
+     */
+    float get_path_cost() const;
+    /**
+     * @brief Gets the amount of hexes expanded by the last replan, to see how much a change cost.
+     *
+     */
+    int get_last_expansion_count() const;
+};
+
+#endif //GODOT_HEX_GRID_EXTENSION_HEX_PATH_PLANNER_H
@@ -0,0 +1,71 @@
+#include "HexPathfinder.h"
+
+#include <climits>
+
+HexPathfinder::HexPathfinder(const HexTileStorage &storage) : storage(storage) {
+	// A straight line on a wrapping map can pass every cell at most once before it repeats.
+	int64_t cell_count = storage.get_cell_count();
+	jump_limit = storage.wraps() && cell_count < INT_MAX ? int(cell_count) : INT_MAX;
+}
+
+void HexPathfinder::reset() {
+	records.clear();
+	open.clear();
+	expansions = 0;
+}
+
+void HexPathfinder::relax(std::pair<int, int> hex, std::pair<int, int> parent, float cost, int direction, std::pair<int, int> goal) {
+	auto inserted = records.try_emplace(HexTileStorage::key(hex.first, hex.second));
+	Record &record = inserted.first->second;
+	if (!inserted.second && (record.closed || cost >= record.cost)) {
+		return;
+	}
+	record.parent = parent;
+	record.cost = cost;
+	record.direction = direction;
+
+	open.push_back(OpenEntry{ cost + float(storage.distance(hex, goal)), cost, hex });
+	std::push_heap(open.begin(), open.end(), is_worse);
+}
+
+bool HexPathfinder::pop(std::pair<int, int> &hex) {
+	while (!open.empty()) {
+		std::pop_heap(open.begin(), open.end(), is_worse);
+		OpenEntry entry = open.back();
+		open.pop_back();
+
+		Record &record = records[HexTileStorage::key(entry.hex.first, entry.hex.second)];
+		if (record.closed || entry.cost > record.cost) {
+			continue;
+		}
+		record.closed = true;
+		hex = entry.hex;
+		return true;
+	}
+	return false;
+}
+
+void HexPathfinder::build_path(std::pair<int, int> start, std::pair<int, int> goal, std::vector<std::pair<int, int>> &path) const {
+	std::pair<int, int> hex = goal;
+	path.push_back(hex);
+	while (hex != start) {
+		const Record &record = records.at(HexTileStorage::key(hex.first, hex.second));
+		if (record.direction < 0) {
+			path.push_back(record.parent);
+		} else {
+			// Jumps run in a straight line, so the skipped hexes are found by stepping back toward the parent.
+			std::pair<int, int> skipped = step(hex, record.direction + 3);
+			while (skipped != record.parent) {
+				path.push_back(skipped);
+				skipped = step(skipped, record.direction + 3);
+			}
+			path.push_back(record.parent);
+		}
+		hex = record.parent;
+	}
+	std::reverse(path.begin(), path.end());
+}
+
+size_t HexPathfinder::get_expansions() const {
+	return expansions;
+}
@@ -0,0 +1,287 @@
+/**
+ * @file HexPathfinder.h
+ * @brief A* and Jump Point Search over a HexGrid's tile storage.
+ * @details The jump point search follows the canonical ordering from Sturtevant and Rabin's "Canonical Orderings on Grids". The six directions alternate between primary (0, 2, 4) and secondary (1, 3, 5). Every shortest path in open terrain runs between two neighboring directions, one of each kind, so it can always be taken primary moves first. A primary move may continue or turn into either neighboring secondary direction, a secondary move may only continue. A secondary move is only allowed to turn where a wall blocks the path it would otherwise have been reached by, a forced neighbor. Scans then run along straight lines and only stop at the goal, a forced neighbor, or a primary step whose secondary scans find one, so open terrain is crossed without expanding every hex.
+ * @version 1.0
+ *
+ *
+ *
+ */
+#ifndef GODOT_HEX_GRID_EXTENSION_HEX_PATHFINDER_H
+#define GODOT_HEX_GRID_EXTENSION_HEX_PATHFINDER_H
+
+#include "HexShapes.h"
+#include "HexTileStorage.h"
+#include <algorithm>
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/// @brief A single path search. Not a Godot object, the HexGrid creates one per query.
+class HexPathfinder
+{
+    /**
+     * @brief The search state of a hex that has been reached.
+     *
+     */
+    struct Record {
+        std::pair<int, int> parent{};
+        float cost{};
+        /// @brief The direction the hex was reached in, or -1 if it was reached from a neighbor or is the start.
+        int direction{ -1 };
+        bool closed{};
+    };
+    /**
+     * @brief An entry in the open list. Entries are never updated, stale ones are skipped when popped.
+     *
+     */
+    struct OpenEntry {
+        float estimate{};
+        float cost{};
+        std::pair<int, int> hex{};
+    };
+
+    /**
+     * @brief The storage the search runs over. Used for wrapping, neighbors and distances.
+     *
+     */
+    const HexTileStorage &storage;
+    /**
+     * @brief A map that maps a hex's key to its search state.
+     *
+     */
+    std::unordered_map<int64_t, Record> records{};
+    /**
+     * @brief The open list, kept as a heap with the lowest estimate on top.
+     *
+     */
+    std::vector<OpenEntry> open{};
+    /**
+     * @brief The amount of hexes expanded by the last search.
+     *
+     */
+    size_t expansions{};
+    /**
+     * @brief The longest a single scan may run before it stops on its own. Only limited on wrapping maps, where a straight line can circle the map forever.
+     *
+     */
+    int jump_limit{};
+
+    /**
+     * @brief Orders the open list so the lowest estimate is on top. Ties go to the entry furthest along, which tends to reach the goal sooner.
+     *
+     */
+    static bool is_worse(const OpenEntry &a, const OpenEntry &b) {
+        return a.estimate > b.estimate || (a.estimate == b.estimate && a.cost < b.cost);
+    }
+    /**
+     * @brief Checks if a direction is primary, the kind that may turn.
+     *
+     */
+    static bool is_primary(int direction) {
+        return (direction & 1) == 0;
+    }
+
+    /**
+     * @brief Gets the canonical neighbor of a hex in a direction.
+     *
+     */
+    std::pair<int, int> step(std::pair<int, int> hex, int direction) const {
+        const std::pair<int, int> &offset = HEX_DIRECTIONS[direction % 6];
+        return storage.canonicalize(std::pair<int, int>(hex.first + offset.first, hex.second + offset.second));
+    }
+    /**
+     * @brief Clears the state of the previous search.
+     *
+     */
+    void reset();
+    /**
+     * @brief Records a better way to reach a hex, and queues it. Does nothing if the hex was already reached at no more cost.
+     *
+     * @param hex The canonical coordinates of the hex.
+     * @param parent The hex it was reached from.
+     * @param cost The total cost of reaching it.
+     * @param direction The direction it was reached in, or -1.
+     * @param goal The goal, for the estimate.
+     */
+    void relax(std::pair<int, int> hex, std::pair<int, int> parent, float cost, int direction, std::pair<int, int> goal);
+    /**
+     * @brief Pops the open hex with the lowest estimate and closes it.
+     *
+     * @param hex The popped hex.
+     * @return bool False if the open list ran out.
+     */
+    bool pop(std::pair<int, int> &hex);
+    /**
+     * @brief Walks the parents back from the goal. Hexes skipped over by a jump are filled back in.
+     *
+     * @param start The start of the search.
+     * @param goal The goal of the search.
+     * @param path The path from the start to the goal, both included.
+     */
+    void build_path(std::pair<int, int> start, std::pair<int, int> goal, std::vector<std::pair<int, int>> &path) const;
+
+    /**
+     * @brief Checks if a hex reached by a secondary move has a forced neighbor, one that can only be reached through it.
+     *
+     * @param hex The hex.
+     * @param direction The secondary direction it was reached in.
+     * @param is_passable The passability test.
+     * @return bool True if either neighboring primary direction is forced.
+     */
+    template <typename Passable>
+    bool has_forced_neighbor(std::pair<int, int> hex, int direction, Passable &is_passable) const {
+        for (int side = 1; side <= 5; side += 4) {
+            // The neighbor one turn over is normally reached from the hex two turns over, unless that one is a wall.
+            std::pair<int, int> neighbor = step(hex, direction + side);
+            std::pair<int, int> shortcut = step(hex, direction + 2 * side);
+            if (is_passable(neighbor.first, neighbor.second) && !is_passable(shortcut.first, shortcut.second)) {
+                return true;
+            }
+        }
+        return false;
+    }
+    /**
+     * @brief Scans along a straight line for the next jump point.
+     *
+     * @param from The hex to scan from. Not checked itself.
+     * @param direction The direction to scan in.
+     * @param goal The goal, which always counts as a jump point.
+     * @param is_passable The passability test.
+     * @param jump_point The jump point found.
+     * @param steps The amount of steps to the jump point.
+     * @return bool False if the scan ran into a wall first.
+     */
+    template <typename Passable>
+    bool jump(std::pair<int, int> from, int direction, std::pair<int, int> goal, Passable &is_passable, std::pair<int, int> &jump_point, int &steps) const {
+        std::pair<int, int> hex = from;
+        for (steps = 1; ; steps++) {
+            hex = step(hex, direction);
+            if (!is_passable(hex.first, hex.second)) {
+                return false;
+            }
+            jump_point = hex;
+            if (hex == goal || steps >= jump_limit) {
+                return true;
+            }
+            if (!is_primary(direction)) {
+                if (has_forced_neighbor(hex, direction, is_passable)) {
+                    return true;
+                }
+                continue;
+            }
+
+            // A primary step is a jump point if either secondary scan off of it finds one.
+            std::pair<int, int> found{};
+            int found_steps = 0;
+            if (jump(hex, direction + 1, goal, is_passable, found, found_steps) || jump(hex, direction + 5, goal, is_passable, found, found_steps)) {
+                return true;
+            }
+        }
+    }
+
+public:
+    explicit HexPathfinder(const HexTileStorage &storage);
+
+    /**
+     * @brief Finds the cheapest path with A*.
+     *
+     * @param start The hex to start from.
+     * @param goal The hex to reach.
+     * @param is_passable Called as is_passable(q, r) with canonical coordinates. Returns true if the hex can be entered.
+     * @param cost Called as cost(q, r) with canonical coordinates. Returns the cost of entering the hex, which must be at least 1 for the path to be optimal.
+     * @param path The path from the start to the goal, both included. Left empty if there is none.
+     * @return bool True if a path was found.
+     */
+    template <typename Passable, typename Cost>
+    bool find_path(std::pair<int, int> start, std::pair<int, int> goal, Passable &&is_passable, Cost &&cost, std::vector<std::pair<int, int>> &path) {
+        reset();
+        path.clear();
+        start = storage.canonicalize(start);
+        goal = storage.canonicalize(goal);
+        if (!is_passable(start.first, start.second) || !is_passable(goal.first, goal.second)) {
+            return false;
+        }
+
+        relax(start, start, 0.0f, -1, goal);
+        std::pair<int, int> current{};
+        while (pop(current)) {
+            if (current == goal) {
+                build_path(start, goal, path);
+                return true;
+            }
+            expansions++;
+
+            float current_cost = records[HexTileStorage::key(current.first, current.second)].cost;
+            storage.for_each_neighbor(current.first, current.second, [&](int q, int r, HexTile*) {
+                if (is_passable(q, r)) {
+                    relax(std::pair<int, int>(q, r), current, current_cost + cost(q, r), -1, goal);
+                }
+            });
+        }
+        return false;
+    }
+    /**
+     * @brief Finds a shortest path with Jump Point Search, where every step costs the same. Finds paths as short as A* would, while expanding far fewer hexes in open terrain.
+     *
+     * @param start The hex to start from.
+     * @param goal The hex to reach.
+     * @param is_passable Called as is_passable(q, r) with canonical coordinates. Returns true if the hex can be entered.
+     * @param path The path from the start to the goal, both included. Left empty if there is none.
+     * @return bool True if a path was found.
+     */
+    template <typename Passable>
+    bool find_jump_path(std::pair<int, int> start, std::pair<int, int> goal, Passable &&is_passable, std::vector<std::pair<int, int>> &path) {
+        reset();
+        path.clear();
+        start = storage.canonicalize(start);
+        goal = storage.canonicalize(goal);
+        if (!is_passable(start.first, start.second) || !is_passable(goal.first, goal.second)) {
+            return false;
+        }
+
+        relax(start, start, 0.0f, -1, goal);
+        std::pair<int, int> current{};
+        while (pop(current)) {
+            if (current == goal) {
+                build_path(start, goal, path);
+                return true;
+            }
+            expansions++;
+
+            const Record &record = records[HexTileStorage::key(current.first, current.second)];
+            float current_cost = record.cost;
+            int arrival = record.direction;
+            for (int direction = 0; direction < 6; direction++) {
+                if (arrival >= 0 && direction != arrival) {
+                    int turn = (direction - arrival + 6) % 6;
+                    if (turn != 1 && turn != 5) {
+                        continue;
+                    }
+                    // Secondary moves only turn toward a forced neighbor.
+                    if (!is_primary(arrival)) {
+                        std::pair<int, int> shortcut = step(current, arrival + 2 * turn);
+                        if (is_passable(shortcut.first, shortcut.second)) {
+                            continue;
+                        }
+                    }
+                }
+
+                std::pair<int, int> jump_point{};
+                int steps = 0;
+                if (jump(current, direction, goal, is_passable, jump_point, steps)) {
+                    relax(jump_point, current, current_cost + float(steps), direction, goal);
+                }
+            }
+        }
+        return false;
+    }
+    /**
+     * @brief Gets the amount of hexes expanded by the last search.
+     *
+     */
+    size_t get_expansions() const;
+};
+
+#endif //GODOT_HEX_GRID_EXTENSION_HEX_PATHFINDER_H
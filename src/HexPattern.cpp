@@ -0,0 +1,189 @@
+#include "HexPattern.h"
+#include "HexTileStorage.h"
+#include "godot_cpp/core/class_db.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+HexPattern::HexPattern() {
+
+}
+
+size_t HexPattern::ensure_cell(godot::Vector2i offset) {
+	auto found = cell_indices.find(HexTileStorage::key(offset.x, offset.y));
+	if (found != cell_indices.end()) {
+		return found->second;
+	}
+	cells.push_back(Cell{ std::pair<int, int>(offset.x, offset.y), TILE_KEEP, -1 });
+	for (std::pair<const godot::StringName, std::vector<float>> &layer : layers) {
+		layer.second.push_back(std::numeric_limits<float>::quiet_NaN());
+	}
+	cell_indices[HexTileStorage::key(offset.x, offset.y)] = cells.size() - 1;
+	return cells.size() - 1;
+}
+
+void HexPattern::set_tile(godot::Vector2i offset, const godot::Ref<godot::PackedScene> &tile) {
+	Cell &cell = cells[ensure_cell(offset)];
+	cell.action = TILE_PLACE;
+	cell.tile = -1;
+	if (tile.is_valid()) {
+		auto found = std::find(tiles.begin(), tiles.end(), tile);
+		cell.tile = int(found - tiles.begin());
+		if (found == tiles.end()) {
+			tiles.push_back(tile);
+		}
+	}
+}
+
+void HexPattern::set_deleted(godot::Vector2i offset) {
+	Cell &cell = cells[ensure_cell(offset)];
+	cell.action = TILE_DELETE;
+	cell.tile = -1;
+}
+
+void HexPattern::set_layer_value(godot::Vector2i offset, const godot::StringName &layer, float value) {
+	ERR_FAIL_COND_MSG(std::isnan(value), "Layer values cannot be NaN.");
+	size_t index = ensure_cell(offset);
+	std::vector<float> &values = layers[layer];
+	values.resize(cells.size(), std::numeric_limits<float>::quiet_NaN());
+	values[index] = value;
+}
+
+void HexPattern::remove_cell(godot::Vector2i offset) {
+	auto found = cell_indices.find(HexTileStorage::key(offset.x, offset.y));
+	ERR_FAIL_COND_MSG(found == cell_indices.end(), "Cannot remove a non-existing cell.");
+	// The last cell is moved into the gap, along with its layer values.
+	size_t index = found->second;
+	size_t last = cells.size() - 1;
+	cell_indices.erase(found);
+	if (index != last) {
+		cells[index] = cells[last];
+		cell_indices[HexTileStorage::key(cells[index].offset.first, cells[index].offset.second)] = index;
+	}
+	cells.pop_back();
+	for (std::pair<const godot::StringName, std::vector<float>> &layer : layers) {
+		layer.second[index] = layer.second[last];
+		layer.second.pop_back();
+	}
+}
+
+void HexPattern::clear() {
+	cells.clear();
+	cell_indices.clear();
+	tiles.clear();
+	layers.clear();
+}
+
+godot::Array HexPattern::get_cells() const {
+	godot::Array return_array = godot::Array();
+	for (const Cell &cell : cells) {
+		return_array.append(godot::Vector2i(cell.offset.first, cell.offset.second));
+	}
+	return return_array;
+}
+
+int HexPattern::get_cell_count() const {
+	return int(cells.size());
+}
+
+godot::PackedInt32Array HexPattern::get_cell_data() const {
+	godot::PackedInt32Array data = godot::PackedInt32Array();
+	data.resize(cells.size() * 4);
+	int32_t* write = data.ptrw();
+	for (const Cell &cell : cells) {
+		*write++ = cell.offset.first;
+		*write++ = cell.offset.second;
+		*write++ = cell.action;
+		*write++ = cell.tile;
+	}
+	return data;
+}
+
+void HexPattern::set_cell_data(const godot::PackedInt32Array &data) {
+	ERR_FAIL_COND_MSG(data.size() % 4 != 0, "Pattern data is malformed.");
+	cells.clear();
+	cell_indices.clear();
+	// The index of the record each kept cell came from, so layer values written for the records can follow the cells that survive.
+	std::vector<size_t> kept = std::vector<size_t>();
+	const int32_t* read = data.ptr();
+	for (int64_t i = 0; i < data.size(); i += 4) {
+		ERR_CONTINUE_MSG((read[i + 2] < TILE_KEEP) || (read[i + 2] > TILE_DELETE), "Pattern data has an invalid tile action.");
+		if (cell_indices.count(HexTileStorage::key(read[i], read[i + 1]))) {
+			continue;
+		}
+		cell_indices[HexTileStorage::key(read[i], read[i + 1])] = cells.size();
+		cells.push_back(Cell{ std::pair<int, int>(read[i], read[i + 1]), read[i + 2], read[i + 3] });
+		kept.push_back(size_t(i / 4));
+	}
+	size_t records = size_t(data.size() / 4);
+	for (std::pair<const godot::StringName, std::vector<float>> &layer : layers) {
+		if (layer.second.size() == records) {
+			for (size_t index = 0; index < kept.size(); index++) {
+				layer.second[index] = layer.second[kept[index]];
+			}
+		}
+		layer.second.resize(cells.size(), std::numeric_limits<float>::quiet_NaN());
+	}
+}
+
+godot::Array HexPattern::get_tile_palette() const {
+	godot::Array palette = godot::Array();
+	for (const godot::Ref<godot::PackedScene> &tile : tiles) {
+		palette.append(tile);
+	}
+	return palette;
+}
+
+void HexPattern::set_tile_palette(const godot::Array &palette) {
+	tiles.clear();
+	for (int64_t i = 0; i < palette.size(); i++) {
+		tiles.push_back(godot::Ref<godot::PackedScene>(palette[i]));
+	}
+}
+
+godot::Dictionary HexPattern::get_layer_data() const {
+	godot::Dictionary data = godot::Dictionary();
+	for (const std::pair<const godot::StringName, std::vector<float>> &layer : layers) {
+		godot::PackedFloat32Array values = godot::PackedFloat32Array();
+		values.resize(int64_t(layer.second.size()));
+		std::copy(layer.second.begin(), layer.second.end(), values.ptrw());
+		data[layer.first] = values;
+	}
+	return data;
+}
+
+void HexPattern::set_layer_data(const godot::Dictionary &data) {
+	layers.clear();
+	godot::Array names = data.keys();
+	for (int64_t i = 0; i < names.size(); i++) {
+		godot::PackedFloat32Array values = data[names[i]];
+		std::vector<float> &layer = layers[godot::StringName(names[i])];
+		layer.assign(values.ptr(), values.ptr() + values.size());
+		// Padded or cut to the cells, so every layer always lines up with them.
+		layer.resize(cells.size(), std::numeric_limits<float>::quiet_NaN());
+	}
+}
+
+void HexPattern::_bind_methods() {
+	godot::ClassDB::bind_method(godot::D_METHOD("set_tile", "offset", "tile"), &HexPattern::set_tile, DEFVAL(nullptr));
+	godot::ClassDB::bind_method(godot::D_METHOD("set_deleted", "offset"), &HexPattern::set_deleted);
+	godot::ClassDB::bind_method(godot::D_METHOD("set_layer_value", "offset", "layer", "value"), &HexPattern::set_layer_value);
+	godot::ClassDB::bind_method(godot::D_METHOD("remove_cell", "offset"), &HexPattern::remove_cell);
+	godot::ClassDB::bind_method(godot::D_METHOD("clear"), &HexPattern::clear);
+	godot::ClassDB::bind_method(godot::D_METHOD("get_cells"), &HexPattern::get_cells);
+	godot::ClassDB::bind_method(godot::D_METHOD("get_cell_count"), &HexPattern::get_cell_count);
+	godot::ClassDB::bind_method(godot::D_METHOD("get_cell_data"), &HexPattern::get_cell_data);
+	godot::ClassDB::bind_method(godot::D_METHOD("set_cell_data", "data"), &HexPattern::set_cell_data);
+	godot::ClassDB::bind_method(godot::D_METHOD("get_tile_palette"), &HexPattern::get_tile_palette);
+	godot::ClassDB::bind_method(godot::D_METHOD("set_tile_palette", "palette"), &HexPattern::set_tile_palette);
+	godot::ClassDB::bind_method(godot::D_METHOD("get_layer_data"), &HexPattern::get_layer_data);
+	godot::ClassDB::bind_method(godot::D_METHOD("set_layer_data", "data"), &HexPattern::set_layer_data);
+	ADD_PROPERTY(godot::PropertyInfo(godot::Variant::PACKED_INT32_ARRAY, "cell_data", godot::PROPERTY_HINT_NONE, "", godot::PROPERTY_USAGE_STORAGE), "set_cell_data", "get_cell_data");
+	ADD_PROPERTY(godot::PropertyInfo(godot::Variant::ARRAY, "tile_palette", godot::PROPERTY_HINT_NONE, "", godot::PROPERTY_USAGE_STORAGE), "set_tile_palette", "get_tile_palette");
+	ADD_PROPERTY(godot::PropertyInfo(godot::Variant::DICTIONARY, "layer_data", godot::PROPERTY_HINT_NONE, "", godot::PROPERTY_USAGE_STORAGE), "set_layer_data", "get_layer_data");
+
+	godot::ClassDB::bind_integer_constant(get_class_static(), "TileAction", "TILE_KEEP", TILE_KEEP);
+	godot::ClassDB::bind_integer_constant(get_class_static(), "TileAction", "TILE_PLACE", TILE_PLACE);
+	godot::ClassDB::bind_integer_constant(get_class_static(), "TileAction", "TILE_DELETE", TILE_DELETE);
+}
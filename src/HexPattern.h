@@ -0,0 +1,152 @@
+/**
+ * @file HexPattern.h
+ * @brief A prefab of hexes, such as a fortress or a lake, that can be stamped onto a HexGrid rotated and mirrored.
+ * @details Cells are kept as offsets from the pattern's anchor, each with what to do with its tile and the values to write to any layers. The scenes are kept once each in a palette, so a pattern saved as a resource stores an index per cell rather than a scene.
+ * @version 1.0
+ *
+ *
+ *
+ */
+#ifndef GODOT_HEX_GRID_EXTENSION_HEX_PATTERN_H
+#define GODOT_HEX_GRID_EXTENSION_HEX_PATTERN_H
+
+#include "godot_cpp/classes/packed_scene.hpp"
+#include "godot_cpp/classes/resource.hpp"
+#include "godot_cpp/core/object.hpp"
+#include "godot_cpp/variant/dictionary.hpp"
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/// @brief Offsets with tiles and layer values, placed all at once by HexGrid.stamp_pattern.
+class HexPattern : public godot::Resource
+{
+    GDCLASS(HexPattern, godot::Resource)
+    // Reads the cells directly when stamping.
+    friend class HexGrid;
+
+public:
+    /**
+     * @brief Enumerations for what a cell does to the hex it lands on.
+     *
+     */
+    enum TileAction {
+        /// @brief Leaves the hex as it is, only writing layer values.
+        TILE_KEEP,
+        /// @brief Spawns the hex, or replaces it if it exists.
+        TILE_PLACE,
+        /// @brief Deletes the hex if it exists.
+        TILE_DELETE
+    };
+
+private:
+    /**
+     * @brief One cell of the pattern.
+     *
+     */
+    struct Cell {
+        std::pair<int, int> offset{};
+        int action{};
+        /// @brief The index into tiles, or -1 for the tile given when stamping.
+        int tile{ -1 };
+    };
+    struct StringNameHasher {
+        size_t operator()(const godot::StringName &name) const { return name.hash(); }
+    };
+
+    std::vector<Cell> cells{};
+    /**
+     * @brief A map that maps an offset's key to its index in cells.
+     *
+     */
+    std::unordered_map<int64_t, size_t> cell_indices{};
+    /**
+     * @brief The scenes used by the cells, each once.
+     *
+     */
+    std::vector<godot::Ref<godot::PackedScene>> tiles{};
+    /**
+     * @brief A map that maps a layer name to the value of every cell, in the same order as cells. Cells that do not write the layer hold NaN.
+     *
+     */
+    std::unordered_map<godot::StringName, std::vector<float>, StringNameHasher> layers{};
+
+    /**
+     * @brief Binds methods for usage in Godot.
+     *
+     */
+    static void _bind_methods();
+    /**
+     * @brief Gets the index of a cell, adding it if needed.
+     *
+     */
+    size_t ensure_cell(godot::Vector2i offset);
+
+public:
+    HexPattern();
+    /**
+     * @brief Places a tile at an offset when stamped. Intended for usage directly from Godot.
+     *
+     * @param offset The offset from the anchor, q as x and r as y.
+     * @param tile The tile's scene. If null, the one given to stamp_pattern is used.
+     */
+    void set_tile(godot::Vector2i offset, const godot::Ref<godot::PackedScene> &tile);
+    /**
+     * @brief Deletes the hex at an offset when stamped. Intended for usage directly from Godot.
+     *
+     * @param offset The offset from the anchor, q as x and r as y.
+     */
+    void set_deleted(godot::Vector2i offset);
+    /**
+     * @brief Writes a layer value at an offset when stamped. Intended for usage directly from Godot.
+     *
+     * @param offset The offset from the anchor, q as x and r as y.
+     * @param layer The layer's name.
+     * @param value The value.
+     */
+    void set_layer_value(godot::Vector2i offset, const godot::StringName &layer, float value);
+    /**
+     * @brief Removes a cell, with its tile and layer values. Intended for usage directly from Godot.
+     *
+     * @param offset The offset from the anchor, q as x and r as y.
+     */
+    void remove_cell(godot::Vector2i offset);
+    /**
+     * @brief Removes every cell. Intended for usage directly from Godot.
+     *
+     */
+    void clear();
+    /**
+     * @brief Gets the offsets of every cell. Intended for usage directly from Godot.
+     *
+     * @return godot::Array An array containing the Vector2i offsets.
+     */
+    godot::Array get_cells() const;
+    int get_cell_count() const;
+
+    /**
+     * @brief Gets the cells packed as q, r, action and tile index, four values per cell. Used to save the pattern.
+     *
+     */
+    godot::PackedInt32Array get_cell_data() const;
+    /**
+     * @brief Replaces the cells with packed ones from get_cell_data. Records with an invalid action or a repeated offset are skipped, along with their layer values, and every layer is padded with NaN or cut to the cells that remain.
+     *
+     */
+    void set_cell_data(const godot::PackedInt32Array &data);
+    godot::Array get_tile_palette() const;
+    void set_tile_palette(const godot::Array &palette);
+    /**
+     * @brief Gets the layer values, as a dictionary that maps each layer name to a PackedFloat32Array in the same order as the cells. Used to save the pattern.
+     *
+     */
+    godot::Dictionary get_layer_data() const;
+    /**
+     * @brief Replaces the layer values with ones from get_layer_data. Each layer is padded with NaN or cut to the number of cells.
+     *
+     */
+    void set_layer_data(const godot::Dictionary &data);
+};
+
+#endif //GODOT_HEX_GRID_EXTENSION_HEX_PATTERN_H
@@ -0,0 +1,399 @@
+#include "HexRegion.h"
+#include "HexShapes.h"
+#include "godot_cpp/core/class_db.hpp"
+
+#include <algorithm>
+#include <numeric>
+
+namespace {
+	// The cells in the first and last column and row of a chunk. Every word holds four rows of sixteen cells.
+	constexpr uint64_t FIRST_COLUMN = 0x0001000100010001ULL;
+	constexpr uint64_t LAST_COLUMN = 0x8000800080008000ULL;
+	constexpr uint64_t ROW_BITS = 0xFFFFULL;
+
+	// Shifts the bits of a chunk towards higher cell indices, or lower ones if the amount is negative. Bits shifted out are dropped.
+	HexRegion::ChunkBits shift_bits(const HexRegion::ChunkBits &bits, int amount) {
+		HexRegion::ChunkBits result{};
+		if (amount >= 0) {
+			int words = amount >> 6;
+			int offset = amount & 63;
+			for (int i = HEX_CHUNK_WORDS - 1; i >= words; i--) {
+				uint64_t word = bits[i - words] << offset;
+				if (offset && i - words - 1 >= 0) {
+					word |= bits[i - words - 1] >> (64 - offset);
+				}
+				result[i] = word;
+			}
+		} else {
+			amount = -amount;
+			int words = amount >> 6;
+			int offset = amount & 63;
+			for (int i = 0; i + words < HEX_CHUNK_WORDS; i++) {
+				uint64_t word = bits[i + words] >> offset;
+				if (offset && i + words + 1 < HEX_CHUNK_WORDS) {
+					word |= bits[i + words + 1] << (64 - offset);
+				}
+				result[i] = word;
+			}
+		}
+		return result;
+	}
+
+	bool is_zero(const HexRegion::ChunkBits &bits) {
+		uint64_t any = 0;
+		for (uint64_t word : bits) {
+			any |= word;
+		}
+		return any == 0;
+	}
+}
+
+HexRegion::HexRegion() {
+
+}
+
+int64_t HexRegion::find_chunk(int64_t key) const {
+	auto it = std::lower_bound(chunk_keys.begin(), chunk_keys.end(), key);
+	if (it == chunk_keys.end() || *it != key) {
+		return -1;
+	}
+	return it - chunk_keys.begin();
+}
+
+void HexRegion::add_hex(int q, int r) {
+	int64_t key = hex_chunk_key_of(q, r);
+	int cell = hex_chunk_cell(q, r);
+
+	auto it = std::lower_bound(chunk_keys.begin(), chunk_keys.end(), key);
+	size_t index = it - chunk_keys.begin();
+	if (it == chunk_keys.end() || *it != key) {
+		chunk_keys.insert(it, key);
+		chunk_bits.insert(chunk_bits.begin() + index, ChunkBits{});
+	}
+	chunk_bits[index][cell >> 6] |= uint64_t(1) << (cell & 63);
+}
+
+void HexRegion::remove_hex(int q, int r) {
+	int64_t index = find_chunk(hex_chunk_key_of(q, r));
+	if (index < 0) {
+		return;
+	}
+
+	int cell = hex_chunk_cell(q, r);
+	chunk_bits[index][cell >> 6] &= ~(uint64_t(1) << (cell & 63));
+	if (is_zero(chunk_bits[index])) {
+		chunk_keys.erase(chunk_keys.begin() + index);
+		chunk_bits.erase(chunk_bits.begin() + index);
+	}
+}
+
+bool HexRegion::has_hex(int q, int r) const {
+	int64_t index = find_chunk(hex_chunk_key_of(q, r));
+	if (index < 0) {
+		return false;
+	}
+
+	int cell = hex_chunk_cell(q, r);
+	return (chunk_bits[index][cell >> 6] >> (cell & 63)) & 1;
+}
+
+void HexRegion::clear() {
+	chunk_keys.clear();
+	chunk_bits.clear();
+}
+
+int64_t HexRegion::count() const {
+	int64_t total = 0;
+	for (const ChunkBits &bits : chunk_bits) {
+		for (uint64_t word : bits) {
+			total += hex_popcount(word);
+		}
+	}
+	return total;
+}
+
+bool HexRegion::is_empty() const {
+	return chunk_keys.empty();
+}
+
+void HexRegion::union_with(const godot::Ref<HexRegion> &other) {
+	ERR_FAIL_COND_MSG(other.is_null(), "Cannot union with a null region.");
+	if (other.ptr() == this) {
+		return;
+	}
+
+	std::vector<int64_t> keys{};
+	std::vector<ChunkBits> bits{};
+	keys.reserve(chunk_keys.size() + other->chunk_keys.size());
+	bits.reserve(chunk_keys.size() + other->chunk_keys.size());
+
+	// Both key arrays are sorted, so this is a plain merge.
+	size_t i = 0;
+	size_t j = 0;
+	while (i < chunk_keys.size() || j < other->chunk_keys.size()) {
+		if (j == other->chunk_keys.size() || (i < chunk_keys.size() && chunk_keys[i] < other->chunk_keys[j])) {
+			keys.push_back(chunk_keys[i]);
+			bits.push_back(chunk_bits[i]);
+			i++;
+		} else if (i == chunk_keys.size() || other->chunk_keys[j] < chunk_keys[i]) {
+			keys.push_back(other->chunk_keys[j]);
+			bits.push_back(other->chunk_bits[j]);
+			j++;
+		} else {
+			ChunkBits merged;
+			for (int word = 0; word < HEX_CHUNK_WORDS; word++) {
+				merged[word] = chunk_bits[i][word] | other->chunk_bits[j][word];
+			}
+			keys.push_back(chunk_keys[i]);
+			bits.push_back(merged);
+			i++;
+			j++;
+		}
+	}
+
+	chunk_keys.swap(keys);
+	chunk_bits.swap(bits);
+}
+
+void HexRegion::intersect_with(const godot::Ref<HexRegion> &other) {
+	ERR_FAIL_COND_MSG(other.is_null(), "Cannot intersect with a null region.");
+	if (other.ptr() == this) {
+		return;
+	}
+
+	// Chunks are only ever dropped, so the result is compacted in place.
+	size_t kept = 0;
+	size_t j = 0;
+	for (size_t i = 0; i < chunk_keys.size(); i++) {
+		while (j < other->chunk_keys.size() && other->chunk_keys[j] < chunk_keys[i]) {
+			j++;
+		}
+		if (j == other->chunk_keys.size() || other->chunk_keys[j] != chunk_keys[i]) {
+			continue;
+		}
+
+		ChunkBits masked;
+		for (int word = 0; word < HEX_CHUNK_WORDS; word++) {
+			masked[word] = chunk_bits[i][word] & other->chunk_bits[j][word];
+		}
+		if (!is_zero(masked)) {
+			chunk_keys[kept] = chunk_keys[i];
+			chunk_bits[kept] = masked;
+			kept++;
+		}
+	}
+
+	chunk_keys.resize(kept);
+	chunk_bits.resize(kept);
+}
+
+void HexRegion::subtract(const godot::Ref<HexRegion> &other) {
+	ERR_FAIL_COND_MSG(other.is_null(), "Cannot subtract a null region.");
+	if (other.ptr() == this) {
+		clear();
+		return;
+	}
+
+	size_t j = 0;
+	for (size_t i = 0; i < chunk_keys.size(); i++) {
+		while (j < other->chunk_keys.size() && other->chunk_keys[j] < chunk_keys[i]) {
+			j++;
+		}
+		if (j < other->chunk_keys.size() && other->chunk_keys[j] == chunk_keys[i]) {
+			for (int word = 0; word < HEX_CHUNK_WORDS; word++) {
+				chunk_bits[i][word] &= ~other->chunk_bits[j][word];
+			}
+		}
+	}
+
+	remove_empty_chunks();
+}
+
+void HexRegion::translate(int direction, std::vector<int64_t> &keys, std::vector<ChunkBits> &bits) const {
+	int dq = HEX_DIRECTIONS[direction].first;
+	int dr = HEX_DIRECTIONS[direction].second;
+
+	// Cells either stay in their chunk or spill over into the next chunk along the move, on each axis.
+	int chunk_dq_options[2] = { 0, dq };
+	int chunk_dr_options[2] = { 0, dr };
+
+	for (int i_dq = 0; i_dq < (dq != 0 ? 2 : 1); i_dq++) {
+		for (int i_dr = 0; i_dr < (dr != 0 ? 2 : 1); i_dr++) {
+			int chunk_dq = chunk_dq_options[i_dq];
+			int chunk_dr = chunk_dr_options[i_dr];
+
+			// Picks out the cells that land in this chunk.
+			uint64_t column_mask = ~uint64_t(0);
+			if (dq != 0) {
+				uint64_t edge = dq > 0 ? LAST_COLUMN : FIRST_COLUMN;
+				column_mask = chunk_dq == 0 ? ~edge : edge;
+			}
+			ChunkBits mask;
+			for (int word = 0; word < HEX_CHUNK_WORDS; word++) {
+				mask[word] = column_mask;
+			}
+			if (dr != 0) {
+				int edge_word = dr > 0 ? HEX_CHUNK_WORDS - 1 : 0;
+				uint64_t edge = dr > 0 ? ROW_BITS << 48 : ROW_BITS;
+				if (chunk_dr == 0) {
+					mask[edge_word] &= ~edge;
+				} else {
+					for (int word = 0; word < HEX_CHUNK_WORDS; word++) {
+						mask[word] &= word == edge_word ? edge : 0;
+					}
+				}
+			}
+
+			int shift = dq + dr * HEX_CHUNK_SIZE - chunk_dq * HEX_CHUNK_SIZE - chunk_dr * HEX_CHUNK_CELLS;
+
+			for (size_t i = 0; i < chunk_keys.size(); i++) {
+				ChunkBits selected;
+				for (int word = 0; word < HEX_CHUNK_WORDS; word++) {
+					selected[word] = chunk_bits[i][word] & mask[word];
+				}
+				if (is_zero(selected)) {
+					continue;
+				}
+
+				std::pair<int, int> chunk = hex_chunk_unkey(chunk_keys[i]);
+				keys.push_back(hex_chunk_key(chunk.first + chunk_dq, chunk.second + chunk_dr));
+				bits.push_back(shift_bits(selected, shift));
+			}
+		}
+	}
+}
+
+void HexRegion::assign_unsorted(const std::vector<int64_t> &keys, const std::vector<ChunkBits> &bits) {
+	std::vector<size_t> order(keys.size());
+	std::iota(order.begin(), order.end(), 0);
+	std::sort(order.begin(), order.end(), [&keys](size_t a, size_t b) { return keys[a] < keys[b]; });
+
+	chunk_keys.clear();
+	chunk_bits.clear();
+	for (size_t index : order) {
+		if (!chunk_keys.empty() && chunk_keys.back() == keys[index]) {
+			for (int word = 0; word < HEX_CHUNK_WORDS; word++) {
+				chunk_bits.back()[word] |= bits[index][word];
+			}
+		} else {
+			chunk_keys.push_back(keys[index]);
+			chunk_bits.push_back(bits[index]);
+		}
+	}
+}
+
+void HexRegion::remove_empty_chunks() {
+	size_t kept = 0;
+	for (size_t i = 0; i < chunk_keys.size(); i++) {
+		if (!is_zero(chunk_bits[i])) {
+			chunk_keys[kept] = chunk_keys[i];
+			chunk_bits[kept] = chunk_bits[i];
+			kept++;
+		}
+	}
+	chunk_keys.resize(kept);
+	chunk_bits.resize(kept);
+}
+
+void HexRegion::dilate() {
+	std::vector<int64_t> keys = chunk_keys;
+	std::vector<ChunkBits> bits = chunk_bits;
+
+	for (int direction = 0; direction < 6; direction++) {
+		translate(direction, keys, bits);
+	}
+
+	assign_unsorted(keys, bits);
+}
+
+void HexRegion::erode() {
+	// A hex survives if moving the original region towards it from every direction still covers it.
+	godot::Ref<HexRegion> original = copy();
+	for (int direction = 0; direction < 6; direction++) {
+		std::vector<int64_t> keys{};
+		std::vector<ChunkBits> bits{};
+		original->translate(direction, keys, bits);
+
+		godot::Ref<HexRegion> moved;
+		moved.instantiate();
+		moved->assign_unsorted(keys, bits);
+		intersect_with(moved);
+	}
+}
+
+godot::Ref<HexRegion> HexRegion::copy() const {
+	godot::Ref<HexRegion> region;
+	region.instantiate();
+	region->chunk_keys = chunk_keys;
+	region->chunk_bits = chunk_bits;
+	return region;
+}
+
+godot::Array HexRegion::get_coords() const {
+	godot::Array coords = godot::Array();
+	for_each([&coords](int q, int r) {
+		coords.append(godot::Vector2i(q, r));
+	});
+	return coords;
+}
+
+void HexRegion::add_coords(const godot::Array &coords) {
+	for (int i = 0; i < coords.size(); i++) {
+		ERR_FAIL_COND_MSG(coords[i].get_type() != godot::Variant::VECTOR2I, "Can only add arrays of Vector2i.");
+		godot::Vector2i hex = coords[i];
+		add_hex(hex.x, hex.y);
+	}
+}
+
+godot::PackedInt64Array HexRegion::get_data() const {
+	godot::PackedInt64Array data = godot::PackedInt64Array();
+	data.resize(chunk_keys.size() * (1 + HEX_CHUNK_WORDS));
+
+	int64_t* write = data.ptrw();
+	for (size_t i = 0; i < chunk_keys.size(); i++) {
+		*write++ = chunk_keys[i];
+		for (int word = 0; word < HEX_CHUNK_WORDS; word++) {
+			*write++ = int64_t(chunk_bits[i][word]);
+		}
+	}
+	return data;
+}
+
+void HexRegion::set_data(const godot::PackedInt64Array &data) {
+	ERR_FAIL_COND_MSG(data.size() % (1 + HEX_CHUNK_WORDS) != 0, "Region data is malformed.");
+
+	std::vector<int64_t> keys{};
+	std::vector<ChunkBits> bits{};
+	const int64_t* read = data.ptr();
+	for (int64_t i = 0; i < data.size(); i += 1 + HEX_CHUNK_WORDS) {
+		keys.push_back(read[i]);
+		ChunkBits chunk;
+		for (int word = 0; word < HEX_CHUNK_WORDS; word++) {
+			chunk[word] = uint64_t(read[i + 1 + word]);
+		}
+		bits.push_back(chunk);
+	}
+
+	assign_unsorted(keys, bits);
+	remove_empty_chunks();
+}
+
+void HexRegion::_bind_methods() {
+	godot::ClassDB::bind_method(godot::D_METHOD("add_hex", "q", "r"), &HexRegion::add_hex);
+	godot::ClassDB::bind_method(godot::D_METHOD("remove_hex", "q", "r"), &HexRegion::remove_hex);
+	godot::ClassDB::bind_method(godot::D_METHOD("has_hex", "q", "r"), &HexRegion::has_hex);
+	godot::ClassDB::bind_method(godot::D_METHOD("clear"), &HexRegion::clear);
+	godot::ClassDB::bind_method(godot::D_METHOD("count"), &HexRegion::count);
+	godot::ClassDB::bind_method(godot::D_METHOD("is_empty"), &HexRegion::is_empty);
+	godot::ClassDB::bind_method(godot::D_METHOD("union_with", "other"), &HexRegion::union_with);
+	godot::ClassDB::bind_method(godot::D_METHOD("intersect_with", "other"), &HexRegion::intersect_with);
+	godot::ClassDB::bind_method(godot::D_METHOD("subtract", "other"), &HexRegion::subtract);
+	godot::ClassDB::bind_method(godot::D_METHOD("dilate"), &HexRegion::dilate);
+	godot::ClassDB::bind_method(godot::D_METHOD("erode"), &HexRegion::erode);
+	godot::ClassDB::bind_method(godot::D_METHOD("copy"), &HexRegion::copy);
+	godot::ClassDB::bind_method(godot::D_METHOD("get_coords"), &HexRegion::get_coords);
+	godot::ClassDB::bind_method(godot::D_METHOD("add_coords", "coords"), &HexRegion::add_coords);
+	godot::ClassDB::bind_method(godot::D_METHOD("get_data"), &HexRegion::get_data);
+	godot::ClassDB::bind_method(godot::D_METHOD("set_data", "data"), &HexRegion::set_data);
+	ADD_PROPERTY(godot::PropertyInfo(godot::Variant::PACKED_INT64_ARRAY, "data", godot::PROPERTY_HINT_NONE, "", godot::PROPERTY_USAGE_STORAGE), "set_data", "get_data");
+}
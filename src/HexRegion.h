@@ -0,0 +1,196 @@
+/**
+ * @file HexRegion.h
+ * @brief A set of hexes stored as a chunked bitset.
+ * @details Each chunk holds one bit per cell, using the layout from HexChunk.h. Chunks are kept sorted by key in two parallel arrays, so set operations between regions are a single linear walk over packed words.
+ * @version 1.0
+ *
+ *
+ *
+ */
+#ifndef GODOT_HEX_GRID_EXTENSION_HEX_REGION_H
+#define GODOT_HEX_GRID_EXTENSION_HEX_REGION_H
+
+#include "godot_cpp/classes/resource.hpp"
+#include "godot_cpp/core/object.hpp"
+#include "HexChunk.h"
+#include <array>
+#include <vector>
+
+/// @brief A set of hexes with fast set algebra. Intended for combining areas from ranges, searches and visibility queries.
+class HexRegion : public godot::Resource
+{
+    GDCLASS(HexRegion, godot::Resource)
+
+public:
+    /**
+     * @brief The bits of one chunk, one per cell.
+     *
+     */
+    using ChunkBits = std::array<uint64_t, HEX_CHUNK_WORDS>;
+
+private:
+    /**
+     * @brief The keys of every chunk with at least one set cell, sorted.
+     *
+     */
+    std::vector<int64_t> chunk_keys{};
+    /**
+     * @brief The bits of every chunk, in the same order as the keys.
+     *
+     */
+    std::vector<ChunkBits> chunk_bits{};
+
+    /**
+     * @brief Binds methods for usage in Godot.
+     *
+     */
+    static void _bind_methods();
+    /**
+     * @brief Finds the index of a chunk.
+     *
+     * @param key The chunk's key.
+     * @return int64_t The chunk's index, or -1 if the region has no cells in it.
+     */
+    int64_t find_chunk(int64_t key) const;
+    /**
+     * @brief Moves every cell one step in a direction.
+     *
+     * @param direction The direction to move in, from 0 to 5.
+     * @param keys The keys of the moved chunks. They are not sorted, and a key may show up more than once.
+     * @param bits The bits of the moved chunks, in the same order as the keys.
+     */
+    void translate(int direction, std::vector<int64_t> &keys, std::vector<ChunkBits> &bits) const;
+    /**
+     * @brief Replaces the region with unsorted chunks, merging chunks that share a key.
+     *
+     * @param keys The keys of the chunks.
+     * @param bits The bits of the chunks, in the same order as the keys.
+     */
+    void assign_unsorted(const std::vector<int64_t> &keys, const std::vector<ChunkBits> &bits);
+    /**
+     * @brief Drops every chunk that has no set cells left.
+     *
+     */
+    void remove_empty_chunks();
+
+public:
+    HexRegion();
+    /**
+     * @brief Adds a hex to the region.
+     *
+     * @param q The q-coordinate.
+     * @param r The r-coordinate.
+     */
+    void add_hex(int q, int r);
+    /**
+     * @brief Removes a hex from the region.
+     *
+     * @param q The q-coordinate.
+     * @param r The r-coordinate.
+     */
+    void remove_hex(int q, int r);
+    /**
+     * @brief Checks if a hex is in the region.
+     *
+     * @param q The q-coordinate.
+     * @param r The r-coordinate.
+     * @return bool True if the hex is in the region.
+     */
+    bool has_hex(int q, int r) const;
+    /**
+     * @brief Removes every hex from the region.
+     *
+     */
+    void clear();
+    /**
+     * @brief Counts the hexes in the region.
+     *
+     * @return int64_t The amount of hexes.
+     */
+    int64_t count() const;
+    /**
+     * @brief Checks if the region has no hexes.
+     *
+     * @return bool True if the region is empty.
+     */
+    bool is_empty() const;
+    /**
+     * @brief Adds every hex of another region to this one.
+     *
+     * @param other The other region.
+     */
+    void union_with(const godot::Ref<HexRegion> &other);
+    /**
+     * @brief Removes every hex that is not also in another region.
+     *
+     * @param other The other region.
+     */
+    void intersect_with(const godot::Ref<HexRegion> &other);
+    /**
+     * @brief Removes every hex that is in another region.
+     *
+     * @param other The other region.
+     */
+    void subtract(const godot::Ref<HexRegion> &other);
+    /**
+     * @brief Grows the region by one ring, adding every neighbor of every hex.
+     *
+     */
+    void dilate();
+    /**
+     * @brief Shrinks the region by one ring, removing every hex that has a neighbor outside of it.
+     *
+     */
+    void erode();
+    /**
+     * @brief Creates a copy of the region.
+     *
+     * @return godot::Ref<HexRegion> The copy.
+     */
+    godot::Ref<HexRegion> copy() const;
+    /**
+     * @brief Gets the coordinates of every hex in the region, ordered by chunk. Intended for usage directly from Godot.
+     *
+     * @return godot::Array An array of Vector2i, with q as x and r as y.
+     */
+    godot::Array get_coords() const;
+    /**
+     * @brief Adds the coordinates of several hexes to the region. Intended for usage directly from Godot.
+     *
+     * @param coords An array of Vector2i, with q as x and r as y.
+     */
+    void add_coords(const godot::Array &coords);
+    /**
+     * @brief Gets the packed chunks, for saving the region. Each chunk is its key followed by its words.
+     *
+     * @return godot::PackedInt64Array The packed chunks.
+     */
+    godot::PackedInt64Array get_data() const;
+    /**
+     * @brief Replaces the region with packed chunks from get_data.
+     *
+     * @param data The packed chunks.
+     */
+    void set_data(const godot::PackedInt64Array &data);
+
+    /**
+     * @brief Calls a function with the coordinates of every hex in the region, ordered by chunk.
+     *
+     * @param function Called as function(q, r).
+     */
+    template <typename Function>
+    void for_each(Function &&function) const {
+        for (size_t i = 0; i < chunk_keys.size(); i++) {
+            for (int word = 0; word < HEX_CHUNK_WORDS; word++) {
+                uint64_t bits = chunk_bits[i][word];
+                while (bits) {
+                    std::pair<int, int> hex = hex_chunk_cell_co_ords(chunk_keys[i], word * 64 + hex_lowest_bit(bits));
+                    function(hex.first, hex.second);
+                    bits &= bits - 1;
+                }
+            }
+        }
+    }
+};
+
+#endif //GODOT_HEX_GRID_EXTENSION_HEX_REGION_H
@@ -0,0 +1,142 @@
+#include "HexRevisionLog.h"
+
+#include <algorithm>
+#include <cstring>
+
+HexRevisionLog::Chunk &HexRevisionLog::ensure_chunk(int64_t key) {
+	std::unique_ptr<Chunk> &chunk = chunks[key];
+	if (!chunk) {
+		chunk = std::make_unique<Chunk>();
+	}
+	return *chunk;
+}
+
+void HexRevisionLog::mark(int q, int r, uint64_t revision) {
+	Chunk &chunk = ensure_chunk(hex_chunk_key_of(q, r));
+	chunk.cells[hex_chunk_cell(q, r)] = revision;
+	chunk.latest = std::max(chunk.latest, revision);
+}
+
+void HexRevisionLog::mark_chunk(int64_t key, uint64_t revision, const std::array<bool, HEX_CHUNK_CELLS>* changed) {
+	if (changed && std::find(changed->begin(), changed->end(), true) == changed->end()) {
+		return;
+	}
+	Chunk &chunk = ensure_chunk(key);
+	for (int cell = 0; cell < HEX_CHUNK_CELLS; cell++) {
+		if (!changed || (*changed)[cell]) {
+			chunk.cells[cell] = revision;
+		}
+	}
+	chunk.latest = std::max(chunk.latest, revision);
+}
+
+void HexRevisionLog::clear() {
+	chunks.clear();
+}
+
+size_t HexRevisionLog::get_memory_usage() const {
+	size_t node_size = sizeof(void*) + sizeof(std::pair<const int64_t, std::unique_ptr<Chunk>>) + sizeof(Chunk);
+	return chunks.size() * node_size + chunks.bucket_count() * sizeof(void*);
+}
+
+void HexDeltaWriter::write_varint(uint64_t value) {
+	while (value >= 0x80) {
+		bytes.push_back(uint8_t(value) | 0x80);
+		value >>= 7;
+	}
+	bytes.push_back(uint8_t(value));
+}
+
+void HexDeltaWriter::write_signed(int64_t value) {
+	// Zigzag, so small negative values stay short too.
+	write_varint((uint64_t(value) << 1) ^ uint64_t(value >> 63));
+}
+
+void HexDeltaWriter::write_float(float value) {
+	uint32_t bits{};
+	std::memcpy(&bits, &value, sizeof(bits));
+	for (int shift = 0; shift < 32; shift += 8) {
+		bytes.push_back(uint8_t(bits >> shift));
+	}
+}
+
+void HexDeltaWriter::write_string(const std::string &value) {
+	write_varint(value.size());
+	bytes.insert(bytes.end(), value.begin(), value.end());
+}
+
+void HexDeltaWriter::write_run(int length, int kind) {
+	write_varint((uint64_t(length) << 2) | uint64_t(kind & 3));
+}
+
+const std::vector<uint8_t> &HexDeltaWriter::get_bytes() const {
+	return bytes;
+}
+
+HexDeltaReader::HexDeltaReader(const uint8_t* data, size_t size) : data(data), size(size) {
+
+}
+
+uint64_t HexDeltaReader::read_varint() {
+	uint64_t value = 0;
+	for (int shift = 0; shift < 64; shift += 7) {
+		if (failed || position >= size) {
+			failed = true;
+			return 0;
+		}
+		uint8_t byte = data[position++];
+		value |= uint64_t(byte & 0x7f) << shift;
+		if (!(byte & 0x80)) {
+			return value;
+		}
+	}
+	failed = true;
+	return 0;
+}
+
+int64_t HexDeltaReader::read_signed() {
+	uint64_t value = read_varint();
+	return int64_t(value >> 1) ^ -int64_t(value & 1);
+}
+
+float HexDeltaReader::read_float() {
+	if (failed || size - position < 4) {
+		failed = true;
+		return 0.0f;
+	}
+	uint32_t bits = 0;
+	for (int shift = 0; shift < 32; shift += 8) {
+		bits |= uint32_t(data[position++]) << shift;
+	}
+	float value{};
+	std::memcpy(&value, &bits, sizeof(value));
+	return value;
+}
+
+std::string HexDeltaReader::read_string() {
+	uint64_t length = read_varint();
+	if (failed || length > size - position) {
+		failed = true;
+		return std::string();
+	}
+	std::string value(reinterpret_cast<const char*>(data + position), size_t(length));
+	position += size_t(length);
+	return value;
+}
+
+void HexDeltaReader::read_run(int &length, int &kind) {
+	uint64_t header = read_varint();
+	if ((header >> 2) > uint64_t(HEX_CHUNK_CELLS)) {
+		failed = true;
+	}
+	length = failed ? 0 : int(header >> 2);
+	kind = failed ? 0 : int(header & 3);
+}
+
+bool HexDeltaReader::has_failed() const {
+	return failed;
+}
+
+bool HexDeltaReader::is_at_end() const {
+	return position == size;
+}
@@ -0,0 +1,147 @@
+/**
+ * @file HexRevisionLog.h
+ * @brief Tracks the revision every cell last changed at, and the byte format grid deltas are written in.
+ * @details Revisions are stamped per cell, in chunks using the layout from HexChunk.h. Each chunk also keeps its latest stamp, so a delta only visits chunks that changed since the revision it starts from, and only writes the cells inside them that did.
+ * Deltas are written with unsigned LEB128 varints, zigzag for signed values, and little endian 32 bit floats. Cells inside a chunk are written in index order as runs, each run starting with a varint holding its length shifted left by two and its kind in the low two bits.
+ * @version 1.0
+ *
+ *
+ *
+ */
+#ifndef GODOT_HEX_GRID_EXTENSION_HEX_REVISION_LOG_H
+#define GODOT_HEX_GRID_EXTENSION_HEX_REVISION_LOG_H
+
+#include "HexChunk.h"
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/// @brief The revisions of one kind of cell data, such as the tiles or a layer. Not a Godot object, the HexGrid owns its logs.
+class HexRevisionLog
+{
+public:
+    /**
+     * @brief The revisions of one chunk.
+     *
+     */
+    struct Chunk {
+        /// @brief The latest revision of any cell in the chunk.
+        uint64_t latest{};
+        /// @brief The revision each cell last changed at, zero if it never did.
+        std::array<uint64_t, HEX_CHUNK_CELLS> cells{};
+    };
+
+private:
+    /**
+     * @brief A map that maps a chunk key to its revisions.
+     *
+     */
+    std::unordered_map<int64_t, std::unique_ptr<Chunk>> chunks{};
+
+    /**
+     * @brief Gets a chunk's revisions, creating it if needed.
+     *
+     */
+    Chunk &ensure_chunk(int64_t key);
+
+public:
+    /**
+     * @brief Stamps a cell.
+     *
+     * @param q The q-coordinate.
+     * @param r The r-coordinate.
+     * @param revision The revision it changed at.
+     */
+    void mark(int q, int r, uint64_t revision);
+    /**
+     * @brief Stamps the cells of a chunk, for writes that replace a chunk at once.
+     *
+     * @param key The chunk's key.
+     * @param revision The revision they changed at.
+     * @param changed Which cells to stamp. If null, every cell is stamped.
+     */
+    void mark_chunk(int64_t key, uint64_t revision, const std::array<bool, HEX_CHUNK_CELLS>* changed = nullptr);
+    /**
+     * @brief Drops every stamp.
+     *
+     */
+    void clear();
+    /**
+     * @brief Calls a function for every chunk with a cell stamped after a revision, in no particular order.
+     *
+     * @param revision The revision to look after.
+     * @param function Called as function(key, chunk).
+     */
+    template <typename Function>
+    void for_each_chunk_since(uint64_t revision, Function &&function) const {
+        for (const std::pair<const int64_t, std::unique_ptr<Chunk>> &pair : chunks) {
+            if (pair.second->latest > revision) {
+                function(pair.first, *pair.second);
+            }
+        }
+    }
+    /**
+     * @brief Gets the memory held by the stamps.
+     *
+     * @return size_t The memory, in bytes.
+     */
+    size_t get_memory_usage() const;
+};
+
+/// @brief Appends values to a delta.
+class HexDeltaWriter
+{
+    std::vector<uint8_t> bytes{};
+
+public:
+    void write_varint(uint64_t value);
+    void write_signed(int64_t value);
+    void write_float(float value);
+    void write_string(const std::string &value);
+    /**
+     * @brief Writes the header of a run of cells.
+     *
+     * @param length The amount of cells in the run.
+     * @param kind What the run holds, from 0 to 3.
+     */
+    void write_run(int length, int kind);
+    const std::vector<uint8_t> &get_bytes() const;
+};
+
+/// @brief Reads values back out of a delta. Reading past the end, or a malformed value, sets the reader as failed and returns zero from then on.
+class HexDeltaReader
+{
+    const uint8_t* data{};
+    size_t size{};
+    size_t position{};
+    bool failed{};
+
+public:
+    HexDeltaReader(const uint8_t* data, size_t size);
+    uint64_t read_varint();
+    int64_t read_signed();
+    float read_float();
+    std::string read_string();
+    /**
+     * @brief Reads the header of a run of cells.
+     *
+     * @param length Set to the amount of cells in the run.
+     * @param kind Set to what the run holds.
+     */
+    void read_run(int &length, int &kind);
+    /**
+     * @brief Gets whether anything could not be read.
+     *
+     */
+    bool has_failed() const;
+    /**
+     * @brief Gets whether every byte was read.
+     *
+     */
+    bool is_at_end() const;
+};
+
+#endif //GODOT_HEX_GRID_EXTENSION_HEX_REVISION_LOG_H
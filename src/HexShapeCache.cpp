@@ -0,0 +1,69 @@
+#include "HexShapeCache.h"
+#include "HexShapes.h"
+
+#include <cstdlib>
+
+HexShapeCache::~HexShapeCache() {
+	for (size_t i = 0; i < size_t(2) * LINE_SPAN * LINE_SPAN; i++) {
+		delete lines[i].load(std::memory_order_relaxed);
+	}
+	for (int radius = 0; radius <= MAX_CACHED_DISTANCE; radius++) {
+		delete rings[radius].load(std::memory_order_relaxed);
+		delete spirals[radius].load(std::memory_order_relaxed);
+	}
+}
+
+HexShapeCache &HexShapeCache::get_shared() {
+	static HexShapeCache shared{};
+	return shared;
+}
+
+bool HexShapeCache::find_line(int dq, int dr, bool symmetric, Span &out) {
+	if ((std::abs(dq) + std::abs(dr) + std::abs(dq + dr)) / 2 > MAX_CACHED_DISTANCE) {
+		return false;
+	}
+
+	size_t slot = (size_t(symmetric) * LINE_SPAN + size_t(dr + MAX_CACHED_DISTANCE)) * LINE_SPAN + size_t(dq + MAX_CACHED_DISTANCE);
+	out = find_or_add(lines[slot], [dq, dr, symmetric](std::vector<std::pair<int, int>> &offsets) {
+		HexLineRange line(std::pair<int, int>(0, 0), std::pair<int, int>(dq, dr), symmetric);
+		offsets.reserve(line.size());
+		for (std::pair<int, int> offset : line) {
+			offsets.push_back(offset);
+		}
+	});
+	return true;
+}
+
+bool HexShapeCache::find_ring(int radius, Span &out) {
+	if (radius < 0 || radius > MAX_CACHED_DISTANCE) {
+		return false;
+	}
+
+	out = find_or_add(rings[radius], [radius](std::vector<std::pair<int, int>> &offsets) {
+		HexRingRange ring(0, 0, radius);
+		offsets.reserve(ring.size());
+		for (std::pair<int, int> offset : ring) {
+			offsets.push_back(offset);
+		}
+	});
+	return true;
+}
+
+bool HexShapeCache::find_spiral(int radius, Span &out) {
+	if (radius < 0 || radius > MAX_CACHED_DISTANCE) {
+		return false;
+	}
+
+	out = find_or_add(spirals[radius], [radius](std::vector<std::pair<int, int>> &offsets) {
+		HexSpiralRange spiral(0, 0, radius);
+		offsets.reserve(spiral.size());
+		for (std::pair<int, int> offset : spiral) {
+			offsets.push_back(offset);
+		}
+	});
+	return true;
+}
+
+size_t HexShapeCache::get_memory_usage() const {
+	return memory_usage.load(std::memory_order_relaxed) + sizeof(std::atomic<const Shape*>) * size_t(2) * LINE_SPAN * LINE_SPAN;
+}
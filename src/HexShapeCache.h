@@ -0,0 +1,139 @@
+/**
+ * @file HexShapeCache.h
+ * @brief A cache of precomputed line, ring and spiral offsets.
+ * @details Lines only depend on the vector between their ends, and rings and spirals only on their radius, so each shape is computed once relative to the origin and reused from anywhere by adding the origin back. Every shape that can be cached has a fixed slot, so a lookup is an index and an atomic load, without locks. Shapes are published once and never changed or freed before the cache is, so a returned span stays valid for the cache's lifetime, on any thread. The shapes do not depend on any grid, so a single cache is shared by all of them, and its slot table is only allocated by the first query.
+ * @version 1.0
+ *
+ *
+ *
+ */
+#ifndef GODOT_HEX_GRID_EXTENSION_HEX_SHAPE_CACHE_H
+#define GODOT_HEX_GRID_EXTENSION_HEX_SHAPE_CACHE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+/// @brief Translation invariant shape offsets, shared by every query. Lookups are safe from several threads at once.
+class HexShapeCache
+{
+public:
+    /**
+     * @brief A cached sequence of offsets from the origin.
+     *
+     */
+    struct Span {
+        const std::pair<int, int>* first{};
+        size_t count{};
+
+        const std::pair<int, int>* begin() const { return first; }
+        const std::pair<int, int>* end() const { return first + count; }
+        size_t size() const { return count; }
+    };
+
+    /// @brief Lines longer than this and rings or spirals wider than this are not cached, since they are rarely repeated.
+    static constexpr int MAX_CACHED_DISTANCE = 64;
+
+private:
+    /// @brief The amount of slots along each axis of a line's vector.
+    static constexpr int LINE_SPAN = 2 * MAX_CACHED_DISTANCE + 1;
+
+    /**
+     * @brief A published shape. Never changed after it is published.
+     *
+     */
+    using Shape = std::vector<std::pair<int, int>>;
+    /**
+     * @brief The slots of the lines, indexed by their vector. The first half is for plain lines, the second for symmetric ones. Null until a line is first drawn.
+     *
+     */
+    std::unique_ptr<std::atomic<const Shape*>[]> lines{ std::make_unique<std::atomic<const Shape*>[]>(size_t(2) * LINE_SPAN * LINE_SPAN) };
+    /**
+     * @brief The slots of the rings, indexed by their radius.
+     *
+     */
+    std::atomic<const Shape*> rings[MAX_CACHED_DISTANCE + 1]{};
+    /**
+     * @brief The slots of the spirals, indexed by their radius.
+     *
+     */
+    std::atomic<const Shape*> spirals[MAX_CACHED_DISTANCE + 1]{};
+    /**
+     * @brief The memory held by the published shapes, in bytes.
+     *
+     */
+    std::atomic<size_t> memory_usage{};
+
+    /**
+     * @brief Gets a shape from its slot, computing and publishing it if it is missing.
+     *
+     * @param slot The shape's slot.
+     * @param compute Called as compute(offsets) to fill in the offsets of a missing shape.
+     * @return Span The shape's offsets.
+     */
+    template <typename Compute>
+    Span find_or_add(std::atomic<const Shape*> &slot, Compute &&compute) {
+        const Shape* shape = slot.load(std::memory_order_acquire);
+        if (!shape) {
+            // Threads that miss at once each compute the shape, and all but the first to publish drop theirs.
+            Shape* computed = new Shape();
+            compute(*computed);
+            if (slot.compare_exchange_strong(shape, computed, std::memory_order_acq_rel, std::memory_order_acquire)) {
+                memory_usage.fetch_add(sizeof(Shape) + computed->capacity() * sizeof(std::pair<int, int>), std::memory_order_relaxed);
+                shape = computed;
+            } else {
+                delete computed;
+            }
+        }
+        return Span{ shape->data(), shape->size() };
+    }
+
+public:
+    HexShapeCache() = default;
+    HexShapeCache(const HexShapeCache &) = delete;
+    HexShapeCache &operator=(const HexShapeCache &) = delete;
+    ~HexShapeCache();
+    /**
+     * @brief Gets the cache shared by every grid, creating it on first use.
+     *
+     * @return HexShapeCache& The cache. Lives until the library is unloaded.
+     */
+    static HexShapeCache &get_shared();
+    /**
+     * @brief Gets the offsets of a line from the origin, as drawn by HexLineRange.
+     *
+     * @param dq The q-coordinate of the line's end, relative to its start.
+     * @param dr The r-coordinate of the line's end, relative to its start.
+     * @param symmetric Whether to use the symmetric variant.
+     * @param out The offsets, starting with 0,0.
+     * @return bool False if the line is too long to cache. The span is left untouched.
+     */
+    bool find_line(int dq, int dr, bool symmetric, Span &out);
+    /**
+     * @brief Gets the offsets of a ring, in the order of HexRingRange.
+     *
+     * @param radius The ring's radius.
+     * @param out The offsets.
+     * @return bool False if the ring is too wide to cache. The span is left untouched.
+     */
+    bool find_ring(int radius, Span &out);
+    /**
+     * @brief Gets the offsets of a spiral, in the order of HexSpiralRange.
+     *
+     * @param radius The radius of the spiral's outermost ring.
+     * @param out The offsets, starting with 0,0.
+     * @return bool False if the spiral is too wide to cache. The span is left untouched.
+     */
+    bool find_spiral(int radius, Span &out);
+    /**
+     * @brief Gets the memory held by the cached shapes.
+     *
+     * @return size_t The memory, in bytes.
+     */
+    size_t get_memory_usage() const;
+};
+
+#endif //GODOT_HEX_GRID_EXTENSION_HEX_SHAPE_CACHE_H
@@ -0,0 +1,421 @@
+/**
+ * @file HexShapes.h
+ * @brief Lazy ranges over common hex shapes.
+ * @details The ranges compute their coordinates as they are iterated, so looping over one never allocates. They yield axial coordinates as pairs, the same as the rest of the HexGrid.
+ * @version 1.0
+ *
+ *
+ *
+ */
+#ifndef GODOT_HEX_GRID_EXTENSION_HEX_SHAPES_H
+#define GODOT_HEX_GRID_EXTENSION_HEX_SHAPES_H
+
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <utility>
+
+/**
+ * @brief The axial offsets of the six neighbors, starting east and going counter-clockwise.
+ *
+ */
+inline constexpr std::array<std::pair<int, int>, 6> HEX_DIRECTIONS{ { {1, 0}, {1, -1}, {0, -1}, {-1, 0}, {-1, 1}, {0, 1} } };
+/**
+ * @brief The axial offsets of the six diagonals, in the same order as the directions.
+ *
+ */
+inline constexpr std::array<std::pair<int, int>, 6> HEX_DIAGONALS{ { {2, -1}, {1, -2}, {-1, -1}, {-2, 1}, {-1, 2}, {1, 1} } };
+
+/**
+ * @brief A ring of hexes at a set distance from a center. Starts at the hex in direction 4 and walks around the ring, same as HexGrid::get_ring.
+ *
+ */
+class HexRingRange {
+    std::pair<int, int> center;
+    int radius;
+
+public:
+    class iterator {
+        friend class HexRingRange;
+        std::pair<int, int> hex{};
+        int radius{};
+        int side{};
+        int step{};
+        int remaining{};
+
+    public:
+        std::pair<int, int> operator*() const { return hex; }
+        iterator &operator++() {
+            hex.first += HEX_DIRECTIONS[side].first;
+            hex.second += HEX_DIRECTIONS[side].second;
+            if (++step == radius) {
+                step = 0;
+                side++;
+            }
+            remaining--;
+            return *this;
+        }
+        bool operator!=(const iterator &other) const { return remaining != other.remaining; }
+    };
+
+    /**
+     * @param q The center q-coordinate.
+     * @param r The center r-coordinate.
+     * @param radius The radius of the ring. A radius of zero or less is an empty ring.
+     */
+    HexRingRange(int q, int r, int radius) : center(q, r), radius(radius) {}
+
+    iterator begin() const {
+        iterator it;
+        if (radius > 0) {
+            it.hex = std::pair<int, int>(center.first + HEX_DIRECTIONS[4].first * radius, center.second + HEX_DIRECTIONS[4].second * radius);
+            it.radius = radius;
+            it.remaining = 6 * radius;
+        }
+        return it;
+    }
+    iterator end() const { return iterator(); }
+    /**
+     * @brief The amount of hexes in the ring.
+     */
+    int size() const { return radius > 0 ? 6 * radius : 0; }
+};
+
+/**
+ * @brief The center hex followed by every ring from one up to and including the radius.
+ *
+ */
+class HexSpiralRange {
+    std::pair<int, int> center;
+    int radius;
+
+public:
+    class iterator {
+        friend class HexSpiralRange;
+        std::pair<int, int> center{};
+        std::pair<int, int> hex{};
+        int ring{};
+        int side{};
+        int step{};
+        int remaining{};
+
+    public:
+        std::pair<int, int> operator*() const { return hex; }
+        iterator &operator++() {
+            remaining--;
+            if (ring == 0) {
+                ring = 1;
+                hex = std::pair<int, int>(center.first + HEX_DIRECTIONS[4].first, center.second + HEX_DIRECTIONS[4].second);
+                return *this;
+            }
+            hex.first += HEX_DIRECTIONS[side].first;
+            hex.second += HEX_DIRECTIONS[side].second;
+            if (++step == ring) {
+                step = 0;
+                if (++side == 6) {
+                    // Step outwards onto the start of the next ring.
+                    side = 0;
+                    ring++;
+                    hex.first += HEX_DIRECTIONS[4].first;
+                    hex.second += HEX_DIRECTIONS[4].second;
+                }
+            }
+            return *this;
+        }
+        bool operator!=(const iterator &other) const { return remaining != other.remaining; }
+    };
+
+    /**
+     * @param q The center q-coordinate.
+     * @param r The center r-coordinate.
+     * @param radius The radius of the last ring. A radius of zero is just the center, less than zero is empty.
+     */
+    HexSpiralRange(int q, int r, int radius) : center(q, r), radius(radius) {}
+
+    iterator begin() const {
+        iterator it;
+        if (radius >= 0) {
+            it.center = center;
+            it.hex = center;
+            it.remaining = size();
+        }
+        return it;
+    }
+    iterator end() const { return iterator(); }
+    /**
+     * @brief The amount of hexes in the spiral.
+     */
+    int size() const { return radius >= 0 ? 1 + 3 * radius * (radius + 1) : 0; }
+};
+
+/**
+ * @brief Every hex within a distance of a center, row by row. Covers the same hexes as HexSpiralRange, in an order that is friendlier to row major storage.
+ *
+ */
+class HexHexagonRange {
+    std::pair<int, int> center;
+    int radius;
+
+public:
+    class iterator {
+        friend class HexHexagonRange;
+        std::pair<int, int> center{};
+        int radius{};
+        int dq{};
+        int dr{};
+        int remaining{};
+
+    public:
+        std::pair<int, int> operator*() const { return std::pair<int, int>(center.first + dq, center.second + dr); }
+        iterator &operator++() {
+            if (++dq > std::min(radius, radius - dr)) {
+                dr++;
+                dq = std::max(-radius, -radius - dr);
+            }
+            remaining--;
+            return *this;
+        }
+        bool operator!=(const iterator &other) const { return remaining != other.remaining; }
+    };
+
+    /**
+     * @param q The center q-coordinate.
+     * @param r The center r-coordinate.
+     * @param radius The distance from the center to the edge. Less than zero is empty.
+     */
+    HexHexagonRange(int q, int r, int radius) : center(q, r), radius(radius) {}
+
+    iterator begin() const {
+        iterator it;
+        if (radius >= 0) {
+            it.center = center;
+            it.radius = radius;
+            it.dr = -radius;
+            it.dq = 0;
+            it.remaining = size();
+        }
+        return it;
+    }
+    iterator end() const { return iterator(); }
+    /**
+     * @brief The amount of hexes in the hexagon.
+     */
+    int size() const { return radius >= 0 ? 1 + 3 * radius * (radius + 1) : 0; }
+};
+
+/**
+ * @brief Every hex with a q-coordinate and r-coordinate inside the given inclusive bounds, row by row.
+ *
+ */
+class HexParallelogramRange {
+    int q_min, q_max, r_min, r_max;
+
+public:
+    class iterator {
+        friend class HexParallelogramRange;
+        int q{};
+        int r{};
+        int q_min{};
+        int q_max{};
+        int remaining{};
+
+    public:
+        std::pair<int, int> operator*() const { return std::pair<int, int>(q, r); }
+        iterator &operator++() {
+            if (++q > q_max) {
+                q = q_min;
+                r++;
+            }
+            remaining--;
+            return *this;
+        }
+        bool operator!=(const iterator &other) const { return remaining != other.remaining; }
+    };
+
+    HexParallelogramRange(int q_min, int q_max, int r_min, int r_max) : q_min(q_min), q_max(q_max), r_min(r_min), r_max(r_max) {}
+
+    iterator begin() const {
+        iterator it;
+        it.q = q_min;
+        it.r = r_min;
+        it.q_min = q_min;
+        it.q_max = q_max;
+        it.remaining = size();
+        return it;
+    }
+    iterator end() const { return iterator(); }
+    /**
+     * @brief The amount of hexes in the parallelogram.
+     */
+    int size() const { return (q_max < q_min || r_max < r_min) ? 0 : (q_max - q_min + 1) * (r_max - r_min + 1); }
+};
+
+/**
+ * @brief A line between two hexes, both included, using the same TranThong stepping as HexGrid::get_cube_line.
+ * @details When symmetric, the line is mirrored over the q axis whenever q is less than s along the line's vector, the same as HexGrid::get_cube_symmetric_line.
+ *
+ */
+class HexLineRange {
+    int start[3];
+    int target[3];
+    bool mirror{};
+
+public:
+    class iterator {
+        friend class HexLineRange;
+        int co_ords[3]{};
+        int diff[3]{};
+        int sign[3]{};
+        int major{};
+        int minor_a{};
+        int minor_b{};
+        int test_a{};
+        int test_b{};
+        int origin_r{};
+        int origin_s{};
+        bool mirror{};
+        int remaining{};
+
+    public:
+        std::pair<int, int> operator*() const {
+            if (mirror) {
+                // Mirroring over q around the origin swaps the r and s parts of the vector.
+                return std::pair<int, int>(co_ords[0], origin_r + (-co_ords[0] - co_ords[1]) - origin_s);
+            }
+            return std::pair<int, int>(co_ords[0], co_ords[1]);
+        }
+        iterator &operator++() {
+            test_a -= diff[minor_a];
+            test_b -= diff[minor_b];
+            co_ords[major] += sign[major];
+            if (test_a < 0) {
+                co_ords[minor_a] += sign[minor_a];
+                test_a += diff[major];
+            }
+            if (test_b < 0) {
+                co_ords[minor_b] += sign[minor_b];
+                test_b += diff[major];
+            }
+            remaining--;
+            return *this;
+        }
+        bool operator!=(const iterator &other) const { return remaining != other.remaining; }
+    };
+
+    /**
+     * @param hex_one The first hex, in axial coordinates.
+     * @param hex_two The second hex, in axial coordinates.
+     * @param symmetric Whether to draw the symmetric variant of the line.
+     */
+    HexLineRange(std::pair<int, int> hex_one, std::pair<int, int> hex_two, bool symmetric)
+        : start{ hex_one.first, hex_one.second, -hex_one.first - hex_one.second },
+          target{ hex_two.first, hex_two.second, -hex_two.first - hex_two.second } {
+        int vector_q = target[0] - start[0];
+        int vector_r = target[1] - start[1];
+        int vector_s = target[2] - start[2];
+        if (symmetric && vector_q < vector_s) {
+            mirror = true;
+            target[1] = start[1] + vector_s;
+            target[2] = start[2] + vector_r;
+        }
+    }
+
+    iterator begin() const {
+        iterator it;
+        for (int i = 0; i < 3; i++) {
+            it.co_ords[i] = start[i];
+            it.diff[i] = std::abs(target[i] - start[i]);
+            it.sign[i] = target[i] >= start[i] ? 1 : -1;
+        }
+
+        if (it.diff[0] >= it.diff[1] && it.diff[0] >= it.diff[2]) {
+            it.major = 0; it.minor_a = 1; it.minor_b = 2;
+        } else if (it.diff[1] >= it.diff[0] && it.diff[1] >= it.diff[2]) {
+            it.major = 1; it.minor_a = 0; it.minor_b = 2;
+        } else {
+            it.major = 2; it.minor_a = 0; it.minor_b = 1;
+        }
+
+        // The rounding bias always comes from the y and z signs, whichever axis is the major one.
+        it.test_a = (it.diff[it.major] + (it.sign[1] == -1 ? -1 : 0)) >> 1;
+        it.test_b = (it.diff[it.major] + (it.sign[2] == -1 ? -1 : 0)) >> 1;
+        it.origin_r = start[1];
+        it.origin_s = start[2];
+        it.mirror = mirror;
+        it.remaining = it.diff[it.major] + 1;
+        return it;
+    }
+    iterator end() const { return iterator(); }
+    /**
+     * @brief The amount of hexes in the line.
+     */
+    int size() const {
+        return std::max(std::abs(target[0] - start[0]), std::max(std::abs(target[1] - start[1]), std::abs(target[2] - start[2]))) + 1;
+    }
+};
+
+/**
+ * @brief A 60' wedge of hexes spreading out from a center, bounded by two neighboring directions. The center itself is not included.
+ *
+ */
+class HexConeRange {
+    std::pair<int, int> center;
+    int direction;
+    int radius;
+
+public:
+    class iterator {
+        friend class HexConeRange;
+        std::pair<int, int> hex{};
+        std::pair<int, int> center{};
+        int direction{};
+        int distance{};
+        int step{};
+        int remaining{};
+
+    public:
+        std::pair<int, int> operator*() const { return hex; }
+        iterator &operator++() {
+            if (++step > distance) {
+                // Move onto the first corner of the next row out.
+                step = 0;
+                distance++;
+                hex = std::pair<int, int>(center.first + HEX_DIRECTIONS[direction].first * distance, center.second + HEX_DIRECTIONS[direction].second * distance);
+            } else {
+                // Walk along the row towards the second corner.
+                hex.first += HEX_DIRECTIONS[(direction + 2) % 6].first;
+                hex.second += HEX_DIRECTIONS[(direction + 2) % 6].second;
+            }
+            remaining--;
+            return *this;
+        }
+        bool operator!=(const iterator &other) const { return remaining != other.remaining; }
+    };
+
+    /**
+     * @param q The center q-coordinate.
+     * @param r The center r-coordinate.
+     * @param direction The direction of the first edge of the wedge, from 0 to 5. The second edge is the next direction counter-clockwise.
+     * @param radius The distance of the last row of the wedge.
+     */
+    HexConeRange(int q, int r, int direction, int radius) : center(q, r), direction(((direction % 6) + 6) % 6), radius(radius) {}
+
+    iterator begin() const {
+        iterator it;
+        if (radius > 0) {
+            it.center = center;
+            it.direction = direction;
+            it.distance = 1;
+            it.hex = std::pair<int, int>(center.first + HEX_DIRECTIONS[direction].first, center.second + HEX_DIRECTIONS[direction].second);
+            it.remaining = size();
+        }
+        return it;
+    }
+    iterator end() const { return iterator(); }
+    /**
+     * @brief The amount of hexes in the wedge.
+     */
+    int size() const { return radius > 0 ? (radius * (radius + 3)) / 2 : 0; }
+};
+
+#endif //GODOT_HEX_GRID_EXTENSION_HEX_SHAPES_H
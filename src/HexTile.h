@@ -49,6 +49,16 @@ public:
      * 
      */
     std::pair<int, int> co_ords;
+    /**
+     * @brief The instance id of the PackedScene this tile was instantiated from. Used by the HexGrid to return the tile to the right pool.
+     * 
+     */
+    uint64_t scene_id{};
+    /**
+     * @brief Whether the HexGrid connected its mouse signals to this tile, so they can be disconnected when the tile is recycled.
+     * 
+     */
+    bool mouse_signals_connected{};
     /**
      * @brief Binds methods for usage in Godot.
      * 
@@ -0,0 +1,188 @@
+#include "HexTileStorage.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+void HexTileStorage::configure(int new_shape, int new_width, int new_height, int new_wrap) {
+	shape = new_shape;
+	wrap = can_wrap(new_shape, new_height, new_wrap) ? new_wrap : HEX_WRAP_NONE;
+	radius = 0;
+	tile_count = 0;
+	sparse_tiles.clear();
+	dense_tiles.clear();
+	dense_tiles.shrink_to_fit();
+
+	switch (shape) {
+		case HEX_MAP_UNBOUNDED:
+			width = 0;
+			height = 0;
+			return;
+		case HEX_MAP_HEXAGON:
+			// The hexagon sits in a square box, the corners of which are never used.
+			radius = new_width;
+			width = 2 * radius + 1;
+			height = width;
+			break;
+		default:
+			width = new_width;
+			height = new_height;
+			break;
+	}
+	dense_tiles.assign(size_t(width) * size_t(height), nullptr);
+	if (dense_tiles.empty()) {
+		wrap = HEX_WRAP_NONE;
+	}
+
+	// Both shapes that can wrap have a column of q + f(r), so crossing the map from west to east is a step along q.
+	wrap_steps[0] = std::pair<int, int>(width, 0);
+	wrap_steps[1] = shape == HEX_MAP_RECTANGLE_ODD_R ? std::pair<int, int>(-height / 2, height) : std::pair<int, int>(0, height);
+
+	for (int i = 0; i < 2; i++) {
+		// Any cell with the right parity works, the steps only depend on whether its row or column is odd.
+		std::pair<int, int> center = shape == HEX_MAP_RECTANGLE_ODD_R ? std::pair<int, int>(0, i) : std::pair<int, int>(i, 0);
+		std::pair<int, int> center_local = to_local(center.first, center.second);
+		for (int direction = 0; direction < 6; direction++) {
+			std::pair<int, int> neighbor_local = to_local(center.first + HEX_DIRECTIONS[direction].first, center.second + HEX_DIRECTIONS[direction].second);
+			NeighborStep &step = neighbor_steps[i][direction];
+			step.col = neighbor_local.first - center_local.first;
+			step.row = neighbor_local.second - center_local.second;
+			step.index = int64_t(step.row) * width + step.col;
+		}
+	}
+}
+
+int HexTileStorage::get_shape() const {
+	return shape;
+}
+
+int HexTileStorage::get_wrap() const {
+	return wrap;
+}
+
+bool HexTileStorage::can_wrap(int shape, int height, int wrap) {
+	if (wrap == HEX_WRAP_NONE) {
+		return true;
+	}
+	if (shape != HEX_MAP_RECTANGLE_ODD_R && shape != HEX_MAP_PARALLELOGRAM) {
+		return false;
+	}
+	// Odd rows are shoved right, so an odd height would put an odd row next to another odd row across the seam.
+	return wrap == HEX_WRAP_CYLINDRICAL || shape == HEX_MAP_PARALLELOGRAM || height % 2 == 0;
+}
+
+int HexTileStorage::distance(std::pair<int, int> hex_one, std::pair<int, int> hex_two) const {
+	hex_one = canonicalize(hex_one);
+	std::pair<int, int> copy = nearest_copy(hex_one, hex_two);
+	int dq = copy.first - hex_one.first;
+	int dr = copy.second - hex_one.second;
+	return (std::abs(dq) + std::abs(dr) + std::abs(dq + dr)) / 2;
+}
+
+std::pair<int, int> HexTileStorage::nearest_copy(std::pair<int, int> from, std::pair<int, int> to) const {
+	if (wrap == HEX_WRAP_NONE) {
+		return to;
+	}
+
+	// Both hexes are canonical, so the closest copy is at most one crossing away along each axis.
+	to = canonicalize(to);
+	int row_crossings = wrap == HEX_WRAP_TOROIDAL ? 1 : 0;
+	std::pair<int, int> best = to;
+	int best_distance = -1;
+	for (int i = -1; i <= 1; i++) {
+		for (int j = -row_crossings; j <= row_crossings; j++) {
+			std::pair<int, int> copy(to.first + i * wrap_steps[0].first + j * wrap_steps[1].first, to.second + i * wrap_steps[0].second + j * wrap_steps[1].second);
+			int dq = copy.first - from.first;
+			int dr = copy.second - from.second;
+			int copy_distance = (std::abs(dq) + std::abs(dr) + std::abs(dq + dr)) / 2;
+			if (best_distance < 0 || copy_distance < best_distance) {
+				best = copy;
+				best_distance = copy_distance;
+			}
+		}
+	}
+	return best;
+}
+
+bool HexTileStorage::is_bounded() const {
+	return shape != HEX_MAP_UNBOUNDED;
+}
+
+int64_t HexTileStorage::get_cell_count() const {
+	switch (shape) {
+		case HEX_MAP_UNBOUNDED:
+			return -1;
+		case HEX_MAP_HEXAGON:
+			return 3 * int64_t(radius) * (radius + 1) + 1;
+		default:
+			return int64_t(width) * height;
+	}
+}
+
+size_t HexTileStorage::size() const {
+	return tile_count;
+}
+
+size_t HexTileStorage::get_memory_usage() const {
+	if (shape != HEX_MAP_UNBOUNDED) {
+		return dense_tiles.capacity() * sizeof(HexTile*);
+	}
+	// An estimate: one pointer per bucket, plus a node holding the next pointer and the key value pair per entry.
+	size_t node_size = sizeof(void*) + sizeof(std::pair<const int64_t, HexTile*>);
+	return sparse_tiles.bucket_count() * sizeof(void*) + sparse_tiles.size() * node_size;
+}
+
+float HexTileStorage::get_load_factor() const {
+	if (shape != HEX_MAP_UNBOUNDED) {
+		return dense_tiles.empty() ? 0.0f : float(double(tile_count) / double(dense_tiles.size()));
+	}
+	return sparse_tiles.load_factor();
+}
+
+bool HexTileStorage::store(int q, int r, HexTile* tile) {
+	HexTile** slot{};
+	if (shape != HEX_MAP_UNBOUNDED) {
+		int64_t index = index_of(q, r);
+		if (index < 0) {
+			return false;
+		}
+		slot = &dense_tiles[index];
+	} else {
+		slot = &sparse_tiles[key(q, r)];
+	}
+
+	tile_count += *slot == nullptr;
+	*slot = tile;
+	return true;
+}
+
+HexTile* HexTileStorage::erase(int q, int r) {
+	HexTile* tile{};
+	if (shape != HEX_MAP_UNBOUNDED) {
+		int64_t index = index_of(q, r);
+		if (index < 0) {
+			return nullptr;
+		}
+		tile = dense_tiles[index];
+		dense_tiles[index] = nullptr;
+	} else {
+		auto pair = sparse_tiles.find(key(q, r));
+		if (pair == sparse_tiles.end()) {
+			return nullptr;
+		}
+		tile = pair->second;
+		sparse_tiles.erase(pair);
+	}
+
+	tile_count -= tile != nullptr;
+	return tile;
+}
+
+void HexTileStorage::clear() {
+	sparse_tiles.clear();
+	std::fill(dense_tiles.begin(), dense_tiles.end(), nullptr);
+	tile_count = 0;
+}
+
+std::pair<int, int> HexTileStorage::co_ords_of(int64_t index) const {
+	return from_local(int(index % width), int(index / width));
+}
@@ -0,0 +1,483 @@
+/**
+ * @file HexTileStorage.h
+ * @brief Maps axial coordinates to the HexGrid's tiles.
+ * @details Unbounded maps keep their tiles in a hash map. Bounded maps keep them in one flat array sized to the map's shape, where a lookup is a bounds check plus a multiply-add. Rectangles are laid out in offset coordinates, so every row of the array is a row of the map.
+ * @version 1.0
+ *
+ *
+ *
+ */
+#ifndef GODOT_HEX_GRID_EXTENSION_HEX_TILE_STORAGE_H
+#define GODOT_HEX_GRID_EXTENSION_HEX_TILE_STORAGE_H
+
+#include "HexShapes.h"
+#include <array>
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+class HexTile;
+
+/// @brief The shapes a HexGrid's map can take.
+enum HexMapShape {
+    /// @brief No bounds, tiles can be spawned anywhere. Stored sparsely.
+    HEX_MAP_UNBOUNDED,
+    /// @brief A rectangle of width columns and height rows, where odd rows are shoved right by half a hex. Rows run along r.
+    HEX_MAP_RECTANGLE_ODD_R,
+    /// @brief A rectangle of width columns and height rows, where even columns are shoved down by half a hex. Columns run along q.
+    HEX_MAP_RECTANGLE_EVEN_Q,
+    /// @brief A hexagon centered on 0,0, with the width as its radius.
+    HEX_MAP_HEXAGON,
+    /// @brief A parallelogram with q from 0 to width - 1 and r from 0 to height - 1.
+    HEX_MAP_PARALLELOGRAM
+};
+
+/// @brief How a bounded map's edges connect to each other.
+enum HexWrapMode {
+    /// @brief The edges are walls.
+    HEX_WRAP_NONE,
+    /// @brief The east and west edges are joined, like a globe.
+    HEX_WRAP_CYLINDRICAL,
+    /// @brief The east and west edges are joined, and so are the north and south edges.
+    HEX_WRAP_TOROIDAL
+};
+
+/// @brief The offset coordinate layouts, as described at https://www.redblobgames.com/grids/hexagons/#coordinates-offset
+enum HexOffsetType {
+    /// @brief Pointy tops, odd rows shoved right.
+    HEX_OFFSET_ODD_R,
+    /// @brief Pointy tops, even rows shoved right.
+    HEX_OFFSET_EVEN_R,
+    /// @brief Flat tops, odd columns shoved down.
+    HEX_OFFSET_ODD_Q,
+    /// @brief Flat tops, even columns shoved down.
+    HEX_OFFSET_EVEN_Q
+};
+
+/**
+ * @brief Converts axial coordinates to offset coordinates.
+ *
+ * @param q The q-coordinate.
+ * @param r The r-coordinate.
+ * @param offset_type The offset layout. Typically a HexOffsetType enum.
+ * @return std::pair<int, int> The column as its first, and the row as its second.
+ */
+inline std::pair<int, int> hex_axial_to_offset(int q, int r, int offset_type) {
+    switch (offset_type) {
+        case HEX_OFFSET_EVEN_R:
+            return std::pair<int, int>(q + (r + (r & 1)) / 2, r);
+        case HEX_OFFSET_ODD_Q:
+            return std::pair<int, int>(q, r + (q - (q & 1)) / 2);
+        case HEX_OFFSET_EVEN_Q:
+            return std::pair<int, int>(q, r + (q + (q & 1)) / 2);
+        default:
+            return std::pair<int, int>(q + (r - (r & 1)) / 2, r);
+    }
+}
+
+/**
+ * @brief Converts offset coordinates to axial coordinates.
+ *
+ * @param col The column.
+ * @param row The row.
+ * @param offset_type The offset layout. Typically a HexOffsetType enum.
+ * @return std::pair<int, int> The q-coordinate as its first, and the r-coordinate as its second.
+ */
+inline std::pair<int, int> hex_offset_to_axial(int col, int row, int offset_type) {
+    switch (offset_type) {
+        case HEX_OFFSET_EVEN_R:
+            return std::pair<int, int>(col - (row + (row & 1)) / 2, row);
+        case HEX_OFFSET_ODD_Q:
+            return std::pair<int, int>(col, row - (col - (col & 1)) / 2);
+        case HEX_OFFSET_EVEN_Q:
+            return std::pair<int, int>(col, row - (col + (col & 1)) / 2);
+        default:
+            return std::pair<int, int>(col - (row - (row & 1)) / 2, row);
+    }
+}
+
+/// @brief The HexGrid's tile storage. Not a Godot object.
+class HexTileStorage
+{
+    /**
+     * @brief The step from a cell to one of its neighbors in the flat array.
+     *
+     */
+    struct NeighborStep {
+        int col{};
+        int row{};
+        int64_t index{};
+    };
+
+    /**
+     * @brief The map's shape. Typically a HexMapShape enum.
+     *
+     */
+    int shape{ HEX_MAP_UNBOUNDED };
+    /**
+     * @brief How the map's edges connect. Typically a HexWrapMode enum.
+     *
+     */
+    int wrap{ HEX_WRAP_NONE };
+    /**
+     * @brief The axial step that crosses the map once from west to east, and once from north to south. A hex and the hex one step away are the same cell on a wrapping map.
+     *
+     */
+    std::array<std::pair<int, int>, 2> wrap_steps{};
+    /**
+     * @brief The amount of columns in the flat array.
+     *
+     */
+    int width{};
+    /**
+     * @brief The amount of rows in the flat array.
+     *
+     */
+    int height{};
+    /**
+     * @brief The hexagon's radius. Only used by HEX_MAP_HEXAGON.
+     *
+     */
+    int radius{};
+    /**
+     * @brief The amount of stored tiles.
+     *
+     */
+    size_t tile_count{};
+    /**
+     * @brief The tiles of an unbounded map, keyed by key().
+     *
+     */
+    std::unordered_map<int64_t, HexTile*> sparse_tiles{};
+    /**
+     * @brief The tiles of a bounded map, row by row. Empty cells are null.
+     *
+     */
+    std::vector<HexTile*> dense_tiles{};
+    /**
+     * @brief The steps to each neighbor, in the order of HEX_DIRECTIONS. Offset rectangles need a different set for odd and even rows or columns.
+     *
+     */
+    std::array<std::array<NeighborStep, 6>, 2> neighbor_steps{};
+
+    /**
+     * @brief Converts axial coordinates to a column and row of the flat array.
+     *
+     */
+    inline std::pair<int, int> to_local(int q, int r) const {
+        switch (shape) {
+            case HEX_MAP_RECTANGLE_ODD_R:
+                return hex_axial_to_offset(q, r, HEX_OFFSET_ODD_R);
+            case HEX_MAP_RECTANGLE_EVEN_Q:
+                return hex_axial_to_offset(q, r, HEX_OFFSET_EVEN_Q);
+            case HEX_MAP_HEXAGON:
+                return std::pair<int, int>(q + radius, r + radius);
+            default:
+                return std::pair<int, int>(q, r);
+        }
+    }
+    /**
+     * @brief Converts a column and row of the flat array back to axial coordinates.
+     *
+     */
+    inline std::pair<int, int> from_local(int col, int row) const {
+        switch (shape) {
+            case HEX_MAP_RECTANGLE_ODD_R:
+                return hex_offset_to_axial(col, row, HEX_OFFSET_ODD_R);
+            case HEX_MAP_RECTANGLE_EVEN_Q:
+                return hex_offset_to_axial(col, row, HEX_OFFSET_EVEN_Q);
+            case HEX_MAP_HEXAGON:
+                return std::pair<int, int>(col - radius, row - radius);
+            default:
+                return std::pair<int, int>(col, row);
+        }
+    }
+    /**
+     * @brief Wraps a column and row of the flat array back into the map, along the axes the wrap mode joins.
+     *
+     */
+    inline void wrap_local(int &col, int &row) const {
+        col = ((col % width) + width) % width;
+        if (wrap == HEX_WRAP_TOROIDAL) {
+            row = ((row % height) + height) % height;
+        }
+    }
+    /**
+     * @brief Checks if a column and row of the flat array is part of the map. The hexagon also cuts off the box's corners.
+     *
+     */
+    inline bool local_in_bounds(int col, int row) const {
+        return uint32_t(col) < uint32_t(width) && uint32_t(row) < uint32_t(height) && (shape != HEX_MAP_HEXAGON || uint32_t(col + row - radius) <= uint32_t(2 * radius));
+    }
+    /**
+     * @brief Gets which set of neighbor steps a cell uses.
+     *
+     */
+    inline int parity(int q, int r) const {
+        return shape == HEX_MAP_RECTANGLE_ODD_R ? (r & 1) : shape == HEX_MAP_RECTANGLE_EVEN_Q ? (q & 1) : 0;
+    }
+
+public:
+    /**
+     * @brief Packs axial coordinates into a key without collisions.
+     *
+     * @param q The q-coordinate.
+     * @param r The r-coordinate.
+     * @return int64_t The key.
+     */
+    static inline int64_t key(int q, int r) {
+        return int64_t((uint64_t(uint32_t(q)) << 32) | uint64_t(uint32_t(r)));
+    }
+    /**
+     * @brief Unpacks a key back into axial coordinates.
+     *
+     * @param key The key.
+     * @return std::pair<int, int> The q-coordinate as its first, and the r-coordinate as its second.
+     */
+    static inline std::pair<int, int> unkey(int64_t key) {
+        return std::pair<int, int>(int(int32_t(uint32_t(uint64_t(key) >> 32))), int(int32_t(uint32_t(uint64_t(key)))));
+    }
+
+    /**
+     * @brief Changes the map's shape. The storage must be empty.
+     *
+     * @param new_shape The shape. Typically a HexMapShape enum.
+     * @param new_width The width, or the radius for HEX_MAP_HEXAGON.
+     * @param new_height The height. Unused by HEX_MAP_HEXAGON.
+     * @param new_wrap How the edges connect. Typically a HexWrapMode enum. Only odd-r rectangles and parallelograms can wrap, and odd-r rectangles need an even height to wrap north to south.
+     */
+    void configure(int new_shape, int new_width, int new_height, int new_wrap);
+    int get_shape() const;
+    int get_wrap() const;
+    /**
+     * @brief Checks if a shape and wrap mode can be combined.
+     *
+     * @return bool True if the storage can be configured with them.
+     */
+    static bool can_wrap(int shape, int height, int wrap);
+    /**
+     * @brief Gets the distance between two hexes, taking the shortest way around a wrapping map.
+     *
+     * @return int The distance in steps.
+     */
+    int distance(std::pair<int, int> hex_one, std::pair<int, int> hex_two) const;
+    /**
+     * @brief Gets the copy of a hex that is closest to another, taking the shortest way around a wrapping map. Drawing a line or a path to the copy crosses the seam when that is shorter.
+     *
+     * @param from The hex to measure from. Should be canonical.
+     * @param to The hex to find a copy of.
+     * @return std::pair<int, int> The closest copy of to. Not canonical, it may lie outside of the map.
+     */
+    std::pair<int, int> nearest_copy(std::pair<int, int> from, std::pair<int, int> to) const;
+    /**
+     * @brief Checks if the map has bounds, and so uses the flat array.
+     *
+     */
+    bool is_bounded() const;
+    /**
+     * @brief Gets the amount of cells in the map.
+     *
+     * @return int64_t The amount of cells, or -1 if the map is unbounded.
+     */
+    int64_t get_cell_count() const;
+    /**
+     * @brief Gets the amount of stored tiles.
+     *
+     */
+    size_t size() const;
+    /**
+     * @brief Estimates the memory used by the storage.
+     *
+     * @return size_t The estimate, in bytes.
+     */
+    size_t get_memory_usage() const;
+    /**
+     * @brief Gets the share of used slots, of the hash map's buckets or of the flat array's cells.
+     *
+     */
+    float get_load_factor() const;
+    /**
+     * @brief Stores a tile.
+     *
+     * @param q The q-coordinate.
+     * @param r The r-coordinate.
+     * @param tile The tile. Must not be null.
+     * @return bool False if the coordinates are outside of the map.
+     */
+    bool store(int q, int r, HexTile* tile);
+    /**
+     * @brief Removes a tile.
+     *
+     * @param q The q-coordinate.
+     * @param r The r-coordinate.
+     * @return HexTile* The removed tile, or null if there was none.
+     */
+    HexTile* erase(int q, int r);
+    /**
+     * @brief Removes every tile, keeping the shape.
+     *
+     */
+    void clear();
+
+    /**
+     * @brief Checks if the map wraps around.
+     *
+     */
+    inline bool wraps() const {
+        return wrap != HEX_WRAP_NONE;
+    }
+    /**
+     * @brief Maps coordinates past the seam of a wrapping map back onto the map. Every cell has exactly one canonical pair of coordinates, the one its tile is stored and spawned at.
+     *
+     * @param hex The coordinates.
+     * @return std::pair<int, int> The canonical coordinates. Unchanged if the map does not wrap.
+     */
+    inline std::pair<int, int> canonicalize(std::pair<int, int> hex) const {
+        if (wrap == HEX_WRAP_NONE) {
+            return hex;
+        }
+        std::pair<int, int> local = to_local(hex.first, hex.second);
+        wrap_local(local.first, local.second);
+        return from_local(local.first, local.second);
+    }
+    /**
+     * @brief Gets a cell's index in the flat array.
+     *
+     * @param q The q-coordinate.
+     * @param r The r-coordinate.
+     * @return int64_t The index, or -1 if the coordinates are outside of the map or the map is unbounded.
+     */
+    inline int64_t index_of(int q, int r) const {
+        std::pair<int, int> local = to_local(q, r);
+        if (wrap != HEX_WRAP_NONE) {
+            wrap_local(local.first, local.second);
+        }
+        if (dense_tiles.empty() || !local_in_bounds(local.first, local.second)) {
+            return -1;
+        }
+        return int64_t(local.second) * width + local.first;
+    }
+    /**
+     * @brief Checks if coordinates are inside the map. Always true for unbounded maps. On wrapping maps, coordinates past the seam count as inside.
+     *
+     */
+    inline bool contains(int q, int r) const {
+        if (shape == HEX_MAP_UNBOUNDED) {
+            return true;
+        }
+        std::pair<int, int> local = to_local(q, r);
+        if (wrap != HEX_WRAP_NONE) {
+            wrap_local(local.first, local.second);
+        }
+        return local_in_bounds(local.first, local.second);
+    }
+    /**
+     * @brief Gets the tile at the coordinates. Unlike indexing the hash map, this never inserts anything.
+     *
+     * @param q The q-coordinate.
+     * @param r The r-coordinate.
+     * @return HexTile* The tile, or null if there is none.
+     */
+    inline HexTile* get(int q, int r) const {
+        if (shape != HEX_MAP_UNBOUNDED) {
+            int64_t index = index_of(q, r);
+            return index < 0 ? nullptr : dense_tiles[index];
+        }
+        auto tile = sparse_tiles.find(key(q, r));
+        return tile == sparse_tiles.end() ? nullptr : tile->second;
+    }
+
+    /**
+     * @brief Calls a function for every neighbor of a cell that is inside the map, in the order of HEX_DIRECTIONS. Bounded maps step through the flat array instead of looking up every neighbor. On wrapping maps, neighbors across the seam are passed with their canonical coordinates.
+     *
+     * @param q The q-coordinate.
+     * @param r The r-coordinate.
+     * @param function Called as function(q, r, tile). The tile can be null.
+     */
+    template <typename Function>
+    void for_each_neighbor(int q, int r, Function &&function) const {
+        if (wrap != HEX_WRAP_NONE) {
+            std::pair<int, int> hex = canonicalize(std::pair<int, int>(q, r));
+            std::pair<int, int> local = to_local(hex.first, hex.second);
+            const std::array<NeighborStep, 6> &steps = neighbor_steps[parity(hex.first, hex.second)];
+            for (int i = 0; i < 6; i++) {
+                int col = local.first + steps[i].col;
+                int row = local.second + steps[i].row;
+                wrap_local(col, row);
+                if (local_in_bounds(col, row)) {
+                    std::pair<int, int> neighbor = from_local(col, row);
+                    function(neighbor.first, neighbor.second, dense_tiles[int64_t(row) * width + col]);
+                }
+            }
+            return;
+        }
+
+        std::pair<int, int> local = to_local(q, r);
+        if (shape == HEX_MAP_UNBOUNDED || !local_in_bounds(local.first, local.second)) {
+            for (std::pair<int, int> direction : HEX_DIRECTIONS) {
+                int neighbor_q = q + direction.first;
+                int neighbor_r = r + direction.second;
+                if (contains(neighbor_q, neighbor_r)) {
+                    function(neighbor_q, neighbor_r, get(neighbor_q, neighbor_r));
+                }
+            }
+            return;
+        }
+
+        const std::array<NeighborStep, 6> &steps = neighbor_steps[parity(q, r)];
+        HexTile* const* center = dense_tiles.data() + int64_t(local.second) * width + local.first;
+        for (int i = 0; i < 6; i++) {
+            if (local_in_bounds(local.first + steps[i].col, local.second + steps[i].row)) {
+                function(q + HEX_DIRECTIONS[i].first, r + HEX_DIRECTIONS[i].second, center[steps[i].index]);
+            }
+        }
+    }
+    /**
+     * @brief Calls a function for every stored tile. Bounded maps go row by row, unbounded maps in no particular order.
+     *
+     * @param function Called as function(q, r, tile).
+     */
+    template <typename Function>
+    void for_each(Function &&function) const {
+        if (shape == HEX_MAP_UNBOUNDED) {
+            for (const std::pair<const int64_t, HexTile*> &pair : sparse_tiles) {
+                std::pair<int, int> hex = unkey(pair.first);
+                function(hex.first, hex.second, pair.second);
+            }
+            return;
+        }
+
+        for (size_t index = 0; index < dense_tiles.size(); index++) {
+            if (dense_tiles[index]) {
+                std::pair<int, int> hex = co_ords_of(int64_t(index));
+                function(hex.first, hex.second, dense_tiles[index]);
+            }
+        }
+    }
+    /**
+     * @brief Calls a function for every cell of a bounded map, whether it holds a tile or not, row by row.
+     *
+     * @param function Called as function(q, r).
+     */
+    template <typename Function>
+    void for_each_cell(Function &&function) const {
+        for (int row = 0; row < height; row++) {
+            for (int col = 0; col < width; col++) {
+                if (local_in_bounds(col, row)) {
+                    std::pair<int, int> hex = co_ords_of(int64_t(row) * width + col);
+                    function(hex.first, hex.second);
+                }
+            }
+        }
+    }
+    /**
+     * @brief Gets the coordinates of an index in the flat array.
+     *
+     * @param index The index.
+     * @return std::pair<int, int> The axial coordinates.
+     */
+    std::pair<int, int> co_ords_of(int64_t index) const;
+};
+
+#endif //GODOT_HEX_GRID_EXTENSION_HEX_TILE_STORAGE_H
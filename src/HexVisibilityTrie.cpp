@@ -0,0 +1,100 @@
+#include "HexVisibilityTrie.h"
+#include "HexShapes.h"
+#include "HexTileStorage.h"
+
+namespace {
+	/**
+	 * @brief A node of the trie while it is being built, before it is flattened.
+	 *
+	 */
+	struct BuildNode {
+		std::pair<int, int> hex{};
+		int depth{};
+		bool terminal{};
+		std::vector<uint32_t> children{};
+	};
+}
+
+void HexVisibilityTrie::build(int new_radius) {
+	radius = new_radius;
+	nodes.clear();
+	terminals.clear();
+	if (new_radius < 0) {
+		return;
+	}
+
+	std::vector<BuildNode> build_nodes{};
+	build_nodes.push_back(BuildNode{ std::pair<int, int>(0, 0), 0, true });
+
+	for (std::pair<int, int> target : HexSpiralRange(0, 0, new_radius)) {
+		uint32_t current = 0;
+		HexLineRange line(std::pair<int, int>(0, 0), target, true);
+		auto point = line.begin();
+		// The first point of every line is the origin, the root.
+		for (++point; point != line.end(); ++point) {
+			uint32_t next = 0;
+			for (uint32_t child : build_nodes[current].children) {
+				if (build_nodes[child].hex == *point) {
+					next = child;
+					break;
+				}
+			}
+			if (next == 0) {
+				next = uint32_t(build_nodes.size());
+				build_nodes.push_back(BuildNode{ *point, build_nodes[current].depth + 1 });
+				build_nodes[current].children.push_back(next);
+			}
+			current = next;
+		}
+		build_nodes[current].terminal = true;
+	}
+
+	// Flattens the trie in depth first order. A stack entry is a build node and the flat index of its parent.
+	nodes.reserve(build_nodes.size());
+	std::vector<std::pair<uint32_t, uint32_t>> stack{ { 0, 0 } };
+	std::vector<uint32_t> open_nodes{};
+	while (!stack.empty()) {
+		std::pair<uint32_t, uint32_t> entry = stack.back();
+		stack.pop_back();
+		const BuildNode &build_node = build_nodes[entry.first];
+
+		// Every node still open at this depth or deeper has no descendants left.
+		while (!open_nodes.empty() && nodes[open_nodes.back()].depth >= build_node.depth) {
+			nodes[open_nodes.back()].subtree_end = uint32_t(nodes.size());
+			open_nodes.pop_back();
+		}
+
+		uint32_t index = uint32_t(nodes.size());
+		Node node{};
+		node.q = int16_t(build_node.hex.first);
+		node.r = int16_t(build_node.hex.second);
+		node.depth = uint16_t(build_node.depth);
+		node.terminal = build_node.terminal;
+		node.parent = entry.second;
+		nodes.push_back(node);
+		open_nodes.push_back(index);
+		if (build_node.terminal) {
+			terminals[HexTileStorage::key(build_node.hex.first, build_node.hex.second)] = index;
+		}
+
+		for (auto child = build_node.children.rbegin(); child != build_node.children.rend(); ++child) {
+			stack.push_back(std::pair<uint32_t, uint32_t>(*child, index));
+		}
+	}
+	for (uint32_t index : open_nodes) {
+		nodes[index].subtree_end = uint32_t(nodes.size());
+	}
+}
+
+int HexVisibilityTrie::get_radius() const {
+	return radius;
+}
+
+const std::vector<HexVisibilityTrie::Node> &HexVisibilityTrie::get_nodes() const {
+	return nodes;
+}
+
+int64_t HexVisibilityTrie::find_terminal(int dq, int dr) const {
+	auto terminal = terminals.find(HexTileStorage::key(dq, dr));
+	return terminal == terminals.end() ? -1 : int64_t(terminal->second);
+}
@@ -0,0 +1,137 @@
+/**
+ * @file HexVisibilityTrie.h
+ * @brief A precomputed trie of every symmetric line from the origin, based on denismr's Symmetric Precomputed Visibility Trie.
+ * @details See https://github.com/denismr/SymmetricPCVT/ for the original. Every line from the origin to a hex within the radius is inserted into a trie, so lines that share a start share nodes. The trie is stored flattened in depth first order, where a node's subtree is the range up to its subtree end. A visibility query walks the nodes in order and skips a whole subtree at the first blocker, so every line behind a blocker is pruned at once.
+ * @version 1.0
+ *
+ *
+ *
+ */
+#ifndef GODOT_HEX_GRID_EXTENSION_HEX_VISIBILITY_TRIE_H
+#define GODOT_HEX_GRID_EXTENSION_HEX_VISIBILITY_TRIE_H
+
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/// @brief The lines of sight from the origin to every hex within a radius. Not a Godot object, the HexGrid owns its trie.
+class HexVisibilityTrie
+{
+public:
+    /**
+     * @brief A hex on one or more lines, relative to the origin.
+     *
+     */
+    struct Node {
+        /// @brief The offset from the origin.
+        int16_t q{};
+        int16_t r{};
+        /// @brief The distance from the origin, which is also the node's depth in the trie.
+        uint16_t depth{};
+        /// @brief Whether a line ends here, so this node decides if its hex is visible.
+        bool terminal{};
+        /// @brief The index one past the node's last descendant.
+        uint32_t subtree_end{};
+        /// @brief The index of the node one step closer to the origin.
+        uint32_t parent{};
+    };
+
+private:
+    /**
+     * @brief The nodes in depth first order. The root is the origin itself.
+     *
+     */
+    std::vector<Node> nodes{};
+    /**
+     * @brief A map that maps an offset's key to the node its line ends at.
+     *
+     */
+    std::unordered_map<int64_t, uint32_t> terminals{};
+    /**
+     * @brief The radius the trie was built for.
+     *
+     */
+    int radius{ -1 };
+
+public:
+    /**
+     * @brief Rebuilds the trie for a radius. Lines are drawn with the symmetric variant of HexLineRange, like get_cube_symmetric_line.
+     *
+     * @param new_radius The furthest distance lines reach.
+     */
+    void build(int new_radius);
+    /**
+     * @brief Gets the radius the trie was built for.
+     *
+     * @return int The radius, or -1 if the trie was never built.
+     */
+    int get_radius() const;
+    /**
+     * @brief Gets the nodes in depth first order.
+     *
+     */
+    const std::vector<Node> &get_nodes() const;
+    /**
+     * @brief Finds the node a line ends at.
+     *
+     * @param dq The target's q-coordinate relative to the origin.
+     * @param dr The target's r-coordinate relative to the origin.
+     * @return int64_t The node's index, or -1 if the offset is beyond the radius.
+     */
+    int64_t find_terminal(int dq, int dr) const;
+
+    /**
+     * @brief Walks every line from an origin, stopping each line at its first blocker. The origin itself never blocks.
+     *
+     * @param radius The furthest distance to walk. Should be no more than the trie's radius.
+     * @param is_blocked Called as is_blocked(dq, dr) with offsets from the origin. Returns true if the hex blocks sight.
+     * @param visit Called as visit(dq, dr) for every visible hex, once per hex. Blockers are visible if the line to them is clear.
+     */
+    template <typename Blocked, typename Visit>
+    void walk(int radius, Blocked &&is_blocked, Visit &&visit) const {
+        if (nodes.empty()) {
+            return;
+        }
+        visit(0, 0);
+
+        uint32_t count = uint32_t(nodes.size());
+        uint32_t index = 1;
+        while (index < count) {
+            const Node &node = nodes[index];
+            if (node.depth > radius) {
+                index = node.subtree_end;
+                continue;
+            }
+            bool blocked = is_blocked(node.q, node.r);
+            if (node.terminal) {
+                visit(node.q, node.r);
+            }
+            // Every line through a blocker is blocked past it, so its whole subtree is skipped.
+            index = blocked ? node.subtree_end : index + 1;
+        }
+    }
+    /**
+     * @brief Checks if the line from the origin to an offset is clear. Only the hexes between the two ends can block.
+     *
+     * @param dq The target's q-coordinate relative to the origin. Must be within the trie's radius.
+     * @param dr The target's r-coordinate relative to the origin.
+     * @param is_blocked Called as is_blocked(dq, dr) with offsets from the origin.
+     * @return bool True if nothing blocks the line.
+     */
+    template <typename Blocked>
+    bool is_line_clear(int dq, int dr, Blocked &&is_blocked) const {
+        int64_t index = find_terminal(dq, dr);
+        if (index <= 0) {
+            return index == 0;
+        }
+        for (uint32_t node = nodes[index].parent; node != 0; node = nodes[node].parent) {
+            if (is_blocked(nodes[node].q, nodes[node].r)) {
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
+#endif //GODOT_HEX_GRID_EXTENSION_HEX_VISIBILITY_TRIE_H
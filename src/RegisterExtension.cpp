@@ -15,6 +15,13 @@
 
 #include "HexTile.h"
 #include "HexGrid.h"
+#include "HexRegion.h"
+#include "HexInfluenceMap.h"
+#include "HexPathPlanner.h"
+#include "HexGraph.h"
+#include "HexCellularAutomaton.h"
+#include "HexGridSnapshot.h"
+#include "HexPattern.h"
 #include "GodotHexGridExtension.h"
 
 /// @file
@@ -37,6 +44,13 @@ namespace
 
         godot::ClassDB::register_class<HexGrid>();
         godot::ClassDB::register_class<HexTile>();
+        godot::ClassDB::register_class<HexRegion>();
+        godot::ClassDB::register_class<HexInfluenceMap>();
+        godot::ClassDB::register_class<HexPathPlanner>();
+        godot::ClassDB::register_class<HexGraph>();
+        godot::ClassDB::register_class<HexCellularAutomaton>();
+        godot::ClassDB::register_class<HexGridSnapshot>();
+        godot::ClassDB::register_class<HexPattern>();
         godot::ClassDB::register_class<GodotHexGridExtension>();
     }
 